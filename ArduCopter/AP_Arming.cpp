@@ -53,10 +53,12 @@ bool AP_Arming_Copter::pre_arm_checks(bool display_failure)
         return true;
     }
 
-    return fence_checks(display_failure)
-        & parameter_checks(display_failure)
-        & motor_checks(display_failure)
-        & pilot_throttle_checks(display_failure) &
+    return run_check("Fence", FUNCTOR_BIND_MEMBER(&AP_Arming_Copter::pre_arm_fence_check, bool, bool), display_failure)
+        & run_check("Parameters", FUNCTOR_BIND_MEMBER(&AP_Arming_Copter::parameter_checks, bool, bool), display_failure,
+                    CHECK_INPUT_PARAMETERS)
+        & run_check("Environment", FUNCTOR_BIND_MEMBER(&AP_Arming_Copter::environment_checks, bool, bool), display_failure)
+        & run_check("Motors", FUNCTOR_BIND_MEMBER(&AP_Arming_Copter::motor_checks, bool, bool), display_failure)
+        & run_check("Throttle", FUNCTOR_BIND_MEMBER(&AP_Arming_Copter::pilot_throttle_checks, bool, bool), display_failure) &
         AP_Arming::pre_arm_checks(display_failure);
 }
 
@@ -138,6 +140,8 @@ bool AP_Arming_Copter::board_voltage_checks(bool display_failure)
     return true;
 }
 
+// check parameter values. These only depend on the configuration so
+// the result is cached by run_check() until a parameter changes
 bool AP_Arming_Copter::parameter_checks(bool display_failure)
 {
     // check various parameter values
@@ -172,18 +176,11 @@ bool AP_Arming_Copter::parameter_checks(bool display_failure)
         }
 #endif
 
-        #if RANGEFINDER_ENABLED == ENABLED && OPTFLOW == ENABLED
-        // check range finder if optflow enabled
-        if (copter.optflow.enabled() && !copter.rangefinder.pre_arm_check()) {
-            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "check range finder");
-            return false;
-        }
-        #endif
-
         #if FRAME_CONFIG == HELI_FRAME
         // check helicopter parameters
-        if (!copter.motors->parameter_check(display_failure)) {
-            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "Heli motors checks failed");
+        char fail_msg[50];
+        if (!copter.motors->parameter_check(fail_msg, ARRAY_SIZE(fail_msg))) {
+            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "%s", fail_msg);
             return false;
         }
         // Inverted flight feature disabled for Heli Single and Dual frames
@@ -200,6 +197,35 @@ bool AP_Arming_Copter::parameter_checks(bool display_failure)
 
         #endif // HELI_FRAME
 
+        // ensure controllers are OK with us arming:
+        char failure_msg[50];
+        if (!copter.pos_control->pre_arm_checks("PSC", failure_msg, ARRAY_SIZE(failure_msg))) {
+            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "Bad parameter: %s", failure_msg);
+            return false;
+        }
+        if (!copter.attitude_control->pre_arm_checks("ATC", failure_msg, ARRAY_SIZE(failure_msg))) {
+            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "Bad parameter: %s", failure_msg);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// checks enabled with the parameter checks that depend on sensors and
+// the vehicle's surroundings, so are run every time
+bool AP_Arming_Copter::environment_checks(bool display_failure)
+{
+    if ((checks_to_perform == ARMING_CHECK_ALL) || (checks_to_perform & ARMING_CHECK_PARAMETERS)) {
+
+        #if RANGEFINDER_ENABLED == ENABLED && OPTFLOW == ENABLED
+        // check range finder if optflow enabled
+        if (copter.optflow.enabled() && !copter.rangefinder.pre_arm_check()) {
+            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "check range finder");
+            return false;
+        }
+        #endif
+
         // check for missing terrain data
         if (!pre_arm_terrain_check(display_failure)) {
             return false;
@@ -217,17 +243,6 @@ bool AP_Arming_Copter::parameter_checks(bool display_failure)
         if (!pre_arm_proximity_check(display_failure)) {
             return false;
         }
-
-        // ensure controllers are OK with us arming:
-        char failure_msg[50];
-        if (!copter.pos_control->pre_arm_checks("PSC", failure_msg, ARRAY_SIZE(failure_msg))) {
-            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "Bad parameter: %s", failure_msg);
-            return false;
-        }
-        if (!copter.attitude_control->pre_arm_checks("ATC", failure_msg, ARRAY_SIZE(failure_msg))) {
-            check_failed(ARMING_CHECK_PARAMETERS, display_failure, "Bad parameter: %s", failure_msg);
-            return false;
-        }
     }
 
     return true;
@@ -378,6 +393,13 @@ bool AP_Arming_Copter::pre_arm_ekf_attitude_check()
     return filt_status.flags.attitude;
 }
 
+// check the fence is ready. The inherited fence_checks() can't be bound
+// by run_check() from here as it is a protected member of AP_Arming
+bool AP_Arming_Copter::pre_arm_fence_check(bool display_failure)
+{
+    return fence_checks(display_failure);
+}
+
 // check we have required terrain data
 bool AP_Arming_Copter::pre_arm_terrain_check(bool display_failure)
 {
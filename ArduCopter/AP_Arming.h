@@ -28,6 +28,7 @@ protected:
 
     bool pre_arm_checks(bool display_failure) override;
     bool pre_arm_ekf_attitude_check();
+    bool pre_arm_fence_check(bool display_failure);
     bool pre_arm_terrain_check(bool display_failure);
     bool pre_arm_proximity_check(bool display_failure);
     bool arm_checks(bool display_failure, AP_Arming::Method method);
@@ -41,6 +42,7 @@ protected:
 
     // NOTE! the following check functions *DO NOT* call into AP_Arming!
     bool parameter_checks(bool display_failure);
+    bool environment_checks(bool display_failure);
     bool motor_checks(bool display_failure);
     bool pilot_throttle_checks(bool display_failure);
 
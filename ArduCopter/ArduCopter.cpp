@@ -129,6 +129,7 @@ const AP_Scheduler::Task Copter::scheduler_tasks[] = {
 #if LOGGING_ENABLED == ENABLED
     SCHED_TASK(fourhundred_hz_logging,400,    50),
 #endif
+    SCHED_TASK_CLASS(SRV_Channels,         &copter.g2.servo_channels,   update_esc_telem, 50,  75),
     SCHED_TASK_CLASS(AP_Notify,            &copter.notify,              update,          50,  90),
     SCHED_TASK(one_hz_loop,            1,    100),
     SCHED_TASK(ekf_check,             10,     75),
@@ -225,11 +226,19 @@ void Copter::fast_loop()
     // update INS immediately to get current gyro data populated
     ins.update();
 
-    // run low level rate controllers that only require IMU data
-    attitude_control->rate_controller_run();
+    if (!fast_rate_thread_active()) {
+        // run low level rate controllers that only require IMU data
+        attitude_control->rate_controller_run();
 
-    // send outputs to the motors library immediately
-    motors_output();
+        // send outputs to the motors library immediately
+        motors_output();
+    }
+#if FRAME_CONFIG != HELI_FRAME
+    else if (rate_thread_update_outputs()) {
+        // the motor test drives the motors from the main loop
+        motors_output();
+    }
+#endif
 
     // run EKF state estimator (expensive)
     // --------------------
@@ -249,6 +258,11 @@ void Copter::fast_loop()
     // run the attitude controllers
     update_flight_mode();
 
+    if (fast_rate_thread_active()) {
+        // pass the new rate targets to the rate thread
+        attitude_control->publish_rate_targets();
+    }
+
     // update home from EKF if necessary
     update_home_from_EKF();
 
@@ -365,6 +379,9 @@ void Copter::ten_hz_logging_loop()
 #if FRAME_CONFIG == HELI_FRAME
     Log_Write_Heli();
 #endif
+    if (should_log(MASK_LOG_PM)) {
+        Log_Write_Rate_Thread();
+    }
 }
 
 // twentyfive_hz_logging - should be run at 25hz
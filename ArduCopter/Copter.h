@@ -77,6 +77,7 @@
 #include <AP_SmartRTL/AP_SmartRTL.h>
 #include <AP_TempCalibration/AP_TempCalibration.h>
 #include <AC_AutoTune/AC_AutoTune.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
 
 // Configuration
 #include "defines.h"
@@ -96,6 +97,10 @@
 #if AC_AVOID_ENABLED == ENABLED
  #include <AC_Avoidance/AC_Avoid.h>
 #endif
+#if AC_OAPATHPLANNER_ENABLED == ENABLED
+ #include <AC_WPNav/AC_WPNav_OA.h>
+ #include <AC_Avoidance/AP_OAPathPlanner.h>
+#endif
 #if SPRAYER_ENABLED == ENABLED
  # include <AC_Sprayer/AC_Sprayer.h>
 #endif
@@ -360,6 +365,28 @@ private:
         return failsafe.radio || battery.has_failsafed() || failsafe.gcs || failsafe.ekf || failsafe.terrain || failsafe.adsb;
     }
 
+#if FRAME_CONFIG != HELI_FRAME
+    // fast rate thread state, written by the rate thread
+    struct RateThreadStats {
+        uint16_t loop_rate_hz;          // rate controller runs per second
+        uint16_t latency_min_us;        // shortest time from gyro sample to motor output
+        uint16_t latency_avg_us;
+        uint16_t latency_max_us;
+        uint32_t timeouts;              // waits for a gyro sample that timed out
+    };
+    // motor output state evaluated by the main loop for the rate thread
+    struct RateThreadOutputs {
+        bool enabled;                   // false while the advanced failsafe has stopped the motors or the main loop drives them
+        bool interlock;                 // motor interlock from motors_interlock_update()
+    };
+    struct {
+        bool active;                    // true once the thread has been started, the main loop no longer runs the rate controller
+        bool main_loop_output;          // the main loop is driving the motors for a motor test
+        DoubleBuffer<RateThreadStats> stats;
+        DoubleBuffer<RateThreadOutputs> outputs;
+    } rate_thread;
+#endif
+
     // sensor health for logging
     struct {
         uint8_t baro        : 1;    // true if baro is healthy
@@ -442,6 +469,9 @@ private:
     // arm_time_ms - Records when vehicle was armed. Will be Zero if we are disarmed.
     uint32_t arm_time_ms;
 
+    // motor interlock state last logged by motors_interlock_update()
+    bool motors_interlock_logged;
+
     // Used to exit the roll and pitch auto trim function
     uint8_t auto_trim_counter;
 
@@ -729,6 +759,7 @@ private:
 #endif
     void Log_Write_Precland();
     void Log_Write_GuidedTarget(uint8_t target_type, const Vector3f& pos_target, const Vector3f& vel_target);
+    void Log_Write_Rate_Thread();
     void Log_Write_Vehicle_Startup_Messages();
     void log_init(void);
 
@@ -753,8 +784,25 @@ private:
     bool init_arm_motors(AP_Arming::Method method, bool do_arming_checks=true);
     void init_disarm_motors();
     void motors_output();
+    bool motors_output_enabled();
+    bool motors_interlock_update();
+    void motors_output_run(bool interlock, bool motor_test);
     void lost_vehicle_check();
 
+    // rate_thread.cpp
+#if FRAME_CONFIG != HELI_FRAME
+    void rate_thread_init();
+    void rate_thread_run();
+    bool rate_thread_update_outputs();
+#endif
+    bool fast_rate_thread_active() const {
+#if FRAME_CONFIG != HELI_FRAME
+        return rate_thread.active;
+#else
+        return false;
+#endif
+    }
+
     // navigation.cpp
     void run_nav_updates(void);
     int32_t home_bearing();
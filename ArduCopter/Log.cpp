@@ -382,6 +382,40 @@ void Copter::Log_Write_GuidedTarget(uint8_t target_type, const Vector3f& pos_tar
     logger.WriteBlock(&pkt, sizeof(pkt));
 }
 
+// fast rate thread logging
+struct PACKED log_Rate_Thread {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t loop_rate_hz;
+    uint16_t latency_min_us;
+    uint16_t latency_avg_us;
+    uint16_t latency_max_us;
+    uint32_t timeouts;
+    uint32_t gyro_overruns;
+};
+
+// Write the fast rate thread's loop rate and gyro to motor output latency
+void Copter::Log_Write_Rate_Thread()
+{
+#if FRAME_CONFIG != HELI_FRAME
+    RateThreadStats stats;
+    if (!rate_thread.active || !rate_thread.stats.read(stats)) {
+        return;
+    }
+    struct log_Rate_Thread pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_RATE_THREAD_MSG),
+        time_us         : AP_HAL::micros64(),
+        loop_rate_hz    : stats.loop_rate_hz,
+        latency_min_us  : stats.latency_min_us,
+        latency_avg_us  : stats.latency_avg_us,
+        latency_max_us  : stats.latency_max_us,
+        timeouts        : stats.timeouts,
+        gyro_overruns   : ins.get_fast_gyro_overruns()
+    };
+    logger.WriteBlock(&pkt, sizeof(pkt));
+#endif
+}
+
 // type and unit information can be found in
 // libraries/AP_Logger/Logstructure.h; search for "log_Units" for
 // units and "Format characters" for field type information
@@ -413,6 +447,8 @@ const struct LogStructure Copter::log_structure[] = {
 #endif
     { LOG_GUIDEDTARGET_MSG, sizeof(log_GuidedTarget),
       "GUID",  "QBffffff",    "TimeUS,Type,pX,pY,pZ,vX,vY,vZ", "s-mmmnnn", "F-000000" },
+    { LOG_RATE_THREAD_MSG, sizeof(log_Rate_Thread),
+      "FRT",   "QHHHHII",     "TimeUS,Rate,LMin,LAvg,LMax,TOut,GOvr", "szsss--", "F-FFF--" },
 };
 
 void Copter::Log_Write_Vehicle_Startup_Messages()
@@ -447,6 +483,7 @@ void Copter::Log_Write_Parameter_Tuning(uint8_t param, float tuning_val, int16_t
 void Copter::Log_Sensor_Health() {}
 void Copter::Log_Write_Precland() {}
 void Copter::Log_Write_GuidedTarget(uint8_t target_type, const Vector3f& pos_target, const Vector3f& vel_target) {}
+void Copter::Log_Write_Rate_Thread() {}
 void Copter::Log_Write_Vehicle_Startup_Messages() {}
 
 #if FRAME_CONFIG == HELI_FRAME
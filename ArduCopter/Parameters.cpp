@@ -934,6 +934,22 @@ const AP_Param::GroupInfo ParametersG2::var_info[] = {
     // Scripting is intentionally not showing up in the parameter docs until it is a more standard feature
     AP_SUBGROUPINFO(scripting, "SCR_", 30, ParametersG2, AP_Scripting),
 #endif
+
+#if AC_OAPATHPLANNER_ENABLED == ENABLED
+    // @Group: OA_
+    // @Path: ../libraries/AC_Avoidance/AP_OAPathPlanner.cpp
+    AP_SUBGROUPINFO(oa, "OA_", 31, ParametersG2, AP_OAPathPlanner),
+#endif
+
+#if FRAME_CONFIG != HELI_FRAME
+    // @Param: FSTRATE_ENABLE
+    // @DisplayName: Fast rate thread enable
+    // @Description: Runs the rate controller and motor output in a high priority thread on every gyro sample instead of in the main loop, reducing the time from gyro sample to motor output
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("FSTRATE_ENABLE", 32, ParametersG2, fast_rate_enable, 0),
+#endif
     
     AP_GROUPEND
 };
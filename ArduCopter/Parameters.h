@@ -588,6 +588,15 @@ public:
     AP_Scripting scripting;
 #endif // ENABLE_SCRIPTING
 
+#if AC_OAPATHPLANNER_ENABLED == ENABLED
+    // object avoidance path planning
+    AP_OAPathPlanner oa;
+#endif
+
+#if FRAME_CONFIG != HELI_FRAME
+    // run the rate controller and motor output in their own thread
+    AP_Int8 fast_rate_enable;
+#endif
 };
 
 extern const AP_Param::Info        var_info[];
@@ -680,6 +680,14 @@
   #error AC_Avoidance relies on AC_FENCE which is disabled
 #endif
 
+#ifndef AC_OAPATHPLANNER_ENABLED
+ #define AC_OAPATHPLANNER_ENABLED   !HAL_MINIMIZE_FEATURES
+#endif
+
+#if AC_OAPATHPLANNER_ENABLED && !AC_AVOID_ENABLED
+  #error AC_OAPathPlanner relies on AC_AVOID_ENABLED which is disabled
+#endif
+
 #if MODE_FOLLOW_ENABLED && !AC_AVOID_ENABLED
   #error Follow Mode relies on AC_AVOID which is disabled
 #endif
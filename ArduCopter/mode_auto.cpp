@@ -1141,6 +1141,11 @@ void Copter::ModeAuto::do_nav_wp(const AP_Mission::Mission_Command& cmd)
                 break;
         }
         copter.wp_nav->set_fast_waypoint(fast_waypoint);
+
+        // blend the corner into the next straight segment
+        if (fast_waypoint && temp_cmd.id == MAV_CMD_NAV_WAYPOINT) {
+            copter.wp_nav->set_wp_destination_next(loc_from_cmd(temp_cmd));
+        }
     }
 }
 
@@ -298,6 +298,15 @@ void Copter::init_disarm_motors()
 
 // motors_output - send output to motors library which will adjust and send to ESCs and servos
 void Copter::motors_output()
+{
+    if (!motors_output_enabled()) {
+        return;
+    }
+    motors_output_run(motors_interlock_update(), ap.motor_test);
+}
+
+// returns false if the advanced failsafe has stopped the motor output
+bool Copter::motors_output_enabled()
 {
 #if ADVANCED_FAILSAFE == ENABLED
     // this is to allow the failsafe module to deliberately crash
@@ -306,17 +315,36 @@ void Copter::motors_output()
     if (g2.afs.should_crash_vehicle()) {
         g2.afs.terminate_vehicle();
         if (!g2.afs.terminating_vehicle_via_landing()) {
-            return;
+            return false;
         }
         // landing must continue to run the motors output
     }
 #endif
+    return true;
+}
 
+// update the arming delay and return the motor interlock state. This
+// writes ap and logs so is only called from the main loop, the rate
+// thread is passed the result
+bool Copter::motors_interlock_update()
+{
     // Update arming delay state
     if (ap.in_arming_delay && (!motors->armed() || millis()-arm_time_ms > ARMING_DELAY_SEC*1.0e3f || control_mode == THROW)) {
         ap.in_arming_delay = false;
     }
 
+    const bool interlock = motors->armed() && !ap.in_arming_delay && (!ap.using_interlock || ap.motor_interlock_switch) && !SRV_Channels::get_emergency_stop();
+    // the interlock is not changed during a motor test
+    if (!ap.motor_test && interlock != motors_interlock_logged) {
+        motors_interlock_logged = interlock;
+        Log_Write_Event(interlock ? DATA_MOTORS_INTERLOCK_ENABLED : DATA_MOTORS_INTERLOCK_DISABLED);
+    }
+    return interlock;
+}
+
+// send output to the motors with the interlock state from motors_interlock_update()
+void Copter::motors_output_run(bool interlock, bool motor_test)
+{
     // output any servo channels
     SRV_Channels::calc_pwm();
 
@@ -327,17 +355,10 @@ void Copter::motors_output()
     SRV_Channels::output_ch_all();
 
     // check if we are performing the motor test
-    if (ap.motor_test) {
+    if (motor_test) {
         motor_test_output();
     } else {
-        bool interlock = motors->armed() && !ap.in_arming_delay && (!ap.using_interlock || ap.motor_interlock_switch) && !SRV_Channels::get_emergency_stop();
-        if (!motors->get_interlock() && interlock) {
-            motors->set_interlock(true);
-            Log_Write_Event(DATA_MOTORS_INTERLOCK_ENABLED);
-        } else if (motors->get_interlock() && !interlock) {
-            motors->set_interlock(false);
-            Log_Write_Event(DATA_MOTORS_INTERLOCK_DISABLED);
-        }
+        motors->set_interlock(interlock);
 
         // send output signals to motors
         motors->output();
@@ -0,0 +1,133 @@
+#include "Copter.h"
+
+#if FRAME_CONFIG != HELI_FRAME
+
+/*
+  fast rate thread
+
+  The rate controller and motor output normally run at the start of
+  fast_loop() so a slow scheduler task in the previous loop delays the
+  next motor output. With FSTRATE_ENABLE set they instead run in a
+  high priority thread on every primary gyro sample and the main loop
+  only passes the rate targets to the thread once the flight mode has
+  updated them.
+
+  Everything that writes vehicle state or logs stays on the main loop:
+  the arming delay, motor interlock and advanced failsafe are evaluated
+  there and passed to the thread, and the motor test drives the motors
+  from the main loop.
+ */
+
+#define RATE_THREAD_GYRO_QUEUE_LENGTH   8       // gyro samples queued while the thread is busy
+#define RATE_THREAD_STATS_PERIOD_US     100000  // time between updates of the loop rate and latency statistics
+
+// start the rate thread if enabled, called at the end of initialisation
+void Copter::rate_thread_init()
+{
+    if (g2.fast_rate_enable == 0) {
+        return;
+    }
+
+    if (!ins.enable_fast_gyro(RATE_THREAD_GYRO_QUEUE_LENGTH)) {
+        gcs().send_text(MAV_SEVERITY_ERROR, "Fast rate: failed to allocate gyro queue");
+        return;
+    }
+
+    // the main loop stops running the rate controller and motor output
+    // before the thread starts so they are never run by both
+    rate_thread.active = true;
+
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&Copter::rate_thread_run, void),
+                                      "rate",
+                                      4096, AP_HAL::Scheduler::PRIORITY_BOOST, 1)) {
+        rate_thread.active = false;
+        gcs().send_text(MAV_SEVERITY_ERROR, "Fast rate: failed to start thread");
+        return;
+    }
+}
+
+/*
+  pass the motor output state to the rate thread, called from the
+  main loop. Returns true if the main loop should run motors_output()
+  itself, which it does for a motor test once the rate thread has been
+  told to stop its output
+ */
+bool Copter::rate_thread_update_outputs()
+{
+    const bool main_loop_output = ap.motor_test;
+    const RateThreadOutputs outputs {
+        !main_loop_output && motors_output_enabled(),
+        motors_interlock_update()
+    };
+    rate_thread.outputs.write(outputs);
+
+    const bool ret = main_loop_output && rate_thread.main_loop_output;
+    rate_thread.main_loop_output = main_loop_output;
+    return ret;
+}
+
+// run the rate controller and motor output on each new gyro sample
+void Copter::rate_thread_run()
+{
+    // if the gyro stops the motors are still updated at half the main loop rate
+    const uint32_t timeout_us = scheduler.get_loop_period_us() * 2;
+
+    uint32_t stats_start_us = AP_HAL::micros();
+    uint32_t loops = 0;
+    uint32_t latency_sum_us = 0;
+    uint32_t latency_min_us = UINT32_MAX;
+    uint32_t latency_max_us = 0;
+    uint32_t timeouts = 0;
+
+    while (true) {
+        AP_InertialSensor::FastGyroSample sample;
+        const bool have_sample = ins.wait_for_fast_gyro_sample(sample, timeout_us);
+        if (have_sample) {
+            attitude_control->rate_controller_run_fast(sample.gyro);
+        } else {
+            timeouts++;
+        }
+
+        // compassmot drives the motors from the main thread
+        RateThreadOutputs outputs;
+        if (!ap.compass_mot && rate_thread.outputs.read(outputs) && outputs.enabled) {
+            motors_output_run(outputs.interlock, false);
+        }
+
+        if (have_sample) {
+            // time from the gyro sample arriving to the outputs being pushed
+            const uint32_t latency_us = uint32_t(AP_HAL::micros64() - sample.sample_us);
+            latency_sum_us += latency_us;
+            latency_min_us = MIN(latency_min_us, latency_us);
+            latency_max_us = MAX(latency_max_us, latency_us);
+            loops++;
+        }
+
+        const uint32_t now = AP_HAL::micros();
+        if (now - stats_start_us < RATE_THREAD_STATS_PERIOD_US) {
+            continue;
+        }
+        if (loops > 0) {
+            // run the rate PIDs and the motor throttle filters at the measured rate
+            const float loop_rate_hz = loops * 1.0e6f / (now - stats_start_us);
+            attitude_control->set_rate_controller_dt(1.0f / loop_rate_hz);
+            motors->set_loop_rate(uint16_t(loop_rate_hz + 0.5f));
+
+            const RateThreadStats stats {
+                uint16_t(loop_rate_hz + 0.5f),
+                uint16_t(MIN(latency_min_us, UINT16_MAX)),
+                uint16_t(MIN(latency_sum_us / loops, UINT16_MAX)),
+                uint16_t(MIN(latency_max_us, UINT16_MAX)),
+                timeouts
+            };
+            rate_thread.stats.write(stats);
+        }
+        stats_start_us = now;
+        loops = 0;
+        latency_sum_us = 0;
+        latency_min_us = UINT32_MAX;
+        latency_max_us = 0;
+    }
+}
+
+#endif // FRAME_CONFIG != HELI_FRAME
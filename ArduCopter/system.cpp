@@ -224,6 +224,11 @@ void Copter::init_ardupilot()
     g2.smart_rtl.init();
 #endif
 
+#if AC_OAPATHPLANNER_ENABLED == ENABLED
+    // initialise object avoidance path planning
+    g2.oa.init();
+#endif
+
     // initialise AP_Logger library
     logger.setVehicle_Startup_Writer(FUNCTOR_BIND(&copter, &Copter::Log_Write_Vehicle_Startup_Messages, void));
 
@@ -262,6 +267,11 @@ void Copter::init_ardupilot()
 
     hal.console->printf("\nReady to FLY ");
 
+#if FRAME_CONFIG != HELI_FRAME
+    // move the rate controller out of the main loop if enabled
+    rate_thread_init();
+#endif
+
     // flag that initialisation has completed
     ap.initialised = true;
 }
@@ -567,7 +577,11 @@ void Copter::allocate_motors(void)
     }
     AP_Param::load_object_from_eeprom(pos_control, pos_control->var_info);
 
+#if AC_OAPATHPLANNER_ENABLED == ENABLED
+    wp_nav = new AC_WPNav_OA(inertial_nav, *ahrs_view, *pos_control, *attitude_control);
+#else
     wp_nav = new AC_WPNav(inertial_nav, *ahrs_view, *pos_control, *attitude_control);
+#endif
     if (wp_nav == nullptr) {
         AP_HAL::panic("Unable to allocate WPNav");
     }
@@ -77,6 +77,7 @@ const AP_Scheduler::Task Plane::scheduler_tasks[] = {
     SCHED_TASK(Log_Write_Fast,         25,    300),
     SCHED_TASK(update_logging1,        25,    300),
     SCHED_TASK(update_logging2,        25,    300),
+    SCHED_TASK_CLASS(SRV_Channels, &plane.g2.servo_channels, update_esc_telem, 50, 75),
 #if SOARING_ENABLED == ENABLED
     SCHED_TASK(update_soaring,         50,    400),
 #endif
@@ -1634,6 +1634,49 @@ class AutoTestCopter(AutoTest):
         if ex is not None:
             raise ex
 
+    def test_esc_telemetry(self):
+        ex = None
+        self.context_push()
+        self.progress("Making sure we don't ordinarily get ESC_TELEMETRY_1_TO_4")
+        m = self.mav.recv_match(type='ESC_TELEMETRY_1_TO_4',
+                                blocking=True,
+                                timeout=5)
+        if m is not None:
+            raise NotAchievedException("Received unexpected ESC_TELEMETRY_1_TO_4 msg")
+
+        try:
+            self.set_parameter("SIM_ESC_TELEM", 1)
+
+            self.progress("Making sure we now get ESC_TELEMETRY_1_TO_4 messages")
+            m = self.mav.recv_match(type='ESC_TELEMETRY_1_TO_4',
+                                    blocking=True,
+                                    timeout=10)
+            if m is None:
+                raise NotAchievedException("Did not get expected ESC_TELEMETRY_1_TO_4 msg")
+
+            self.takeoff(10, mode="LOITER")
+
+            self.progress("Checking all motors report RPM, voltage and current")
+            m = self.mav.recv_match(type='ESC_TELEMETRY_1_TO_4',
+                                    blocking=True,
+                                    timeout=10)
+            if m is None:
+                raise NotAchievedException("Did not get ESC_TELEMETRY_1_TO_4 msg in flight")
+            for i in range(4):
+                if m.rpm[i] == 0 or m.voltage[i] == 0 or m.current[i] == 0:
+                    raise NotAchievedException("ESC %u telemetry missing (rpm=%u voltage=%u current=%u)" %
+                                               (i+1, m.rpm[i], m.voltage[i], m.current[i]))
+
+            self.land()
+
+        except Exception as e:
+            self.progress("Exception caught")
+            ex = e
+        self.land()
+        self.context_pop()
+        if ex is not None:
+            raise ex
+
     def test_parachute(self):
 
         self.set_rc(9, 1000)
@@ -2997,6 +3040,10 @@ class AutoTestCopter(AutoTest):
              "Test RangeFinder Basic Functionality",
              self.test_rangefinder),
 
+            ("ESCTelemetry",
+             "Test simulated ESC telemetry",
+             self.test_esc_telemetry),
+
             ("Parachute",
              "Test Parachute Functionality",
              self.test_parachute),
@@ -176,9 +176,13 @@ void AC_AttitudeControl::relax_attitude_controllers()
     _thrust_error_angle = 0.0f;
 
     // Reset the PID filters
-    get_rate_roll_pid().reset_filter();
-    get_rate_pitch_pid().reset_filter();
-    get_rate_yaw_pid().reset_filter();
+    if (rate_pids_in_thread()) {
+        _rate_filter_reset_requests++;
+    } else {
+        get_rate_roll_pid().reset_filter();
+        get_rate_pitch_pid().reset_filter();
+        get_rate_yaw_pid().reset_filter();
+    }
 
     // Reset the I terms
     reset_rate_controller_I_terms();
@@ -186,6 +190,11 @@ void AC_AttitudeControl::relax_attitude_controllers()
 
 void AC_AttitudeControl::reset_rate_controller_I_terms()
 {
+    if (rate_pids_in_thread()) {
+        // the fast rate thread resets them when it gets the next targets
+        _rate_I_reset_requests++;
+        return;
+    }
     get_rate_roll_pid().reset_I();
     get_rate_pitch_pid().reset_I();
     get_rate_yaw_pid().reset_I();
@@ -903,6 +912,43 @@ Vector3f AC_AttitudeControl::update_ang_vel_target_from_att_error(const Vector3f
     return rate_target_ang_vel;
 }
 
+// Pass the angular velocity targets to a rate controller running in its own thread
+void AC_AttitudeControl::publish_rate_targets()
+{
+    const RateTargets targets {
+        _rate_target_ang_vel,
+        _ahrs.get_gyro_drift(),
+        _rate_I_reset_requests,
+        _rate_filter_reset_requests
+    };
+    _rate_targets.write(targets);
+}
+
+// Carry out the rate PID resets requested by the main loop, called from the fast rate thread
+void AC_AttitudeControl::apply_rate_pid_resets(const RateTargets &targets)
+{
+    if (targets.filter_reset_count != _rate_filter_resets_done) {
+        _rate_filter_resets_done = targets.filter_reset_count;
+        get_rate_roll_pid().reset_filter();
+        get_rate_pitch_pid().reset_filter();
+        get_rate_yaw_pid().reset_filter();
+    }
+    if (targets.I_reset_count != _rate_I_resets_done) {
+        _rate_I_resets_done = targets.I_reset_count;
+        get_rate_roll_pid().reset_I();
+        get_rate_pitch_pid().reset_I();
+        get_rate_yaw_pid().reset_I();
+    }
+}
+
+// Set the time step of the angular velocity controllers when they run faster than the main loop
+void AC_AttitudeControl::set_rate_controller_dt(float dt)
+{
+    get_rate_roll_pid().set_dt(dt);
+    get_rate_pitch_pid().set_dt(dt);
+    get_rate_yaw_pid().set_dt(dt);
+}
+
 // Run the roll angular velocity PID controller and return the output
 float AC_AttitudeControl::rate_target_to_motor_roll(float rate_actual_rads, float rate_target_rads)
 {
@@ -10,6 +10,7 @@
 #include <AP_Motors/AP_Motors.h>
 #include <AC_PID/AC_PID.h>
 #include <AC_PID/AC_P.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
 
 #define AC_ATTITUDE_CONTROL_ANGLE_P                     4.5f             // default angle P gain for roll, pitch and yaw
 
@@ -160,6 +161,17 @@ public:
     // Run angular velocity controller and send outputs to the motors
     virtual void rate_controller_run() = 0;
 
+    // Pass the angular velocity targets to a rate controller running in its own thread
+    // called from the main loop instead of rate_controller_run once the attitude targets have been updated
+    virtual void publish_rate_targets();
+
+    // Run angular velocity controller on a gyro sample from the primary IMU and send outputs to the motors
+    // called from the fast rate thread, returns false if no targets have been published or the frame does not support it
+    virtual bool rate_controller_run_fast(const Vector3f &gyro) { return false; }
+
+    // Set the time step of the angular velocity controllers when they run faster than the main loop
+    void set_rate_controller_dt(float dt);
+
     // Convert a 321-intrinsic euler angle derivative to an angular velocity vector
     void euler_rate_to_ang_vel(const Vector3f& euler_rad, const Vector3f& euler_rate_rads, Vector3f& ang_vel_rads);
 
@@ -389,6 +401,27 @@ protected:
     // velocity controller.
     Vector3f            _rate_target_ang_vel;
 
+    // angular velocity targets and gyro drift passed to the fast rate controller,
+    // with counts of the rate PID resets requested by the main loop
+    struct RateTargets {
+        Vector3f ang_vel;
+        Vector3f gyro_drift;
+        uint16_t I_reset_count;
+        uint16_t filter_reset_count;
+    };
+    DoubleBuffer<RateTargets> _rate_targets;
+
+    // once targets have been published the rate PIDs belong to the fast
+    // rate thread and the main loop requests resets instead
+    bool rate_pids_in_thread() const { return _rate_targets.sequence() != 0; }
+    uint16_t _rate_I_reset_requests;
+    uint16_t _rate_filter_reset_requests;
+
+    // carry out the resets requested in targets, called from the fast rate thread
+    void apply_rate_pid_resets(const RateTargets &targets);
+    uint16_t _rate_I_resets_done;
+    uint16_t _rate_filter_resets_done;
+
     // This represents a quaternion attitude error in the body frame, used for inertial frame reset handling.
     Quaternion          _attitude_ang_error;
 
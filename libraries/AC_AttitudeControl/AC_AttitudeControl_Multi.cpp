@@ -255,10 +255,33 @@ void AC_AttitudeControl_Multi::rate_controller_run()
     // move throttle vs attitude mixing towards desired (called from here because this is conveniently called on every iteration)
     update_throttle_rpy_mix();
 
-    Vector3f gyro_latest = _ahrs.get_gyro_latest();
-    _motors.set_roll(rate_target_to_motor_roll(gyro_latest.x, _rate_target_ang_vel.x));
-    _motors.set_pitch(rate_target_to_motor_pitch(gyro_latest.y, _rate_target_ang_vel.y));
-    _motors.set_yaw(rate_target_to_motor_yaw(gyro_latest.z, _rate_target_ang_vel.z));
+    run_rate_pids(_ahrs.get_gyro_latest(), _rate_target_ang_vel);
+}
+
+void AC_AttitudeControl_Multi::publish_rate_targets()
+{
+    // the throttle mix is slewed at the main loop rate whichever thread runs the rate controller
+    update_throttle_rpy_mix();
+
+    AC_AttitudeControl::publish_rate_targets();
+}
+
+bool AC_AttitudeControl_Multi::rate_controller_run_fast(const Vector3f &gyro)
+{
+    RateTargets targets;
+    if (!_rate_targets.read(targets)) {
+        return false;
+    }
+    apply_rate_pid_resets(targets);
+    run_rate_pids(_ahrs.correct_gyro(gyro, targets.gyro_drift), targets.ang_vel);
+    return true;
+}
+
+void AC_AttitudeControl_Multi::run_rate_pids(const Vector3f &gyro, const Vector3f &rate_target_ang_vel)
+{
+    _motors.set_roll(rate_target_to_motor_roll(gyro.x, rate_target_ang_vel.x));
+    _motors.set_pitch(rate_target_to_motor_pitch(gyro.y, rate_target_ang_vel.y));
+    _motors.set_yaw(rate_target_to_motor_yaw(gyro.z, rate_target_ang_vel.z));
 
     control_monitor_update();
 }
@@ -75,6 +75,12 @@ public:
     // run lowest level body-frame rate controller and send outputs to the motors
     void rate_controller_run() override;
 
+    // update the throttle mix and pass the rate targets to the fast rate thread
+    void publish_rate_targets() override;
+
+    // run lowest level body-frame rate controller on a fast gyro sample and send outputs to the motors
+    bool rate_controller_run_fast(const Vector3f &gyro) override;
+
     // sanity check parameters.  should be called once before take-off
     void parameter_sanity_check() override;
 
@@ -86,6 +92,9 @@ protected:
     // update_throttle_rpy_mix - updates thr_low_comp value towards the target
     void update_throttle_rpy_mix();
 
+    // run the rate PIDs on a corrected gyro and send outputs to the motors
+    void run_rate_pids(const Vector3f &gyro, const Vector3f &rate_target_ang_vel);
+
     // get maximum value throttle can be raised to based on throttle vs attitude prioritisation
     float get_throttle_avg_max(float throttle_in);
 
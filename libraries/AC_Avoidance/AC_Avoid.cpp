@@ -83,6 +83,7 @@ void AC_Avoid::adjust_velocity(float kP, float accel_cmss, Vector2f &desired_vel
 
     if ((_enabled & AC_AVOID_USE_PROXIMITY_SENSOR) > 0 && _proximity_enabled) {
         adjust_velocity_proximity(kP, accel_cmss_limited, desired_vel_cms, dt);
+        adjust_velocity_proximity_map(kP, accel_cmss_limited, desired_vel_cms, dt);
     }
 }
 
@@ -285,12 +286,22 @@ void AC_Avoid::adjust_velocity_circle_fence(float kP, float accel_cmss, Vector2f
     }
     position_xy *= 100.0f; // m -> cm
 
-    const float speed = desired_vel_cms.length();
     // get the fence radius in cm
     const float fence_radius = _fence.get_radius() * 100.0f;
     // get the margin to the fence in cm
     const float margin_cm = _fence.get_margin() * 100.0f;
 
+    adjust_velocity_circle(kP, accel_cmss, desired_vel_cms, position_xy, fence_radius, margin_cm, dt);
+}
+
+/*
+ * Adjusts the desired velocity to remain within a circle.
+ *   position_xy is the vehicle's position relative to the centre of the circle in cm
+ */
+void AC_Avoid::adjust_velocity_circle(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f &position_xy, float fence_radius, float margin_cm, float dt)
+{
+    const float speed = desired_vel_cms.length();
+
     if (!is_zero(speed) && position_xy.length() <= fence_radius) {
         // Currently inside circular fence
         Vector2f stopping_point = position_xy + desired_vel_cms*(get_stopping_distance(kP, accel_cmss, speed)/speed);
@@ -340,13 +351,65 @@ void AC_Avoid::adjust_velocity_polygon_fence(float kP, float accel_cmss, Vector2
         return;
     }
 
-    // get polygon boundary
-    // Note: first point in list is the return-point (which copter does not use)
-    uint16_t num_points;
-    const Vector2f* boundary = _fence.get_polygon_points(num_points);
+    // get polygons and circles making up the fence
+    const AC_PolyFence_index *fence_index = _fence.get_polygon_index();
+    if (fence_index == nullptr) {
+        return;
+    }
 
-    // adjust velocity using polygon
-    adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, boundary, num_points, true, _fence.get_margin(), dt);
+    Vector2f position_xy;
+    if (!_ahrs.get_relative_position_NE_origin(position_xy)) {
+        // boundary is in earth frame but we have no idea
+        // where we are
+        return;
+    }
+    position_xy = position_xy * 100.0f;  // m to cm
+
+    // do not adjust velocity if vehicle is outside an inclusion zone or inside an exclusion zone
+    if (fence_index->breached(position_xy)) {
+        return;
+    }
+
+    // Safe_vel will be adjusted to remain within fence.
+    // We need a separate vector in case adjustment fails,
+    // e.g. if we are exactly on the boundary.
+    Vector2f safe_vel(desired_vel_cms);
+
+    // calc margin in cm
+    const float margin_cm = MAX(_fence.get_margin() * 100.0f, 0.0f);
+
+    // for stopping
+    const float speed = safe_vel.length();
+    const float stopping_distance_plus_margin = 2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed);
+    const Vector2f stopping_point_plus_margin = position_xy + safe_vel*(stopping_distance_plus_margin/speed);
+
+    // edges further away than the stopping distance plus margin cannot limit the velocity so only nearby edges are checked
+    Vector2f start, end;
+    AC_PolyFence_index::EdgeIterator edges = fence_index->edges_near(position_xy, stopping_distance_plus_margin);
+    while (edges.next(start, end)) {
+        if (!adjust_velocity_edge(kP, accel_cmss, safe_vel, position_xy, stopping_point_plus_margin, start, end, margin_cm, dt)) {
+            return;
+        }
+    }
+
+    // adjust velocity for circles
+    for (uint8_t i=0; i<fence_index->num_items(); i++) {
+        const AC_PolyFence_index::Item &item = fence_index->get_item(i);
+        if (item.type == AC_PolyFence_index::ItemType::INCLUSION_CIRCLE) {
+            adjust_velocity_circle(kP, accel_cmss, safe_vel, position_xy - item.centre, item.radius, margin_cm, dt);
+        } else if (item.type == AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE) {
+            // limit velocity towards the centre of the circle
+            Vector2f limit_direction = item.centre - position_xy;
+            const float distance_to_centre = limit_direction.length();
+            if (is_zero(distance_to_centre)) {
+                return;
+            }
+            limit_direction /= distance_to_centre;
+            limit_velocity(kP, accel_cmss, safe_vel, limit_direction, MAX(distance_to_centre - item.radius - margin_cm, 0.0f), dt);
+        }
+    }
+
+    desired_vel_cms = safe_vel;
 }
 
 /*
@@ -396,6 +459,48 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector2f &d
     adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, boundary, num_points, false, _margin, dt);
 }
 
+/*
+ * Adjusts the desired velocity based on the occupancy map of obstacles seen by the proximity sensors and rangefinders
+ * The map remembers obstacles which are no longer in view of the sensors (e.g. behind the vehicle)
+ */
+void AC_Avoid::adjust_velocity_proximity_map(float kP, float accel_cmss, Vector2f &desired_vel_cms, float dt)
+{
+    // exit immediately if there is no map or no desired velocity
+    const AP_Proximity_Map *map = _proximity.get_map();
+    if (map == nullptr || desired_vel_cms.is_zero()) {
+        return;
+    }
+
+    Vector3f position;
+    if (!_ahrs.get_relative_position_NED_origin(position)) {
+        return;
+    }
+
+    // only obstacles within stopping distance can limit the velocity
+    const float voxel_size_cm = map->get_voxel_size() * 100.0f;
+    const float margin_cm = MAX(_margin * 100.0f, 0.0f);
+    const float max_dist_cm = margin_cm + voxel_size_cm + get_stopping_distance(kP, accel_cmss, desired_vel_cms.length());
+
+    Vector2f safe_vel(desired_vel_cms);
+    AP_Proximity_Map::OccupiedIterator it = map->occupied_near(position, max_dist_cm * 0.01f, map->get_voxel_size());
+    Vector3f centre;
+    while (it.next(centre)) {
+        // ignore obstacles above or below the vehicle
+        if (fabsf(centre.z - position.z) * 100.0f > voxel_size_cm) {
+            continue;
+        }
+        Vector2f limit_direction((centre.x - position.x) * 100.0f, (centre.y - position.y) * 100.0f);
+        const float dist_cm = limit_direction.length();
+        if (is_zero(dist_cm) || dist_cm > max_dist_cm) {
+            continue;
+        }
+        limit_direction /= dist_cm;
+        // stop margin short of the near side of the voxel
+        limit_velocity(kP, accel_cmss, safe_vel, limit_direction, MAX(dist_cm - voxel_size_cm * 0.5f - margin_cm, 0.0f), dt);
+    }
+    desired_vel_cms = safe_vel;
+}
+
 /*
  * Adjusts the desired velocity for the polygon fence.
  */
@@ -442,45 +547,8 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
     uint16_t i, j;
     for (i = 0, j = num_points-1; i < num_points; j = i++) {
         // end points of current edge
-        Vector2f start = boundary[j];
-        Vector2f end = boundary[i];
-        if ((AC_Avoid::BehaviourType)_behavior.get() == BEHAVIOR_SLIDE) {
-            // vector from current position to closest point on current edge
-            Vector2f limit_direction = Vector2f::closest_point(position_xy, start, end) - position_xy;
-            // distance to closest point
-            const float limit_distance_cm = limit_direction.length();
-            if (!is_zero(limit_distance_cm)) {
-                // We are strictly inside the given edge.
-                // Adjust velocity to not violate this edge.
-                limit_direction /= limit_distance_cm;
-                limit_velocity(kP, accel_cmss, safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
-            } else {
-                // We are exactly on the edge - treat this as a fence breach.
-                // i.e. do not adjust velocity.
-                return;
-            }
-        } else {
-            // find intersection with line segment
-            Vector2f intersection;
-            if (Vector2f::segment_intersection(position_xy, stopping_point_plus_margin, start, end, intersection)) {
-                // vector from current position to point on current edge
-                Vector2f limit_direction = intersection - position_xy;
-                const float limit_distance_cm = limit_direction.length();
-                if (!is_zero(limit_distance_cm)) {
-                    if (limit_distance_cm <= margin_cm) {
-                        // we are within the margin so stop vehicle
-                        safe_vel.zero();
-                    } else {
-                        // vehicle inside the given edge, adjust velocity to not violate this edge
-                        limit_direction /= limit_distance_cm;
-                        limit_velocity(kP, accel_cmss, safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
-                    }
-                } else {
-                    // We are exactly on the edge - treat this as a fence breach.
-                    // i.e. do not adjust velocity.
-                    return;
-                }
-            }
+        if (!adjust_velocity_edge(kP, accel_cmss, safe_vel, position_xy, stopping_point_plus_margin, boundary[j], boundary[i], margin_cm, dt)) {
+            return;
         }
     }
 
@@ -494,6 +562,53 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
     }
 }
 
+/*
+ * Adjusts safe_vel so that the vehicle does not cross the edge from start to end.
+ *   returns false if the vehicle is exactly on the edge, which should be treated as a fence breach
+ */
+bool AC_Avoid::adjust_velocity_edge(float kP, float accel_cmss, Vector2f &safe_vel, const Vector2f &position_xy, const Vector2f &stopping_point_plus_margin, const Vector2f &start, const Vector2f &end, float margin_cm, float dt) const
+{
+    if ((AC_Avoid::BehaviourType)_behavior.get() == BEHAVIOR_SLIDE) {
+        // vector from current position to closest point on current edge
+        Vector2f limit_direction = Vector2f::closest_point(position_xy, start, end) - position_xy;
+        // distance to closest point
+        const float limit_distance_cm = limit_direction.length();
+        if (!is_zero(limit_distance_cm)) {
+            // We are strictly inside the given edge.
+            // Adjust velocity to not violate this edge.
+            limit_direction /= limit_distance_cm;
+            limit_velocity(kP, accel_cmss, safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
+        } else {
+            // We are exactly on the edge - treat this as a fence breach.
+            // i.e. do not adjust velocity.
+            return false;
+        }
+    } else {
+        // find intersection with line segment
+        Vector2f intersection;
+        if (Vector2f::segment_intersection(position_xy, stopping_point_plus_margin, start, end, intersection)) {
+            // vector from current position to point on current edge
+            Vector2f limit_direction = intersection - position_xy;
+            const float limit_distance_cm = limit_direction.length();
+            if (!is_zero(limit_distance_cm)) {
+                if (limit_distance_cm <= margin_cm) {
+                    // we are within the margin so stop vehicle
+                    safe_vel.zero();
+                } else {
+                    // vehicle inside the given edge, adjust velocity to not violate this edge
+                    limit_direction /= limit_distance_cm;
+                    limit_velocity(kP, accel_cmss, safe_vel, limit_direction, MAX(limit_distance_cm - margin_cm, 0.0f), dt);
+                }
+            } else {
+                // We are exactly on the edge - treat this as a fence breach.
+                // i.e. do not adjust velocity.
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 /*
  * Computes distance required to stop, given current speed.
  *
@@ -540,7 +655,7 @@ void AC_Avoid::get_proximity_roll_pitch_pct(float &roll_positive, float &roll_ne
         return;
     }
 
-    const uint8_t obj_count = _proximity.get_object_count();
+    const uint16_t obj_count = _proximity.get_object_count();
 
     // if no objects return
     if (obj_count == 0) {
@@ -548,7 +663,7 @@ void AC_Avoid::get_proximity_roll_pitch_pct(float &roll_positive, float &roll_ne
     }
 
     // calculate maximum roll, pitch values from objects
-    for (uint8_t i=0; i<obj_count; i++) {
+    for (uint16_t i=0; i<obj_count; i++) {
         float ang_deg, dist_m;
         if (_proximity.get_object_angle_and_distance(i, ang_deg, dist_m)) {
             if (dist_m < _dist_max) {
@@ -95,7 +95,14 @@ private:
     void adjust_velocity_circle_fence(float kP, float accel_cmss, Vector2f &desired_vel_cms, float dt);
 
     /*
-     * Adjusts the desired velocity for the polygon fence.
+     * Adjusts the desired velocity to remain within a circle.
+     *   position_xy is the vehicle's position relative to the centre of the circle in cm
+     *   fence_radius and margin_cm are in cm
+     */
+    void adjust_velocity_circle(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f &position_xy, float fence_radius, float margin_cm, float dt);
+
+    /*
+     * Adjusts the desired velocity for the polygon fence including all of its inclusion and exclusion polygons and circles.
      */
     void adjust_velocity_polygon_fence(float kP, float accel_cmss, Vector2f &desired_vel_cms, float dt);
 
@@ -109,6 +116,11 @@ private:
      */
     void adjust_velocity_proximity(float kP, float accel_cmss, Vector2f &desired_vel_cms, float dt);
 
+    /*
+     * Adjusts the desired velocity based on the occupancy map of obstacles seen by the proximity sensors and rangefinders
+     */
+    void adjust_velocity_proximity_map(float kP, float accel_cmss, Vector2f &desired_vel_cms, float dt);
+
     /*
      * Adjusts the desired velocity given an array of boundary points
      *   earth_frame should be true if boundary is in earth-frame, false for body-frame
@@ -116,6 +128,13 @@ private:
      */
     void adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, const Vector2f* boundary, uint16_t num_points, bool earth_frame, float margin, float dt);
 
+    /*
+     * Adjusts safe_vel so that the vehicle does not cross the edge from start to end.
+     *   position_xy, stopping_point_plus_margin and the edge must be in the same frame as safe_vel
+     *   returns false if the vehicle is exactly on the edge, which should be treated as a fence breach
+     */
+    bool adjust_velocity_edge(float kP, float accel_cmss, Vector2f &safe_vel, const Vector2f &position_xy, const Vector2f &stopping_point_plus_margin, const Vector2f &start, const Vector2f &end, float margin_cm, float dt) const;
+
     /*
      * Computes distance required to stop, given current speed.
      */
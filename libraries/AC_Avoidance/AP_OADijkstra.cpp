@@ -0,0 +1,360 @@
+#include "AP_OADijkstra.h"
+
+#define AP_OADIJKSTRA_NODE_NONE     0xFFFF  // parent of nodes not yet reached
+#define AP_OADIJKSTRA_OBSTACLE_NODE_DIST    1.5f    // distance of obstacle nodes from obstacle as a multiple of the margin
+
+// free all memory
+void AP_OADijkstra::free_nodes()
+{
+    free(_nodes);
+    free(_fence_visible);
+    free(_cost);
+    free(_estimate);
+    free(_parent);
+    free(_closed);
+    _nodes = nullptr;
+    _fence_visible = nullptr;
+    _cost = nullptr;
+    _estimate = nullptr;
+    _parent = nullptr;
+    _closed = nullptr;
+    _num_fence_nodes = 0;
+    _num_nodes = 0;
+    _max_nodes = 0;
+}
+
+/*
+  place nodes around the fence and calculate which can see each other
+
+  This is the expensive part of building the graph, checking every
+  pair of nodes against the fence edges between them, so it is only
+  done when the fence changes.
+ */
+bool AP_OADijkstra::update_fence(const AC_PolyFence_index *fence, float margin_cm)
+{
+    free_nodes();
+    _fence = fence;
+    _margin_cm = margin_cm;
+
+    // count the nodes which may be placed around the fence
+    uint16_t fence_nodes_max = 0;
+    if (fence != nullptr) {
+        for (uint8_t i=0; i<fence->num_items(); i++) {
+            const AC_PolyFence_index::Item &item = fence->get_item(i);
+            switch (item.type) {
+            case AC_PolyFence_index::ItemType::INCLUSION_POLYGON:
+            case AC_PolyFence_index::ItemType::EXCLUSION_POLYGON:
+                fence_nodes_max += item.count - 1;
+                break;
+            case AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE:
+                fence_nodes_max += AP_OADIJKSTRA_CIRCLE_NODES;
+                break;
+            case AC_PolyFence_index::ItemType::INCLUSION_CIRCLE:
+                break;
+            }
+        }
+    }
+    fence_nodes_max = MIN(fence_nodes_max, AP_OADIJKSTRA_FENCE_NODES_MAX);
+
+    // allocate space for fence nodes, obstacle nodes, start and destination
+    _max_nodes = fence_nodes_max + AP_OADIJKSTRA_OBSTACLES_MAX * AP_OADIJKSTRA_OBSTACLE_NODES + 2;
+    _nodes = (Vector2f *)calloc(_max_nodes, sizeof(Vector2f));
+    _cost = (float *)calloc(_max_nodes, sizeof(float));
+    _estimate = (float *)calloc(_max_nodes, sizeof(float));
+    _parent = (uint16_t *)calloc(_max_nodes, sizeof(uint16_t));
+    _closed = (uint8_t *)calloc(_max_nodes, sizeof(uint8_t));
+    if (_nodes == nullptr || _cost == nullptr || _estimate == nullptr || _parent == nullptr || _closed == nullptr) {
+        free_nodes();
+        return false;
+    }
+
+    // place nodes around the fence
+    if (fence != nullptr) {
+        for (uint8_t i=0; i<fence->num_items(); i++) {
+            const AC_PolyFence_index::Item &item = fence->get_item(i);
+            switch (item.type) {
+            case AC_PolyFence_index::ItemType::INCLUSION_POLYGON:
+            case AC_PolyFence_index::ItemType::EXCLUSION_POLYGON:
+                add_polygon_nodes(item, fence->get_points());
+                break;
+            case AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE:
+                add_circle_nodes(item);
+                break;
+            case AC_PolyFence_index::ItemType::INCLUSION_CIRCLE:
+                // the path between any two points inside a circle is a straight line
+                break;
+            }
+        }
+    }
+    _num_fence_nodes = _num_nodes;
+
+    // calculate which fence nodes can see each other
+    const uint32_t num_bits = (uint32_t)_num_fence_nodes * _num_fence_nodes;
+    _fence_visible = (uint32_t *)calloc((num_bits + 31) / 32, sizeof(uint32_t));
+    if (_fence_visible == nullptr) {
+        free_nodes();
+        return false;
+    }
+    for (uint16_t i=0; i<_num_fence_nodes; i++) {
+        for (uint16_t j=i+1; j<_num_fence_nodes; j++) {
+            if (segment_clear_of_fence(_nodes[i], _nodes[j])) {
+                const uint32_t bit_ij = (uint32_t)i * _num_fence_nodes + j;
+                const uint32_t bit_ji = (uint32_t)j * _num_fence_nodes + i;
+                _fence_visible[bit_ij / 32] |= 1U << (bit_ij % 32);
+                _fence_visible[bit_ji / 32] |= 1U << (bit_ji % 32);
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+  add nodes around a polygon item
+
+  A shortest path only bends around the convex corners of an
+  exclusion polygon or the concave corners of an inclusion polygon.
+  The node is placed the margin distance from the corner along the
+  bisector of the two edges, on the side away from both edges.
+ */
+void AP_OADijkstra::add_polygon_nodes(const AC_PolyFence_index::Item &item, const Vector2f *points)
+{
+    // the last vertex is the same as the first
+    const uint16_t num_vertices = item.count - 1;
+
+    // the sign of the polygon's area gives the direction it is wound in
+    float area = 0.0f;
+    for (uint16_t v=0; v<num_vertices; v++) {
+        area += points[item.first + v] % points[item.first + v + 1];
+    }
+
+    const bool exclusion = (item.type == AC_PolyFence_index::ItemType::EXCLUSION_POLYGON);
+    for (uint16_t v=0; v<num_vertices; v++) {
+        const Vector2f &prev = points[item.first + (v + num_vertices - 1) % num_vertices];
+        const Vector2f &vertex = points[item.first + v];
+        const Vector2f &next = points[item.first + v + 1];
+        Vector2f to_vertex = vertex - prev;
+        Vector2f from_vertex = next - vertex;
+        if (to_vertex.is_zero() || from_vertex.is_zero()) {
+            continue;
+        }
+        to_vertex.normalize();
+        from_vertex.normalize();
+
+        // a corner is convex if it turns the same way as the polygon is wound
+        const float turn = to_vertex % from_vertex;
+        if (is_zero(turn) || ((turn * area > 0.0f) != exclusion)) {
+            continue;
+        }
+
+        Vector2f away = to_vertex - from_vertex;
+        away.normalize();
+        add_node(vertex + away * _margin_cm, AP_OADIJKSTRA_FENCE_NODES_MAX);
+    }
+}
+
+/*
+  add nodes around an exclusion circle item
+
+  Nodes are placed far enough out that the path between neighbouring
+  nodes keeps the margin distance from the circle.
+ */
+void AP_OADijkstra::add_circle_nodes(const AC_PolyFence_index::Item &item)
+{
+    const float radius = (item.radius + _margin_cm) / cosf(M_PI / AP_OADIJKSTRA_CIRCLE_NODES);
+    for (uint8_t i=0; i<AP_OADIJKSTRA_CIRCLE_NODES; i++) {
+        const float angle = M_2PI * i / AP_OADIJKSTRA_CIRCLE_NODES;
+        add_node(item.centre + Vector2f(cosf(angle), sinf(angle)) * radius, AP_OADIJKSTRA_FENCE_NODES_MAX);
+    }
+}
+
+// add node if it is within the fence, returns true on success
+bool AP_OADijkstra::add_node(const Vector2f &node, uint16_t max_nodes)
+{
+    if (_num_nodes >= max_nodes) {
+        return false;
+    }
+    if (_fence != nullptr && _fence->breached(node)) {
+        return false;
+    }
+    _nodes[_num_nodes++] = node;
+    return true;
+}
+
+// returns true if the segment from a to b does not cross the fence
+bool AP_OADijkstra::segment_clear_of_fence(const Vector2f &a, const Vector2f &b) const
+{
+    if (_fence == nullptr) {
+        return true;
+    }
+
+    // check polygon edges around the segment
+    Vector2f start, end, intersection;
+    AC_PolyFence_index::EdgeIterator edges = _fence->edges_near((a + b) * 0.5f, (b - a).length() * 0.5f);
+    while (edges.next(start, end)) {
+        if (Vector2f::segment_intersection(a, b, start, end, intersection)) {
+            return false;
+        }
+    }
+
+    // check circles
+    for (uint8_t i=0; i<_fence->num_items(); i++) {
+        const AC_PolyFence_index::Item &item = _fence->get_item(i);
+        if (item.type == AC_PolyFence_index::ItemType::INCLUSION_CIRCLE) {
+            if ((a - item.centre).length_squared() > sq(item.radius) ||
+                (b - item.centre).length_squared() > sq(item.radius)) {
+                return false;
+            }
+        } else if (item.type == AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE) {
+            const Vector2f closest = Vector2f::closest_point(item.centre, a, b);
+            if ((closest - item.centre).length_squared() < sq(item.radius)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// returns true if the segment from a to b keeps the margin distance away from all obstacles
+bool AP_OADijkstra::segment_clear_of_obstacles(const Vector2f &a, const Vector2f &b) const
+{
+    for (uint8_t i=0; i<_num_obstacles; i++) {
+        const Vector2f closest = Vector2f::closest_point(_obstacles[i], a, b);
+        if ((closest - _obstacles[i]).length_squared() < sq(_margin_cm)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// returns true if nodes i and j can see each other
+bool AP_OADijkstra::visible(uint16_t i, uint16_t j) const
+{
+    if (i < _num_fence_nodes && j < _num_fence_nodes) {
+        if (!fence_visible(i, j)) {
+            return false;
+        }
+    } else if (!segment_clear_of_fence(_nodes[i], _nodes[j])) {
+        return false;
+    }
+    return segment_clear_of_obstacles(_nodes[i], _nodes[j]);
+}
+
+/*
+  find the shortest path from start to destination
+
+  Nodes are expanded in order of path length so far plus straight line
+  distance to the destination (A*).  Visibility is only checked for
+  neighbours which would be reached by a shorter path, so most pairs
+  of nodes are never checked.
+ */
+AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Vector2f &start, const Vector2f &destination,
+                                                         const Vector2f *obstacles, uint8_t num_obstacles,
+                                                         Vector2f &next_destination)
+{
+    _path_length = 0;
+    _num_nodes = _num_fence_nodes;
+    _num_obstacles = 0;
+
+    if (_nodes == nullptr) {
+        return DIJKSTRA_STATE_ERROR;
+    }
+
+    // nothing can be done if the vehicle is already outside the fence
+    if (_fence != nullptr && _fence->breached(start)) {
+        return DIJKSTRA_STATE_NOT_REQUIRED;
+    }
+    if (_fence != nullptr && _fence->breached(destination)) {
+        return DIJKSTRA_STATE_ERROR;
+    }
+
+    // obstacles the vehicle is already within the margin of are
+    // ignored, otherwise no path could leave them.  Velocity limiting
+    // still keeps the vehicle from hitting them
+    for (uint8_t i=0; i<num_obstacles && _num_obstacles<AP_OADIJKSTRA_OBSTACLES_MAX; i++) {
+        if ((obstacles[i] - start).length_squared() >= sq(_margin_cm)) {
+            _obstacles[_num_obstacles++] = obstacles[i];
+        }
+    }
+
+    // place nodes around obstacles, skipping any too close to another obstacle
+    const uint16_t max_nodes = _max_nodes - 2;
+    const float node_dist = _margin_cm * AP_OADIJKSTRA_OBSTACLE_NODE_DIST;
+    for (uint8_t i=0; i<_num_obstacles; i++) {
+        for (uint8_t j=0; j<AP_OADIJKSTRA_OBSTACLE_NODES; j++) {
+            const float angle = M_2PI * (j + 0.5f) / AP_OADIJKSTRA_OBSTACLE_NODES;
+            const Vector2f node = _obstacles[i] + Vector2f(cosf(angle), sinf(angle)) * node_dist;
+            if (segment_clear_of_obstacles(node, node)) {
+                add_node(node, max_nodes);
+            }
+        }
+    }
+
+    // add start and destination
+    const uint16_t start_node = _num_nodes++;
+    const uint16_t dest_node = _num_nodes++;
+    _nodes[start_node] = start;
+    _nodes[dest_node] = destination;
+
+    // check for a direct path
+    if (visible(start_node, dest_node)) {
+        return DIJKSTRA_STATE_NOT_REQUIRED;
+    }
+
+    for (uint16_t n=0; n<_num_nodes; n++) {
+        _cost[n] = FLT_MAX;
+        _estimate[n] = FLT_MAX;
+        _parent[n] = AP_OADIJKSTRA_NODE_NONE;
+        _closed[n] = 0;
+    }
+    _cost[start_node] = 0.0f;
+    _estimate[start_node] = (destination - start).length();
+
+    while (true) {
+        // find the open node with the lowest estimated total path length
+        uint16_t best = AP_OADIJKSTRA_NODE_NONE;
+        float best_estimate = FLT_MAX;
+        for (uint16_t n=0; n<_num_nodes; n++) {
+            if (!_closed[n] && _estimate[n] < best_estimate) {
+                best = n;
+                best_estimate = _estimate[n];
+            }
+        }
+        if (best == AP_OADIJKSTRA_NODE_NONE) {
+            // destination cannot be reached
+            return DIJKSTRA_STATE_ERROR;
+        }
+        if (best == dest_node) {
+            break;
+        }
+        _closed[best] = 1;
+
+        // update neighbours
+        for (uint16_t n=0; n<_num_nodes; n++) {
+            if (_closed[n]) {
+                continue;
+            }
+            const float cost = _cost[best] + (_nodes[n] - _nodes[best]).length();
+            if (cost >= _cost[n] || !visible(best, n)) {
+                continue;
+            }
+            _cost[n] = cost;
+            _estimate[n] = cost + (destination - _nodes[n]).length();
+            _parent[n] = best;
+        }
+    }
+
+    // walk back along the path to find the first node after the start
+    uint16_t n = dest_node;
+    _path_length = 1;
+    while (_parent[n] != start_node) {
+        n = _parent[n];
+        if (_path_length < UINT8_MAX) {
+            _path_length++;
+        }
+    }
+    next_destination = _nodes[n];
+
+    return DIJKSTRA_STATE_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_Math/AP_Math.h>
+#include <AC_Fence/AC_PolyFence_index.h>
+
+// maximum number of nodes placed around the fence, the visibility matrix takes nodes^2 bits
+#ifndef AP_OADIJKSTRA_FENCE_NODES_MAX
+#if HAL_MINIMIZE_FEATURES
+#define AP_OADIJKSTRA_FENCE_NODES_MAX       100
+#else
+#define AP_OADIJKSTRA_FENCE_NODES_MAX       500
+#endif
+#endif
+#define AP_OADIJKSTRA_OBSTACLES_MAX         16  // maximum number of proximity obstacles
+#define AP_OADIJKSTRA_OBSTACLE_NODES        4   // number of nodes placed around each obstacle
+#define AP_OADIJKSTRA_CIRCLE_NODES          8   // number of nodes placed around each exclusion circle
+
+/*
+ * Finds the shortest path around the fence and proximity obstacles
+ * using a visibility graph and A* search.
+ *
+ * Nodes are placed the margin distance outside the convex corners of
+ * exclusion polygons, inside the concave corners of inclusion
+ * polygons, around exclusion circles and around each obstacle.  These
+ * are the only points at which a shortest path can change direction.
+ *
+ * Which fence nodes can see each other is only calculated when the
+ * fence changes.  Visibility to and from the vehicle, the destination
+ * and obstacle nodes, and past obstacles, is checked during the
+ * search as nodes are expanded.
+ *
+ * All positions are offsets in cm from the EKF origin.
+ */
+class AP_OADijkstra {
+public:
+
+    AP_OADijkstra() {}
+
+    /* Do not allow copies */
+    AP_OADijkstra(const AP_OADijkstra &other) = delete;
+    AP_OADijkstra &operator=(const AP_OADijkstra&) = delete;
+
+    enum AP_OADijkstra_State : uint8_t {
+        DIJKSTRA_STATE_NOT_REQUIRED = 0,    // nothing lies between the vehicle and destination
+        DIJKSTRA_STATE_ERROR,               // no path could be found
+        DIJKSTRA_STATE_SUCCESS              // path found
+    };
+
+    // place nodes around the fence and calculate which can see each other
+    // fence may be nullptr if there is no fence, otherwise it must not change until the next call
+    // returns false if memory could not be allocated
+    bool update_fence(const AC_PolyFence_index *fence, float margin_cm);
+
+    // find the shortest path from start to destination, next_destination is set to the first point along the path
+    AP_OADijkstra_State update(const Vector2f &start, const Vector2f &destination,
+                               const Vector2f *obstacles, uint8_t num_obstacles,
+                               Vector2f &next_destination);
+
+    // number of nodes placed around the fence
+    uint16_t get_num_fence_nodes() const { return _num_fence_nodes; }
+
+    // number of nodes and points along the path found by the last update
+    uint16_t get_num_nodes() const { return _num_nodes; }
+    uint8_t get_path_length() const { return _path_length; }
+
+private:
+
+    // add nodes around polygon item
+    void add_polygon_nodes(const AC_PolyFence_index::Item &item, const Vector2f *points);
+
+    // add nodes around exclusion circle item
+    void add_circle_nodes(const AC_PolyFence_index::Item &item);
+
+    // add node if it is within the fence, returns true on success
+    bool add_node(const Vector2f &node, uint16_t max_nodes);
+
+    // returns true if the segment from a to b does not cross the fence
+    bool segment_clear_of_fence(const Vector2f &a, const Vector2f &b) const;
+
+    // returns true if the segment from a to b keeps the margin distance away from all obstacles
+    bool segment_clear_of_obstacles(const Vector2f &a, const Vector2f &b) const;
+
+    // returns true if nodes i and j can see each other
+    bool visible(uint16_t i, uint16_t j) const;
+
+    // access visibility matrix of fence nodes
+    bool fence_visible(uint16_t i, uint16_t j) const {
+        const uint32_t bit = (uint32_t)i * _num_fence_nodes + j;
+        return (_fence_visible[bit / 32] & (1U << (bit % 32))) != 0;
+    }
+
+    // free all memory
+    void free_nodes();
+
+    const AC_PolyFence_index *_fence = nullptr; // fence the nodes were placed around
+    float _margin_cm = 0.0f;            // distance to keep away from fence and obstacles
+
+    // nodes.  Fence nodes come first followed by obstacle nodes, then the start and destination
+    Vector2f *_nodes = nullptr;
+    uint16_t _num_fence_nodes = 0;
+    uint16_t _num_nodes = 0;
+    uint16_t _max_nodes = 0;
+    uint32_t *_fence_visible = nullptr; // bit matrix of which fence nodes can see each other
+
+    // search state for each node
+    float *_cost = nullptr;             // length of shortest path found from start
+    float *_estimate = nullptr;         // cost plus straight line distance to destination
+    uint16_t *_parent = nullptr;        // previous node along shortest path from start
+    uint8_t *_closed = nullptr;         // 1 once the shortest path to this node is known
+
+    // obstacles for the current update
+    Vector2f _obstacles[AP_OADIJKSTRA_OBSTACLES_MAX];
+    uint8_t _num_obstacles = 0;
+
+    uint8_t _path_length = 0;           // number of points along path found by last update
+};
@@ -0,0 +1,404 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_OAPathPlanner.h"
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AC_Fence/AC_Fence.h>
+#include <AP_Common/Semaphore.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Proximity/AP_Proximity.h>
+#include <GCS_MAVLink/GCS.h>
+
+extern const AP_HAL::HAL &hal;
+
+#define OA_UPDATE_MS                    100     // path planning updates run at 10hz
+#define OA_TIMEOUT_MS                   3000    // results over 3 seconds old are ignored
+#define OA_THREAD_POLL_MS               10      // avoidance thread checks for a new destination at 100hz
+
+const AP_Param::GroupInfo AP_OAPathPlanner::var_info[] = {
+
+    // @Param: TYPE
+    // @DisplayName: Object Avoidance Path Planning algorithm to use
+    // @Description: Enabled/disable path planning around the polygon fence and proximity obstacles
+    // @Values: 0:Disabled,1:Dijkstra
+    // @User: Standard
+    // @RebootRequired: True
+    AP_GROUPINFO_FLAGS("TYPE", 1, AP_OAPathPlanner, _type, OA_PATHPLAN_DISABLED, AP_PARAM_FLAG_ENABLE),
+
+    // @Param: MARGIN_MAX
+    // @DisplayName: Object Avoidance wide margin distance
+    // @Description: Object Avoidance will keep at least this distance from the polygon fence and proximity obstacles
+    // @Units: m
+    // @Range: 0.1 100
+    // @Increment: 1
+    // @User: Standard
+    AP_GROUPINFO("MARGIN_MAX", 2, AP_OAPathPlanner, _margin_max, AP_OAPATHPLANNER_MARGIN_MAX_DEFAULT),
+
+    AP_GROUPEND
+};
+
+AP_OAPathPlanner::AP_OAPathPlanner()
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    if (_singleton != nullptr) {
+        AP_HAL::panic("OAPathPlanner must be singleton");
+    }
+#endif
+    _singleton = this;
+    AP_Param::setup_object_defaults(this, var_info);
+}
+
+// start the planning thread if enabled
+void AP_OAPathPlanner::init()
+{
+    if (_type == OA_PATHPLAN_DISABLED || _thread_created) {
+        return;
+    }
+
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_OAPathPlanner::avoidance_thread, void),
+                                      "avoidance",
+                                      8192, AP_HAL::Scheduler::PRIORITY_IO, -1)) {
+        gcs().send_text(MAV_SEVERITY_ERROR, "OA: failed to start thread");
+        return;
+    }
+    _thread_created = true;
+}
+
+// provides an alternative origin and destination to avoid the fence and obstacles
+AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::mission_avoidance(const Vector2f &current_pos,
+                                                                  const Vector2f &origin,
+                                                                  const Vector2f &destination,
+                                                                  Vector2f &result_origin,
+                                                                  Vector2f &result_destination)
+{
+    // exit immediately if disabled or thread is not running
+    if (!_thread_created) {
+        return OA_NOT_REQUIRED;
+    }
+
+    // the occupancy map may hold many voxels so is searched by the avoidance thread under the map's semaphore
+    // but the proximity sensor objects are gathered here because the proximity library is not thread safe
+    Vector3f map_position;
+    const bool use_map = get_map_position(map_position);
+    Vector2f obstacles[AP_OADIJKSTRA_OBSTACLES_MAX];
+    const uint8_t num_obstacles = use_map ? 0 : get_obstacles(current_pos, obstacles);
+
+    // logging is not thread safe so the avoidance thread's log data is written here
+    struct log_data log;
+    bool log_pending;
+    {
+        WITH_SEMAPHORE(_rsem);
+        log = _log;
+        log_pending = _log_pending;
+        _log_pending = false;
+    }
+    if (log_pending) {
+        Write_OA(log);
+    }
+
+    const uint32_t now = AP_HAL::millis();
+    WITH_SEMAPHORE(_rsem);
+
+    // place new request for the thread to work on
+    _request.current_pos = current_pos;
+    _request.origin = origin;
+    _request.destination = destination;
+    memcpy(_request.obstacles, obstacles, sizeof(Vector2f) * num_obstacles);
+    _request.num_obstacles = num_obstacles;
+    _request.use_map = use_map;
+    _request.map_position = map_position;
+    _request.request_time_ms = now;
+
+    // check result's destination matches our request
+    if ((now - _result.result_time_ms > OA_TIMEOUT_MS) || (_result.destination != destination)) {
+        return OA_PROCESSING;
+    }
+
+    // send back results
+    if (_result.ret_state == OA_SUCCESS) {
+        result_origin = _result.origin_new;
+        result_destination = _result.destination_new;
+    }
+    return _result.ret_state;
+}
+
+// get vehicle position in meters from the EKF origin, returns false if the occupancy map is not available
+bool AP_OAPathPlanner::get_map_position(Vector3f &position) const
+{
+    // use the occupancy map if available because it also holds obstacles out of view of the sensors
+    const AP_Proximity *proximity = AP_Proximity::get_singleton();
+    if (proximity == nullptr || proximity->get_map() == nullptr) {
+        return false;
+    }
+    return AP::ahrs().get_relative_position_NED_origin(position);
+}
+
+// get positions of proximity sensor obstacles in cm from the EKF origin, returns number of obstacles
+uint8_t AP_OAPathPlanner::get_obstacles(const Vector2f &current_pos, Vector2f *obstacles) const
+{
+    const AP_Proximity *proximity = AP_Proximity::get_singleton();
+    if (proximity == nullptr) {
+        return 0;
+    }
+
+    // high resolution sensors may have more objects than can be planned around so keep the closest
+    const float yaw = AP::ahrs().yaw;
+    float dist_sq[AP_OADIJKSTRA_OBSTACLES_MAX];
+    uint8_t num_obstacles = 0;
+    const uint16_t num_objects = proximity->get_object_count();
+    for (uint16_t i=0; i<num_objects; i++) {
+        float angle_deg, distance;
+        if (proximity->get_object_angle_and_distance(i, angle_deg, distance)) {
+            // convert from body frame angle to earth frame offset in cm
+            const float angle_ef = radians(angle_deg) + yaw;
+            const Vector2f offset = Vector2f(cosf(angle_ef), sinf(angle_ef)) * (distance * 100.0f);
+            add_closest_obstacle(current_pos + offset, offset.length_squared(), obstacles, dist_sq, num_obstacles);
+        }
+    }
+    return num_obstacles;
+}
+
+// add obstacle to a list sorted by distance holding at most AP_OADIJKSTRA_OBSTACLES_MAX obstacles, the furthest is dropped if the list is full
+void AP_OAPathPlanner::add_closest_obstacle(const Vector2f &obstacle, float obstacle_dist_sq, Vector2f *obstacles, float *dist_sq, uint8_t &num_obstacles)
+{
+    if (num_obstacles == AP_OADIJKSTRA_OBSTACLES_MAX && obstacle_dist_sq >= dist_sq[num_obstacles-1]) {
+        return;
+    }
+    uint8_t i = MIN(num_obstacles, AP_OADIJKSTRA_OBSTACLES_MAX-1);
+    for (; i > 0 && dist_sq[i-1] > obstacle_dist_sq; i--) {
+        dist_sq[i] = dist_sq[i-1];
+        obstacles[i] = obstacles[i-1];
+    }
+    dist_sq[i] = obstacle_dist_sq;
+    obstacles[i] = obstacle;
+    num_obstacles = MIN(num_obstacles+1, AP_OADIJKSTRA_OBSTACLES_MAX);
+}
+
+// get positions of the closest occupied voxels at the vehicle's altitude in cm from the EKF origin, returns number of obstacles
+uint8_t AP_OAPathPlanner::get_map_obstacles(const AP_Proximity_Map &map, const Vector3f &position, Vector2f *obstacles) const
+{
+    float dist_sq[AP_OADIJKSTRA_OBSTACLES_MAX];
+    uint8_t num_obstacles = 0;
+    const float voxel_size = map.get_voxel_size();
+    AP_Proximity_Map::OccupiedIterator it = map.occupied();
+    Vector3f centre;
+    while (it.next(centre)) {
+        if (fabsf(centre.z - position.z) > voxel_size) {
+            continue;
+        }
+        const float d_sq = sq(centre.x - position.x) + sq(centre.y - position.y);
+        add_closest_obstacle(Vector2f(centre.x, centre.y) * 100.0f, d_sq, obstacles, dist_sq, num_obstacles);
+    }
+    return num_obstacles;
+}
+
+// avoidance thread that continually updates the avoidance_result structure based on avoidance_request
+void AP_OAPathPlanner::avoidance_thread()
+{
+    uint32_t last_update_ms = 0;
+
+    while (true) {
+
+        hal.scheduler->delay(OA_THREAD_POLL_MS);
+
+        // copy the request so the main thread is not held up while planning
+        Vector2f current_pos, destination;
+        Vector2f obstacles[AP_OADIJKSTRA_OBSTACLES_MAX];
+        uint8_t num_obstacles;
+        bool use_map;
+        Vector3f map_position;
+        const uint32_t now = AP_HAL::millis();
+        {
+            WITH_SEMAPHORE(_rsem);
+
+            // nothing to do if the waypoint controller is not running
+            if (now - _request.request_time_ms > OA_TIMEOUT_MS) {
+                continue;
+            }
+
+            // update at 10hz or as soon as the destination changes so the vehicle does not wait for a new path
+            if ((now - last_update_ms < OA_UPDATE_MS) && (_request.destination == _result.destination)) {
+                continue;
+            }
+
+            current_pos = _request.current_pos;
+            destination = _request.destination;
+            num_obstacles = _request.num_obstacles;
+            memcpy(obstacles, _request.obstacles, sizeof(Vector2f) * num_obstacles);
+            use_map = _request.use_map;
+            map_position = _request.map_position;
+        }
+        last_update_ms = now;
+
+        // take the closest obstacles from the occupancy map
+        if (use_map) {
+            const AP_Proximity *proximity = AP_Proximity::get_singleton();
+            const AP_Proximity_Map *map = (proximity != nullptr) ? proximity->get_map() : nullptr;
+            if (map != nullptr) {
+                WITH_SEMAPHORE(map->get_semaphore());
+                num_obstacles = get_map_obstacles(*map, map_position, obstacles);
+            }
+        }
+
+        // run path planning
+        Vector2f destination_new;
+        uint32_t build_us = 0;
+        const uint32_t start_us = AP_HAL::micros();
+        OA_RetState res = OA_NOT_REQUIRED;
+        switch (_type) {
+        case OA_PATHPLAN_DISABLED:
+            break;
+        case OA_PATHPLAN_DIJKSTRA:
+            res = run_dijkstra(current_pos, destination, obstacles, num_obstacles, destination_new, build_us);
+            break;
+        }
+        const uint32_t calc_us = AP_HAL::micros() - start_us - build_us;
+        _calc_max_us = MAX(_calc_max_us, calc_us);
+
+        {
+            // give the result and log data to the main thread
+            WITH_SEMAPHORE(_rsem);
+            _result.destination = destination;
+            _result.origin_new = current_pos;
+            _result.destination_new = destination_new;
+            _result.result_time_ms = AP_HAL::millis();
+            _result.ret_state = res;
+
+            _log.time_us = AP_HAL::micros64();
+            _log.state = res;
+            _log.num_fence_nodes = _dijkstra.get_num_fence_nodes();
+            _log.num_nodes = _dijkstra.get_num_nodes();
+            _log.num_obstacles = num_obstacles;
+            _log.path_length = _dijkstra.get_path_length();
+            _log.build_us = build_us;
+            _log.calc_us = calc_us;
+            _log.calc_max_us = _calc_max_us;
+            _log_pending = true;
+        }
+    }
+}
+
+// copy the fence into _fence_copy, returns false if memory could not be allocated
+// the fence's polygon semaphore must be held
+bool AP_OAPathPlanner::copy_fence(const AC_PolyFence_index &fence)
+{
+    // clearing the copy first means it no longer refers to _fence_points
+    _fence_num_points = 0;
+    if (!_fence_copy.init(fence.num_items())) {
+        return false;
+    }
+    if (fence.num_points() > _fence_points_max) {
+        Vector2f *new_points = (Vector2f *)realloc(_fence_points, fence.num_points() * sizeof(Vector2f));
+        if (new_points == nullptr) {
+            return false;
+        }
+        _fence_points = new_points;
+        _fence_points_max = fence.num_points();
+    }
+    if (fence.num_points() > 0) {
+        memcpy(_fence_points, fence.get_points(), fence.num_points() * sizeof(Vector2f));
+    }
+    _fence_num_points = fence.num_points();
+    for (uint8_t i = 0; i < fence.num_items(); i++) {
+        const AC_PolyFence_index::Item &item = fence.get_item(i);
+        switch (item.type) {
+        case AC_PolyFence_index::ItemType::INCLUSION_POLYGON:
+        case AC_PolyFence_index::ItemType::EXCLUSION_POLYGON:
+            _fence_copy.add_polygon(item.type, item.first, item.count);
+            break;
+        case AC_PolyFence_index::ItemType::INCLUSION_CIRCLE:
+        case AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE:
+            _fence_copy.add_circle(item.type, item.centre, item.radius);
+            break;
+        }
+    }
+    return true;
+}
+
+// find path using Dijkstra's, rebuilding the fence graph if the fence has changed
+AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::run_dijkstra(const Vector2f &current_pos, const Vector2f &destination,
+                                                             const Vector2f *obstacles, uint8_t num_obstacles,
+                                                             Vector2f &destination_new, uint32_t &build_us)
+{
+    AC_Fence *fence = AP::fence();
+    if (fence == nullptr) {
+        return OA_ERROR;
+    }
+
+    const float margin_cm = MAX(_margin_max * 100.0f, 1.0f);
+    bool fence_changed = false;
+    bool fence_enabled;
+    {
+        // only hold the fence's semaphore long enough to copy it so the main thread is never blocked by planning
+        WITH_SEMAPHORE(fence->get_polygon_semaphore());
+        const AC_PolyFence_index *fence_index = fence->get_polygon_index();
+        fence_enabled = ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) != 0) && (fence_index != nullptr);
+        if (!_fence_graph_valid ||
+            fence_enabled != _fence_graph_enabled ||
+            fence->get_boundary_update_ms() != _fence_graph_update_ms) {
+            _fence_graph_enabled = fence_enabled;
+            _fence_graph_update_ms = fence->get_boundary_update_ms();
+            _fence_graph_valid = !fence_enabled || copy_fence(*fence_index);
+            if (!_fence_graph_valid) {
+                gcs().send_text(MAV_SEVERITY_WARNING, "OA: out of memory for fence");
+                return OA_ERROR;
+            }
+            fence_changed = true;
+        }
+    }
+
+    // the graph and search only use the copy of the fence which is only changed by this thread
+    if (fence_changed || !is_equal(margin_cm, _fence_graph_margin_cm)) {
+        const uint32_t build_start_us = AP_HAL::micros();
+        _fence_graph_margin_cm = margin_cm;
+        _fence_graph_valid = (!fence_enabled || _fence_copy.build(_fence_points, _fence_num_points)) &&
+                             _dijkstra.update_fence(fence_enabled ? &_fence_copy : nullptr, margin_cm);
+        build_us = AP_HAL::micros() - build_start_us;
+        if (!_fence_graph_valid) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "OA: out of memory for fence");
+            return OA_ERROR;
+        }
+    }
+
+    switch (_dijkstra.update(current_pos, destination, obstacles, num_obstacles, destination_new)) {
+    case AP_OADijkstra::DIJKSTRA_STATE_NOT_REQUIRED:
+        return OA_NOT_REQUIRED;
+    case AP_OADijkstra::DIJKSTRA_STATE_SUCCESS:
+        return OA_SUCCESS;
+    case AP_OADijkstra::DIJKSTRA_STATE_ERROR:
+        break;
+    }
+    return OA_ERROR;
+}
+
+// write planning state and timing to the onboard log, must only be called from the main thread
+void AP_OAPathPlanner::Write_OA(const struct log_data &log) const
+{
+    // FNodes and Nodes are the number of fence nodes and the total including obstacle nodes, Len the number of points along the path
+    AP::logger().Write("OA", "TimeUS,State,FNodes,Nodes,Obs,Len,BuildUS,CalcUS,MaxUS", "QBHHBBIII",
+                       log.time_us,
+                       (uint8_t)log.state,
+                       log.num_fence_nodes,
+                       log.num_nodes,
+                       log.num_obstacles,
+                       log.path_length,
+                       log.build_us,
+                       log.calc_us,
+                       log.calc_max_us);
+}
+
+// singleton instance
+AP_OAPathPlanner *AP_OAPathPlanner::_singleton;
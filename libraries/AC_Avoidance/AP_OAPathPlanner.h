@@ -0,0 +1,147 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Proximity/AP_Proximity_Map.h>
+#include "AP_OADijkstra.h"
+
+#define AP_OAPATHPLANNER_MARGIN_MAX_DEFAULT     2.0f    // default distance in meters to keep away from fence and obstacles
+
+/*
+ * Object avoidance path planner
+ *
+ * Finds a path around the polygon fence and proximity obstacles from
+ * the vehicle to the waypoint controller's destination.  Planning
+ * runs in its own thread.  The waypoint controller calls
+ * mission_avoidance each iteration which posts a new request and
+ * returns the result of the last plan completed for that destination.
+ */
+class AP_OAPathPlanner {
+public:
+
+    AP_OAPathPlanner();
+
+    /* Do not allow copies */
+    AP_OAPathPlanner(const AP_OAPathPlanner &other) = delete;
+    AP_OAPathPlanner &operator=(const AP_OAPathPlanner&) = delete;
+
+    // get singleton instance
+    static AP_OAPathPlanner *get_singleton() {
+        return _singleton;
+    }
+
+    // start the planning thread if enabled
+    void init();
+
+    // object avoidance processing return status enum
+    enum OA_RetState : uint8_t {
+        OA_NOT_REQUIRED = 0,            // object avoidance is not required
+        OA_PROCESSING,                  // still calculating alternative path
+        OA_ERROR,                       // error during calculation
+        OA_SUCCESS                      // success
+    };
+
+    // provides an alternative origin and destination to avoid the fence and obstacles
+    //   all positions are offsets in cm from the EKF origin
+    //   result_origin and result_destination are only updated if OA_SUCCESS is returned
+    OA_RetState mission_avoidance(const Vector2f &current_pos, const Vector2f &origin, const Vector2f &destination,
+                                  Vector2f &result_origin, Vector2f &result_destination);
+
+    static const struct AP_Param::GroupInfo var_info[];
+
+private:
+
+    // path planning types
+    enum OAPathPlanTypes {
+        OA_PATHPLAN_DISABLED = 0,
+        OA_PATHPLAN_DIJKSTRA = 1
+    };
+
+    // avoidance thread that continually updates the avoidance_result structure based on avoidance_request
+    void avoidance_thread();
+
+    // get positions of proximity sensor obstacles in cm from the EKF origin, returns number of obstacles
+    uint8_t get_obstacles(const Vector2f &current_pos, Vector2f *obstacles) const;
+
+    // get vehicle position in meters from the EKF origin, returns false if the occupancy map is not available
+    bool get_map_position(Vector3f &position) const;
+
+    // get positions of the closest occupied voxels at the vehicle's altitude in cm from the EKF origin, returns number of obstacles
+    uint8_t get_map_obstacles(const AP_Proximity_Map &map, const Vector3f &position, Vector2f *obstacles) const;
+
+    // add obstacle to a list sorted by distance holding at most AP_OADIJKSTRA_OBSTACLES_MAX obstacles, the furthest is dropped if the list is full
+    static void add_closest_obstacle(const Vector2f &obstacle, float obstacle_dist_sq, Vector2f *obstacles, float *dist_sq, uint8_t &num_obstacles);
+
+    // copy the fence into _fence_copy, returns false if memory could not be allocated
+    // the fence's polygon semaphore must be held
+    bool copy_fence(const AC_PolyFence_index &fence);
+
+    // find path using Dijkstra's, rebuilding the fence graph if the fence has changed
+    OA_RetState run_dijkstra(const Vector2f &current_pos, const Vector2f &destination,
+                             const Vector2f *obstacles, uint8_t num_obstacles,
+                             Vector2f &destination_new, uint32_t &build_us);
+
+    // planning state and timing for the onboard log
+    struct log_data {
+        uint64_t time_us;               // system time the plan completed
+        OA_RetState state;              // avoidance state
+        uint16_t num_fence_nodes;       // number of fence nodes
+        uint16_t num_nodes;             // number of nodes including obstacle nodes
+        uint8_t num_obstacles;          // number of obstacles planned around
+        uint8_t path_length;            // number of points along the path
+        uint32_t build_us;              // time taken to build the fence graph
+        uint32_t calc_us;               // time taken to find the path
+        uint32_t calc_max_us;           // longest time taken to find a path
+    };
+
+    // write planning state and timing to the onboard log, must only be called from the main thread
+    void Write_OA(const struct log_data &log) const;
+
+    // an avoidance request from the waypoint controller
+    struct {
+        Vector2f current_pos;
+        Vector2f origin;
+        Vector2f destination;
+        Vector2f obstacles[AP_OADIJKSTRA_OBSTACLES_MAX];
+        uint8_t num_obstacles;
+        bool use_map;                   // true if obstacles should be taken from the occupancy map
+        Vector3f map_position;          // vehicle position in meters from the EKF origin used to search the map
+        uint32_t request_time_ms;
+    } _request;
+
+    // the result of the last plan completed by the avoidance thread
+    struct {
+        Vector2f destination;           // destination the result was calculated for
+        Vector2f origin_new;            // origin to use while avoiding
+        Vector2f destination_new;       // intermediate destination to use while avoiding
+        uint32_t result_time_ms;        // system time the result was calculated
+        OA_RetState ret_state;          // avoidance state
+    } _result;
+
+    struct log_data _log;               // log data of the last plan completed by the avoidance thread
+    bool _log_pending;                  // true if _log has not yet been written by the main thread
+
+    HAL_Semaphore _rsem;                // semaphore for request, result and log data
+
+    bool _thread_created;               // true once the avoidance thread has been started
+
+    // fence graph state, only accessed from the avoidance thread
+    AP_OADijkstra _dijkstra;
+    bool _fence_graph_valid;            // true if the graph was built successfully
+    bool _fence_graph_enabled;          // true if the polygon fence was enabled when the graph was built
+    uint32_t _fence_graph_update_ms;    // fence boundary update time when the graph was built
+    float _fence_graph_margin_cm;       // margin used when the graph was built
+    AC_PolyFence_index _fence_copy;     // copy of the fence the graph was built from
+    Vector2f *_fence_points;            // vertices of the copied fence
+    uint16_t _fence_points_max;         // number of vertices _fence_points can hold
+    uint16_t _fence_num_points;         // number of vertices in the copied fence
+    uint32_t _calc_max_us;              // longest time taken to find a path
+
+    // parameters
+    AP_Int8 _type;                      // type of path planner to use
+    AP_Float _margin_max;               // distance to keep away from fence and obstacles
+
+    static AP_OAPathPlanner *_singleton;
+};
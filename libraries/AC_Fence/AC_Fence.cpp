@@ -1,6 +1,7 @@
 #include "AC_Fence.h"
 
 #include <AP_AHRS/AP_AHRS.h>
+#include <AP_Common/Semaphore.h>
 #include <AP_HAL/AP_HAL.h>
 
 extern const AP_HAL::HAL& hal;
@@ -278,7 +279,7 @@ bool AC_Fence::polygon_fence_is_breached()
     }
 
     position = position * 100.0f;  // m to cm
-    return _poly_loader.boundary_breached(position, _boundary_num_points, _boundary);
+    return _poly_index.breached(position);
 }
 
 bool AC_Fence::check_fence_circle()
@@ -386,11 +387,11 @@ bool AC_Fence::check_destination_within_fence(const Location& loc)
     }
 
     // polygon fence check
-    if ((get_enabled_fences() & AC_FENCE_TYPE_POLYGON) && _boundary_num_points > 0) {
+    if ((get_enabled_fences() & AC_FENCE_TYPE_POLYGON) && _boundary_valid) {
         // check ekf has a good location
         Vector2f posNE;
         if (loc.get_vector_xy_from_origin_NE(posNE)) {
-            if (_poly_loader.boundary_breached(posNE, _boundary_num_points, _boundary)) {
+            if (_poly_index.breached(posNE)) {
                 return false;
             }
         }
@@ -462,14 +463,23 @@ void AC_Fence::manual_recovery_start()
 /// returns pointer to array of polygon points and num_points is filled in with the total number
 Vector2f* AC_Fence::get_polygon_points(uint16_t& num_points) const
 {
-    // return array minus the first point which holds the return location
-    num_points = (_boundary_num_points <= 1) ? 0 : _boundary_num_points - 1;
+    // return the initial polygon which follows the first point holding the return location
+    num_points = _boundary_first_polygon_num_points;
     if ((_boundary == nullptr) || (num_points == 0)) {
         return nullptr;
     }
     return &_boundary[1];
 }
 
+/// returns index of all polygon fence items or nullptr if the polygon fence is not valid
+const AC_PolyFence_index *AC_Fence::get_polygon_index() const
+{
+    if (!_boundary_valid) {
+        return nullptr;
+    }
+    return &_poly_index;
+}
+
 /// returns true if we've breached the polygon boundary.  simple passthrough to underlying _poly_loader object
 bool AC_Fence::boundary_breached(const Vector2f& location, uint16_t num_points, const Vector2f* points) const
 {
@@ -489,12 +499,13 @@ void AC_Fence::handle_msg(GCS_MAVLINK &link, mavlink_message_t* msg)
         case MAVLINK_MSG_ID_FENCE_POINT: {
             mavlink_fence_point_t packet;
             mavlink_msg_fence_point_decode(msg, &packet);
-            if (!check_latlng(packet.lat,packet.lng)) {
+            Vector2l point;
+            point.x = packet.lat*1.0e7f;
+            point.y = packet.lng*1.0e7f;
+            AC_PolyFence_index::ItemType item_type;
+            if (!check_latlng(packet.lat,packet.lng) && !AC_PolyFence_loader::is_item_marker(point, item_type)) {
                 link.send_text(MAV_SEVERITY_WARNING, "Invalid fence point, lat or lng too large");
             } else {
-                Vector2l point;
-                point.x = packet.lat*1.0e7f;
-                point.y = packet.lng*1.0e7f;
                 if (!_poly_loader.save_point_to_eeprom(packet.idx, point)) {
                     link.send_text(MAV_SEVERITY_WARNING, "Failed to save polygon point, too many points?");
                 } else {
@@ -557,27 +568,110 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
     // sanity check total
     _total = constrain_int16(_total, 0, _poly_loader.max_points());
 
-    // load each point from eeprom
+    // other threads may be reading the boundary
+    WITH_SEMAPHORE(_poly_sem);
+
+    // the boundary is not valid until all points have been loaded
+    _boundary_valid = false;
+    _boundary_update_ms = AP_HAL::millis();
+
+    // count item markers so the index can be sized.  The initial polygon is one more item
     Vector2l temp_latlon;
+    AC_PolyFence_index::ItemType item_type = AC_PolyFence_index::ItemType::INCLUSION_POLYGON;
+    uint8_t num_items = 1;
+    for (uint16_t index=1; index<_total; index++) {
+        if (!_poly_loader.load_point_from_eeprom(index, temp_latlon)) {
+            return false;
+        }
+        if (AC_PolyFence_loader::is_item_marker(temp_latlon, item_type)) {
+            num_items++;
+        }
+    }
+    if (!_poly_index.init(num_items)) {
+        return false;
+    }
+
+    // load each point from eeprom, adding each item to the index as its last point is loaded
+    bool items_valid = true;
+    uint16_t item_first = 1;
+    item_type = AC_PolyFence_index::ItemType::INCLUSION_POLYGON;
+    _boundary_first_polygon_num_points = 0;
     for (uint16_t index=0; index<_total; index++) {
         // load boundary point as lat/lon point
         if (!_poly_loader.load_point_from_eeprom(index, temp_latlon)) {
             return false;
         }
+        AC_PolyFence_index::ItemType next_type;
+        if (index > 0 && AC_PolyFence_loader::is_item_marker(temp_latlon, next_type)) {
+            // marker ends the previous item.  An empty initial polygon is allowed
+            if (item_first == 1) {
+                _boundary_first_polygon_num_points = index - item_first;
+            }
+            if (index > 1 || item_first != 1) {
+                items_valid &= add_polygon_item(item_type, item_first, index - item_first);
+            }
+            _boundary[index].zero();
+            item_type = next_type;
+            item_first = index + 1;
+            continue;
+        }
+        // points that are not valid locations, such as markers of another version, make the fence invalid
+        if (!check_latlng(temp_latlon.x, temp_latlon.y)) {
+            items_valid = false;
+            _boundary[index].zero();
+            continue;
+        }
         // move into location structure and convert to offset from ekf origin
         temp_loc.lat = temp_latlon.x;
         temp_loc.lng = temp_latlon.y;
         _boundary[index] = location_diff(ekf_origin, temp_loc) * 100.0f;
     }
+    if (_total > 0) {
+        if (item_first == 1) {
+            _boundary_first_polygon_num_points = _total - item_first;
+        }
+        items_valid &= add_polygon_item(item_type, item_first, _total - item_first);
+    }
     _boundary_num_points = _total;
     _boundary_loaded = true;
 
-    // update validity of polygon
-    _boundary_valid = _poly_loader.boundary_valid(_boundary_num_points, _boundary);
+    // update validity of polygon.  The return point must be within the fence
+    _boundary_valid = items_valid &&
+                      _poly_index.num_items() > 0 &&
+                      _poly_index.build(_boundary, _boundary_num_points) &&
+                      !_poly_index.breached(_boundary[0]);
 
     return true;
 }
 
+/// add the polygon or circle made up of count boundary points starting at first to the polygon index.  returns true on success
+bool AC_Fence::add_polygon_item(AC_PolyFence_index::ItemType type, uint16_t first, uint16_t count)
+{
+    switch (type) {
+    case AC_PolyFence_index::ItemType::INCLUSION_POLYGON:
+    case AC_PolyFence_index::ItemType::EXCLUSION_POLYGON:
+        // last point must be the same as the first
+        if (!Polygon_complete(&_boundary[first], count)) {
+            return false;
+        }
+        return _poly_index.add_polygon(type, first, count);
+
+    case AC_PolyFence_index::ItemType::INCLUSION_CIRCLE:
+    case AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE: {
+        // circles are made up of the centre and a point on the edge
+        if (count != 2) {
+            return false;
+        }
+        const float radius = (_boundary[first+1] - _boundary[first]).length();
+        if (!is_positive(radius)) {
+            return false;
+        }
+        return _poly_index.add_circle(type, _boundary[first], radius);
+    }
+    }
+    return false;
+}
+
 // methods for mavlink SYS_STATUS message (send_sys_status)
 bool AC_Fence::sys_status_present() const
 {
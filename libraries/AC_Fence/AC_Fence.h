@@ -100,8 +100,18 @@ public:
     ///
 
     /// returns pointer to array of polygon points and num_points is filled in with the total number
+    ///     only the initial polygon is returned, use get_polygon_index for all polygons and circles
     Vector2f* get_polygon_points(uint16_t& num_points) const;
 
+    /// returns index of all polygon fence items (in cm from the EKF origin) or nullptr if the polygon fence is not valid
+    const AC_PolyFence_index *get_polygon_index() const;
+
+    /// returns semaphore which must be held when reading the polygon index or points from another thread
+    HAL_Semaphore &get_polygon_semaphore() { return _poly_sem; }
+
+    /// returns system time in milliseconds of the last time the polygon boundary was loaded
+    uint32_t get_boundary_update_ms() const { return _boundary_update_ms; }
+
     /// returns true if we've breached the polygon boundary.  simple passthrough to underlying _poly_loader object
     bool boundary_breached(const Vector2f& location, uint16_t num_points, const Vector2f* points) const;
 
@@ -144,6 +154,9 @@ private:
     /// load polygon points stored in eeprom into boundary array and perform validation.  returns true if load successfully completed
     bool load_polygon_from_eeprom(bool force_reload = false);
 
+    /// add the polygon or circle made up of count boundary points starting at first to the polygon index.  returns true on success
+    bool add_polygon_item(AC_PolyFence_index::ItemType type, uint16_t first, uint16_t count);
+
     // returns true if we have breached the fence:
     bool polygon_fence_is_breached();
 
@@ -181,9 +194,13 @@ private:
     AC_PolyFence_loader _poly_loader;               // helper for loading/saving polygon points
     Vector2f        *_boundary = nullptr;           // array of boundary points.  Note: point 0 is the return point
     uint8_t         _boundary_num_points = 0;       // number of points in the boundary array (should equal _total parameter after load has completed)
+    uint8_t         _boundary_first_polygon_num_points = 0; // number of points in the initial polygon (starting at point 1)
+    AC_PolyFence_index _poly_index;                 // index of all polygons and circles in the boundary array
     bool            _boundary_create_attempted = false; // true if we have attempted to create the boundary array
     bool            _boundary_loaded = false;       // true if boundary array has been loaded from eeprom
     bool            _boundary_valid = false;        // true if boundary forms a closed polygon
+    uint32_t        _boundary_update_ms = 0;        // system time of last load of the boundary
+    HAL_Semaphore   _poly_sem;                      // semaphore protecting boundary and polygon index
 };
 
 namespace AP {
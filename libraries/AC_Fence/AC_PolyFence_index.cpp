@@ -0,0 +1,395 @@
+#include "AC_PolyFence_index.h"
+
+// remove all items, free the edge grid and allocate space for max_items items
+// returns false if memory could not be allocated
+bool AC_PolyFence_index::init(uint8_t max_items)
+{
+    clear();
+    if (max_items == 0) {
+        return true;
+    }
+    _items = (Item *)calloc(max_items, sizeof(Item));
+    if (_items == nullptr) {
+        return false;
+    }
+    _max_items = max_items;
+    return true;
+}
+
+// remove all items and free all memory
+void AC_PolyFence_index::clear()
+{
+    free(_items);
+    free(_cell_start);
+    free(_cell_edges);
+    _items = nullptr;
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _max_items = 0;
+    _num_items = 0;
+    _grid_size = 0;
+    _points = nullptr;
+    _num_points = 0;
+}
+
+// add a polygon made up of count vertices starting at first
+// returns false if there are too few vertices to form a closed polygon or there is no room for another item
+bool AC_PolyFence_index::add_polygon(ItemType type, uint16_t first, uint16_t count)
+{
+    // a polygon requires at least 4 points (a triangle and last point equals first)
+    if (_num_items >= _max_items || count < 4) {
+        return false;
+    }
+    Item &item = _items[_num_items++];
+    item.type = type;
+    item.first = first;
+    item.count = count;
+    return true;
+}
+
+// add a circle, returns false if there is no room for another item
+bool AC_PolyFence_index::add_circle(ItemType type, const Vector2f &centre, float radius)
+{
+    if (_num_items >= _max_items) {
+        return false;
+    }
+    Item &item = _items[_num_items++];
+    item.type = type;
+    item.centre = centre;
+    item.radius = radius;
+    item.bb_min = centre - Vector2f(radius, radius);
+    item.bb_max = centre + Vector2f(radius, radius);
+    return true;
+}
+
+// grid cell column holding a point, constrained to the grid
+int16_t AC_PolyFence_index::cell_col(float x) const
+{
+    const float col = (x - _grid_origin.x) / _cell_size.x;
+    if (col <= 0.0f) {
+        return 0;
+    }
+    return MIN((int16_t)col, (int16_t)(_grid_size - 1));
+}
+
+// grid cell row holding a point, constrained to the grid
+int16_t AC_PolyFence_index::cell_row(float y) const
+{
+    const float row = (y - _grid_origin.y) / _cell_size.y;
+    if (row <= 0.0f) {
+        return 0;
+    }
+    return MIN((int16_t)row, (int16_t)(_grid_size - 1));
+}
+
+// returns true if the item is a polygon
+bool AC_PolyFence_index::is_polygon(const Item &item)
+{
+    return item.type == ItemType::INCLUSION_POLYGON || item.type == ItemType::EXCLUSION_POLYGON;
+}
+
+// get the range of grid cells covered by the bounding box of edge v
+void AC_PolyFence_index::edge_cells(uint16_t v, int16_t &col_min, int16_t &col_max, int16_t &row_min, int16_t &row_max) const
+{
+    const Vector2f &a = _points[v];
+    const Vector2f &b = _points[v+1];
+    col_min = cell_col(MIN(a.x, b.x));
+    col_max = cell_col(MAX(a.x, b.x));
+    row_min = cell_row(MIN(a.y, b.y));
+    row_max = cell_row(MAX(a.y, b.y));
+}
+
+/*
+  calculate bounding boxes and build the edge grid once all items have been added
+
+  The grid is held as a list of edges sorted by cell, with _cell_start
+  holding the position of each cell's first edge.  The list is built
+  in two passes, the first counting the edges in each cell.
+ */
+bool AC_PolyFence_index::build(const Vector2f *points, uint16_t num_points)
+{
+    _points = points;
+    _num_points = num_points;
+
+    free(_cell_start);
+    free(_cell_edges);
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _grid_size = 0;
+
+    // calculate polygon bounding boxes and the bounding box of all polygons
+    uint32_t num_edges = 0;
+    Vector2f bb_min, bb_max;
+    for (uint8_t i=0; i<_num_items; i++) {
+        Item &item = _items[i];
+        if (!is_polygon(item)) {
+            continue;
+        }
+        if (item.first + item.count > num_points) {
+            // should never happen
+            return false;
+        }
+        item.bb_min = item.bb_max = points[item.first];
+        for (uint16_t v=item.first+1; v<item.first+item.count; v++) {
+            item.bb_min.x = MIN(item.bb_min.x, points[v].x);
+            item.bb_min.y = MIN(item.bb_min.y, points[v].y);
+            item.bb_max.x = MAX(item.bb_max.x, points[v].x);
+            item.bb_max.y = MAX(item.bb_max.y, points[v].y);
+        }
+        if (num_edges == 0) {
+            bb_min = item.bb_min;
+            bb_max = item.bb_max;
+        } else {
+            bb_min.x = MIN(bb_min.x, item.bb_min.x);
+            bb_min.y = MIN(bb_min.y, item.bb_min.y);
+            bb_max.x = MAX(bb_max.x, item.bb_max.x);
+            bb_max.y = MAX(bb_max.y, item.bb_max.y);
+        }
+        num_edges += item.count - 1;
+    }
+
+    // nothing more to do if there are no polygons
+    if (num_edges == 0) {
+        return true;
+    }
+
+    // aim for roughly one edge per cell
+    uint8_t grid_size = constrain_int16(ceilf(sqrtf(num_edges)), 1, AC_POLYFENCE_INDEX_GRID_MAX);
+    _grid_origin = bb_min;
+
+    uint32_t num_entries;
+    while (true) {
+        _grid_size = grid_size;
+        _cell_size.x = MAX((bb_max.x - bb_min.x) / grid_size, 1.0f);
+        _cell_size.y = MAX((bb_max.y - bb_min.y) / grid_size, 1.0f);
+
+        // count the cells covered by each edge
+        num_entries = 0;
+        for (uint8_t i=0; i<_num_items; i++) {
+            const Item &item = _items[i];
+            if (!is_polygon(item)) {
+                continue;
+            }
+            for (uint16_t v=item.first; v<item.first+item.count-1; v++) {
+                int16_t col_min, col_max, row_min, row_max;
+                edge_cells(v, col_min, col_max, row_min, row_max);
+                num_entries += (row_max - row_min + 1) * (col_max - col_min + 1);
+            }
+        }
+
+        // long diagonal edges can cover many cells.  Use a coarser grid if there are too many entries
+        if (num_entries < UINT16_MAX || grid_size == 1) {
+            break;
+        }
+        grid_size /= 2;
+    }
+    if (num_entries >= UINT16_MAX) {
+        _grid_size = 0;
+        return false;
+    }
+
+    const uint16_t num_cells = _grid_size * _grid_size;
+    _cell_start = (uint16_t *)calloc(num_cells + 1, sizeof(uint16_t));
+    _cell_edges = (uint16_t *)calloc(num_entries, sizeof(uint16_t));
+    if (_cell_start == nullptr || _cell_edges == nullptr) {
+        free(_cell_start);
+        free(_cell_edges);
+        _cell_start = nullptr;
+        _cell_edges = nullptr;
+        _grid_size = 0;
+        return false;
+    }
+
+    // count the edges in each cell, then convert the counts to start positions
+    for (uint8_t i=0; i<_num_items; i++) {
+        const Item &item = _items[i];
+        if (!is_polygon(item)) {
+            continue;
+        }
+        for (uint16_t v=item.first; v<item.first+item.count-1; v++) {
+            int16_t col_min, col_max, row_min, row_max;
+            edge_cells(v, col_min, col_max, row_min, row_max);
+            for (int16_t row=row_min; row<=row_max; row++) {
+                for (int16_t col=col_min; col<=col_max; col++) {
+                    _cell_start[row * _grid_size + col + 1]++;
+                }
+            }
+        }
+    }
+    for (uint16_t c=0; c<num_cells; c++) {
+        _cell_start[c+1] += _cell_start[c];
+    }
+
+    // fill in the edges, advancing each cell's start position as we go
+    for (uint8_t i=0; i<_num_items; i++) {
+        const Item &item = _items[i];
+        if (!is_polygon(item)) {
+            continue;
+        }
+        for (uint16_t v=item.first; v<item.first+item.count-1; v++) {
+            int16_t col_min, col_max, row_min, row_max;
+            edge_cells(v, col_min, col_max, row_min, row_max);
+            for (int16_t row=row_min; row<=row_max; row++) {
+                for (int16_t col=col_min; col<=col_max; col++) {
+                    _cell_edges[_cell_start[row * _grid_size + col]++] = v;
+                }
+            }
+        }
+    }
+
+    // each start position now holds the start of the next cell, so shift them back
+    for (uint16_t c=num_cells; c>0; c--) {
+        _cell_start[c] = _cell_start[c-1];
+    }
+    _cell_start[0] = 0;
+
+    return true;
+}
+
+/*
+  returns true if point p is inside polygon item
+
+  This uses the same crossing test as Polygon_outside() but only
+  counts crossings of a ray from p towards +x (east) with edges in the
+  row of cells holding p.  An edge covering several cells of the row
+  is only tested in the first of those cells the scan reaches, so
+  each edge is tested once whichever cell its crossing point rounds
+  into.
+ */
+bool AC_PolyFence_index::polygon_contains(const Item &item, const Vector2f &p) const
+{
+    const uint16_t last = item.first + item.count - 1;
+
+    if (_grid_size == 0) {
+        return !Polygon_outside(p, &_points[item.first], item.count);
+    }
+
+    bool inside = false;
+    const int16_t row = cell_row(p.y);
+    const int16_t col_start = cell_col(p.x);
+    for (int16_t col=col_start; col<_grid_size; col++) {
+        const uint16_t cell = row * _grid_size + col;
+        for (uint16_t ofs=_cell_start[cell]; ofs<_cell_start[cell+1]; ofs++) {
+            const uint16_t v = _cell_edges[ofs];
+            if (v < item.first || v >= last) {
+                // edge belongs to another polygon
+                continue;
+            }
+            int16_t col_min, col_max, row_min, row_max;
+            edge_cells(v, col_min, col_max, row_min, row_max);
+            if (MAX(col_min, col_start) != col) {
+                // edge was tested in an earlier cell
+                continue;
+            }
+            const Vector2f &a = _points[v];
+            const Vector2f &b = _points[v+1];
+            if ((a.y > p.y) == (b.y > p.y)) {
+                continue;
+            }
+            const float x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+            if (x > p.x) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+// returns true if point p is inside item i
+bool AC_PolyFence_index::item_contains(uint8_t i, const Vector2f &p) const
+{
+    const Item &item = _items[i];
+
+    // quick check against bounding box
+    if (p.x < item.bb_min.x || p.x > item.bb_max.x ||
+        p.y < item.bb_min.y || p.y > item.bb_max.y) {
+        return false;
+    }
+
+    if (is_polygon(item)) {
+        return polygon_contains(item, p);
+    }
+    return (p - item.centre).length_squared() <= sq(item.radius);
+}
+
+// returns true if point p is outside an inclusion item or inside an exclusion item
+bool AC_PolyFence_index::breached(const Vector2f &p) const
+{
+    for (uint8_t i=0; i<_num_items; i++) {
+        const bool inside = item_contains(i, p);
+        switch (_items[i].type) {
+        case ItemType::INCLUSION_POLYGON:
+        case ItemType::INCLUSION_CIRCLE:
+            if (!inside) {
+                return true;
+            }
+            break;
+        case ItemType::EXCLUSION_POLYGON:
+        case ItemType::EXCLUSION_CIRCLE:
+            if (inside) {
+                return true;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+AC_PolyFence_index::EdgeIterator::EdgeIterator(const AC_PolyFence_index &index, const Vector2f &p, float distance) :
+    _index(index),
+    _ofs(0),
+    _ofs_end(0)
+{
+    // no edges if there is no grid or the area of interest is outside the grid
+    const float grid_width = index._cell_size.x * index._grid_size;
+    const float grid_height = index._cell_size.y * index._grid_size;
+    if (index._grid_size == 0 ||
+        p.x + distance < index._grid_origin.x || p.x - distance > index._grid_origin.x + grid_width ||
+        p.y + distance < index._grid_origin.y || p.y - distance > index._grid_origin.y + grid_height) {
+        _col_min = _col_max = _col = 0;
+        _row_min = _row = 0;
+        _row_max = -1;
+        return;
+    }
+
+    _col_min = index.cell_col(p.x - distance);
+    _col_max = index.cell_col(p.x + distance);
+    _row_min = index.cell_row(p.y - distance);
+    _row_max = index.cell_row(p.y + distance);
+    _row = _row_min;
+    _col = _col_min;
+    const uint16_t cell = _row * index._grid_size + _col;
+    _ofs = index._cell_start[cell];
+    _ofs_end = index._cell_start[cell+1];
+}
+
+// get the next edge, returns false when there are no more edges
+bool AC_PolyFence_index::EdgeIterator::next(Vector2f &start, Vector2f &end)
+{
+    while (_row <= _row_max) {
+        while (_ofs < _ofs_end) {
+            const uint16_t v = _index._cell_edges[_ofs++];
+            // an edge covering several cells of the search area is only returned from the first of them
+            int16_t col_min, col_max, row_min, row_max;
+            _index.edge_cells(v, col_min, col_max, row_min, row_max);
+            if (MAX(col_min, _col_min) != _col || MAX(row_min, _row_min) != _row) {
+                continue;
+            }
+            start = _index._points[v];
+            end = _index._points[v+1];
+            return true;
+        }
+
+        // move to next cell
+        if (++_col > _col_max) {
+            _col = _col_min;
+            _row++;
+        }
+        if (_row <= _row_max) {
+            const uint16_t cell = _row * _index._grid_size + _col;
+            _ofs = _index._cell_start[cell];
+            _ofs_end = _index._cell_start[cell+1];
+        }
+    }
+    return false;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#define AC_POLYFENCE_INDEX_GRID_MAX     32      // maximum number of grid cells along each side of the edge grid
+
+/*
+  index of the polygons and circles making up a fence
+
+  Polygon vertices are held by the caller as offsets in cm from the
+  EKF origin and are not copied.  Each polygon is closed (its last
+  vertex equals its first) and the edge from vertex v to vertex v+1
+  is identified by v.
+
+  Each item keeps its bounding box so most items can be rejected
+  without looking at their edges.  The edges of all polygons are
+  bucketed into a uniform grid covering all the polygons, with each
+  edge added to every cell its own bounding box overlaps.  Breach
+  checks then only look at the edges in one row of cells and searches
+  for edges near the vehicle only look at the cells around it.
+ */
+class AC_PolyFence_index
+{
+public:
+
+    enum class ItemType : uint8_t {
+        INCLUSION_POLYGON = 0,  // vehicle must remain inside polygon
+        EXCLUSION_POLYGON = 1,  // vehicle must remain outside polygon
+        INCLUSION_CIRCLE  = 2,  // vehicle must remain inside circle
+        EXCLUSION_CIRCLE  = 3,  // vehicle must remain outside circle
+    };
+
+    struct Item {
+        ItemType type;
+        uint16_t first;         // index of the first vertex (polygons only)
+        uint16_t count;         // number of vertices including the closing vertex (polygons only)
+        Vector2f centre;        // centre in cm from the EKF origin (circles only)
+        float radius;           // radius in cm (circles only)
+        Vector2f bb_min;        // south-west corner of bounding box
+        Vector2f bb_max;        // north-east corner of bounding box
+    };
+
+    AC_PolyFence_index() {}
+
+    /* Do not allow copies */
+    AC_PolyFence_index(const AC_PolyFence_index &other) = delete;
+    AC_PolyFence_index &operator=(const AC_PolyFence_index&) = delete;
+
+    // remove all items, free the edge grid and allocate space for max_items items
+    // returns false if memory could not be allocated
+    bool init(uint8_t max_items);
+
+    // remove all items and free all memory
+    void clear();
+
+    // add a polygon made up of count vertices starting at first
+    // returns false if there are too few vertices to form a closed polygon or there is no room for another item
+    bool add_polygon(ItemType type, uint16_t first, uint16_t count);
+
+    // add a circle, returns false if there is no room for another item
+    bool add_circle(ItemType type, const Vector2f &centre, float radius);
+
+    // calculate bounding boxes and build the edge grid once all items have been added
+    // points must remain valid until clear is called
+    // returns false if memory for the grid could not be allocated
+    bool build(const Vector2f *points, uint16_t num_points);
+
+    // number of items in the fence
+    uint8_t num_items() const { return _num_items; }
+
+    // get an item
+    const Item &get_item(uint8_t i) const { return _items[i]; }
+
+    // get the polygon vertices passed to build
+    const Vector2f *get_points() const { return _points; }
+
+    // number of polygon vertices passed to build
+    uint16_t num_points() const { return _num_points; }
+
+    // returns true if point p is inside item i
+    bool item_contains(uint8_t i, const Vector2f &p) const;
+
+    // returns true if point p is outside an inclusion item or inside an exclusion item
+    bool breached(const Vector2f &p) const;
+
+    /*
+      iterator over the polygon edges which may come within a given
+      distance of a point.  Each edge is returned at most once but
+      some edges further away may also be returned.
+     */
+    class EdgeIterator {
+    public:
+        EdgeIterator(const AC_PolyFence_index &index, const Vector2f &p, float distance);
+
+        // get the next edge, returns false when there are no more edges
+        bool next(Vector2f &start, Vector2f &end);
+
+    private:
+        const AC_PolyFence_index &_index;
+        int16_t _col_min, _col_max;     // range of cells covering the search area
+        int16_t _row_min, _row_max;
+        int16_t _col, _row;
+        uint16_t _ofs;          // next entry in the current cell
+        uint16_t _ofs_end;      // end of the current cell
+    };
+
+    // get an iterator over edges within distance (in cm) of p
+    EdgeIterator edges_near(const Vector2f &p, float distance) const {
+        return EdgeIterator(*this, p, distance);
+    }
+
+private:
+
+    // returns true if the item is a polygon
+    static bool is_polygon(const Item &item);
+
+    // grid cell column and row holding a point, constrained to the grid
+    int16_t cell_col(float x) const;
+    int16_t cell_row(float y) const;
+
+    // get the range of grid cells covered by the bounding box of edge v
+    void edge_cells(uint16_t v, int16_t &col_min, int16_t &col_max, int16_t &row_min, int16_t &row_max) const;
+
+    // returns true if point p is inside polygon item
+    bool polygon_contains(const Item &item, const Vector2f &p) const;
+
+    Item *_items = nullptr;
+    uint8_t _max_items = 0;
+    uint8_t _num_items = 0;
+
+    const Vector2f *_points = nullptr;  // polygon vertices
+    uint16_t _num_points = 0;
+
+    // edge grid
+    uint8_t _grid_size = 0;             // number of cells along each side, zero if there is no grid
+    Vector2f _grid_origin;              // south-west corner of grid
+    Vector2f _cell_size;                // size of each cell in cm
+    uint16_t *_cell_start = nullptr;    // index into _cell_edges of the first edge in each cell, with one extra element
+    uint16_t *_cell_edges = nullptr;    // edges in each cell
+};
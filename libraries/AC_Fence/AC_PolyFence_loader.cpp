@@ -53,6 +53,26 @@ bool AC_PolyFence_loader::save_point_to_eeprom(uint16_t i, const Vector2l& point
     return true;
 }
 
+// returns true if point is a marker for the start of a fence item, type is filled in with the item's type
+bool AC_PolyFence_loader::is_item_marker(const Vector2l& point, AC_PolyFence_index::ItemType &type)
+{
+    // allow for rounding of the latitude sent by the ground station
+    const int32_t half_degree = 5000000;
+    if (point.x < AC_POLYFENCE_ITEM_MARKER_LAT - half_degree) {
+        return false;
+    }
+    const int32_t item_type = (point.x - (AC_POLYFENCE_ITEM_MARKER_LAT - half_degree)) / 10000000;
+    if (item_type > (int32_t)AC_PolyFence_index::ItemType::EXCLUSION_CIRCLE) {
+        return false;
+    }
+    if (labs(point.y - AC_POLYFENCE_FORMAT_VERSION * 10000000) >= half_degree) {
+        // marker of an unsupported version
+        return false;
+    }
+    type = (AC_PolyFence_index::ItemType)item_type;
+    return true;
+}
+
 // validate array of boundary points (expressed as either floats or long ints)
 //   returns true if boundary is valid
 template <typename T>
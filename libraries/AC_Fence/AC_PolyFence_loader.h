@@ -2,6 +2,36 @@
 
 #include <AP_Common/AP_Common.h>
 #include <AP_Math/AP_Math.h>
+#include "AC_PolyFence_index.h"
+
+/*
+  Fence points are stored as a list of latitude/longitude pairs.  Point
+  0 is the return point and the following points form a closed polygon
+  which the vehicle must remain inside.
+
+  Further polygons and circles may follow, each starting with a marker
+  point whose latitude is AC_POLYFENCE_ITEM_MARKER_LAT plus the item
+  type in whole degrees (i.e. 91 to 94 degrees, which is not a valid
+  latitude) and whose longitude is AC_POLYFENCE_FORMAT_VERSION in
+  whole degrees.  The item types are those of the MAVLink fence
+  commands in the same order:
+
+    91: inclusion polygon (MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION), followed by its vertices with the last equal to the first
+    92: exclusion polygon (MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION), followed by its vertices with the last equal to the first
+    93: inclusion circle (MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION), followed by its centre and a point on its edge
+    94: exclusion circle (MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION), followed by its centre and a point on its edge
+
+  Markers are sent and fetched with FENCE_POINT like any other point.
+  A marker with another version is rejected when uploaded and makes
+  a stored fence invalid, so a change to the meaning of the markers
+  must increment AC_POLYFENCE_FORMAT_VERSION.
+
+  If point 1 is a marker there is no initial polygon.  The vehicle
+  must remain inside all inclusion items and outside all exclusion
+  items.
+ */
+#define AC_POLYFENCE_ITEM_MARKER_LAT    910000000   // latitude (in degrees * 1e7) of a marker for the first item type
+#define AC_POLYFENCE_FORMAT_VERSION     1           // version of the marker format, held in the marker's longitude in whole degrees
 
 class AC_PolyFence_loader
 {
@@ -21,6 +51,9 @@ public:
     // save a fence point to eeprom, returns true on successful save
     bool save_point_to_eeprom(uint16_t i, const Vector2l& point);
 
+    // returns true if point is a marker for the start of a fence item, type is filled in with the item's type
+    static bool is_item_marker(const Vector2l& point, AC_PolyFence_index::ItemType &type);
+
 
     // validate array of boundary points (expressed as either floats or long ints)
     //   returns true if boundary is valid
@@ -67,6 +67,15 @@ const AP_Param::GroupInfo AC_WPNav::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("RFND_USE",   10, AC_WPNav, _rangefinder_use, 1),
 
+    // @Param: JERK
+    // @DisplayName: Waypoint Jerk
+    // @Description: Defines the jerk in m/s/s/s used during missions.  Straight segments started with the vehicle stopped follow a jerk limited trajectory which blends the corner into the next segment at fast waypoints.  Zero, the default, uses the leash based controller
+    // @Units: m/s/s/s
+    // @Range: 0 20
+    // @Increment: 0.5
+    // @User: Advanced
+    AP_GROUPINFO("JERK",       11, AC_WPNav, _wp_jerk, WPNAV_JERK_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -89,6 +98,9 @@ AC_WPNav::AC_WPNav(const AP_InertialNav& inav, const AP_AHRS_View& ahrs, AC_PosC
     _flags.recalc_wp_leash = false;
     _flags.new_wp_destination = false;
     _flags.segment_type = SEGMENT_STRAIGHT;
+    _scurve_active = false;
+    _scurve_next_valid = false;
+    _scurve_time_scale = 1.0f;
 
     // sanity check some parameters
     _wp_accel_cmss = MIN(_wp_accel_cmss, GRAVITY_MSS * 100.0f * tanf(ToRad(_attitude_control.lean_angle_max() * 0.01f)));
@@ -157,6 +169,9 @@ void AC_WPNav::wp_and_spline_init()
 
     // initialise yaw heading to current heading target
     _flags.wp_yaw_set = false;
+
+    // the first leg decides whether to use the jerk limited trajectory
+    reset_scurve();
 }
 
 /// set_speed_xy - allows main code to pass target horizontal velocity for wp navigation
@@ -247,13 +262,46 @@ bool AC_WPNav::set_wp_destination_NED(const Vector3f& destination_NED)
     return set_wp_destination(Vector3f(destination_NED.x * 100.0f, destination_NED.y * 100.0f, -destination_NED.z * 100.0f), false);
 }
 
+/// set_wp_destination_next - set the waypoint after the current destination so the corner between them can be blended
+///     returns false if the jerk limited trajectory is not in use or the location cannot be converted to a vector from ekf origin
+bool AC_WPNav::set_wp_destination_next(const Location& destination)
+{
+    bool terr_alt;
+    Vector3f dest_neu;
+
+    // convert destination location to vector
+    if (!get_vector_NEU(destination, dest_neu, terr_alt)) {
+        return false;
+    }
+
+    return set_wp_destination_next(dest_neu, terr_alt);
+}
+
+/// set_wp_destination_next - set the waypoint after the current destination using position vector (distance from ekf origin in cm)
+///     terrain_alt should be true if destination.z is a desired altitude above terrain
+bool AC_WPNav::set_wp_destination_next(const Vector3f& destination, bool terrain_alt)
+{
+    // the next leg must use the same altitude frame and can not be changed once the corner has been started
+    if (!_scurve_active || (terrain_alt != _terrain_alt) || _scurve_next_leg.started()) {
+        return false;
+    }
+
+    calc_scurve_track(_scurve_next_leg, _destination, destination);
+    _scurve_next_valid = true;
+    return true;
+}
+
 /// set_origin_and_destination - set origin and destination waypoints using position vectors (distance from home in cm)
 ///     terrain_alt should be true if origin.z and destination.z are desired altitudes above terrain (false if these are alt-above-ekf-origin)
 ///     returns false on failure (likely caused by missing terrain data)
 bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt)
 {
+    // if the corner into this leg has already been started the leg begins at the previous destination and the position target is left alone
+    const bool continue_scurve = _scurve_active && _scurve_next_valid && _scurve_next_leg.started() &&
+                                 (terrain_alt == _terrain_alt) && (destination == _scurve_next_leg.get_destination());
+
     // store origin and destination locations
-    _origin = origin;
+    _origin = continue_scurve ? _scurve_next_leg.get_origin() : origin;
     _destination = destination;
     _terrain_alt = terrain_alt;
     Vector3f pos_delta = _destination - _origin;
@@ -282,8 +330,27 @@ bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vecto
         }
     }
 
+    // use the jerk limited trajectory if the corner into this leg has been started or the vehicle is stopped,
+    // otherwise the leash based controller takes over from the current target
+    if (continue_scurve) {
+        _scurve_prev_leg = _scurve_this_leg;
+        _scurve_this_leg = _scurve_next_leg;
+    } else {
+        reset_scurve();
+        if (is_positive(_wp_jerk) && (_inav.get_velocity().length() < WPNAV_WP_TRACK_SPEED_MIN)) {
+            _scurve_prev_leg.init();
+            calc_scurve_track(_scurve_this_leg, origin, destination);
+            _scurve_time_scale = 1.0f;
+            _scurve_active = true;
+        }
+    }
+    _scurve_next_leg.init();
+    _scurve_next_valid = false;
+
     // initialise intermediate point to the origin
-    _pos_control.set_pos_target(origin + Vector3f(0,0,origin_terr_offset));
+    if (!continue_scurve) {
+        _pos_control.set_pos_target(origin + Vector3f(0,0,origin_terr_offset));
+    }
     _track_desired = 0;             // target is at beginning of track
     _flags.reached_destination = false;
     _flags.fast_waypoint = false;   // default waypoint back to slow
@@ -307,7 +374,7 @@ bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vecto
 void AC_WPNav::shift_wp_origin_to_current_pos()
 {
     // return immediately if vehicle is not at the origin
-    if (_track_desired > 0.0f) {
+    if (_track_desired > 0.0f || (_scurve_active && _scurve_this_leg.started())) {
         return;
     }
 
@@ -321,6 +388,11 @@ void AC_WPNav::shift_wp_origin_to_current_pos()
     // shift origin and destination
     _origin += pos_diff;
     _destination += pos_diff;
+    if (_scurve_active) {
+        calc_scurve_track(_scurve_this_leg, _origin, _destination);
+        _scurve_next_leg.init();
+        _scurve_next_valid = false;
+    }
 
     // move pos controller target and disable feed forward
     _pos_control.set_pos_target(curr_pos);
@@ -495,6 +567,160 @@ bool AC_WPNav::advance_wp_target_along_track(float dt)
     return true;
 }
 
+/// advance_scurve_target_along_track - move target along the jerk limited trajectory from origin to destination
+///     returns false if it is unable to advance (most likely because of missing terrain data)
+bool AC_WPNav::advance_scurve_target_along_track(float dt)
+{
+    // calculate terrain adjustments
+    float terr_offset = 0.0f;
+    if (_terrain_alt && !get_terrain_offset(terr_offset)) {
+        return false;
+    }
+
+    // calculate the error between the vehicle and the previous target
+    const Vector3f &curr_pos = _inav.get_position();
+    const Vector3f &pos_target = _pos_control.get_pos_target();
+    const float track_error_z = curr_pos.z - pos_target.z;
+    _track_error_xy = norm(curr_pos.x - pos_target.x, curr_pos.y - pos_target.y);
+
+    // slow time along the trajectory as the vehicle falls behind the target, stopping it half way to the end of the leash
+    const float leash_xy = _pos_control.get_leash_xy();
+    const float leash_z = track_error_z >= 0 ? _pos_control.get_leash_up_z() : _pos_control.get_leash_down_z();
+    float time_scale = 1.0f;
+    if (is_positive(leash_xy)) {
+        time_scale = MIN(time_scale, 2.0f * (1.0f - _track_error_xy / leash_xy));
+    }
+    if (is_positive(leash_z)) {
+        time_scale = MIN(time_scale, 2.0f * (1.0f - fabsf(track_error_z) / leash_z));
+    }
+    time_scale = MAX(time_scale, 0.0f);
+
+    // change the time scale gradually so the feed forward does not jump
+    const float time_scale_change_max = WPNAV_SCURVE_TIME_SCALE_RATE * dt;
+    _scurve_time_scale += constrain_float(time_scale - _scurve_time_scale, -time_scale_change_max, time_scale_change_max);
+    const float scaled_dt = _scurve_time_scale * dt;
+
+    // move along this leg and the previous leg which is still slowing down
+    _scurve_prev_leg.advance_time(scaled_dt);
+    _scurve_this_leg.advance_time(scaled_dt);
+
+    // start the next leg while this leg slows down to blend the corner between them
+    if (_scurve_next_valid) {
+        if (_scurve_next_leg.started() ||
+            (_scurve_this_leg.time_remaining() <= MIN(_scurve_this_leg.get_accel_time(), _scurve_next_leg.get_accel_time()))) {
+            _scurve_next_leg.advance_time(scaled_dt);
+        }
+    }
+
+    // add up the target from each leg, the previous leg contributes the distance it has yet to cover
+    Vector3f target_pos, target_vel, target_accel;
+    _scurve_this_leg.get_target(target_pos, target_vel, target_accel);
+    target_pos += _scurve_this_leg.get_origin();
+    Vector3f leg_pos, leg_vel, leg_accel;
+    if (!_scurve_prev_leg.finished()) {
+        _scurve_prev_leg.get_target(leg_pos, leg_vel, leg_accel);
+        target_pos += leg_pos + _scurve_prev_leg.get_origin() - _scurve_prev_leg.get_destination();
+        target_vel += leg_vel;
+        target_accel += leg_accel;
+    }
+    const bool next_leg_started = _scurve_next_valid && _scurve_next_leg.started();
+    if (next_leg_started) {
+        _scurve_next_leg.get_target(leg_pos, leg_vel, leg_accel);
+        target_pos += leg_pos;
+        target_vel += leg_vel;
+        target_accel += leg_accel;
+    }
+    _track_desired = _scurve_this_leg.get_distance();
+
+    // scale the feed forward by the rate time is moving along the trajectory
+    target_vel *= _scurve_time_scale;
+    target_accel *= sq(_scurve_time_scale);
+
+    // convert target_pos.z to altitude above the ekf origin
+    target_pos.z += terr_offset;
+
+    // the position controller moves the target by the feed forward velocity before using it
+    _pos_control.set_pos_target(Vector3f(target_pos.x - target_vel.x * dt, target_pos.y - target_vel.y * dt, target_pos.z));
+    _pos_control.set_desired_velocity_xy(target_vel.x, target_vel.y);
+    _pos_control.set_desired_accel_xy(target_accel.x, target_accel.y);
+
+    // check if we've reached the waypoint
+    if (!_flags.reached_destination) {
+        if (next_leg_started) {
+            // the corner into the next leg has been started
+            _flags.reached_destination = true;
+        } else if (_scurve_this_leg.finished()) {
+            // "fast" waypoints are complete once the target reaches the destination
+            if (_flags.fast_waypoint) {
+                _flags.reached_destination = true;
+            } else {
+                // regular waypoints also require the copter to be within the waypoint radius
+                Vector3f dist_to_dest = (curr_pos - Vector3f(0,0,terr_offset)) - _destination;
+                if (dist_to_dest.length() <= _wp_radius_cm) {
+                    _flags.reached_destination = true;
+                }
+            }
+        }
+    }
+
+    // update the target yaw if origin and destination are at least 2m apart horizontally
+    if (_track_length_xy >= WPNAV_YAW_DIST_MIN) {
+        if (norm(target_vel.x, target_vel.y) > WPNAV_WP_TRACK_SPEED_MIN) {
+            // point along the target's velocity which turns smoothly through corners
+            set_yaw_cd(RadiansToCentiDegrees(atan2f(target_vel.y, target_vel.x)));
+        } else if (!_flags.wp_yaw_set) {
+            // point along the segment until the target is moving
+            set_yaw_cd(get_bearing_cd(_origin, _destination));
+        }
+    }
+
+    // successfully advanced along track
+    return true;
+}
+
+// calculate the jerk limited trajectory from origin to destination using the limits in the direction of travel
+void AC_WPNav::calc_scurve_track(SCurve &scurve, const Vector3f& origin, const Vector3f& destination) const
+{
+    const Vector3f pos_delta = destination - origin;
+    const float track_length = pos_delta.length();
+    if (is_zero(track_length)) {
+        scurve.calculate_track(origin, destination, 0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    // limit the speed and acceleration along the track so the horizontal and vertical limits are not exceeded
+    const float pos_delta_unit_xy = norm(pos_delta.x, pos_delta.y) / track_length;
+    const float pos_delta_unit_z = fabsf(pos_delta.z) / track_length;
+    float speed = FLT_MAX;
+    float accel = FLT_MAX;
+    if (!is_zero(pos_delta_unit_xy)) {
+        speed = _pos_control.get_max_speed_xy() / pos_delta_unit_xy;
+        accel = _wp_accel_cmss / pos_delta_unit_xy;
+    }
+    if (!is_zero(pos_delta_unit_z)) {
+        const float speed_z = (pos_delta.z >= 0.0f) ? _pos_control.get_max_speed_up() : fabsf(_pos_control.get_max_speed_down());
+        speed = MIN(speed, speed_z / pos_delta_unit_z);
+        accel = MIN(accel, _wp_accel_z_cmss / pos_delta_unit_z);
+    }
+
+    // jerk is scaled with the acceleration so the time taken to reach full acceleration is the same in all directions
+    const float jerk = _wp_jerk * 100.0f * accel / MAX(_wp_accel_cmss.get(), WPNAV_ACCELERATION_MIN);
+
+    scurve.calculate_track(origin, destination, speed, accel, jerk);
+}
+
+// stop using the jerk limited trajectory and remove its feed forward from the position controller
+void AC_WPNav::reset_scurve()
+{
+    if (_scurve_active) {
+        _pos_control.set_desired_velocity_xy(0.0f, 0.0f);
+        _pos_control.set_desired_accel_xy(0.0f, 0.0f);
+    }
+    _scurve_active = false;
+    _scurve_next_leg.init();
+    _scurve_next_valid = false;
+}
+
 /// get_wp_distance_to_destination - get horizontal distance to destination in cm
 float AC_WPNav::get_wp_distance_to_destination() const
 {
@@ -523,7 +749,8 @@ bool AC_WPNav::update_wpnav()
     _pos_control.set_max_accel_z(_wp_accel_z_cmss);
 
     // advance the target if necessary
-    if (!advance_wp_target_along_track(dt)) {
+    const bool advanced = _scurve_active ? advance_scurve_target_along_track(dt) : advance_wp_target_along_track(dt);
+    if (!advanced) {
         // To-Do: handle inability to advance along track (probably because of missing terrain data)
         ret = false;
     }
@@ -549,6 +776,14 @@ void AC_WPNav::check_wp_leash_length()
     // exit immediately if recalc is not required
     if (_flags.recalc_wp_leash) {
         calculate_wp_leash_length();
+
+        // jerk limited legs use the new speed if they have not been started
+        if (_scurve_active && !_scurve_this_leg.started() && _scurve_prev_leg.finished()) {
+            calc_scurve_track(_scurve_this_leg, _scurve_this_leg.get_origin(), _scurve_this_leg.get_destination());
+        }
+        if (_scurve_next_valid && !_scurve_next_leg.started()) {
+            calc_scurve_track(_scurve_next_leg, _scurve_next_leg.get_origin(), _scurve_next_leg.get_destination());
+        }
     }
 }
 
@@ -687,6 +922,9 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
     // mission is "active" if wpnav has been called recently and vehicle reached the previous waypoint
     bool prev_segment_exists = (_flags.reached_destination && ((AP_HAL::millis() - _wp_last_update) < 1000));
 
+    // splines do not use the jerk limited trajectory
+    reset_scurve();
+
     // get dt from pos controller
     float dt = _pos_control.get_dt();
 
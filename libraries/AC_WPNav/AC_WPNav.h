@@ -3,6 +3,7 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/SCurve.h>
 #include <AP_Common/Location.h>
 #include <AP_InertialNav/AP_InertialNav.h>     // Inertial Navigation library
 #include <AC_AttitudeControl/AC_PosControl.h>      // Position control library
@@ -34,6 +35,9 @@
 
 #define WPNAV_RANGEFINDER_FILT_Z         0.25f      // range finder distance filtered at 0.25hz
 
+#define WPNAV_JERK_DEFAULT                0.0f      // default jerk in m/s/s/s used for jerk limited trajectories, zero uses the leash based controller
+#define WPNAV_SCURVE_TIME_SCALE_RATE      2.0f      // maximum rate of change of the jerk limited trajectory's time scale per second
+
 class AC_WPNav
 {
 public:
@@ -110,7 +114,7 @@ public:
     // returns wp location using location class.
     // returns false if unable to convert from target vector to global
     // coordinates
-    bool get_wp_destination(Location& destination);
+    virtual bool get_wp_destination(Location& destination);
 
     /// set_wp_destination waypoint using position vector (distance from ekf origin in cm)
     ///     terrain_alt should be true if destination.z is a desired altitude above terrain
@@ -119,10 +123,16 @@ public:
     /// set waypoint destination using NED position vector from ekf origin in meters
     bool set_wp_destination_NED(const Vector3f& destination_NED);
 
+    /// set_wp_destination_next - set the waypoint after the current destination so the corner between them can be blended
+    ///     the jerk limited trajectory starts the next leg while slowing down for the current destination, which should be a fast waypoint
+    ///     returns false if the jerk limited trajectory is not in use or the location cannot be converted to a vector from ekf origin
+    bool set_wp_destination_next(const Location& destination);
+    bool set_wp_destination_next(const Vector3f& destination, bool terrain_alt = false);
+
     /// set_wp_origin_and_destination - set origin and destination waypoints using position vectors (distance from ekf origin in cm)
     ///     terrain_alt should be true if origin.z and destination.z are desired altitudes above terrain (false if these are alt-above-ekf-origin)
     ///     returns false on failure (likely caused by missing terrain data)
-    bool set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt = false);
+    virtual bool set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt = false);
 
     /// shift_wp_origin_to_current_pos - shifts the origin and destination so the origin starts at the current position
     ///     used to reset the position just before takeoff
@@ -135,13 +145,13 @@ public:
     void get_wp_stopping_point(Vector3f& stopping_point) const;
 
     /// get_wp_distance_to_destination - get horizontal distance to destination in cm
-    float get_wp_distance_to_destination() const;
+    virtual float get_wp_distance_to_destination() const;
 
     /// get_bearing_to_destination - get bearing to next waypoint in centi-degrees
-    int32_t get_wp_bearing_to_destination() const;
+    virtual int32_t get_wp_bearing_to_destination() const;
 
     /// reached_destination - true when we have come within RADIUS cm of the waypoint
-    bool reached_wp_destination() const { return _flags.reached_destination; }
+    virtual bool reached_wp_destination() const { return _flags.reached_destination; }
 
     // reached_wp_destination_xy - true if within RADIUS_CM of waypoint in x/y
     bool reached_wp_destination_xy() const {
@@ -152,7 +162,7 @@ public:
     void set_fast_waypoint(bool fast) { _flags.fast_waypoint = fast; }
 
     /// update_wpnav - run the wp controller - should be called at 100hz or higher
-    bool update_wpnav();
+    virtual bool update_wpnav();
 
     // check_wp_leash_length - check recalc_wp_leash flag and calls calculate_wp_leash_length() if necessary
     //  should be called after _pos_control.update_xy_controller which may have changed the position controller leash lengths
@@ -201,7 +211,7 @@ public:
     ///     stopped_at_start should be set to true if vehicle is stopped at the origin
     ///     seg_end_type should be set to stopped, straight or spline depending upon the next segment's type
     ///     next_destination should be set to the next segment's destination if the seg_end_type is SEGMENT_END_STRAIGHT or SEGMENT_END_SPLINE
-    bool set_spline_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt, bool stopped_at_start, spline_segment_end_type seg_end_type, const Vector3f& next_destination);
+    virtual bool set_spline_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt, bool stopped_at_start, spline_segment_end_type seg_end_type, const Vector3f& next_destination);
 
     /// reached_spline_destination - true when we have come within RADIUS cm of the waypoint
     bool reached_spline_destination() const { return _flags.reached_destination; }
@@ -244,6 +254,16 @@ protected:
         uint8_t wp_yaw_set              : 1;    // true if yaw target has been set
     } _flags;
 
+    /// advance_scurve_target_along_track - move target along the jerk limited trajectory from origin to destination
+    ///     returns false if it is unable to advance (most likely because of missing terrain data)
+    bool advance_scurve_target_along_track(float dt);
+
+    // calculate the jerk limited trajectory from origin to destination using the limits in the direction of travel
+    void calc_scurve_track(SCurve &scurve, const Vector3f& origin, const Vector3f& destination) const;
+
+    // stop using the jerk limited trajectory and remove its feed forward from the position controller
+    void reset_scurve();
+
     /// calc_slow_down_distance - calculates distance before waypoint that target point should begin to slow-down assuming it is traveling at full speed
     void calc_slow_down_distance(float speed_cms, float accel_cmss);
 
@@ -288,6 +308,7 @@ protected:
     AP_Float    _wp_radius_cm;          // distance from a waypoint in cm that, when crossed, indicates the wp has been reached
     AP_Float    _wp_accel_cmss;          // horizontal acceleration in cm/s/s during missions
     AP_Float    _wp_accel_z_cmss;        // vertical acceleration in cm/s/s during missions
+    AP_Float    _wp_jerk;                // jerk in m/s/s/s during missions, zero disables jerk limited trajectories
 
     // waypoint controller internal variables
     uint32_t    _wp_last_update;        // time of last update_wpnav call
@@ -313,6 +334,14 @@ protected:
     float       _spline_vel_scaler;	    //
     float       _yaw;                   // heading according to yaw
 
+    // jerk limited trajectory variables
+    bool        _scurve_active;         // true if the current straight leg follows the jerk limited trajectory
+    bool        _scurve_next_valid;     // true if the next leg has been set by set_wp_destination_next
+    SCurve      _scurve_prev_leg;       // previous leg, still slowing down while this leg speeds up through the corner
+    SCurve      _scurve_this_leg;       // leg from origin to destination
+    SCurve      _scurve_next_leg;       // next leg, started while this leg slows down to blend the corner
+    float       _scurve_time_scale;     // rate time moves along the trajectory, reduced when the vehicle falls behind the target
+
     // terrain following variables
     bool        _terrain_alt;   // true if origin and destination.z are alt-above-terrain, false if alt-above-ekf-origin
     bool        _rangefinder_available;
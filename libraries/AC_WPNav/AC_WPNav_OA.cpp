@@ -0,0 +1,146 @@
+#include <AP_HAL/AP_HAL.h>
+#include "AC_WPNav_OA.h"
+
+AC_WPNav_OA::AC_WPNav_OA(const AP_InertialNav& inav, const AP_AHRS_View& ahrs, AC_PosControl& pos_control, const AC_AttitudeControl& attitude_control) :
+    AC_WPNav(inav, ahrs, pos_control, attitude_control),
+    _oa_state(AP_OAPathPlanner::OA_NOT_REQUIRED),
+    _terrain_alt_oabak(false)
+{
+}
+
+/// set_wp_origin_and_destination - set origin and destination waypoints and abandon any path around obstacles to the previous destination
+bool AC_WPNav_OA::set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt)
+{
+    if (!AC_WPNav::set_wp_origin_and_destination(origin, destination, terrain_alt)) {
+        return false;
+    }
+    _origin_oabak = origin;
+    _destination_oabak = destination;
+    _terrain_alt_oabak = terrain_alt;
+    _oa_state = AP_OAPathPlanner::OA_NOT_REQUIRED;
+    return true;
+}
+
+/// set_spline_origin_and_destination - object avoidance is not used for spline segments
+bool AC_WPNav_OA::set_spline_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt, bool stopped_at_start, spline_segment_end_type seg_end_type, const Vector3f& next_destination)
+{
+    _oa_state = AP_OAPathPlanner::OA_NOT_REQUIRED;
+    return AC_WPNav::set_spline_origin_and_destination(origin, destination, terrain_alt, stopped_at_start, seg_end_type, next_destination);
+}
+
+// returns the destination set by the caller (i.e. not the intermediate destination used to avoid obstacles)
+bool AC_WPNav_OA::get_wp_destination(Location& destination)
+{
+    if (_oa_state == AP_OAPathPlanner::OA_NOT_REQUIRED) {
+        return AC_WPNav::get_wp_destination(destination);
+    }
+
+    if (!AP::ahrs().get_origin(destination)) {
+        return false;
+    }
+    destination.offset(_destination_oabak.x*0.01f, _destination_oabak.y*0.01f);
+    destination.alt += _destination_oabak.z;
+    return true;
+}
+
+/// get_wp_distance_to_destination - get horizontal distance to the destination set by the caller in cm
+float AC_WPNav_OA::get_wp_distance_to_destination() const
+{
+    if (_oa_state == AP_OAPathPlanner::OA_NOT_REQUIRED) {
+        return AC_WPNav::get_wp_distance_to_destination();
+    }
+
+    const Vector3f &curr = _inav.get_position();
+    return norm(_destination_oabak.x-curr.x, _destination_oabak.y-curr.y);
+}
+
+/// get_wp_bearing_to_destination - get bearing to the destination set by the caller in centi-degrees
+int32_t AC_WPNav_OA::get_wp_bearing_to_destination() const
+{
+    if (_oa_state == AP_OAPathPlanner::OA_NOT_REQUIRED) {
+        return AC_WPNav::get_wp_bearing_to_destination();
+    }
+
+    return get_bearing_cd(_inav.get_position(), _destination_oabak);
+}
+
+/// reached_wp_destination - true when we have come within RADIUS cm of the destination set by the caller
+bool AC_WPNav_OA::reached_wp_destination() const
+{
+    // intermediate destinations and stopping points are never the caller's destination
+    return (_oa_state == AP_OAPathPlanner::OA_NOT_REQUIRED) && AC_WPNav::reached_wp_destination();
+}
+
+// set an intermediate destination without forgetting the destination set by the caller
+bool AC_WPNav_OA::set_oa_destination(const Vector2f &destination_xy, bool hold_alt)
+{
+    // continue from the current position target
+    Vector3f origin = _pos_control.get_pos_target();
+    if (_terrain_alt_oabak) {
+        float origin_terr_offset;
+        if (!get_terrain_offset(origin_terr_offset)) {
+            return false;
+        }
+        origin.z -= origin_terr_offset;
+    }
+
+    const Vector3f destination(destination_xy.x, destination_xy.y, hold_alt ? origin.z : _destination_oabak.z);
+    return AC_WPNav::set_wp_origin_and_destination(origin, destination, _terrain_alt_oabak);
+}
+
+/// update_wpnav - run the wp controller - should be called at 100hz or higher
+bool AC_WPNav_OA::update_wpnav()
+{
+    // run path planning around obstacles
+    AP_OAPathPlanner *oa_ptr = AP_OAPathPlanner::get_singleton();
+    if (oa_ptr != nullptr) {
+        const Vector3f &curr_pos = _inav.get_position();
+        const Vector2f destination_xy(_destination_oabak.x, _destination_oabak.y);
+        Vector2f oa_origin_new, oa_destination_new;
+        const AP_OAPathPlanner::OA_RetState oa_retstate = oa_ptr->mission_avoidance(Vector2f(curr_pos.x, curr_pos.y),
+                                                                                    Vector2f(_origin_oabak.x, _origin_oabak.y),
+                                                                                    destination_xy,
+                                                                                    oa_origin_new,
+                                                                                    oa_destination_new);
+        switch (oa_retstate) {
+
+        case AP_OAPathPlanner::OA_NOT_REQUIRED:
+            if (_oa_state != oa_retstate) {
+                // object avoidance has become inactive so reset target to original destination
+                if (set_oa_destination(destination_xy, false)) {
+                    _oa_state = oa_retstate;
+                }
+            }
+            break;
+
+        case AP_OAPathPlanner::OA_PROCESSING:
+            // keep flying towards the current target until a path is found.  Fence and
+            // proximity avoidance keep limiting the velocity in the meantime
+            break;
+
+        case AP_OAPathPlanner::OA_ERROR:
+            // no path could be found so stop the vehicle by setting the destination to a stopping point
+            if (_oa_state != oa_retstate) {
+                Vector3f stopping_point;
+                get_wp_stopping_point_xy(stopping_point);
+                if (set_oa_destination(Vector2f(stopping_point.x, stopping_point.y), true)) {
+                    _oa_state = oa_retstate;
+                }
+            }
+            break;
+
+        case AP_OAPathPlanner::OA_SUCCESS:
+            // if oa destination has become active or changed update wpnav
+            if ((_oa_state != oa_retstate) || (oa_destination_new != _oa_destination)) {
+                if (set_oa_destination(oa_destination_new, false)) {
+                    _oa_destination = oa_destination_new;
+                    _oa_state = oa_retstate;
+                }
+            }
+            break;
+        }
+    }
+
+    // run position controller
+    return AC_WPNav::update_wpnav();
+}
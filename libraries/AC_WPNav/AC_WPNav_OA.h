@@ -0,0 +1,54 @@
+#pragma once
+
+#include <AC_WPNav/AC_WPNav.h>
+#include <AC_Avoidance/AP_OAPathPlanner.h>
+
+/*
+ * Waypoint controller which follows a path around the polygon fence
+ * and proximity obstacles found by the object avoidance path planner.
+ *
+ * The destination set by the caller is remembered while the vehicle
+ * flies to intermediate destinations along the path, and is reported
+ * by the destination, distance, bearing and reached methods.
+ */
+class AC_WPNav_OA : public AC_WPNav
+{
+public:
+
+    /// Constructor
+    AC_WPNav_OA(const AP_InertialNav& inav, const AP_AHRS_View& ahrs, AC_PosControl& pos_control, const AC_AttitudeControl& attitude_control);
+
+    /// set_wp_origin_and_destination - set origin and destination waypoints and abandon any path around obstacles to the previous destination
+    bool set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt = false) override;
+
+    /// set_spline_origin_and_destination - object avoidance is not used for spline segments
+    bool set_spline_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt, bool stopped_at_start, spline_segment_end_type seg_end_type, const Vector3f& next_destination) override;
+
+    // returns the destination set by the caller (i.e. not the intermediate destination used to avoid obstacles)
+    bool get_wp_destination(Location& destination) override;
+
+    /// get_wp_distance_to_destination - get horizontal distance to the destination set by the caller in cm
+    float get_wp_distance_to_destination() const override;
+
+    /// get_wp_bearing_to_destination - get bearing to the destination set by the caller in centi-degrees
+    int32_t get_wp_bearing_to_destination() const override;
+
+    /// reached_wp_destination - true when we have come within RADIUS cm of the destination set by the caller
+    bool reached_wp_destination() const override;
+
+    /// update_wpnav - run the wp controller - should be called at 100hz or higher
+    bool update_wpnav() override;
+
+protected:
+
+    // set an intermediate destination without forgetting the destination set by the caller
+    //   if hold_alt is true the current altitude target is kept, otherwise the altitude moves towards the caller's destination
+    bool set_oa_destination(const Vector2f &destination_xy, bool hold_alt);
+
+    // object avoidance variables
+    AP_OAPathPlanner::OA_RetState _oa_state;    // state of object avoidance, if OA_SUCCESS we are currently avoiding an object
+    Vector3f    _origin_oabak;                  // origin set by caller
+    Vector3f    _destination_oabak;             // destination set by caller
+    bool        _terrain_alt_oabak;             // true if backup origin and destination z-axis are terrain altitudes
+    Vector2f    _oa_destination;                // intermediate destination during avoidance
+};
@@ -337,6 +337,11 @@ public:
         return false;
     }
 
+    // returns the estimated NED magnetic field
+    virtual bool get_mag_field_NED(Vector3f &ret) const WARN_IF_UNUSED {
+        return false;
+    }
+
     // return a position relative to home in meters, North/East/Down
     // order. This will only be accurate if have_inertial_nav() is
     // true
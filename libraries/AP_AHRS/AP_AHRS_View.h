@@ -42,6 +42,9 @@ public:
     // return a smoothed and corrected gyro vector using the latest ins data (which may not have been consumed by the EKF yet)
     Vector3f get_gyro_latest(void) const;
 
+    // return a gyro sample from the primary IMU corrected with the given drift and rotated into this view
+    Vector3f correct_gyro(const Vector3f &gyro, const Vector3f &gyro_drift) const;
+
     // return a DCM rotation matrix representing our current attitude in this view
     const Matrix3f &get_rotation_body_to_ned(void) const {
         return rot_body_to_ned;
@@ -144,6 +147,10 @@ public:
         return ahrs.get_accel_ef_blended();
     }
 
+    const Vector3f &get_gyro_drift(void) const {
+        return ahrs.get_gyro_drift();
+    }
+
     uint32_t getLastPosNorthEastReset(Vector2f &pos) const WARN_IF_UNUSED {
         return ahrs.getLastPosNorthEastReset(pos);
     }
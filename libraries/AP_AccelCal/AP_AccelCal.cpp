@@ -107,11 +107,32 @@ void AP_AccelCal::update()
                 }
                 break;
             }
-            case ACCEL_CAL_COLLECTING_SAMPLE:
+            case ACCEL_CAL_COLLECTING_SAMPLE: {
                 // check for timeout
-
+                bool fit_pending = true;
                 for(uint8_t i=0; (cal = get_calibrator(i)); i++) {
                     cal->check_for_timeout();
+                    if (!cal->fit_pending()) {
+                        fit_pending = false;
+                    }
+                }
+
+                // once every calibrator has all its samples the fits are run together
+                if (fit_pending && !_fitting) {
+                    _fitting = true;
+                    _fit_progress = 0;
+                    if (_fit_thread_started) {
+                        _fit_requested = true;
+                    } else {
+                        run_fits();
+                    }
+                }
+                if (_fitting) {
+                    uint32_t now = AP_HAL::millis();
+                    if (now - _last_position_request_ms > AP_ACCELCAL_POSITION_REQUEST_INTERVAL_MS) {
+                        _last_position_request_ms = now;
+                        _printf("Fitting %u%%", (unsigned)_fit_progress);
+                    }
                 }
 
                 update_status();
@@ -120,6 +141,7 @@ void AP_AccelCal::update()
                     fail();
                 }
                 return;
+            }
             case ACCEL_CAL_SUCCESS:
                 // save
                 if (_saving) {
@@ -182,6 +204,12 @@ void AP_AccelCal::start(GCS_MAVLINK *gcs)
     _start_collect_sample = false;
     _num_active_calibrators = 0;
 
+    if (!_fit_thread_started) {
+        // if the thread can't be started the fits are run in update()
+        _fit_thread_started = hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_AccelCal::fit_thread, void),
+                                                           "accelcal", 4096, AP_HAL::Scheduler::PRIORITY_IO, 1);
+    }
+
     AccelCalibrator *cal;
     for(uint8_t i=0; (cal = get_calibrator(i)); i++) {
         cal->clear();
@@ -191,6 +219,7 @@ void AP_AccelCal::start(GCS_MAVLINK *gcs)
 
     _started = true;
     _saving = false;
+    _fitting = false;
     _gcs = gcs;
     _use_gcs_snoop = true;
     _last_position_request_ms = 0;
@@ -254,10 +283,51 @@ void AP_AccelCal::clear()
     _step = 0;
     _started = false;
     _saving = false;
+    _fitting = false;
 
     update_status();
 }
 
+/*
+  run the fits of all the calibrators, an iteration of each at a time
+  so they progress together and the progress can be reported
+ */
+void AP_AccelCal::run_fits()
+{
+    AccelCalibrator *cal;
+    for (uint8_t iteration=0; iteration<MAX_ITERATIONS; iteration++) {
+        bool more = false;
+        for(uint8_t i=0; (cal = get_calibrator(i)); i++) {
+            if (cal->run_fit_iteration()) {
+                more = true;
+            }
+        }
+        _fit_progress = (iteration + 1) * 100 / MAX_ITERATIONS;
+        if (!more) {
+            break;
+        }
+    }
+    for(uint8_t i=0; (cal = get_calibrator(i)); i++) {
+        cal->finish_fit();
+    }
+    _fit_progress = 100;
+}
+
+/*
+  thread to run the fits away from the main loop, a six position fit
+  of several IMUs is long enough to time out GCS links
+ */
+void AP_AccelCal::fit_thread()
+{
+    while (true) {
+        if (_fit_requested) {
+            run_fits();
+            _fit_requested = false;
+        }
+        hal.scheduler->delay(10);
+    }
+}
+
 void AP_AccelCal::collect_sample()
 {
     if (_status != ACCEL_CAL_WAITING_FOR_ORIENTATION) {
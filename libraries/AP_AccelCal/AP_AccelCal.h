@@ -71,6 +71,15 @@ private:
     bool _started;
     bool _saving;
 
+    // the fits are run together in a thread started with the first
+    // calibration once every calibrator has all its samples
+    bool _fit_thread_started;
+    bool _fitting;
+    bool _fit_requested;
+    uint8_t _fit_progress;
+    void fit_thread(void);
+    void run_fits(void);
+
     uint8_t _num_active_calibrators;
 
     AccelCalibrator* get_calibrator(uint8_t i);
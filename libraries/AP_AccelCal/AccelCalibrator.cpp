@@ -16,6 +16,7 @@
 #include "AccelCalibrator.h"
 #include <stdio.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Semaphore.h>
 
 const extern AP_HAL::HAL& hal;
 /*
@@ -56,6 +57,8 @@ void AccelCalibrator::start(enum accel_cal_fit_type_t fit_type, uint8_t num_samp
 }
 
 void AccelCalibrator::start(enum accel_cal_fit_type_t fit_type, uint8_t num_samples, float sample_time, Vector3f offset, Vector3f diag, Vector3f offdiag) {
+    WITH_SEMAPHORE(_sem);
+
     if (_status == ACCEL_CAL_FAILED || _status == ACCEL_CAL_SUCCESS) {
         clear();
     }
@@ -97,6 +100,7 @@ void AccelCalibrator::start(enum accel_cal_fit_type_t fit_type, uint8_t num_samp
 
 // set Accel calibrator status to make itself ready for future accel cals
 void AccelCalibrator::clear() {
+    WITH_SEMAPHORE(_sem);
     set_status(ACCEL_CAL_NOT_STARTED);
 }
 
@@ -112,7 +116,7 @@ void AccelCalibrator::collect_sample() {
 
 // collect and avg sample to be passed onto LSQ estimator after all requisite orientations are done
 void AccelCalibrator::new_sample(const Vector3f& delta_velocity, float dt) {
-    if (_status != ACCEL_CAL_COLLECTING_SAMPLE) {
+    if (_status != ACCEL_CAL_COLLECTING_SAMPLE || _fit_pending) {
         return;
     }
 
@@ -136,13 +140,8 @@ void AccelCalibrator::new_sample(const Vector3f& delta_velocity, float dt) {
         _samples_collected++;
 
         if (_samples_collected >= _conf_num_samples) {
-            run_fit(MAX_ITERATIONS, _fitness);
-
-            if (_fitness < _conf_tolerance && accept_result()) {
-                set_status(ACCEL_CAL_SUCCESS);
-            } else {
-                set_status(ACCEL_CAL_FAILED);
-            }
+            // the fit is run by AP_AccelCal rather than in the sensor update
+            begin_fit();
         } else {
             set_status(ACCEL_CAL_WAITING_FOR_ORIENTATION);
         }
@@ -193,8 +192,12 @@ bool AccelCalibrator::get_sample_corrected(uint8_t i, Vector3f& s) const {
 
 // checks if no new sample has been received for considerable amount of time
 void AccelCalibrator::check_for_timeout() {
+    // the fit thread may be finishing a fit
+    WITH_SEMAPHORE(_sem);
+
     const uint32_t timeout = _conf_sample_time*2*1000 + 500;
-    if (_status == ACCEL_CAL_COLLECTING_SAMPLE && AP_HAL::millis() - _last_samp_frag_collected_ms > timeout) {
+    if (_status == ACCEL_CAL_COLLECTING_SAMPLE && !_fit_pending &&
+        AP_HAL::millis() - _last_samp_frag_collected_ms > timeout) {
         set_status(ACCEL_CAL_FAILED);
     }
 }
@@ -261,6 +264,7 @@ void AccelCalibrator::set_status(enum accel_cal_status_t status) {
             //Calibrator not started
             _status = ACCEL_CAL_NOT_STARTED;
 
+            _fit_pending = false;
             _samples_collected = 0;
             if (_sample_buffer != nullptr) {
                 free(_sample_buffer);
@@ -314,6 +318,7 @@ void AccelCalibrator::set_status(enum accel_cal_status_t status) {
                 break;
             }
 
+            _fit_pending = false;
             _status = ACCEL_CAL_FAILED;
             break;
     };
@@ -322,61 +327,99 @@ void AccelCalibrator::set_status(enum accel_cal_status_t status) {
 /*
     Run Gauss Newton fitting algorithm over the sample space and come up with offsets, diagonal/scale factors
     and crosstalk/offdiagonal parameters
+
+    The fit is started when the last sample is collected and then run an
+    iteration at a time by AP_AccelCal, so the fits of several
+    calibrators can be run together away from the sensor update
 */
-void AccelCalibrator::run_fit(uint8_t max_iterations, float& fitness)
+void AccelCalibrator::begin_fit()
 {
-    if (_sample_buffer == nullptr) {
-        return;
-    }
-    fitness = calc_mean_squared_residuals(_param.s);
-    float min_fitness = fitness;
-    union param_u fit_param = _param;
-    uint8_t num_iterations = 0;
+    _fitness = calc_mean_squared_residuals(_param.s);
+    _min_fitness = _fitness;
+    _fit_param = _param;
+    _fit_iterations = 0;
+    _fit_done = false;
+    _fit_pending = true;
+}
+
+bool AccelCalibrator::run_fit_iteration()
+{
+    WITH_SEMAPHORE(_sem);
 
-    while(num_iterations < max_iterations) {
-        float JTJ[ACCEL_CAL_MAX_NUM_PARAMS*ACCEL_CAL_MAX_NUM_PARAMS] {};
-        VectorP JTFI;
+    if (!_fit_pending || _fit_done || _sample_buffer == nullptr || _fit_iterations >= MAX_ITERATIONS) {
+        return false;
+    }
+    _fit_iterations++;
 
-        for(uint16_t k = 0; k<_samples_collected; k++) {
-            Vector3f sample;
-            get_sample(k, sample);
+    const uint8_t num_params = get_num_params();
+    float JTJ[ACCEL_CAL_MAX_NUM_PARAMS*ACCEL_CAL_MAX_NUM_PARAMS] {};
+    VectorP JTFI;
 
-            VectorN<float,ACCEL_CAL_MAX_NUM_PARAMS> jacob;
+    for(uint16_t k = 0; k<_samples_collected; k++) {
+        Vector3f sample;
+        get_sample(k, sample);
 
-            calc_jacob(sample, fit_param.s, jacob);
+        VectorP jacob;
+        const float resid = calc_jacob(sample, _fit_param.s, jacob);
 
-            for(uint8_t i = 0; i < get_num_params(); i++) {
-                // compute JTJ
-                for(uint8_t j = 0; j < get_num_params(); j++) {
-                    JTJ[i*get_num_params()+j] += jacob[i] * jacob[j];
-                }
-                // compute JTFI
-                JTFI[i] += jacob[i] * calc_residual(sample, fit_param.s);
+        // JTJ is symmetric so only the upper triangle is accumulated
+        for(uint8_t i = 0; i < num_params; i++) {
+            for(uint8_t j = i; j < num_params; j++) {
+                JTJ[i*num_params+j] += jacob[i] * jacob[j];
             }
+            JTFI[i] += jacob[i] * resid;
         }
-
-        if (!inverse(JTJ, JTJ, get_num_params())) {
-            return;
+    }
+    for(uint8_t i = 1; i < num_params; i++) {
+        for(uint8_t j = 0; j < i; j++) {
+            JTJ[i*num_params+j] = JTJ[j*num_params+i];
         }
+    }
 
-        for(uint8_t row=0; row < get_num_params(); row++) {
-            for(uint8_t col=0; col < get_num_params(); col++) {
-                fit_param.a[row] -= JTFI[col] * JTJ[row*get_num_params()+col];
-            }
+    if (!inverse(JTJ, JTJ, num_params)) {
+        _fit_done = true;
+        return false;
+    }
+
+    float max_step = 0.0f;
+    for(uint8_t row=0; row < num_params; row++) {
+        float step = 0.0f;
+        for(uint8_t col=0; col < num_params; col++) {
+            step += JTFI[col] * JTJ[row*num_params+col];
         }
+        _fit_param.a[row] -= step;
+        max_step = MAX(max_step, fabsf(step));
+    }
 
-        fitness = calc_mean_squared_residuals(fit_param.s);
+    _fitness = calc_mean_squared_residuals(_fit_param.s);
 
-        if (isnan(fitness) || isinf(fitness)) {
-            return;
-        }
+    if (isnan(_fitness) || isinf(_fitness)) {
+        _fit_done = true;
+        return false;
+    }
 
-        if (fitness < min_fitness) {
-            min_fitness = fitness;
-            _param = fit_param;
-        }
+    if (_fitness < _min_fitness) {
+        _min_fitness = _fitness;
+        _param = _fit_param;
+    }
+
+    _fit_done = _fit_iterations >= MAX_ITERATIONS || max_step <= ACCEL_CAL_MIN_STEP;
+    return !_fit_done;
+}
 
-        num_iterations++;
+void AccelCalibrator::finish_fit()
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (!_fit_pending) {
+        return;
+    }
+    _fit_pending = false;
+
+    if (_fitness < _conf_tolerance && accept_result()) {
+        set_status(ACCEL_CAL_SUCCESS);
+    } else {
+        set_status(ACCEL_CAL_FAILED);
     }
 }
 
@@ -418,37 +461,37 @@ float AccelCalibrator::calc_mean_squared_residuals(const struct param_t& params)
 
 // calculate jacobian, a matrix that defines relation to variation in fitness with variation in each of the parameters
 // this is used in LSq estimator to adjust variation in parameter to be used for next iteration of LSq
-void AccelCalibrator::calc_jacob(const Vector3f& sample, const struct param_t& params, VectorP &ret) const {
+// the residual shares the corrected sample and its length with the jacobian so is returned with it
+float AccelCalibrator::calc_jacob(const Vector3f& sample, const struct param_t& params, VectorP &ret) const {
     switch (_conf_fit_type) {
         case ACCEL_CAL_AXIS_ALIGNED_ELLIPSOID:
-        case ACCEL_CAL_ELLIPSOID: {
-            const Vector3f &offset = params.offset;
+        case ACCEL_CAL_ELLIPSOID:
+        default: {
             const Vector3f &diag = params.diag;
             const Vector3f &offdiag = params.offdiag;
-            Matrix3f M(
-                diag.x    , offdiag.x , offdiag.y,
-                offdiag.x , diag.y    , offdiag.z,
-                offdiag.y , offdiag.z , diag.z
-            );
+            const Vector3f s = sample + params.offset;
 
-            float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-            float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-            float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-            float length = (M*(sample+offset)).length();
+            // (A, B, C) is the corrected sample, M*(sample+offset)
+            const float A =  (diag.x    * s.x) + (offdiag.x * s.y) + (offdiag.y * s.z);
+            const float B =  (offdiag.x * s.x) + (diag.y    * s.y) + (offdiag.z * s.z);
+            const float C =  (offdiag.y * s.x) + (offdiag.z * s.y) + (diag.z    * s.z);
+            const float length = norm(A, B, C);
+            const float inv_length = 1.0f / length;
 
             // 0-2: offsets
-            ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-            ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-            ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+            ret[0] = -1.0f * ((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C)) * inv_length;
+            ret[1] = -1.0f * ((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C)) * inv_length;
+            ret[2] = -1.0f * ((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C)) * inv_length;
             // 3-5: diagonals
-            ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-            ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-            ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
+            ret[3] = -1.0f * (s.x * A) * inv_length;
+            ret[4] = -1.0f * (s.y * B) * inv_length;
+            ret[5] = -1.0f * (s.z * C) * inv_length;
             // 6-8: off-diagonals
-            ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-            ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-            ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
-            return;
+            ret[6] = -1.0f * ((s.y * A) + (s.x * B)) * inv_length;
+            ret[7] = -1.0f * ((s.z * A) + (s.x * C)) * inv_length;
+            ret[8] = -1.0f * ((s.z * B) + (s.y * C)) * inv_length;
+
+            return GRAVITY_MSS - length;
         }
     };
 }
@@ -12,12 +12,14 @@
 */
 #pragma once
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
 
 #define ACCEL_CAL_MAX_NUM_PARAMS 9
 #define ACCEL_CAL_TOLERANCE 0.1
 #define MAX_ITERATIONS  50
+#define ACCEL_CAL_MIN_STEP 1.0e-6f   // fit stops early once no parameter changes by more than this
 enum accel_cal_status_t {
     ACCEL_CAL_NOT_STARTED=0,
     ACCEL_CAL_WAITING_FOR_ORIENTATION=1,
@@ -80,6 +82,16 @@ public:
     // returns mean squared fitness of sample points to the selected surface
     float get_fitness() const { return _fitness; }
 
+    // returns true once all samples are collected and the fit is waiting to be run
+    bool fit_pending() const { return _fit_pending; }
+
+    // run one iteration of a pending fit, returns true if more iterations are needed.
+    // This may be called from a different thread to the rest of the interface
+    bool run_fit_iteration();
+
+    // complete a pending fit, setting the status to success or failure
+    void finish_fit();
+
     struct param_t {
         Vector3f offset;
         Vector3f diag;
@@ -119,6 +131,14 @@ private:
     uint32_t _last_samp_frag_collected_ms;
     float _min_sample_dist;
 
+    // fit state, protects the sample buffer and parameters from the thread running the fit
+    HAL_Semaphore _sem;
+    bool _fit_pending;
+    bool _fit_done;             // true once the fit has converged or failed and no more iterations should be run
+    uint8_t _fit_iterations;
+    union param_u _fit_param;
+    float _min_fitness;
+
     // private methods
     // check sanity of including the sample and add it to buffer if test is passed
     bool accept_sample(const Vector3f& sample);
@@ -139,6 +159,9 @@ private:
     float calc_residual(const Vector3f& sample, const struct param_t& params) const;
     float calc_mean_squared_residuals() const;
     float calc_mean_squared_residuals(const struct param_t& params) const;
-    void calc_jacob(const Vector3f& sample, const struct param_t& params, VectorP& ret) const;
-    void run_fit(uint8_t max_iterations, float& fitness);
+    // calculates the jacobian of the residual for a sample, returns the residual
+    float calc_jacob(const Vector3f& sample, const struct param_t& params, VectorP& ret) const;
+
+    // starts the fit once all the samples are collected
+    void begin_fit();
 };
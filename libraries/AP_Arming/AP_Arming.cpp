@@ -24,6 +24,7 @@
 #include <AP_Rally/AP_Rally.h>
 #include <SRV_Channel/SRV_Channel.h>
 #include <AC_Fence/AC_Fence.h>
+#include <AP_Logger/AP_Logger.h>
 
 #if HAL_WITH_UAVCAN
   #include <AP_BoardConfig/AP_BoardConfig_CAN.h>
@@ -152,16 +153,131 @@ MAV_SEVERITY AP_Arming::check_severity(const enum AP_Arming::ArmingChecks check)
 
 void AP_Arming::check_failed(const enum AP_Arming::ArmingChecks check, bool report, const char *fmt, ...) const
 {
-    if (!report) {
+    if (!report && _capture == nullptr) {
         return;
     }
     char taggedfmt[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1];
     hal.util->snprintf(taggedfmt, sizeof(taggedfmt), "PreArm: %s", fmt);
     MAV_SEVERITY severity = check_severity(check);
     va_list arg_list;
-    va_start(arg_list, fmt);
-    gcs().send_textv(severity, taggedfmt, arg_list);
-    va_end(arg_list);
+    if (_capture != nullptr && _capture->num_msgs < AP_ARMING_CACHED_MSGS) {
+        // keep the failure to report while the result is cached
+        va_start(arg_list, fmt);
+        hal.util->vsnprintf(_capture->msgs[_capture->num_msgs], sizeof(_capture->msgs[0]), taggedfmt, arg_list);
+        va_end(arg_list);
+        _capture->severity[_capture->num_msgs++] = severity;
+    }
+    if (report) {
+        va_start(arg_list, fmt);
+        gcs().send_textv(severity, taggedfmt, arg_list);
+        va_end(arg_list);
+    }
+}
+
+/*
+  find the recorded state of a pre-arm check by name, allocating it
+  on first use
+ */
+AP_Arming::CheckState *AP_Arming::find_check(const char *name, uint8_t inputs)
+{
+    for (uint8_t i=0; i<_num_checks; i++) {
+        if (_checks[i].name == name || strcmp(_checks[i].name, name) == 0) {
+            return &_checks[i];
+        }
+    }
+    if (_num_checks >= AP_ARMING_MAX_CHECKS) {
+        return nullptr;
+    }
+    CheckState &state = _checks[_num_checks++];
+    state.name = name;
+    state.cache_slot = -1;
+    if (inputs != CHECK_INPUT_LIVE && _num_cached < AP_ARMING_MAX_CACHED_CHECKS) {
+        state.cache_slot = _num_cached++;
+    }
+    return &state;
+}
+
+/*
+  a cached result is valid until one of the check's inputs changes. It
+  is also re-run periodically to catch parameters changed without
+  going through AP_Param::set_float() or save()
+ */
+bool AP_Arming::cache_valid(const CachedResult &cache, const uint8_t inputs, const uint32_t now_ms) const
+{
+    if (!cache.valid || now_ms - cache.run_ms > AP_ARMING_CACHE_TIMEOUT_MS) {
+        return false;
+    }
+    if ((inputs & CHECK_INPUT_PARAMETERS) && cache.param_changes != AP_Param::change_count()) {
+        return false;
+    }
+    const AP_Mission *mission = AP::mission();
+    if ((inputs & CHECK_INPUT_MISSION) && mission != nullptr &&
+        cache.mission_change_ms != mission->last_change_time_ms()) {
+        return false;
+    }
+    return true;
+}
+
+bool AP_Arming::run_check(const char *name, check_fn_t fn, bool report, uint8_t inputs)
+{
+    CheckState *state = find_check(name, inputs);
+    if (state == nullptr) {
+        return fn(report);
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    CachedResult *cache = state->cache_slot >= 0 ? &_cache[state->cache_slot] : nullptr;
+    if (cache != nullptr && cache_valid(*cache, inputs, now_ms)) {
+        state->cached = true;
+        if (report) {
+            for (uint8_t i=0; i<cache->num_msgs; i++) {
+                gcs().send_text((MAV_SEVERITY)cache->severity[i], "%s", cache->msgs[i]);
+            }
+        }
+    } else {
+        if (cache != nullptr) {
+            // note the inputs before running so a change while the
+            // check runs causes it to be run again
+            cache->param_changes = AP_Param::change_count();
+            const AP_Mission *mission = AP::mission();
+            cache->mission_change_ms = mission != nullptr ? mission->last_change_time_ms() : 0;
+            cache->num_msgs = 0;
+            _capture = cache;
+        }
+        const uint32_t start_us = AP_HAL::micros();
+        state->passed = fn(report);
+        const uint32_t time_us = AP_HAL::micros() - start_us;
+        _capture = nullptr;
+
+        state->cached = false;
+        state->time_us = MIN(time_us, UINT16_MAX);
+        state->max_time_us = MAX(state->max_time_us, state->time_us);
+        if (cache != nullptr) {
+            cache->run_ms = now_ms;
+            cache->valid = true;
+        }
+    }
+
+    // log the checks when they are reported, which is when arming or
+    // periodically while disarmed
+    if (report) {
+        log_check(*state);
+    }
+    return state->passed;
+}
+
+void AP_Arming::log_check(const CheckState &state) const
+{
+    // the logger copies all 16 bytes of a name field
+    char name[16] {};
+    strncpy(name, state.name, sizeof(name));
+    AP::logger().Write("ARMC", "TimeUS,Name,Pass,Cached,Time,MaxTime", "QNBBHH",
+                       AP_HAL::micros64(),
+                       name,
+                       state.passed,
+                       state.cached,
+                       state.time_us,
+                       state.max_time_us);
 }
 
 bool AP_Arming::barometer_checks(bool report)
@@ -562,32 +678,51 @@ bool AP_Arming::mission_checks(bool report)
           {MIS_ITEM_CHECK_TAKEOFF,       MAV_CMD_NAV_TAKEOFF,        "takeoff"},
           {MIS_ITEM_CHECK_VTOL_TAKEOFF,  MAV_CMD_NAV_VTOL_TAKEOFF,   "vtol takeoff"},
         };
+        bool ret = true;
         for (uint8_t i = 0; i < ARRAY_SIZE(misChecks); i++) {
             if (_required_mission_items & misChecks[i].check) {
                 if (!mission->contains_item(misChecks[i].mis_item_type)) {
                     check_failed(ARMING_CHECK_MISSION, report, "Missing mission item: %s", misChecks[i].type);
-                    return false;
+                    ret = false;
                 }
             }
         }
-        if (_required_mission_items & MIS_ITEM_CHECK_RALLY) {
-            Location ahrs_loc;
-            if (!AP::ahrs().get_position(ahrs_loc)) {
-                check_failed(ARMING_CHECK_MISSION, report, "Can't check rally without position");
-                return false;
-            }
-            RallyLocation rally_loc = {};
-            if (!rally->find_nearest_rally_point(ahrs_loc, rally_loc)) {
-                check_failed(ARMING_CHECK_MISSION, report, "No sufficently close rally point located");
-                return false;
-            }
-          }
+        return ret;
+    }
+
+    return true;
+}
+
+/*
+  check there is a rally point close to the vehicle. This depends on
+  the vehicle position so is kept apart from the mission checks, which
+  only depend on the mission and parameters
+ */
+bool AP_Arming::rally_checks(bool report)
+{
+    if (((checks_to_perform & ARMING_CHECK_ALL) || (checks_to_perform & ARMING_CHECK_MISSION)) &&
+        (_required_mission_items & MIS_ITEM_CHECK_RALLY)) {
+        AP_Rally *rally = AP::rally();
+        if (rally == nullptr) {
+            // reported by mission_checks()
+            return false;
+        }
+        Location ahrs_loc;
+        if (!AP::ahrs().get_position(ahrs_loc)) {
+            check_failed(ARMING_CHECK_MISSION, report, "Can't check rally without position");
+            return false;
+        }
+        RallyLocation rally_loc = {};
+        if (!rally->find_nearest_rally_point(ahrs_loc, rally_loc)) {
+            check_failed(ARMING_CHECK_MISSION, report, "No sufficently close rally point located");
+            return false;
+        }
     }
 
     return true;
 }
 
-bool AP_Arming::servo_checks(bool report) const
+bool AP_Arming::servo_checks(bool report)
 {
     bool check_passed = true;
     for (uint8_t i = 0; i < NUM_SERVO_CHANNELS; i++) {
@@ -730,19 +865,22 @@ bool AP_Arming::pre_arm_checks(bool report)
     }
 #endif
 
-    return hardware_safety_check(report)
-        &  barometer_checks(report)
-        &  ins_checks(report)
-        &  compass_checks(report)
-        &  gps_checks(report)
-        &  battery_checks(report)
-        &  logging_checks(report)
-        &  manual_transmitter_checks(report)
-        &  mission_checks(report)
-        &  servo_checks(report)
-        &  board_voltage_checks(report)
-        &  system_checks(report)
-        &  can_checks(report);
+    // all checks are run so that every failure is reported
+    return run_check("Safety", FUNCTOR_BIND_MEMBER(&AP_Arming::hardware_safety_check, bool, bool), report)
+        &  run_check("Baro", FUNCTOR_BIND_MEMBER(&AP_Arming::barometer_checks, bool, bool), report)
+        &  run_check("INS", FUNCTOR_BIND_MEMBER(&AP_Arming::ins_checks, bool, bool), report)
+        &  run_check("Compass", FUNCTOR_BIND_MEMBER(&AP_Arming::compass_checks, bool, bool), report)
+        &  run_check("GPS", FUNCTOR_BIND_MEMBER(&AP_Arming::gps_checks, bool, bool), report)
+        &  run_check("Battery", FUNCTOR_BIND_MEMBER(&AP_Arming::battery_checks, bool, bool), report)
+        &  run_check("Logging", FUNCTOR_BIND_MEMBER(&AP_Arming::logging_checks, bool, bool), report)
+        &  run_check("RC", FUNCTOR_BIND_MEMBER(&AP_Arming::manual_transmitter_checks, bool, bool), report)
+        &  run_check("Mission", FUNCTOR_BIND_MEMBER(&AP_Arming::mission_checks, bool, bool), report,
+                     CHECK_INPUT_PARAMETERS | CHECK_INPUT_MISSION)
+        &  run_check("Rally", FUNCTOR_BIND_MEMBER(&AP_Arming::rally_checks, bool, bool), report)
+        &  run_check("Servo", FUNCTOR_BIND_MEMBER(&AP_Arming::servo_checks, bool, bool), report)
+        &  run_check("BoardVoltage", FUNCTOR_BIND_MEMBER(&AP_Arming::board_voltage_checks, bool, bool), report)
+        &  run_check("System", FUNCTOR_BIND_MEMBER(&AP_Arming::system_checks, bool, bool), report)
+        &  run_check("CAN", FUNCTOR_BIND_MEMBER(&AP_Arming::can_checks, bool, bool), report);
 }
 
 bool AP_Arming::arm_checks(AP_Arming::Method method)
@@ -5,6 +5,11 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <RC_Channel/RC_Channel.h>
 
+#define AP_ARMING_MAX_CHECKS            24      // pre-arm checks whose results and timing are recorded
+#define AP_ARMING_MAX_CACHED_CHECKS     4       // pre-arm checks whose results can be cached
+#define AP_ARMING_CACHED_MSGS           3       // failure messages kept for each cached check
+#define AP_ARMING_CACHE_TIMEOUT_MS      10000   // cached results are re-run at least this often
+
 class AP_Arming {
 public:
 
@@ -115,13 +120,15 @@ protected:
 
     bool mission_checks(bool report);
 
+    bool rally_checks(bool report);
+
     bool fence_checks(bool report);
 
     virtual bool system_checks(bool report);
 
     bool can_checks(bool report);
     
-    bool servo_checks(bool report) const;
+    bool servo_checks(bool report);
     bool rc_checks_copter_sub(bool display_failure, const RC_Channel *channels[4]) const;
 
     // returns true if a particular check is enabled
@@ -131,11 +138,54 @@ protected:
     // handle the case where a check fails
     void check_failed(const enum AP_Arming::ArmingChecks check, bool report, const char *fmt, ...) const;
 
+    // inputs other than the live vehicle state that a pre-arm check
+    // depends on
+    enum CheckInputs {
+        CHECK_INPUT_LIVE        = 0,        // re-run every time
+        CHECK_INPUT_PARAMETERS  = (1U<<0),
+        CHECK_INPUT_MISSION     = (1U<<1),
+    };
+
+    FUNCTOR_TYPEDEF(check_fn_t, bool, bool);
+
+    // run a pre-arm check, recording its result and run time. A check
+    // that only depends on the given inputs is re-run when one of them
+    // changes, otherwise its last failures are reported again
+    bool run_check(const char *name, check_fn_t fn, bool report, uint8_t inputs=CHECK_INPUT_LIVE);
+
 private:
 
     bool ins_accels_consistent(const AP_InertialSensor &ins);
     bool ins_gyros_consistent(const AP_InertialSensor &ins);
 
+    struct CachedResult {
+        bool valid;
+        uint32_t run_ms;
+        uint32_t param_changes;
+        uint32_t mission_change_ms;
+        uint8_t num_msgs;
+        uint8_t severity[AP_ARMING_CACHED_MSGS];
+        char msgs[AP_ARMING_CACHED_MSGS][MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1];
+    } _cache[AP_ARMING_MAX_CACHED_CHECKS];
+    uint8_t _num_cached;
+
+    struct CheckState {
+        const char *name;
+        int8_t cache_slot;          // index into _cache, -1 if not cached
+        bool passed;
+        bool cached;                // last result came from the cache
+        uint16_t time_us;           // run time when last run
+        uint16_t max_time_us;
+    } _checks[AP_ARMING_MAX_CHECKS];
+    uint8_t _num_checks;
+
+    // cached result collecting the failures of the check being run
+    mutable CachedResult *_capture;
+
+    CheckState *find_check(const char *name, uint8_t inputs);
+    bool cache_valid(const CachedResult &cache, uint8_t inputs, uint32_t now_ms) const;
+    void log_check(const CheckState &state) const;
+
     enum MIS_ITEM_CHECK {
         MIS_ITEM_CHECK_LAND          = (1 << 0),
         MIS_ITEM_CHECK_VTOL_LAND     = (1 << 1),
@@ -30,7 +30,7 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_SerialManager/AP_SerialManager.h>
-#include <AP_Logger/AP_Logger.h>
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -74,7 +74,7 @@ const AP_Param::GroupInfo AP_BLHeli::var_info[] = {
 
     // @Param: TRATE
     // @DisplayName: BLHeli telemetry rate
-    // @Description: This sets the rate in Hz for requesting telemetry from ESCs. It is the rate per ESC. Setting to zero disables telemetry requests
+    // @Description: This sets the maximum rate in Hz for requesting telemetry from ESCs. It is the rate per ESC. Each ESC is asked as soon as the previous one has replied, so if this is higher than the ESCs can reply telemetry is requested as fast as possible. Setting to zero disables telemetry requests
     // @Units: Hz
     // @Range: 0 500
     // @User: Standard
@@ -1272,28 +1272,21 @@ void AP_BLHeli::update(void)
     motor_mask = mask;
     debug("ESC: %u motors mask=0x%04x", num_motors, mask);
 
-    if (telem_rate > 0) {
+    if (telem_rate > 0 && num_motors > 0) {
         AP_SerialManager *serial_manager = AP_SerialManager::get_singleton();
         if (serial_manager) {
             telem_uart = serial_manager->find_serial(AP_SerialManager::SerialProtocol_ESCTelemetry,0);
         }
+        if (telem_uart != nullptr &&
+            !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_BLHeli::telem_thread, void),
+                                          "blhtelem", 1024, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+            debug("Failed to start telemetry thread");
+            telem_uart = nullptr;
+        }
     }
 
 }
 
-// get the most recent telemetry data packet for a motor
-bool AP_BLHeli::get_telem_data(uint8_t esc_index, struct telem_data &td)
-{
-    if (esc_index >= max_motors) {
-        return false;
-    }
-    if (last_telem[esc_index].timestamp_ms == 0) {
-        return false;
-    }
-    td = last_telem[esc_index];
-    return true;
-}
-
 /*
   implement the 8 bit CRC used by the BLHeli ESC telemetry protocol
  */
@@ -1310,20 +1303,12 @@ uint8_t AP_BLHeli::telem_crc8(uint8_t crc, uint8_t crc_seed) const
 }
 
 /*
-  read an ESC telemetry packet
+  parse an ESC telemetry packet from the packet buffer
  */
 void AP_BLHeli::read_telemetry_packet(void)
 {
-    uint8_t buf[telem_packet_size];
+    const uint8_t *buf = telem_buf;
     uint8_t crc = 0;
-    for (uint8_t i=0; i<telem_packet_size; i++) {
-        int16_t v = telem_uart->read();
-        if (v < 0) {
-            // short read, we should have 10 bytes ready when this function is called
-            return;
-        }
-        buf[i] = uint8_t(v);
-    }
 
     // calculate crc
     for (uint8_t i=0; i<telem_packet_size-1; i++) {    
@@ -1333,144 +1318,120 @@ void AP_BLHeli::read_telemetry_packet(void)
     if (buf[telem_packet_size-1] != crc) {
         // bad crc
         debug("Bad CRC on %u\n", last_telem_esc);
+        telem_errors[last_telem_esc]++;
         return;
     }
-    struct telem_data td;
+    AP_ESC_Telem::TelemetryData td {};
     td.temperature = buf[0];
-    td.voltage = (buf[1]<<8) | buf[2];
-    td.current = (buf[3]<<8) | buf[4];
-    td.consumption = (buf[5]<<8) | buf[6];
-    td.rpm = ((buf[7]<<8) | buf[8]) * motor_poles;
-    td.timestamp_ms = AP_HAL::millis();
-
-    last_telem[last_telem_esc] = td;
-    last_telem[last_telem_esc].count++;
-
-    AP_Logger *df = AP_Logger::get_singleton();
-    if (df && df->logging_enabled()) {
-        df->Write_ESC(uint8_t(last_telem_esc),
-                      AP_HAL::micros64(),
-                      td.rpm*100U,
-                      td.voltage,
-                      td.current,
-                      td.temperature * 100U,
-                      td.consumption);
+    td.voltage = ((buf[1]<<8) | buf[2]) * 0.01f;
+    td.current = ((buf[3]<<8) | buf[4]) * 0.01f;
+    td.consumption_mah = (buf[5]<<8) | buf[6];
+    // the ESC reports eRPM/100, convert to mechanical RPM
+    td.rpm = ((buf[7]<<8) | buf[8]) * 200.0f / MAX(motor_poles.get(), 2);
+    td.error_count = telem_errors[last_telem_esc];
+
+    AP_ESC_Telem *esc_telem = AP::esc_telem();
+    if (esc_telem != nullptr) {
+        esc_telem->update_telemetry(last_telem_esc, td,
+                                    AP_ESC_Telem::TELEM_TEMPERATURE |
+                                    AP_ESC_Telem::TELEM_VOLTAGE |
+                                    AP_ESC_Telem::TELEM_CURRENT |
+                                    AP_ESC_Telem::TELEM_CONSUMPTION |
+                                    AP_ESC_Telem::TELEM_RPM);
     }
     if (debug_level >= 2) {
+        // integer formats keep the telemetry thread's stack small, V and C are in hundredths
         hal.console->printf("ESC[%u] T=%u V=%u C=%u con=%u RPM=%u t=%u\n",
                             last_telem_esc,
-                            td.temperature,
-                            td.voltage,
-                            td.current,
-                            td.consumption,
-                            td.rpm, (unsigned)AP_HAL::millis());
+                            buf[0],
+                            (buf[1]<<8) | buf[2],
+                            (buf[3]<<8) | buf[4],
+                            (buf[5]<<8) | buf[6],
+                            (unsigned)td.rpm, (unsigned)AP_HAL::millis());
+    }
+}
+
+/*
+  thread for BLHeli telemetry, started when a telemetry port is
+  configured. Running the telemetry off the main loop lets us request
+  the next ESC as soon as the last one has replied
+ */
+void AP_BLHeli::telem_thread(void)
+{
+    // we need to use begin() here to ensure the correct thread owns the uart
+    telem_uart->begin(115200);
+
+    while (true) {
+        if (telem_rate.get() <= 0) {
+            // telemetry has been disabled since the thread was started
+            hal.scheduler->delay(telem_idle_ms);
+            continue;
+        }
+        hal.scheduler->delay_microseconds(telem_poll_us);
+        update_telemetry();
     }
 }
 
 /*
   update BLHeli telemetry handling
-  This is called on push() in SRV_Channels
+
+  Only one ESC can reply at a time on the shared telemetry wire, so we
+  keep a single request outstanding and ask the next ESC as soon as
+  the reply arrives or times out. TRATE caps the rate per ESC; when it
+  is higher than the ESCs can reply the port is kept saturated
  */
 void AP_BLHeli::update_telemetry(void)
 {
-    if (!telem_uart) {
-        return;
-    }
-    uint32_t now = AP_HAL::micros();
-    uint32_t telem_rate_us = 1000000U / uint32_t(telem_rate.get() * num_motors);
-    if (telem_rate_us < 2000) {
-        // make sure we have a gap between frames
-        telem_rate_us = 2000;
-    }
-    if (!telem_uart_started) {
-        // we need to use begin() here to ensure the correct thread owns the uart
-        telem_uart->begin(115200);
-        telem_uart_started = true;
-    }
+    const uint32_t now = AP_HAL::micros();
 
     uint32_t nbytes = telem_uart->available();
-
-    if (nbytes > telem_packet_size) {
-        // if we have more than 10 bytes then we don't know which ESC
-        // they are from. Throw them all away
-        while (nbytes--) {
-            telem_uart->read();
-        }
-        return;
-    }
-    if (nbytes > 0 &&
-        nbytes < telem_packet_size &&
-        (last_telem_byte_read_us == 0 ||
-         now - last_telem_byte_read_us < 1000)) {
-        // wait a bit longer, we don't have enough bytes yet
-        if (last_telem_byte_read_us == 0) {
+    if (nbytes > 0) {
+        if (telem_buf_len + nbytes > telem_packet_size) {
+            // if we have more than 10 bytes then we don't know which ESC
+            // they are from. Throw them all away
+            while (nbytes--) {
+                telem_uart->read();
+            }
+            telem_buf_len = 0;
+            telem_errors[last_telem_esc]++;
+            telem_pending = false;
+        } else {
+            while (nbytes--) {
+                telem_buf[telem_buf_len++] = uint8_t(telem_uart->read());
+            }
             last_telem_byte_read_us = now;
         }
-        return;
     }
-    if (nbytes > 0 && nbytes < telem_packet_size) {
-        // we've waited long enough, discard bytes if we don't have 10 yet
-        while (nbytes--) {
-            telem_uart->read();
-        }
-        return;
-    }
-    if (nbytes == telem_packet_size) {
+
+    if (telem_buf_len == telem_packet_size) {
         // we have a full packet ready to parse
         read_telemetry_packet();
-        last_telem_byte_read_us = 0;
+        telem_buf_len = 0;
+        telem_pending = false;
+    } else if (telem_buf_len > 0 && now - last_telem_byte_read_us >= telem_byte_timeout_us) {
+        // we've waited long enough, discard bytes if we don't have 10 yet
+        telem_buf_len = 0;
+        telem_errors[last_telem_esc]++;
+        telem_pending = false;
+    }
+
+    if (telem_pending && telem_buf_len == 0 && now - last_telem_request_us >= telem_reply_timeout_us) {
+        // the ESC didn't reply, move on to the next one
+        telem_errors[last_telem_esc]++;
+        telem_pending = false;
     }
-    if (now - last_telem_request_us >= telem_rate_us) {
+
+    if (telem_rate.get() <= 0) {
+        return;
+    }
+    const uint32_t telem_rate_us = 1000000U / uint32_t(telem_rate.get() * num_motors);
+    if (!telem_pending && now - last_telem_request_us >= telem_rate_us) {
         // ask the next ESC for telemetry
         last_telem_esc = (last_telem_esc + 1) % num_motors;
         uint16_t mask = 1U << motor_map[last_telem_esc];
         hal.rcout->set_telem_request_mask(mask);
         last_telem_request_us = now;
-    }
-}
-
-/*
-  send ESC telemetry messages over MAVLink
- */
-void AP_BLHeli::send_esc_telemetry_mavlink(uint8_t mav_chan)
-{
-    if (num_motors == 0) {
-        return;
-    }
-    uint8_t temperature[4] {};
-    uint16_t voltage[4] {};
-    uint16_t current[4] {};
-    uint16_t totalcurrent[4] {};
-    uint16_t rpm[4] {};
-    uint16_t count[4] {};
-    uint32_t now = AP_HAL::millis();
-    for (uint8_t i=0; i<num_motors; i++) {
-        uint8_t idx = i % 4;
-        if (last_telem[i].timestamp_ms && (now - last_telem[i].timestamp_ms < 1000)) {
-            temperature[idx]  = last_telem[i].temperature;
-            voltage[idx]      = last_telem[i].voltage;
-            current[idx]      = last_telem[i].current;
-            totalcurrent[idx] = last_telem[i].consumption;
-            rpm[idx]          = last_telem[i].rpm;
-            count[idx]        = last_telem[i].count;
-        } else {
-            temperature[idx] = 0;
-            voltage[idx] = 0;
-            current[idx] = 0;
-            totalcurrent[idx] = 0;
-            rpm[idx] = 0;
-            count[idx] = 0;
-        }
-        if (i % 4 == 3 || i == num_motors - 1) {
-            if (!HAVE_PAYLOAD_SPACE((mavlink_channel_t)mav_chan, ESC_TELEMETRY_1_TO_4)) {
-                return;
-            }
-            if (i < 4) {
-                mavlink_msg_esc_telemetry_1_to_4_send((mavlink_channel_t)mav_chan, temperature, voltage, current, totalcurrent, rpm, count);
-            } else {
-                mavlink_msg_esc_telemetry_5_to_8_send((mavlink_channel_t)mav_chan, temperature, voltage, current, totalcurrent, rpm, count);
-            }
-        }
+        telem_pending = true;
     }
 }
 
@@ -40,30 +40,13 @@ public:
     AP_BLHeli();
     
     void update(void);
-    void update_telemetry(void);
     bool process_input(uint8_t b);
 
     static const struct AP_Param::GroupInfo var_info[];
 
-    struct telem_data {
-        uint8_t temperature; // degrees C
-        uint16_t voltage;    // volts * 100
-        uint16_t current;    // amps * 100
-        uint16_t consumption;// mAh
-        uint16_t rpm;        // eRPM
-        uint16_t count;
-        uint32_t timestamp_ms;
-    };
-
-    // get the most recent telemetry data packet for a motor
-    bool get_telem_data(uint8_t esc_index, struct telem_data &td);
-
     static AP_BLHeli *get_singleton(void) {
         return _singleton;
     }
-
-    // send ESC telemetry messages over MAVLink
-    void send_esc_telemetry_mavlink(uint8_t mav_chan);
     
 private:
     static AP_BLHeli *_singleton;
@@ -220,8 +203,6 @@ private:
     static const uint8_t max_motors = AP_BLHELI_MAX_ESCS;
     uint8_t num_motors;
 
-    struct telem_data last_telem[max_motors];
-
     // have we initialised the interface?
     bool initialised;
 
@@ -245,8 +226,29 @@ private:
     uint32_t last_telem_request_us;
     uint8_t last_telem_esc;
     static const uint8_t telem_packet_size = 10;
-    bool telem_uart_started;
     uint32_t last_telem_byte_read_us;
+
+    // telemetry packet being received
+    uint8_t telem_buf[telem_packet_size];
+    uint8_t telem_buf_len;
+
+    // are we waiting for a reply to a telemetry request?
+    bool telem_pending;
+
+    // CRC errors, framing errors and missed replies for each ESC
+    uint32_t telem_errors[max_motors];
+
+    // how often the telemetry thread checks the port, about the time
+    // taken to receive one packet at 115200 baud
+    static const uint32_t telem_poll_us = 1000;
+    // how often the telemetry thread checks whether telemetry has been re-enabled
+    static const uint32_t telem_idle_ms = 100;
+    // discard a partial packet after this long without a byte, longer
+    // than the poll interval so a packet split across two polls is kept
+    static const uint32_t telem_byte_timeout_us = 2000;
+    // give up on a reply after this long, allowing for the request to
+    // wait for the next output frame
+    static const uint32_t telem_reply_timeout_us = 10000;
     int8_t last_control_port;
 
     bool msp_process_byte(uint8_t c);
@@ -279,6 +281,8 @@ private:
     void run_connection_test(uint8_t chan);
     uint8_t telem_crc8(uint8_t crc, uint8_t crc_seed) const;
     void read_telemetry_packet(void);
+    void update_telemetry(void);
+    void telem_thread(void);
     
     // protocol handler hook
     bool protocol_handler(uint8_t , AP_HAL::UARTDriver *);
@@ -188,15 +188,6 @@ uint16_t AP_Baro_MS56XX::_read_prom_word(uint8_t word)
     return (val[0] << 8) | val[1];
 }
 
-uint32_t AP_Baro_MS56XX::_read_adc()
-{
-    uint8_t val[3];
-    if (!_dev->transfer(&CMD_MS56XX_READ_ADC, 1, val, sizeof(val))) {
-        return 0;
-    }
-    return (val[0] << 16) | (val[1] << 8) | val[2];
-}
-
 bool AP_Baro_MS56XX::_read_prom_5611(uint16_t prom[8])
 {
     /*
@@ -270,31 +261,34 @@ bool AP_Baro_MS56XX::_read_prom_5637(uint16_t prom[8])
 */
 void AP_Baro_MS56XX::_timer(void)
 {
-    uint8_t next_cmd;
-    uint8_t next_state;
-    uint32_t adc_val = _read_adc();
+    uint8_t val[3];
+    const uint8_t next_state = (_state + 1) % 5;
+    const uint8_t next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
+                                             : ADDR_CMD_CONVERT_PRESSURE;
 
     /*
-     * If read fails, re-initiate a read command for current state or we are
-     * stuck
+     * Read the ADC and start the next conversion in one bus batch. The
+     * next conversion is started before we know if the read succeeded,
+     * so a failed read discards the following sample instead of
+     * retrying the current state.
      */
-    if (adc_val == 0) {
-        next_state = _state;
-    } else {
-        next_state = (_state + 1) % 5;
-    }
-
-    next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
-                               : ADDR_CMD_CONVERT_PRESSURE;
-    if (!_dev->transfer(&next_cmd, 1, nullptr, 0)) {
+    AP_HAL::Device::BatchTransfer xfers[2] {
+        { &CMD_MS56XX_READ_ADC, 1, val, sizeof(val), 0 },
+        { &next_cmd, 1, nullptr, 0, 0 },
+    };
+    if (!_dev->transfer_batch(xfers, ARRAY_SIZE(xfers))) {
+        // we don't know which conversion is in progress
+        _discard_next = true;
         return;
     }
+    const uint32_t adc_val = (val[0] << 16) | (val[1] << 8) | val[2];
 
     /* if we had a failed read we are all done */
     if (adc_val == 0) {
         // a failed read can mean the next returned value will be
         // corrupt, we must discard it
         _discard_next = true;
+        _state = next_state;
         return;
     }
 
@@ -132,9 +132,7 @@ AP_BattMonitor::init()
 #endif
                 break;
             case AP_BattMonitor_Params::BattMonitor_TYPE_BLHeliESC:
-#ifdef HAVE_AP_BLHELI_SUPPORT
                 drivers[instance] = new AP_BattMonitor_BLHeliESC(*this, state[instance], _params[instance]);
-#endif
                 break;
             case AP_BattMonitor_Params::BattMonitor_TYPE_Sum:
                 drivers[instance] = new AP_BattMonitor_Sum(*this, state[instance], _params[instance], instance);
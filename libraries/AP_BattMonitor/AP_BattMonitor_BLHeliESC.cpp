@@ -15,9 +15,7 @@
 
 
 #include <AP_HAL/AP_HAL.h>
-#include <AP_BLHeli/AP_BLHeli.h>
-
-#ifdef HAVE_AP_BLHELI_SUPPORT
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
 
 #include "AP_BattMonitor_BLHeliESC.h"
 
@@ -29,8 +27,8 @@ void AP_BattMonitor_BLHeliESC::init(void)
 
 void AP_BattMonitor_BLHeliESC::read(void)
 {
-    AP_BLHeli *blheli = AP_BLHeli::get_singleton();
-    if (!blheli) {
+    const AP_ESC_Telem *esc_telem = AP::esc_telem();
+    if (!esc_telem) {
         return;
     }
 
@@ -42,24 +40,33 @@ void AP_BattMonitor_BLHeliESC::read(void)
     uint32_t now = AP_HAL::millis();
     uint32_t highest_ms = 0;
 
-    for (uint8_t i=0; i<AP_BLHELI_MAX_ESCS; i++) {
-        AP_BLHeli::telem_data td;
-        if (!blheli->get_telem_data(i, td)) {
+    for (uint8_t i=0; i<ESC_TELEM_MAX_ESCS; i++) {
+        AP_ESC_Telem::TelemetryData td;
+        if (!esc_telem->get_telemetry(i, td)) {
             continue;
         }
 
         // accumulate consumed_sum regardless of age, to cope with ESC
         // dropping out
-        consumed_sum += td.consumption;
+        if (td.types & AP_ESC_Telem::TELEM_CONSUMPTION) {
+            consumed_sum += td.consumption_mah;
+        }
 
-        if (now - td.timestamp_ms > 1000) {
+        if (now - td.timestamp_ms > ESC_TELEM_DATA_TIMEOUT_MS) {
             // don't use old data
             continue;
         }
 
         num_escs++;
         voltage_sum += td.voltage;
-        current_sum += td.current;
+        // ESCs report in turn, so use the average current over recent
+        // reports to avoid summing samples taken at different times
+        AP_ESC_Telem::TelemetryStats stats;
+        if (esc_telem->get_telemetry_stats(i, stats)) {
+            current_sum += stats.current.avg;
+        } else {
+            current_sum += td.current;
+        }
         temperature_sum += td.temperature;
         if (td.timestamp_ms > highest_ms) {
             highest_ms = td.timestamp_ms;
@@ -67,7 +74,7 @@ void AP_BattMonitor_BLHeliESC::read(void)
     }
 
     if (num_escs > 0) {
-        _state.voltage = (voltage_sum / num_escs) * 0.01;
+        _state.voltage = voltage_sum / num_escs;
         _state.temperature = temperature_sum / num_escs;
         _state.healthy = true;
     } else {
@@ -75,7 +82,7 @@ void AP_BattMonitor_BLHeliESC::read(void)
         _state.temperature = 0;
         _state.healthy = false;
     }
-    _state.current_amps = current_sum * 0.01;
+    _state.current_amps = current_sum;
     _state.consumed_mah = consumed_sum;
     _state.last_time_micros = highest_ms * 1000;
     _state.temperature_time = highest_ms;
@@ -86,5 +93,3 @@ void AP_BattMonitor_BLHeliESC::read(void)
         have_current = true;
     }
 }
-
-#endif // HAVE_AP_BLHELI_SUPPORT
@@ -26,6 +26,7 @@
 #include "AP_Compass_RM3100.h"
 #include "AP_Compass.h"
 #include "Compass_learn.h"
+#include "Compass_ContinuousLearn.h"
 
 extern AP_HAL::HAL& hal;
 
@@ -86,8 +87,8 @@ const AP_Param::GroupInfo Compass::var_info[] = {
 
     // @Param: LEARN
     // @DisplayName: Learn compass offsets automatically
-    // @Description: Enable or disable the automatic learning of compass offsets. You can enable learning either using a compass-only method that is suitable only for fixed wing aircraft or using the offsets learnt by the active EKF state estimator. If this option is enabled then the learnt offsets are saved when you disarm the vehicle. If InFlight learning is enabled then the compass with automatically start learning once a flight starts (must be armed). While InFlight learning is running you cannot use position control modes.
-    // @Values: 0:Disabled,1:Internal-Learning,2:EKF-Learning,3:InFlight-Learning
+    // @Description: Enable or disable the automatic learning of compass offsets. You can enable learning either using a compass-only method that is suitable only for fixed wing aircraft or using the offsets learnt by the active EKF state estimator. If this option is enabled then the learnt offsets are saved when you disarm the vehicle. If InFlight learning is enabled then the compass with automatically start learning once a flight starts (must be armed). While InFlight learning is running you cannot use position control modes. Continuous learning estimates the offsets and the throttle or current based motor interference on every flight from the EKF field estimate, while the compass stays in use, and saves the estimates that have converged when you disarm.
+    // @Values: 0:Disabled,1:Internal-Learning,2:EKF-Learning,3:InFlight-Learning,4:Continuous-Learning
     // @User: Advanced
     AP_GROUPINFO("LEARN",  3, Compass, _learn, COMPASS_LEARN_DEFAULT),
 
@@ -958,6 +959,13 @@ Compass::read(void)
     if (_learn == LEARN_INFLIGHT && learn != nullptr) {
         learn->update();
     }
+    if (_learn == LEARN_CONTINUOUS && !continuous_learn_allocated) {
+        continuous_learn_allocated = true;
+        continuous_learn = new CompassContinuousLearn(*this);
+    }
+    if (_learn == LEARN_CONTINUOUS && continuous_learn != nullptr) {
+        continuous_learn->update();
+    }
     return healthy();
 }
 
@@ -47,6 +47,7 @@
 #define COMPASS_MAX_BACKEND   3
 
 class CompassLearn;
+class CompassContinuousLearn;
 
 class Compass
 {
@@ -64,6 +65,7 @@ public:
     }
 
     friend class CompassLearn;
+    friend class CompassContinuousLearn;
 
     /// Initialize the compass device.
     ///
@@ -251,7 +253,8 @@ public:
     /// Set the throttle as a percentage from 0.0 to 1.0
     /// @param thr_pct              throttle expressed as a percentage from 0 to 1.0
     void set_throttle(float thr_pct) {
-        if (_motor_comp_type == AP_COMPASS_MOT_COMP_THROTTLE) {
+        if (_motor_comp_type == AP_COMPASS_MOT_COMP_THROTTLE ||
+            _learn == LEARN_CONTINUOUS) {
             _thr = thr_pct;
         }
     }
@@ -304,7 +307,8 @@ public:
         LEARN_NONE=0,
         LEARN_INTERNAL=1,
         LEARN_EKF=2,
-        LEARN_INFLIGHT=3
+        LEARN_INFLIGHT=3,
+        LEARN_CONTINUOUS=4
     };
 
     // return the chosen learning type
@@ -349,6 +353,7 @@ private:
     bool _start_calibration(uint8_t i, bool retry=false, float delay_sec=0.0f);
     bool _start_calibration_mask(uint8_t mask, bool retry=false, bool autosave=false, float delay_sec=0.0f, bool autoreboot=false);
     bool _auto_reboot() { return _compass_cal_autoreboot; }
+    void _calibration_thread(void);
 
     // see if we already have probed a i2c driver by bus number and address
     bool _have_i2c_driver(uint8_t bus_num, uint8_t address) const;
@@ -362,6 +367,13 @@ private:
     bool _cal_complete_requires_reboot;
     bool _cal_has_run;
 
+    // the fits are run in a thread started with each calibration and
+    // exiting when it completes, which flags failures for
+    // compass_cal_update() to report
+    HAL_Semaphore _cal_thread_sem;
+    bool _cal_thread_started;
+    bool _cal_failed[COMPASS_MAX_INSTANCES];
+
     // enum of drivers for COMPASS_TYPEMASK
     enum DriverType {
         DRIVER_HMC5883  =0,
@@ -483,6 +495,9 @@ private:
 
     CompassLearn *learn;
     bool learn_allocated;
+
+    CompassContinuousLearn *continuous_learn;
+    bool continuous_learn_allocated;
 };
 
 namespace AP {
@@ -1,4 +1,5 @@
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Semaphore.h>
 #include <AP_Notify/AP_Notify.h>
 #include <GCS_MAVLink/GCS.h>
 
@@ -12,9 +13,16 @@ Compass::compass_cal_update()
     bool running = false;
 
     for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
-        bool failure;
-        _calibrator[i].update(failure);
-        if (failure) {
+        if (!_cal_thread_started) {
+            // no calibration thread, run the fit here
+            bool failure;
+            _calibrator[i].update(failure);
+            if (failure) {
+                _cal_failed[i] = true;
+            }
+        }
+        if (_cal_failed[i]) {
+            _cal_failed[i] = false;
             AP_Notify::events.compass_cal_failed = 1;
         }
 
@@ -41,6 +49,39 @@ Compass::compass_cal_update()
     }
 }
 
+/*
+  run the calibration fits away from the main loop. Each fit step is
+  several passes over the sample buffer, which with more than one
+  compass calibrating would otherwise cause loop overruns.
+
+  The thread exits once no calibration is running and
+  _start_calibration() starts a new one for the next calibration
+ */
+void
+Compass::_calibration_thread(void)
+{
+    while (true) {
+        bool fitting = false;
+        for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
+            bool failure;
+            if (_calibrator[i].update(failure)) {
+                fitting = true;
+            }
+            if (failure) {
+                _cal_failed[i] = true;
+            }
+        }
+        if (!fitting) {
+            WITH_SEMAPHORE(_cal_thread_sem);
+            if (!is_calibrating()) {
+                _cal_thread_started = false;
+                return;
+            }
+        }
+        hal.scheduler->delay(fitting ? 1 : 10);
+    }
+}
+
 bool
 Compass::_start_calibration(uint8_t i, bool retry, float delay)
 {
@@ -70,6 +111,16 @@ Compass::_start_calibration(uint8_t i, bool retry, float delay)
     _cal_saved[i] = false;
     _calibrator[i].start(retry, delay, get_offsets_max(), i);
 
+    {
+        // the calibrator is started first so a thread about to exit sees it running
+        WITH_SEMAPHORE(_cal_thread_sem);
+        if (!_cal_thread_started) {
+            // if the thread can't be started the fit runs in compass_cal_update()
+            _cal_thread_started = hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&Compass::_calibration_thread, void),
+                                                               "compasscal", 4096, AP_HAL::Scheduler::PRIORITY_IO, 1);
+        }
+    }
+
     // disable compass learning both for calibration and after completion
     _learn.set_and_save(0);
 
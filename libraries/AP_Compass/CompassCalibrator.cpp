@@ -55,10 +55,16 @@
  *
  * The fitting algorithm used is Levenberg-Marquardt. See also:
  * http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm
+ *
+ * Samples are added from the compass backend threads and the fit is run
+ * by update(), which Compass calls from its calibration thread. The
+ * sample buffer and fit state are protected by _sem; new_sample() only
+ * tries to take it, as no samples are wanted while a fit step holds it.
  */
 
 #include "CompassCalibrator.h"
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Semaphore.h>
 #include <AP_Math/AP_GeodesicGrid.h>
 #include <AP_AHRS/AP_AHRS.h>
 #include <GCS_MAVLink/GCS.h>
@@ -77,11 +83,13 @@ _sample_buffer(nullptr)
 }
 
 void CompassCalibrator::clear() {
+    WITH_SEMAPHORE(_sem);
     set_status(COMPASS_CAL_NOT_STARTED);
 }
 
 void CompassCalibrator::start(bool retry, float delay, uint16_t offset_max, uint8_t compass_idx)
 {
+    WITH_SEMAPHORE(_sem);
     if(running()) {
         return;
     }
@@ -155,6 +163,7 @@ CompassCalibrator::completion_mask_t& CompassCalibrator::get_completion_mask()
 bool CompassCalibrator::check_for_timeout() {
     uint32_t tnow = AP_HAL::millis();
     if(running() && tnow - _last_sample_ms > 1000) {
+        WITH_SEMAPHORE(_sem);
         _retry = false;
         set_status(COMPASS_CAL_FAILED);
         return true;
@@ -165,6 +174,11 @@ bool CompassCalibrator::check_for_timeout() {
 void CompassCalibrator::new_sample(const Vector3f& sample) {
     _last_sample_ms = AP_HAL::millis();
 
+    // don't hold up the sensor thread while a fit step runs
+    if (!_sem.take_nonblocking()) {
+        return;
+    }
+
     if(_status == COMPASS_CAL_WAITING_TO_START) {
         set_status(COMPASS_CAL_RUNNING_STEP_ONE);
     }
@@ -173,15 +187,25 @@ void CompassCalibrator::new_sample(const Vector3f& sample) {
         update_completion_mask(sample);
         _sample_buffer[_samples_collected].set(sample);
         _sample_buffer[_samples_collected].att.set_from_ahrs();
+        _sample_sum += _sample_buffer[_samples_collected].get();
         _samples_collected++;
     }
+
+    _sem.give();
 }
 
-void CompassCalibrator::update(bool &failure) {
+bool CompassCalibrator::update(bool &failure) {
     failure = false;
 
     if(!fitting()) {
-        return;
+        return false;
+    }
+
+    WITH_SEMAPHORE(_sem);
+
+    // may have been cancelled while waiting for the semaphore
+    if(!fitting()) {
+        return false;
     }
 
     if(_status == COMPASS_CAL_RUNNING_STEP_ONE) {
@@ -214,6 +238,8 @@ void CompassCalibrator::update(bool &failure) {
             _fit_step++;
         }
     }
+
+    return fitting();
 }
 
 /////////////////////////////////////////////////////////////
@@ -243,6 +269,7 @@ void CompassCalibrator::initialize_fit() {
 void CompassCalibrator::reset_state() {
     _samples_collected = 0;
     _samples_thinned = 0;
+    _sample_sum.zero();
     _params.radius = 200;
     _params.offset.zero();
     _params.diag = Vector3f(1.0f,1.0f,1.0f);
@@ -384,6 +411,7 @@ void CompassCalibrator::thin_samples() {
 
     for(uint16_t i=0; i < _samples_collected; i++) {
         if(!accept_sample(_sample_buffer[i])) {
+            _sample_sum -= _sample_buffer[i].get();
             _sample_buffer[i] = _sample_buffer[_samples_collected-1];
             _samples_collected --;
             _samples_thinned ++;
@@ -434,15 +462,6 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample) {
     return accept_sample(sample.get());
 }
 
-float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const {
-    Matrix3f softiron(
-        params.diag.x    , params.offdiag.x , params.offdiag.y,
-        params.offdiag.x , params.diag.y    , params.offdiag.z,
-        params.offdiag.y , params.offdiag.z , params.diag.z
-    );
-    return params.radius - (softiron*(sample+params.offset)).length();
-}
-
 float CompassCalibrator::calc_mean_squared_residuals() const
 {
     return calc_mean_squared_residuals(_params);
@@ -453,47 +472,74 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
     if(_sample_buffer == nullptr || _samples_collected == 0) {
         return 1.0e30f;
     }
+    const Matrix3f softiron(
+        params.diag.x    , params.offdiag.x , params.offdiag.y,
+        params.offdiag.x , params.diag.y    , params.offdiag.z,
+        params.offdiag.y , params.offdiag.z , params.diag.z
+    );
     float sum = 0.0f;
     for(uint16_t i=0; i < _samples_collected; i++){
-        Vector3f sample = _sample_buffer[i].get();
-        float resid = calc_residual(sample, params);
+        const float resid = params.radius - (softiron*(_sample_buffer[i].get()+params.offset)).length();
         sum += sq(resid);
     }
     sum /= _samples_collected;
     return sum;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const{
-    const Vector3f &offset = params.offset;
+float CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const{
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
+    const Vector3f s = sample + params.offset;
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
+    // (A, B, C) is the corrected sample, softiron*(sample+offset)
+    const float A =  (diag.x    * s.x) + (offdiag.x * s.y) + (offdiag.y * s.z);
+    const float B =  (offdiag.x * s.x) + (diag.y    * s.y) + (offdiag.z * s.z);
+    const float C =  (offdiag.y * s.x) + (offdiag.z * s.y) + (diag.z    * s.z);
+    const float length = norm(A, B, C);
+    const float inv_length = 1.0f / length;
 
     // 0: partial derivative (radius wrt fitness fn) fn operated on sample
     ret[0] = 1.0f;
     // 1-3: partial derivative (offsets wrt fitness fn) fn operated on sample
-    ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    ret[1] = -1.0f * ((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C)) * inv_length;
+    ret[2] = -1.0f * ((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C)) * inv_length;
+    ret[3] = -1.0f * ((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C)) * inv_length;
+
+    return params.radius - length;
 }
 
-void CompassCalibrator::calc_initial_offset()
+/*
+  add the contribution of one sample to the normal equations of a fit
+  step. JTJ is symmetric so only the upper triangle is accumulated here
+  and mirror_normal_equations() fills in the rest once all samples are
+  in
+ */
+void CompassCalibrator::accumulate_normal_equations(const float *jacob, float resid, uint8_t num_params, float *JTJ, float *JTFI)
 {
-    // Set initial offset to the average value of the samples
-    _params.offset.zero();
-    for(uint16_t k = 0; k<_samples_collected; k++) {
-        _params.offset -= _sample_buffer[k].get();
+    for(uint8_t i = 0; i < num_params; i++) {
+        const float ji = jacob[i];
+        float *row = &JTJ[i*num_params];
+        for(uint8_t j = i; j < num_params; j++) {
+            row[j] += ji * jacob[j];
+        }
+        JTFI[i] += ji * resid;
     }
-    _params.offset /= _samples_collected;
+}
+
+void CompassCalibrator::mirror_normal_equations(uint8_t num_params, float *JTJ)
+{
+    for(uint8_t i = 1; i < num_params; i++) {
+        for(uint8_t j = 0; j < i; j++) {
+            JTJ[i*num_params+j] = JTJ[j*num_params+i];
+        }
+    }
+}
+
+void CompassCalibrator::calc_initial_offset()
+{
+    // Set initial offset to the average value of the samples, which
+    // are summed as they are collected
+    _params.offset = -_sample_sum / _samples_collected;
 }
 
 void CompassCalibrator::run_sphere_fit()
@@ -515,22 +561,12 @@ void CompassCalibrator::run_sphere_fit()
 
     // Gauss Newton Part common for all kind of extensions including LM
     for(uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
         float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for(uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for(uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
+        const float resid = calc_sphere_jacob(_sample_buffer[k].get(), fit1_params, sphere_jacob);
+        accumulate_normal_equations(sphere_jacob, resid, COMPASS_CAL_NUM_SPHERE_PARAMS, JTJ, JTFI);
     }
+    mirror_normal_equations(COMPASS_CAL_NUM_SPHERE_PARAMS, JTJ);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));    //a backup JTJ for LM
 
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
@@ -578,33 +614,32 @@ void CompassCalibrator::run_sphere_fit()
 
 
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const{
-    const Vector3f &offset = params.offset;
+float CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const{
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
+    const Vector3f s = sample + params.offset;
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
+    // (A, B, C) is the corrected sample, softiron*(sample+offset)
+    const float A =  (diag.x    * s.x) + (offdiag.x * s.y) + (offdiag.y * s.z);
+    const float B =  (offdiag.x * s.x) + (diag.y    * s.y) + (offdiag.z * s.z);
+    const float C =  (offdiag.y * s.x) + (offdiag.z * s.y) + (diag.z    * s.z);
+    const float length = norm(A, B, C);
+    const float inv_length = 1.0f / length;
 
     // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
-    ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    ret[0] = -1.0f * ((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C)) * inv_length;
+    ret[1] = -1.0f * ((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C)) * inv_length;
+    ret[2] = -1.0f * ((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C)) * inv_length;
     // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
-    ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-    ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-    ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
+    ret[3] = -1.0f * (s.x * A) * inv_length;
+    ret[4] = -1.0f * (s.y * B) * inv_length;
+    ret[5] = -1.0f * (s.z * C) * inv_length;
     // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
-    ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-    ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-    ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
+    ret[6] = -1.0f * ((s.y * A) + (s.x * B)) * inv_length;
+    ret[7] = -1.0f * ((s.z * A) + (s.x * C)) * inv_length;
+    ret[8] = -1.0f * ((s.z * B) + (s.y * C)) * inv_length;
+
+    return params.radius - length;
 }
 
 void CompassCalibrator::run_ellipsoid_fit()
@@ -628,22 +663,12 @@ void CompassCalibrator::run_ellipsoid_fit()
 
     // Gauss Newton Part common for all kind of extensions including LM
     for(uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
         float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
-
-        for(uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for(uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
+        const float resid = calc_ellipsoid_jacob(_sample_buffer[k].get(), fit1_params, ellipsoid_jacob);
+        accumulate_normal_equations(ellipsoid_jacob, resid, COMPASS_CAL_NUM_ELLIPSOID_PARAMS, JTJ, JTFI);
     }
+    mirror_normal_equations(COMPASS_CAL_NUM_ELLIPSOID_PARAMS, JTJ);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));
 
 
 
@@ -871,11 +896,13 @@ bool CompassCalibrator::calculate_orientation(void)
     _params.offset = rot_offsets;
 
     // rotate the samples for the new orientation
+    _sample_sum.zero();
     for (uint32_t i=0; i<_samples_collected; i++) {
         Vector3f s = _sample_buffer[i].get();
         s.rotate_inverse(_orientation);
         s.rotate(besti);
         _sample_buffer[i].set(s);
+        _sample_sum += _sample_buffer[i].get();
     }
 
     _orientation = besti;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
 #define COMPASS_CAL_NUM_SPHERE_PARAMS 4
@@ -19,6 +20,11 @@ enum compass_cal_status_t {
     COMPASS_CAL_BAD_ORIENTATION=6,
 };
 
+/*
+  calibrator for one compass. Samples are added by the compass backend
+  and the fit is run by update(), which may be called from a different
+  thread to the rest of the interface
+ */
 class CompassCalibrator {
 public:
     typedef uint8_t completion_mask_t[10];
@@ -28,13 +34,17 @@ public:
     void start(bool retry, float delay, uint16_t offset_max, uint8_t compass_idx);
     void clear();
 
-    void update(bool &failure);
+    // run a step of the fit, returns true if there is more fitting to do
+    bool update(bool &failure);
     void new_sample(const Vector3f &sample);
 
     bool check_for_timeout();
 
     bool running() const;
 
+    // true if the sample buffer is full and the fit is in progress
+    bool fitting() const;
+
     void set_orientation(enum Rotation orientation, bool is_external, bool fix_orientation) {
         _check_orientation = true;
         _orientation = orientation;
@@ -117,6 +127,9 @@ private:
 
     completion_mask_t _completion_mask;
 
+    // protects the sample buffer and fit state from the thread running update()
+    HAL_Semaphore _sem;
+
     //fit state
     class param_t _params;
     uint16_t _fit_step;
@@ -127,6 +140,7 @@ private:
     float _ellipsoid_lambda;
     uint16_t _samples_collected;
     uint16_t _samples_thinned;
+    Vector3f _sample_sum;   // sum of the samples in the buffer for the initial offset
     float _orientation_confidence;
 
     bool set_status(compass_cal_status_t status);
@@ -141,22 +155,25 @@ private:
     void reset_state();
     void initialize_fit();
 
-    bool fitting() const;
-
     // thins out samples between step one and step two
     void thin_samples();
 
-    float calc_residual(const Vector3f& sample, const param_t& params) const;
     float calc_mean_squared_residuals(const param_t& params) const;
     float calc_mean_squared_residuals() const;
 
     void calc_initial_offset();
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
+    // calculate the jacobian of the residual for a sample, returns the residual
+    float calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_sphere_fit();
 
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
+    float calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_ellipsoid_fit();
 
+    // add a sample's jacobian and residual to the upper triangle of JTJ and to JTFI
+    static void accumulate_normal_equations(const float *jacob, float resid, uint8_t num_params, float *JTJ, float *JTFI);
+    // fill in the lower triangle of JTJ
+    static void mirror_normal_equations(uint8_t num_params, float *JTJ);
+
     /**
      * Update #_completion_mask for the geodesic section of \p v. Corrections
      * are applied to \p v with #_params.
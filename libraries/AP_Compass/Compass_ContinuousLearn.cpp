@@ -0,0 +1,285 @@
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_BattMonitor/AP_BattMonitor.h>
+#include <AP_Logger/AP_Logger.h>
+#include <GCS_MAVLink/GCS.h>
+
+#include "Compass_ContinuousLearn.h"
+
+extern const AP_HAL::HAL &hal;
+
+#define COMPASS_CLEARN_INTERVAL_MS      100     // time between samples
+#define COMPASS_CLEARN_MIN_FLYING_MS    10000   // wait for the EKF field to settle after takeoff
+#define COMPASS_CLEARN_FORGET           0.999f  // forgetting factor, 100s time constant at 10Hz
+#define COMPASS_CLEARN_P_INIT           100.0f  // initial and maximum normalised covariance
+#define COMPASS_CLEARN_MIN_SAMPLES      300     // samples before the gate and convergence checks are used
+#define COMPASS_CLEARN_NOISE_MIN        5.0f    // floor on the residual standard deviation for the gate, milligauss
+#define COMPASS_CLEARN_GATE             4.0f    // residual gate in standard deviations
+#define COMPASS_CLEARN_MAX_REJECT       50      // consecutive rejections before the gate is opened
+#define COMPASS_CLEARN_CONVERGED        5.0f    // estimate standard deviation needed to apply it, milligauss
+
+CompassContinuousLearn::CompassContinuousLearn(Compass &_compass) :
+    compass(_compass)
+{
+    gcs().send_text(MAV_SEVERITY_INFO, "CompassLearn: continuous learning enabled");
+}
+
+/*
+  start a new set of estimates
+ */
+void CompassContinuousLearn::reset(void)
+{
+    for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
+        struct estimator &e = est[i];
+        e.offset.zero();
+        e.motor.zero();
+        e.P00 = COMPASS_CLEARN_P_INIT;
+        e.P01 = 0;
+        e.P11 = COMPASS_CLEARN_P_INIT;
+        e.residual_var = 0;
+        e.count = 0;
+        e.rejected = 0;
+        e.reject_run = 0;
+    }
+
+    // learn the interference against the input already in use for
+    // compensation, otherwise prefer current as it follows the
+    // interference better than throttle
+    if (compass._per_motor.enabled()) {
+        motor_type = AP_COMPASS_MOT_COMP_DISABLED;
+    } else if (compass._motor_comp_type == AP_COMPASS_MOT_COMP_THROTTLE ||
+               compass._motor_comp_type == AP_COMPASS_MOT_COMP_CURRENT) {
+        motor_type = compass._motor_comp_type;
+    } else if (AP::battery().has_current()) {
+        motor_type = AP_COMPASS_MOT_COMP_CURRENT;
+    } else {
+        motor_type = AP_COMPASS_MOT_COMP_THROTTLE;
+    }
+    max_motor_input = 0;
+}
+
+/*
+  update when new compass sample available
+ */
+void CompassContinuousLearn::update(void)
+{
+    if (!hal.util->get_soft_armed()) {
+        if (was_armed) {
+            was_armed = false;
+            apply();
+        }
+        return;
+    }
+    was_armed = true;
+
+    const AP_AHRS &ahrs = AP::ahrs();
+    const uint32_t now_ms = AP_HAL::millis();
+    if (ahrs.get_time_flying_ms() < COMPASS_CLEARN_MIN_FLYING_MS ||
+        now_ms - last_sample_ms < COMPASS_CLEARN_INTERVAL_MS ||
+        compass.is_calibrating()) {
+        return;
+    }
+
+    Vector3f earth_field;
+    if (!ahrs.healthy() || !ahrs.get_mag_field_NED(earth_field) || earth_field.is_zero()) {
+        return;
+    }
+
+    if (!started) {
+        reset();
+        started = true;
+    }
+
+    float input;
+    if (!get_motor_input(input)) {
+        return;
+    }
+    last_sample_ms = now_ms;
+    max_motor_input = MAX(max_motor_input, fabsf(input));
+
+    // the field the compasses should read at the current attitude
+    const Vector3f expected = ahrs.get_rotation_body_to_ned().mul_transpose(earth_field);
+
+    for (uint8_t i=0; i<compass.get_count(); i++) {
+        if (compass.healthy(i)) {
+            update_estimator(est[i], expected - compass.get_field(i), input);
+        }
+    }
+
+    if (now_ms - last_log_ms >= 1000) {
+        last_log_ms = now_ms;
+        log();
+    }
+}
+
+/*
+  get the motor interference input in the units used for COMPASS_MOT
+ */
+bool CompassContinuousLearn::get_motor_input(float &input) const
+{
+    switch (motor_type) {
+    case AP_COMPASS_MOT_COMP_THROTTLE:
+        input = compass._thr;
+        return true;
+    case AP_COMPASS_MOT_COMP_CURRENT: {
+        AP_BattMonitor &battery = AP::battery();
+        if (!battery.has_current()) {
+            return false;
+        }
+        input = battery.current_amps();
+        return true;
+    }
+    default:
+        input = 0;
+        return true;
+    }
+}
+
+/*
+  recursive least squares update of one compass's estimates with the
+  difference between the expected and measured fields
+ */
+void CompassContinuousLearn::update_estimator(struct estimator &e, const Vector3f &error, float input)
+{
+    // a priori residual of the current model
+    const Vector3f resid = error - (e.offset + e.motor * input);
+    const float resid_var = resid.length_squared() / 3;
+
+    // once settled, reject disturbances the model can't explain. A
+    // long run of rejections means the field has really changed
+    if (e.count >= COMPASS_CLEARN_MIN_SAMPLES &&
+        e.reject_run < COMPASS_CLEARN_MAX_REJECT &&
+        resid_var > sq(COMPASS_CLEARN_GATE) * MAX(e.residual_var, sq(COMPASS_CLEARN_NOISE_MIN))) {
+        e.rejected++;
+        e.reject_run++;
+        return;
+    }
+    e.reject_run = 0;
+
+    // the regressor is (1, input) for all three axes
+    const float lambda = COMPASS_CLEARN_FORGET;
+    const float Pu0 = e.P00 + e.P01 * input;
+    const float Pu1 = e.P01 + e.P11 * input;
+    const float denom = lambda + Pu0 + input * Pu1;
+    const float K0 = Pu0 / denom;
+    const float K1 = Pu1 / denom;
+
+    e.offset += resid * K0;
+    e.motor += resid * K1;
+
+    // with forgetting the covariance of a term that isn't excited,
+    // such as the motor term in a steady hover, grows without limit so
+    // it is bounded by its initial value
+    e.P00 = MIN((e.P00 - K0 * Pu0) / lambda, COMPASS_CLEARN_P_INIT);
+    e.P11 = MIN((e.P11 - K1 * Pu1) / lambda, COMPASS_CLEARN_P_INIT);
+    const float P01_max = safe_sqrt(e.P00 * e.P11);
+    e.P01 = constrain_float((e.P01 - K0 * Pu1) / lambda, -P01_max, P01_max);
+
+    e.residual_var += (resid_var - e.residual_var) * 0.02f;
+    e.count++;
+}
+
+bool CompassContinuousLearn::offset_converged(const struct estimator &e) const
+{
+    return e.count >= COMPASS_CLEARN_MIN_SAMPLES &&
+        safe_sqrt(e.P00 * e.residual_var) < COMPASS_CLEARN_CONVERGED;
+}
+
+// the motor term has converged if its uncertainty at the largest input seen is small
+bool CompassContinuousLearn::motor_converged(const struct estimator &e) const
+{
+    return motor_type != AP_COMPASS_MOT_COMP_DISABLED &&
+        is_positive(max_motor_input) &&
+        e.count >= COMPASS_CLEARN_MIN_SAMPLES &&
+        safe_sqrt(e.P11 * e.residual_var) * max_motor_input < COMPASS_CLEARN_CONVERGED;
+}
+
+/*
+  apply the converged estimates to the compass parameters on disarm
+ */
+void CompassContinuousLearn::apply(void)
+{
+    if (!started) {
+        return;
+    }
+    started = false;
+
+    bool have_motor = false;
+    for (uint8_t i=0; i<compass.get_count(); i++) {
+        if (offset_converged(est[i]) && motor_converged(est[i])) {
+            have_motor = true;
+        }
+    }
+    // existing compensation is only kept if it is for the same input
+    const bool same_motor_type = compass._motor_comp_type == motor_type;
+
+    for (uint8_t i=0; i<compass.get_count(); i++) {
+        const struct estimator &e = est[i];
+        if (!offset_converged(e)) {
+            if (have_motor && !same_motor_type) {
+                compass.set_motor_compensation(i, Vector3f());
+            }
+            continue;
+        }
+
+        // offsets are added before the soft iron correction, so map the
+        // learnt correction back through it
+        const Vector3f &diagonals = compass.get_diagonals(i);
+        const Vector3f &offdiagonals = compass.get_offdiagonals(i);
+        Matrix3f mat(
+            diagonals.x, offdiagonals.x, offdiagonals.y,
+            offdiagonals.x,    diagonals.y, offdiagonals.z,
+            offdiagonals.y, offdiagonals.z,    diagonals.z
+            );
+        Vector3f offsets = e.offset;
+        if (mat.invert()) {
+            offsets = mat * e.offset;
+        }
+        compass.set_and_save_offsets(i, compass.get_offsets(i) + offsets);
+
+        if (have_motor) {
+            Vector3f motor;
+            if (motor_converged(e)) {
+                motor = e.motor;
+            }
+            if (same_motor_type) {
+                motor += compass.get_motor_compensation(i);
+            }
+            compass.set_motor_compensation(i, motor);
+        }
+        gcs().send_text(MAV_SEVERITY_INFO, "CompassLearn: mag %u learnt offsets%s saved",
+                        i, motor_converged(e) ? " and interference" : "");
+    }
+
+    if (have_motor) {
+        compass._motor_comp_type.set(motor_type);
+        compass.save_motor_compensation();
+    }
+}
+
+/*
+  log the estimates and their convergence
+ */
+void CompassContinuousLearn::log(void) const
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<compass.get_count(); i++) {
+        const struct estimator &e = est[i];
+        if (e.count == 0) {
+            continue;
+        }
+        AP::logger().Write("MAGL", "TimeUS,I,OX,OY,OZ,MX,MY,MZ,SO,SM,Res,N,Rej", "QBfffffffffII",
+                           now_us,
+                           i,
+                           (double)e.offset.x,
+                           (double)e.offset.y,
+                           (double)e.offset.z,
+                           (double)e.motor.x,
+                           (double)e.motor.y,
+                           (double)e.motor.z,
+                           (double)safe_sqrt(e.P00 * e.residual_var),
+                           (double)(safe_sqrt(e.P11 * e.residual_var) * max_motor_input),
+                           (double)safe_sqrt(e.residual_var),
+                           e.count,
+                           e.rejected);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <AP_Compass/AP_Compass.h>
+
+/*
+  continuous in-flight learning of compass offsets and motor
+  interference
+
+  Each compass field is compared with the field predicted from the EKF
+  earth field and attitude. The difference is fitted per axis to an
+  offset plus a term proportional to the motor interference input
+  (throttle or current, as for COMPASS_MOTCT) by recursive least
+  squares. The regressor is the same for all three axes so they share
+  one 2x2 covariance, making each update a few dozen flops per
+  compass. Converged estimates are applied when the vehicle disarms.
+ */
+class CompassContinuousLearn {
+public:
+    CompassContinuousLearn(Compass &compass);
+
+    // called on each compass read
+    void update(void);
+
+private:
+    Compass &compass;
+
+    struct estimator {
+        // learnt corrections in the corrected field frame, milligauss
+        // and milligauss per unit of motor input
+        Vector3f offset;
+        Vector3f motor;
+
+        // covariance of (offset, motor) normalised by the residual
+        // variance, shared by the three axes
+        float P00;
+        float P01;
+        float P11;
+
+        // filtered residual variance per axis, milligauss^2
+        float residual_var;
+
+        uint32_t count;
+        uint32_t rejected;
+        uint16_t reject_run;
+    } est[COMPASS_MAX_INSTANCES];
+
+    // motor interference input used for the model, one of
+    // AP_COMPASS_MOT_COMP_*, chosen when learning starts
+    uint8_t motor_type;
+
+    // largest motor input seen, used to judge convergence of the
+    // motor term
+    float max_motor_input;
+
+    bool started;
+    bool was_armed;
+    uint32_t last_sample_ms;
+    uint32_t last_log_ms;
+
+    void reset(void);
+    bool get_motor_input(float &input) const;
+    void update_estimator(struct estimator &e, const Vector3f &error, float input);
+    bool offset_converged(const struct estimator &e) const;
+    bool motor_converged(const struct estimator &e) const;
+    void apply(void);
+    void log(void) const;
+};
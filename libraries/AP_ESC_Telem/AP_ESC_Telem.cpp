@@ -0,0 +1,312 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_ESC_Telem.h"
+
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS.h>
+
+extern const AP_HAL::HAL& hal;
+
+AP_ESC_Telem::AP_ESC_Telem()
+{
+    if (_singleton) {
+        AP_HAL::panic("Too many AP_ESC_Telem instances");
+    }
+    _singleton = this;
+}
+
+/*
+  publish new telemetry for an ESC. This is called by the thread that
+  receives the data from the ESC and only needs to be safe against
+  readers, not other writers for the same ESC
+ */
+void AP_ESC_Telem::update_telemetry(uint8_t esc_index, const TelemetryData &data, uint16_t types)
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS) {
+        return;
+    }
+    auto &esc = _escs[esc_index];
+
+    const uint32_t now_us = AP_HAL::micros();
+    if (types & TELEM_CONSUMPTION) {
+        esc.consumption_mah = data.consumption_mah;
+    } else if ((types & TELEM_CURRENT) && esc.last_update_us != 0) {
+        // integrate the current when the ESC does not report what it has used
+        const float dt = (now_us - esc.last_update_us) * 1.0e-6f;
+        if (dt < 1.0f) {
+            esc.consumption_mah += data.current * dt * (1000.0f / 3600.0f);
+        }
+        types |= TELEM_CONSUMPTION;
+    }
+    esc.last_update_us = now_us;
+    esc.count++;
+
+    TelemetryData published = data;
+    published.consumption_mah = esc.consumption_mah;
+    published.types = types;
+    published.count = esc.count;
+    published.timestamp_ms = AP_HAL::millis();
+    esc.data.write(published);
+
+    update_stats(esc, published);
+}
+
+/*
+  add a report to the statistics window for an ESC and publish the
+  min, max and average over the window. Fields the source does not
+  report are counted as zero
+ */
+void AP_ESC_Telem::update_stats(ESCState &esc, const TelemetryData &data)
+{
+    auto &sample = esc.samples[esc.sample_head];
+    sample.rpm = data.rpm;
+    sample.current = data.current;
+    sample.temperature = data.temperature;
+    esc.sample_head = (esc.sample_head + 1) % ESC_TELEM_STATS_SAMPLES;
+    if (esc.num_samples < ESC_TELEM_STATS_SAMPLES) {
+        esc.num_samples++;
+    }
+
+    TelemetryStats stats;
+    stats.rpm = {sample.rpm, sample.rpm, 0};
+    stats.current = {sample.current, sample.current, 0};
+    stats.temperature = {sample.temperature, sample.temperature, 0};
+    for (uint8_t i=0; i<esc.num_samples; i++) {
+        const auto &s = esc.samples[i];
+        stats.rpm.min = MIN(stats.rpm.min, s.rpm);
+        stats.rpm.max = MAX(stats.rpm.max, s.rpm);
+        stats.rpm.avg += s.rpm;
+        stats.current.min = MIN(stats.current.min, s.current);
+        stats.current.max = MAX(stats.current.max, s.current);
+        stats.current.avg += s.current;
+        stats.temperature.min = MIN(stats.temperature.min, s.temperature);
+        stats.temperature.max = MAX(stats.temperature.max, s.temperature);
+        stats.temperature.avg += s.temperature;
+    }
+    stats.rpm.avg /= esc.num_samples;
+    stats.current.avg /= esc.num_samples;
+    stats.temperature.avg /= esc.num_samples;
+    stats.num_samples = esc.num_samples;
+
+    esc.stats.write(stats);
+}
+
+// get the latest telemetry for an ESC, returns false if it has never reported
+bool AP_ESC_Telem::get_telemetry(uint8_t esc_index, TelemetryData &data) const
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS) {
+        return false;
+    }
+    return _escs[esc_index].data.read(data);
+}
+
+/*
+  get telemetry for an ESC only if it is newer than last_sequence,
+  letting each consumer track what it has already seen
+ */
+bool AP_ESC_Telem::get_new_telemetry(uint8_t esc_index, TelemetryData &data, uint32_t &last_sequence) const
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS) {
+        return false;
+    }
+    const auto &esc = _escs[esc_index];
+    const uint32_t sequence = esc.data.sequence();
+    if (sequence == last_sequence || !esc.data.read(data)) {
+        return false;
+    }
+    last_sequence = sequence;
+    return true;
+}
+
+// get statistics over the recent reports from an ESC, returns false if it has never reported
+bool AP_ESC_Telem::get_telemetry_stats(uint8_t esc_index, TelemetryStats &stats) const
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS) {
+        return false;
+    }
+    return _escs[esc_index].stats.read(stats);
+}
+
+// get the RPM of an ESC, returns false if it has not reported RPM recently
+bool AP_ESC_Telem::get_rpm(uint8_t esc_index, float &rpm) const
+{
+    TelemetryData data;
+    if (!get_telemetry(esc_index, data) ||
+        !(data.types & TELEM_RPM) ||
+        !is_fresh(data, AP_HAL::millis())) {
+        return false;
+    }
+    rpm = data.rpm;
+    return true;
+}
+
+// get the average RPM of the ESCs in esc_mask that have reported RPM recently
+bool AP_ESC_Telem::get_average_rpm(uint32_t esc_mask, float &rpm) const
+{
+    float rpm_sum = 0.0f;
+    uint8_t num_escs = 0;
+    for (uint8_t i=0; i<ESC_TELEM_MAX_ESCS; i++) {
+        float esc_rpm;
+        if ((esc_mask & (1U<<i)) && get_rpm(i, esc_rpm)) {
+            rpm_sum += esc_rpm;
+            num_escs++;
+        }
+    }
+    if (num_escs == 0) {
+        return false;
+    }
+    rpm = rpm_sum / num_escs;
+    return true;
+}
+
+// get a mask of ESCs that have reported recently
+uint32_t AP_ESC_Telem::get_active_esc_mask(void) const
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    uint32_t mask = 0;
+    for (uint8_t i=0; i<ESC_TELEM_MAX_ESCS; i++) {
+        TelemetryData data;
+        if (get_telemetry(i, data) && is_fresh(data, now_ms)) {
+            mask |= 1U<<i;
+        }
+    }
+    return mask;
+}
+
+/*
+  read simulated ESCs and log new telemetry. Logging is rate limited
+  per ESC so a fast source can't flood the log, and the statistics for
+  each active ESC are logged once a second
+ */
+void AP_ESC_Telem::update(void)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    _sitl.update(*this);
+#endif
+
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr || !logger->logging_enabled()) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint8_t i=0; i<ESC_TELEM_MAX_ESCS; i++) {
+        auto &esc = _escs[i];
+        if (now_ms - esc.last_stats_log_ms >= ESC_TELEM_STATS_LOG_INTERVAL_MS) {
+            log_stats(i, now_ms);
+        }
+        if (now_ms - esc.last_log_ms < ESC_TELEM_LOG_INTERVAL_MS) {
+            continue;
+        }
+        TelemetryData data;
+        if (!get_new_telemetry(i, data, esc.last_log_sequence)) {
+            continue;
+        }
+        esc.last_log_ms = now_ms;
+        logger->Write_ESC(i,
+                          AP_HAL::micros64(),
+                          int32_t(data.rpm * 100.0f),
+                          uint16_t(data.voltage * 100.0f),
+                          uint16_t(data.current * 100.0f),
+                          data.temperature * 100,
+                          uint16_t(data.consumption_mah));
+    }
+}
+
+/*
+  log the statistics for an ESC if it is reporting
+ */
+void AP_ESC_Telem::log_stats(uint8_t esc_index, uint32_t now_ms)
+{
+    auto &esc = _escs[esc_index];
+    TelemetryData data;
+    TelemetryStats stats;
+    if (!get_telemetry(esc_index, data) ||
+        !is_fresh(data, now_ms) ||
+        !get_telemetry_stats(esc_index, stats)) {
+        return;
+    }
+    esc.last_stats_log_ms = now_ms;
+    AP::logger().Write("ESCS", "TimeUS,Instance,N,RPMMin,RPMAvg,RPMMax,CurrMin,CurrAvg,CurrMax,TempAvg,TempMax,Err",
+                       "QBHffffffffI",
+                       AP_HAL::micros64(),
+                       esc_index,
+                       (uint16_t)stats.num_samples,
+                       (double)stats.rpm.min,
+                       (double)stats.rpm.avg,
+                       (double)stats.rpm.max,
+                       (double)stats.current.min,
+                       (double)stats.current.avg,
+                       (double)stats.current.max,
+                       (double)stats.temperature.avg,
+                       (double)stats.temperature.max,
+                       data.error_count);
+}
+
+/*
+  send ESC telemetry messages over MAVLink
+ */
+void AP_ESC_Telem::send_esc_telemetry_mavlink(uint8_t mav_chan)
+{
+    const uint32_t active_mask = get_active_esc_mask() & 0xFF;
+    if (active_mask == 0) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    // send up to the highest active ESC, the ESC_TELEMETRY messages carry four ESCs each
+    const uint8_t num_escs = 32 - __builtin_clz(active_mask);
+
+    for (uint8_t first=0; first<num_escs; first+=4) {
+        uint8_t temperature[4] {};
+        uint16_t voltage[4] {};
+        uint16_t current[4] {};
+        uint16_t totalcurrent[4] {};
+        uint16_t rpm[4] {};
+        uint16_t count[4] {};
+        for (uint8_t idx=0; idx<4 && first+idx<num_escs; idx++) {
+            TelemetryData data;
+            if (!get_telemetry(first+idx, data) || !is_fresh(data, now_ms)) {
+                continue;
+            }
+            temperature[idx]  = uint8_t(constrain_int16(data.temperature, 0, UINT8_MAX));
+            voltage[idx]      = uint16_t(constrain_float(data.voltage * 100.0f, 0, UINT16_MAX));
+            current[idx]      = uint16_t(constrain_float(data.current * 100.0f, 0, UINT16_MAX));
+            totalcurrent[idx] = uint16_t(constrain_float(data.consumption_mah, 0, UINT16_MAX));
+            rpm[idx]          = uint16_t(constrain_float(data.rpm, 0, UINT16_MAX));
+            count[idx]        = data.count;
+        }
+        if (!HAVE_PAYLOAD_SPACE((mavlink_channel_t)mav_chan, ESC_TELEMETRY_1_TO_4)) {
+            return;
+        }
+        if (first == 0) {
+            mavlink_msg_esc_telemetry_1_to_4_send((mavlink_channel_t)mav_chan, temperature, voltage, current, totalcurrent, rpm, count);
+        } else {
+            mavlink_msg_esc_telemetry_5_to_8_send((mavlink_channel_t)mav_chan, temperature, voltage, current, totalcurrent, rpm, count);
+        }
+    }
+}
+
+// singleton instance
+AP_ESC_Telem *AP_ESC_Telem::_singleton;
+
+namespace AP {
+
+AP_ESC_Telem *esc_telem()
+{
+    return AP_ESC_Telem::get_singleton();
+}
+
+};
@@ -0,0 +1,152 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
+
+#include "AP_ESC_Telem_SITL.h"
+
+#define ESC_TELEM_MAX_ESCS          12
+#define ESC_TELEM_DATA_TIMEOUT_MS   1000    // telemetry older than this is not used
+#define ESC_TELEM_LOG_INTERVAL_MS   20      // minimum time between log messages for each ESC
+#define ESC_TELEM_STATS_SAMPLES     16      // number of reports in the statistics window for each ESC
+#define ESC_TELEM_STATS_LOG_INTERVAL_MS 1000 // time between statistics log messages for each ESC
+
+/*
+  per-motor ESC telemetry store
+
+  ESC telemetry sources (BLHeli, UAVCAN and the SITL ESC model) publish
+  to the store from whichever thread receives the data and consumers
+  such as logging, battery monitoring and filters read it from their
+  own threads without taking a lock. Each ESC's data is held in a
+  double buffer so each ESC index must only be fed by one source.
+ */
+class AP_ESC_Telem {
+public:
+    AP_ESC_Telem();
+
+    /* Do not allow copies */
+    AP_ESC_Telem(const AP_ESC_Telem &other) = delete;
+    AP_ESC_Telem &operator=(const AP_ESC_Telem&) = delete;
+
+    static AP_ESC_Telem *get_singleton(void) {
+        return _singleton;
+    }
+
+    // fields a source provides in TelemetryData
+    enum TelemetryType {
+        TELEM_TEMPERATURE   = (1U<<0),
+        TELEM_VOLTAGE       = (1U<<1),
+        TELEM_CURRENT       = (1U<<2),
+        TELEM_CONSUMPTION   = (1U<<3),
+        TELEM_RPM           = (1U<<4),
+    };
+
+    struct TelemetryData {
+        float rpm;                  // motor RPM
+        float voltage;              // volts
+        float current;              // amps
+        float consumption_mah;      // mAh, integrated from current if the source doesn't report it
+        int16_t temperature;        // degrees C
+        uint16_t types;             // bitmask of TelemetryType fields that are valid
+        uint16_t count;             // number of times this ESC has reported, set by the store
+        uint32_t error_count;       // errors reported by the ESC
+        uint32_t timestamp_ms;      // time the data was published, set by the store
+    };
+
+    // statistics over the last ESC_TELEM_STATS_SAMPLES reports from an ESC
+    struct TelemetryStats {
+        struct Statistic {
+            float min;
+            float max;
+            float avg;
+        } rpm, current, temperature;
+        uint8_t num_samples;
+    };
+
+    // publish new telemetry for an ESC, types is a bitmask of the valid fields in data
+    void update_telemetry(uint8_t esc_index, const TelemetryData &data, uint16_t types);
+
+    // get the latest telemetry for an ESC, returns false if it has never reported
+    bool get_telemetry(uint8_t esc_index, TelemetryData &data) const;
+
+    // get telemetry for an ESC only if it has reported since the last call with the same sequence number
+    bool get_new_telemetry(uint8_t esc_index, TelemetryData &data, uint32_t &last_sequence) const;
+
+    // get statistics over the recent reports from an ESC, returns false if it has never reported
+    bool get_telemetry_stats(uint8_t esc_index, TelemetryStats &stats) const;
+
+    // get the RPM of an ESC, returns false if it has not reported RPM recently
+    bool get_rpm(uint8_t esc_index, float &rpm) const;
+
+    // get the average RPM of the ESCs in esc_mask that have reported RPM recently
+    bool get_average_rpm(uint32_t esc_mask, float &rpm) const;
+
+    // get a mask of ESCs that have reported recently
+    uint32_t get_active_esc_mask(void) const;
+
+    // send ESC telemetry messages over MAVLink
+    void send_esc_telemetry_mavlink(uint8_t mav_chan);
+
+    // read simulated ESCs and log new telemetry, must be called from the main thread
+    void update(void);
+
+private:
+    static AP_ESC_Telem *_singleton;
+
+    // true if the data is recent enough to use
+    static bool is_fresh(const TelemetryData &data, uint32_t now_ms) {
+        return now_ms - data.timestamp_ms < ESC_TELEM_DATA_TIMEOUT_MS;
+    }
+
+    struct ESCState {
+        DoubleBuffer<TelemetryData> data;
+        DoubleBuffer<TelemetryStats> stats;
+
+        // state of the publishing source
+        uint16_t count;
+        float consumption_mah;
+        uint32_t last_update_us;
+
+        // ring buffer of recent reports for the statistics
+        struct {
+            float rpm;
+            float current;
+            float temperature;
+        } samples[ESC_TELEM_STATS_SAMPLES];
+        uint8_t sample_head;
+        uint8_t num_samples;
+
+        // state of the logging in update()
+        uint32_t last_log_sequence;
+        uint32_t last_log_ms;
+        uint32_t last_stats_log_ms;
+    } _escs[ESC_TELEM_MAX_ESCS];
+
+    // add a report to the statistics window for an ESC and publish the statistics
+    static void update_stats(ESCState &esc, const TelemetryData &data);
+
+    // log the statistics for an ESC if it is reporting
+    void log_stats(uint8_t esc_index, uint32_t now_ms);
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    AP_ESC_Telem_SITL _sitl;
+#endif
+};
+
+namespace AP {
+    AP_ESC_Telem *esc_telem();
+};
@@ -0,0 +1,49 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_ESC_Telem.h"
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+#include <SITL/SITL.h>
+
+// publish the simulated ESCs whenever the simulation has stepped
+void AP_ESC_Telem_SITL::update(AP_ESC_Telem &esc_telem)
+{
+    SITL::SITL *sitl = AP::sitl();
+    if (sitl == nullptr || !sitl->esc_telem) {
+        return;
+    }
+    const SITL::sitl_fdm &fdm = sitl->state;
+    if (fdm.timestamp_us == _last_timestamp_us) {
+        return;
+    }
+    _last_timestamp_us = fdm.timestamp_us;
+
+    for (uint8_t i=0; i<MIN(fdm.num_escs, ESC_TELEM_MAX_ESCS); i++) {
+        AP_ESC_Telem::TelemetryData data {};
+        data.rpm = fdm.escs[i].rpm;
+        data.voltage = fdm.escs[i].voltage;
+        data.current = fdm.escs[i].current;
+        data.temperature = int16_t(fdm.escs[i].temperature);
+        esc_telem.update_telemetry(i, data,
+                                   AP_ESC_Telem::TELEM_RPM |
+                                   AP_ESC_Telem::TELEM_VOLTAGE |
+                                   AP_ESC_Telem::TELEM_CURRENT |
+                                   AP_ESC_Telem::TELEM_TEMPERATURE);
+    }
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
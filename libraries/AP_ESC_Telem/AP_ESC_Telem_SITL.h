@@ -0,0 +1,35 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+class AP_ESC_Telem;
+
+/*
+  ESC telemetry from the simulated ESCs in the SITL frame model
+ */
+class AP_ESC_Telem_SITL {
+public:
+    // publish the simulated ESCs whenever the simulation has stepped
+    void update(AP_ESC_Telem &esc_telem);
+
+private:
+    uint64_t _last_timestamp_us;
+};
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
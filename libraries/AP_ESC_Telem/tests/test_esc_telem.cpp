@@ -0,0 +1,123 @@
+#include <AP_gtest.h>
+
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_ESC_Telem esc_telem;
+
+TEST(ESCTelemTest, NoData)
+{
+    AP_ESC_Telem::TelemetryData data;
+    float rpm;
+
+    EXPECT_FALSE(esc_telem.get_telemetry(11, data));
+    EXPECT_FALSE(esc_telem.get_telemetry(ESC_TELEM_MAX_ESCS, data));
+    EXPECT_FALSE(esc_telem.get_rpm(11, rpm));
+    EXPECT_EQ(0U, esc_telem.get_active_esc_mask() & (1U<<11));
+}
+
+TEST(ESCTelemTest, NewTelemetry)
+{
+    AP_ESC_Telem::TelemetryData in {};
+    AP_ESC_Telem::TelemetryData out;
+    uint32_t last_sequence = 0;
+
+    in.rpm = 1000;
+    esc_telem.update_telemetry(0, in, AP_ESC_Telem::TELEM_RPM);
+    EXPECT_TRUE(esc_telem.get_new_telemetry(0, out, last_sequence));
+    EXPECT_FLOAT_EQ(1000, out.rpm);
+    EXPECT_EQ(1U, out.count);
+
+    // nothing new until the ESC reports again
+    EXPECT_FALSE(esc_telem.get_new_telemetry(0, out, last_sequence));
+
+    in.rpm = 2000;
+    esc_telem.update_telemetry(0, in, AP_ESC_Telem::TELEM_RPM);
+    EXPECT_TRUE(esc_telem.get_new_telemetry(0, out, last_sequence));
+    EXPECT_FLOAT_EQ(2000, out.rpm);
+    EXPECT_EQ(2U, out.count);
+}
+
+TEST(ESCTelemTest, ReportedConsumption)
+{
+    AP_ESC_Telem::TelemetryData in {};
+    AP_ESC_Telem::TelemetryData out;
+
+    in.current = 10;
+    in.consumption_mah = 123;
+    esc_telem.update_telemetry(1, in, AP_ESC_Telem::TELEM_CURRENT | AP_ESC_Telem::TELEM_CONSUMPTION);
+    EXPECT_TRUE(esc_telem.get_telemetry(1, out));
+    EXPECT_FLOAT_EQ(123, out.consumption_mah);
+    EXPECT_TRUE(out.types & AP_ESC_Telem::TELEM_CONSUMPTION);
+}
+
+TEST(ESCTelemTest, IntegratedConsumption)
+{
+    AP_ESC_Telem::TelemetryData in {};
+    AP_ESC_Telem::TelemetryData out;
+
+    in.current = 36;
+    esc_telem.update_telemetry(2, in, AP_ESC_Telem::TELEM_CURRENT);
+    hal.scheduler->delay(100);
+    esc_telem.update_telemetry(2, in, AP_ESC_Telem::TELEM_CURRENT);
+
+    // 36A for 0.1s is 1mAh
+    EXPECT_TRUE(esc_telem.get_telemetry(2, out));
+    EXPECT_TRUE(out.types & AP_ESC_Telem::TELEM_CONSUMPTION);
+    EXPECT_NEAR(1.0f, out.consumption_mah, 0.2f);
+}
+
+TEST(ESCTelemTest, AverageRPM)
+{
+    AP_ESC_Telem::TelemetryData in {};
+    float rpm;
+
+    in.rpm = 3000;
+    esc_telem.update_telemetry(4, in, AP_ESC_Telem::TELEM_RPM);
+    in.rpm = 5000;
+    esc_telem.update_telemetry(5, in, AP_ESC_Telem::TELEM_RPM);
+    // an ESC without RPM is not included in the average
+    esc_telem.update_telemetry(6, in, AP_ESC_Telem::TELEM_VOLTAGE);
+
+    EXPECT_TRUE(esc_telem.get_average_rpm((1U<<4) | (1U<<5) | (1U<<6), rpm));
+    EXPECT_FLOAT_EQ(4000, rpm);
+    EXPECT_FALSE(esc_telem.get_average_rpm(1U<<6, rpm));
+
+    const uint32_t mask = esc_telem.get_active_esc_mask();
+    EXPECT_EQ(uint32_t((1U<<4) | (1U<<5) | (1U<<6)), mask & 0x70);
+}
+
+TEST(ESCTelemTest, Statistics)
+{
+    AP_ESC_Telem::TelemetryData in {};
+    AP_ESC_Telem::TelemetryStats stats;
+
+    EXPECT_FALSE(esc_telem.get_telemetry_stats(7, stats));
+
+    in.rpm = 100;
+    in.current = 2;
+    esc_telem.update_telemetry(7, in, AP_ESC_Telem::TELEM_RPM | AP_ESC_Telem::TELEM_CURRENT);
+    EXPECT_TRUE(esc_telem.get_telemetry_stats(7, stats));
+    EXPECT_EQ(1U, stats.num_samples);
+    EXPECT_FLOAT_EQ(100, stats.rpm.min);
+    EXPECT_FLOAT_EQ(100, stats.rpm.max);
+    EXPECT_FLOAT_EQ(100, stats.rpm.avg);
+
+    // overfill the window, only the most recent reports are used
+    for (uint8_t i=1; i<=ESC_TELEM_STATS_SAMPLES+4; i++) {
+        in.rpm = i * 100;
+        in.current = i;
+        esc_telem.update_telemetry(7, in, AP_ESC_Telem::TELEM_RPM | AP_ESC_Telem::TELEM_CURRENT);
+    }
+    EXPECT_TRUE(esc_telem.get_telemetry_stats(7, stats));
+    EXPECT_EQ(ESC_TELEM_STATS_SAMPLES, stats.num_samples);
+    EXPECT_FLOAT_EQ(500, stats.rpm.min);
+    EXPECT_FLOAT_EQ(2000, stats.rpm.max);
+    EXPECT_FLOAT_EQ(1250, stats.rpm.avg);
+    EXPECT_FLOAT_EQ(5, stats.current.min);
+    EXPECT_FLOAT_EQ(20, stats.current.max);
+    EXPECT_FLOAT_EQ(12.5, stats.current.avg);
+}
+
+AP_GTEST_MAIN()
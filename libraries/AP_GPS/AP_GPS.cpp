@@ -17,6 +17,7 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
 #include <AP_Notify/AP_Notify.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
@@ -50,6 +51,7 @@
 #define BLEND_MASK_USE_VPOS_ACC     2
 #define BLEND_MASK_USE_SPD_ACC      4
 #define BLEND_COUNTER_FAILURE_INCREMENT 10
+#define BLEND_OUTLIER_GATE 5.0f // receivers further than this many standard deviations from the others are not blended
 
 extern const AP_HAL::HAL &hal;
 
@@ -264,12 +266,129 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("BLEND_TC", 21, AP_GPS, _blend_tc, 10.0f),
 
+#if GPS_MAX_RECEIVERS > 2
+    // @Param: TYPE3
+    // @DisplayName: 3rd GPS type
+    // @Description: GPS type of 3rd GPS
+    // @Values: 0:None,1:AUTO,2:uBlox,3:MTK,4:MTK19,5:NMEA,6:SiRF,7:HIL,8:SwiftNav,9:UAVCAN,10:SBF,11:GSOF,13:ERB,14:MAV,15:NOVA
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("TYPE3", 22, AP_GPS, _type[2], 0),
+
+    // @Param: GNSS_MODE3
+    // @DisplayName: GNSS system configuration
+    // @Description: Bitmask for what GNSS system to use on the 3rd GPS (all unchecked or zero to leave GPS as configured)
+    // @Values: 0:Leave as currently configured, 1:GPS-NoSBAS, 3:GPS+SBAS, 4:Galileo-NoSBAS, 6:Galileo+SBAS, 8:Beidou, 51:GPS+IMES+QZSS+SBAS (Japan Only), 64:GLONASS, 66:GLONASS+SBAS, 67:GPS+GLONASS+SBAS
+    // @Bitmask: 0:GPS,1:SBAS,2:Galileo,3:Beidou,4:IMES,5:QZSS,6:GLOSNASS
+    // @User: Advanced
+    AP_GROUPINFO("GNSS_MODE3", 23, AP_GPS, _gnss_mode[2], 0),
+
+    // @Param: RATE_MS3
+    // @DisplayName: GPS 3 update rate in milliseconds
+    // @Description: Controls how often the GPS should provide a position update. Lowering below 5Hz is not allowed
+    // @Units: ms
+    // @Values: 100:10Hz,125:8Hz,200:5Hz
+    // @Range: 50 200
+    // @User: Advanced
+    AP_GROUPINFO("RATE_MS3", 24, AP_GPS, _rate_ms[2], 200),
+
+    // @Param: POS3_X
+    // @DisplayName: Antenna X position offset
+    // @Description: X position of the 3rd GPS antenna in body frame. Positive X is forward of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @Range: -10 10
+    // @User: Advanced
+
+    // @Param: POS3_Y
+    // @DisplayName: Antenna Y position offset
+    // @Description: Y position of the 3rd GPS antenna in body frame. Positive Y is to the right of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @Range: -10 10
+    // @User: Advanced
+
+    // @Param: POS3_Z
+    // @DisplayName: Antenna Z position offset
+    // @Description: Z position of the 3rd GPS antenna in body frame. Positive Z is down from the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @Range: -10 10
+    // @User: Advanced
+    AP_GROUPINFO("POS3", 25, AP_GPS, _antenna_offset[2], 0.0f),
+
+    // @Param: DELAY_MS3
+    // @DisplayName: GPS 3 delay in milliseconds
+    // @Description: Controls the amount of GPS  measurement delay that the autopilot compensates for. Set to zero to use the default delay for the detected GPS type.
+    // @Units: ms
+    // @Range: 0 250
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("DELAY_MS3", 26, AP_GPS, _delay_ms[2], 0),
+#endif
+
+#if GPS_MAX_RECEIVERS > 3
+    // @Param: TYPE4
+    // @DisplayName: 4th GPS type
+    // @Description: GPS type of 4th GPS
+    // @Values: 0:None,1:AUTO,2:uBlox,3:MTK,4:MTK19,5:NMEA,6:SiRF,7:HIL,8:SwiftNav,9:UAVCAN,10:SBF,11:GSOF,13:ERB,14:MAV,15:NOVA
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("TYPE4", 27, AP_GPS, _type[3], 0),
+
+    // @Param: GNSS_MODE4
+    // @DisplayName: GNSS system configuration
+    // @Description: Bitmask for what GNSS system to use on the 4th GPS (all unchecked or zero to leave GPS as configured)
+    // @Values: 0:Leave as currently configured, 1:GPS-NoSBAS, 3:GPS+SBAS, 4:Galileo-NoSBAS, 6:Galileo+SBAS, 8:Beidou, 51:GPS+IMES+QZSS+SBAS (Japan Only), 64:GLONASS, 66:GLONASS+SBAS, 67:GPS+GLONASS+SBAS
+    // @Bitmask: 0:GPS,1:SBAS,2:Galileo,3:Beidou,4:IMES,5:QZSS,6:GLOSNASS
+    // @User: Advanced
+    AP_GROUPINFO("GNSS_MODE4", 28, AP_GPS, _gnss_mode[3], 0),
+
+    // @Param: RATE_MS4
+    // @DisplayName: GPS 4 update rate in milliseconds
+    // @Description: Controls how often the GPS should provide a position update. Lowering below 5Hz is not allowed
+    // @Units: ms
+    // @Values: 100:10Hz,125:8Hz,200:5Hz
+    // @Range: 50 200
+    // @User: Advanced
+    AP_GROUPINFO("RATE_MS4", 29, AP_GPS, _rate_ms[3], 200),
+
+    // @Param: POS4_X
+    // @DisplayName: Antenna X position offset
+    // @Description: X position of the 4th GPS antenna in body frame. Positive X is forward of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @Range: -10 10
+    // @User: Advanced
+
+    // @Param: POS4_Y
+    // @DisplayName: Antenna Y position offset
+    // @Description: Y position of the 4th GPS antenna in body frame. Positive Y is to the right of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @Range: -10 10
+    // @User: Advanced
+
+    // @Param: POS4_Z
+    // @DisplayName: Antenna Z position offset
+    // @Description: Z position of the 4th GPS antenna in body frame. Positive Z is down from the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @Range: -10 10
+    // @User: Advanced
+    AP_GROUPINFO("POS4", 30, AP_GPS, _antenna_offset[3], 0.0f),
+
+    // @Param: DELAY_MS4
+    // @DisplayName: GPS 4 delay in milliseconds
+    // @Description: Controls the amount of GPS  measurement delay that the autopilot compensates for. Set to zero to use the default delay for the detected GPS type.
+    // @Units: ms
+    // @Range: 0 250
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("DELAY_MS4", 31, AP_GPS, _delay_ms[3], 0),
+#endif
+
     AP_GROUPEND
 };
 
 // constructor
 AP_GPS::AP_GPS()
 {
+    static_assert(GPS_MAX_RECEIVERS <= 4, "GPS parameters and log messages are only defined for 4 receivers");
     static_assert((sizeof(_initialisation_blob) * (CHAR_BIT + 2)) < (4800 * GPS_BAUD_TIME_MS * 1e-3),
                     "GPS initilisation blob is too large to be completely sent before the baud rate changes");
 
@@ -287,8 +406,9 @@ void AP_GPS::init(const AP_SerialManager& serial_manager)
     primary_instance = 0;
 
     // search for serial ports with gps protocol
-    _port[0] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 0);
-    _port[1] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 1);
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        _port[i] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, i);
+    }
     _last_instance_swap_ms = 0;
 
     // Initialise class variables used to do GPS blending
@@ -675,6 +795,9 @@ void AP_GPS::update(void)
         update_instance(i);
     }
 
+    // write any correction data the receivers didn't have space for when it arrived
+    update_injection();
+
     // calculate number of instances
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (state[i].status != NO_GPS) {
@@ -885,11 +1008,103 @@ void AP_GPS::inject_data(uint8_t *data, uint16_t len)
     }
 }
 
+/*
+  queue a block of data for a GPS. The block is dropped if it does not
+  fit so that the receiver never sees a partial RTCM message
+ */
 void AP_GPS::inject_data(uint8_t instance, uint8_t *data, uint16_t len)
 {
-    if (instance < GPS_MAX_RECEIVERS && drivers[instance] != nullptr) {
-        drivers[instance]->inject_data(data, len);
+    if (instance >= GPS_MAX_RECEIVERS || drivers[instance] == nullptr ||
+        !drivers[instance]->accepts_injection() || len == 0) {
+        return;
+    }
+    if (rtcm_queues[instance] == nullptr) {
+        rtcm_queues[instance] = new rtcm_queue;
+        if (rtcm_queues[instance] == nullptr) {
+            return;
+        }
+    }
+    rtcm_queue &queue = *rtcm_queues[instance];
+    if (queue.data.space() < len || queue.blocks.space() == 0) {
+        queue.blocks_dropped++;
+        return;
+    }
+    queue.data.write(data, len);
+    queue.bytes_queued += len;
+    queue.blocks.push(rtcm_block{queue.bytes_queued, AP_HAL::millis()});
+
+    // start writing straight away rather than waiting for the next update
+    update_injection();
+}
+
+/*
+  write as much queued RTCM data to each receiver as its UART has space
+  for, and track how long each block waited to be written
+ */
+void AP_GPS::update_injection(void)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (rtcm_queues[i] == nullptr) {
+            continue;
+        }
+        rtcm_queue &queue = *rtcm_queues[i];
+        if (drivers[i] == nullptr) {
+            // the receiver has gone, its data will never be written
+            queue.blocks_dropped += queue.blocks.available();
+            queue.bytes_queued -= queue.data.available();
+            queue.data.clear();
+            queue.blocks.clear();
+        }
+
+        uint32_t space = drivers[i] != nullptr ? drivers[i]->inject_space() : 0;
+        while (space > 0 && !queue.data.empty()) {
+            uint32_t n = 0;
+            const uint8_t *ptr = queue.data.readptr(n);
+            n = MIN(n, space);
+            drivers[i]->inject_data(ptr, n);
+            queue.data.advance(n);
+            queue.bytes_written += n;
+            space -= n;
+        }
+
+        rtcm_block block;
+        while (queue.blocks.peek(block) && (int32_t)(queue.bytes_written - block.end) >= 0) {
+            queue.blocks.pop();
+            const uint32_t latency_ms = now_ms - block.queued_ms;
+            queue.latency_max_ms = MAX(queue.latency_max_ms, latency_ms);
+            queue.latency_avg_ms += 0.1f * (latency_ms - queue.latency_avg_ms);
+            queue.blocks_written++;
+        }
+
+        if (now_ms - queue.last_log_ms >= 1000) {
+            queue.last_log_ms = now_ms;
+            log_injection(i, queue);
+        }
+    }
+}
+
+/*
+  log the RTCM injection statistics for a receiver
+ */
+void AP_GPS::log_injection(uint8_t instance, const rtcm_queue &queue) const
+{
+    if (!should_df_log()) {
+        return;
     }
+    AP::logger().Write("RTCM", "TimeUS,I,Blk,Drop,Bytes,Queued,LatAvg,LatMax,Frag,Dup,Inc",
+                       "QBIIIIfIIII",
+                       AP_HAL::micros64(),
+                       instance,
+                       queue.blocks_written,
+                       queue.blocks_dropped,
+                       queue.bytes_written,
+                       queue.data.available(),
+                       (double)queue.latency_avg_ms,
+                       queue.latency_max_ms,
+                       rtcm_buffer != nullptr ? rtcm_buffer->fragments : 0,
+                       rtcm_buffer != nullptr ? rtcm_buffer->duplicates : 0,
+                       rtcm_buffer != nullptr ? rtcm_buffer->incomplete : 0);
 }
 
 void AP_GPS::send_mavlink_gps_raw(mavlink_channel_t chan)
@@ -997,15 +1212,20 @@ void AP_GPS::broadcast_first_configuration_failure_reason(void) const
 // pre-arm check that all GPSs are close to each other.  farthest distance between GPSs (in meters) is returned
 bool AP_GPS::all_consistent(float &distance) const
 {
-    // return true immediately if only one valid receiver
-    if (num_instances <= 1 ||
-        drivers[0] == nullptr || _type[0] == GPS_TYPE_NONE) {
-        distance = 0;
-        return true;
+    // find the largest distance between any two receivers, this is
+    // only used before arming so checking every pair is affordable
+    distance = 0;
+    for (uint8_t i=0; i<num_instances; i++) {
+        if (drivers[i] == nullptr || _type[i] == GPS_TYPE_NONE) {
+            continue;
+        }
+        for (uint8_t j=i+1; j<num_instances; j++) {
+            if (drivers[j] == nullptr || _type[j] == GPS_TYPE_NONE) {
+                continue;
+            }
+            distance = MAX(distance, location_3d_diff_NED(state[i].location, state[j].location).length());
+        }
     }
-
-    // calculate distance
-    distance = location_3d_diff_NED(state[0].location, state[1].location).length();
     // success if distance is within 50m
     return (distance < 50);
 }
@@ -1046,43 +1266,93 @@ void AP_GPS::handle_gps_rtcm_data(const mavlink_message_t *msg)
 
     uint8_t fragment = (packet.flags >> 1U) & 0x03;
     uint8_t sequence = (packet.flags >> 3U) & 0x1F;
-
-    // see if this fragment is consistent with existing fragments
-    if (rtcm_buffer->fragments_received &&
-        (rtcm_buffer->sequence != sequence ||
-        (rtcm_buffer->fragments_received & (1U<<fragment)))) {
-        // we have one or more partial fragments already received
-        // which conflict with the new fragment, discard previous fragments
-        memset(rtcm_buffer, 0, sizeof(*rtcm_buffer));
+    const uint32_t now_ms = AP_HAL::millis();
+    rtcm_buffer->fragments++;
+
+    // find the slot re-assembling this sequence, discarding blocks that have been waiting too long
+    auto *slot = &rtcm_buffer->slot[0];
+    auto *free_slot = slot;
+    auto *oldest_slot = slot;
+    bool found = false;
+    for (auto &s : rtcm_buffer->slot) {
+        if (s.fragments_received != 0 && now_ms - s.first_fragment_ms > GPS_RTCM_FRAGMENT_TIMEOUT_MS) {
+            memset(&s, 0, sizeof(s));
+            rtcm_buffer->incomplete++;
+        }
+        if (s.fragments_received == 0) {
+            free_slot = &s;
+        } else if (s.sequence == sequence) {
+            slot = &s;
+            found = true;
+        } else if (oldest_slot->fragments_received != 0 &&
+                   (int32_t)(s.first_fragment_ms - oldest_slot->first_fragment_ms) < 0) {
+            oldest_slot = &s;
+        }
+    }
+    if (!found) {
+        if (free_slot->fragments_received != 0) {
+            // all slots are in use, give up on the oldest block
+            free_slot = oldest_slot;
+            memset(free_slot, 0, sizeof(*free_slot));
+            rtcm_buffer->incomplete++;
+        }
+        slot = free_slot;
+        slot->sequence = sequence;
+        slot->first_fragment_ms = now_ms;
+    } else if (slot->fragments_received & (1U << fragment)) {
+        // we already have this fragment
+        rtcm_buffer->duplicates++;
+        return;
     }
 
     // add this fragment
-    rtcm_buffer->sequence = sequence;
-    rtcm_buffer->fragments_received |= (1U << fragment);
+    slot->fragments_received |= (1U << fragment);
 
     // copy the data
-    memcpy(&rtcm_buffer->buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*(uint16_t)fragment], packet.data, packet.len);
+    memcpy(&slot->buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*(uint16_t)fragment], packet.data, packet.len);
 
     // when we get a fragment of less than max size then we know the
     // number of fragments. Note that this means if you want to send a
     // block of RTCM data of an exact multiple of the buffer size you
     // need to send a final packet of zero length
     if (packet.len < MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN) {
-        rtcm_buffer->fragment_count = fragment+1;
-        rtcm_buffer->total_length = (MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment) + packet.len;
-    } else if (rtcm_buffer->fragments_received == 0x0F) {
+        slot->fragment_count = fragment+1;
+        slot->total_length = (MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment) + packet.len;
+    } else if (slot->fragments_received == 0x0F) {
         // special case of 4 full fragments
-        rtcm_buffer->fragment_count = 4;
-        rtcm_buffer->total_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4;
+        slot->fragment_count = 4;
+        slot->total_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4;
     }
 
 
     // see if we have all fragments
-    if (rtcm_buffer->fragment_count != 0 &&
-        rtcm_buffer->fragments_received == (1U << rtcm_buffer->fragment_count) - 1) {
-        // we have them all, inject
-        inject_data(rtcm_buffer->buffer, rtcm_buffer->total_length);
-        memset(rtcm_buffer, 0, sizeof(*rtcm_buffer));
+    if (slot->fragment_count != 0 &&
+        slot->fragments_received == (1U << slot->fragment_count) - 1) {
+        // we have them all, inject unless it is a copy of a block already received on another link
+        const uint32_t crc = crc_crc32(0, slot->buffer, slot->total_length);
+        bool duplicate = false;
+        for (const auto &b : rtcm_buffer->injected) {
+            if (b.injected_ms != 0 &&
+                now_ms - b.injected_ms < GPS_RTCM_DUPLICATE_TIMEOUT_MS &&
+                b.sequence == sequence &&
+                b.length == slot->total_length &&
+                b.crc == crc) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate) {
+            rtcm_buffer->duplicates++;
+        } else {
+            inject_data(slot->buffer, slot->total_length);
+            auto &b = rtcm_buffer->injected[rtcm_buffer->injected_next];
+            b.crc = crc;
+            b.length = slot->total_length;
+            b.sequence = sequence;
+            b.injected_ms = now_ms;
+            rtcm_buffer->injected_next = (rtcm_buffer->injected_next + 1) % GPS_RTCM_INJECTED_HISTORY;
+        }
+        memset(slot, 0, sizeof(*slot));
     }
 }
 
@@ -1174,7 +1444,13 @@ bool AP_GPS::calc_blend_weights(void)
     memset(&_blend_weights, 0, sizeof(_blend_weights));
 
     // exit immediately if not enough receivers to do blending
-    if (state[0].status <= NO_FIX || state[1].status <= NO_FIX) {
+    uint8_t num_with_fix = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (state[i].status > NO_FIX) {
+            num_with_fix++;
+        }
+    }
+    if (num_with_fix < 2) {
         return false;
     }
 
@@ -1183,6 +1459,10 @@ bool AP_GPS::calc_blend_weights(void)
     uint32_t min_ms = -1; // oldest non-zero system time of arrival of a GPS message
     int16_t max_rate_ms = 0; // largest update interval of a GPS receiver
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (state[i].status <= NO_FIX) {
+            // receivers without a fix are not blended so can't hold up the others
+            continue;
+        }
         // Find largest and smallest times
         if (state[i].last_gps_time_ms > max_ms) {
             max_ms = state[i].last_gps_time_ms;
@@ -1324,9 +1604,133 @@ bool AP_GPS::calc_blend_weights(void)
         _blend_weights[i] = (hpos_blend_weights[i] + vpos_blend_weights[i] + spd_blend_weights[i]) / sum_of_all_weights;
     }
 
+    reject_blend_outliers();
+
     return true;
 }
 
+/*
+  remove receivers whose horizontal position is inconsistent with the
+  weighted average of the other receivers from the blend. Two receivers
+  that disagree can't tell which is wrong, so this needs at least three
+  receivers reporting their accuracy and never removes more than a
+  minority of them. Each receiver is compared against running sums over
+  all receivers less its own contribution so the cost grows linearly
+  with the number of receivers
+ */
+void AP_GPS::reject_blend_outliers(void)
+{
+    uint8_t num_tested = 0;
+    uint8_t ref_index = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (_blend_weights[i] > 0.0f && state[i].have_horizontal_accuracy && state[i].horizontal_accuracy > 0.0f) {
+            num_tested++;
+            ref_index = i;
+        }
+    }
+
+    uint8_t outlier_mask = 0;
+    uint8_t num_outliers = 0;
+    if (num_tested >= 3) {
+        // compare the receivers at the time the reference receiver's fix was valid
+        float ref_lag_sec;
+        get_lag(ref_index, ref_lag_sec);
+        const uint32_t ref_time_ms = state[ref_index].last_gps_time_ms - (uint32_t)(ref_lag_sec * 1000.0f);
+        Vector3f pos_ned[GPS_MAX_RECEIVERS];
+        calc_receiver_positions(state[ref_index].location, ref_time_ms, AP::ahrs().healthy(), pos_ned);
+
+        Vector2f pos_sum;
+        float weight_sum = 0.0f;
+        float accuracy_sum = 0.0f;
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            if (_blend_weights[i] > 0.0f && state[i].have_horizontal_accuracy && state[i].horizontal_accuracy > 0.0f) {
+                pos_sum += Vector2f(pos_ned[i].x, pos_ned[i].y) * _blend_weights[i];
+                weight_sum += _blend_weights[i];
+                accuracy_sum += state[i].horizontal_accuracy * _blend_weights[i];
+            }
+        }
+
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            if (_blend_weights[i] <= 0.0f || !state[i].have_horizontal_accuracy || state[i].horizontal_accuracy <= 0.0f) {
+                continue;
+            }
+            const float others_weight = weight_sum - _blend_weights[i];
+            if (others_weight <= 0.0f) {
+                continue;
+            }
+            const Vector2f pos(pos_ned[i].x, pos_ned[i].y);
+            const Vector2f others_pos = (pos_sum - pos * _blend_weights[i]) / others_weight;
+            const float others_accuracy = (accuracy_sum - state[i].horizontal_accuracy * _blend_weights[i]) / others_weight;
+            const float innovation_variance = sq(state[i].horizontal_accuracy) + sq(others_accuracy);
+            if ((pos - others_pos).length_squared() > sq(BLEND_OUTLIER_GATE) * innovation_variance) {
+                outlier_mask |= 1U<<i;
+                num_outliers++;
+            }
+        }
+
+        if (num_outliers * 2 >= num_tested) {
+            // the receivers don't agree on where we are, blend them all
+            outlier_mask = 0;
+            num_outliers = 0;
+        }
+    }
+
+    if (num_outliers > 0) {
+        float weight_sum = 0.0f;
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            if (outlier_mask & (1U<<i)) {
+                _blend_weights[i] = 0.0f;
+            }
+            weight_sum += _blend_weights[i];
+        }
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            _blend_weights[i] /= weight_sum;
+        }
+    }
+
+    const uint8_t new_outliers = outlier_mask & ~_blend_outlier_mask;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (new_outliers & (1U<<i)) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "GPS %u: inconsistent, not blended", (unsigned)(i + 1));
+        }
+    }
+    _blend_outlier_mask = outlier_mask;
+}
+
+/*
+  calculate the position of each receiver with a fix as a NED offset in
+  metres from ref. Receivers report fixes at different times and with
+  different lags, so each position is moved along its velocity to the
+  time ref_time_ms. If correct_antennas is true the antenna offsets are
+  rotated into earth frame and removed, giving the position of the body
+  frame origin from each receiver
+ */
+void AP_GPS::calc_receiver_positions(const Location &ref, uint32_t ref_time_ms, bool correct_antennas, Vector3f pos_ned[GPS_MAX_RECEIVERS]) const
+{
+    const Matrix3f &rotation = AP::ahrs().get_rotation_body_to_ned();
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        pos_ned[i].zero();
+        if (state[i].status < GPS_OK_FIX_2D) {
+            continue;
+        }
+        const Vector2f ne = location_diff(ref, state[i].location);
+        pos_ned[i] = Vector3f(ne.x, ne.y, (ref.alt - state[i].location.alt) * 0.01f);
+
+        float lag_sec;
+        get_lag(i, lag_sec);
+        const float dt = (int32_t)(ref_time_ms - state[i].last_gps_time_ms) * 0.001f + lag_sec;
+        Vector3f velocity = state[i].velocity;
+        if (!state[i].have_vertical_velocity) {
+            velocity.z = 0.0f;
+        }
+        pos_ned[i] += velocity * dt;
+
+        if (correct_antennas) {
+            pos_ned[i] -= rotation * _antenna_offset[i].get();
+        }
+    }
+}
+
 /*
  calculate a blended GPS state
 */
@@ -1358,6 +1762,12 @@ void AP_GPS::calc_blended_state(void)
     timing[GPS_BLENDED_INSTANCE].last_fix_time_ms = 0;
     timing[GPS_BLENDED_INSTANCE].last_message_time_ms = 0;
 
+    // when the attitude is known the receivers are blended at the body
+    // frame origin, otherwise at the weighted average antenna position
+    const bool correct_antennas = AP::ahrs().healthy();
+    const Matrix3f &rotation = AP::ahrs().get_rotation_body_to_ned();
+    const Vector3f &gyro = AP::ahrs().get_gyro();
+
     // combine the states into a blended solution
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         // use the highest status
@@ -1365,8 +1775,12 @@ void AP_GPS::calc_blended_state(void)
             state[GPS_BLENDED_INSTANCE].status = state[i].status;
         }
 
-        // calculate a blended average velocity
-        state[GPS_BLENDED_INSTANCE].velocity += state[i].velocity * _blend_weights[i];
+        // calculate a blended average velocity, removing the velocity of the antenna relative to the origin
+        Vector3f velocity = state[i].velocity;
+        if (correct_antennas) {
+            velocity -= rotation * (gyro % _antenna_offset[i].get());
+        }
+        state[GPS_BLENDED_INSTANCE].velocity += velocity * _blend_weights[i];
 
         // report the best valid accuracies and DOP metrics
 
@@ -1402,9 +1816,18 @@ void AP_GPS::calc_blended_state(void)
         }
 
         // report a blended average GPS antenna position
-        Vector3f temp_antenna_offset = _antenna_offset[i];
-        temp_antenna_offset *= _blend_weights[i];
-        _blended_antenna_offset += temp_antenna_offset;
+        if (!correct_antennas) {
+            Vector3f temp_antenna_offset = _antenna_offset[i];
+            temp_antenna_offset *= _blend_weights[i];
+            _blended_antenna_offset += temp_antenna_offset;
+        }
+
+        // blend the lag, the receivers are aligned to the time of the blended fix below
+        if (_blend_weights[i] > 0.0f) {
+            float gps_lag_sec = 0;
+            get_lag(i, gps_lag_sec);
+            _blended_lag_sec += gps_lag_sec * _blend_weights[i];
+        }
 
         // blend the timing data
         if (timing[i].last_fix_time_ms > timing[GPS_BLENDED_INSTANCE].last_fix_time_ms) {
@@ -1432,20 +1855,21 @@ void AP_GPS::calc_blended_state(void)
         }
     }
 
-    // Calculate the weighted sum of horizontal and vertical position offsets relative to the reference position
-    Vector2f blended_NE_offset_m;
-    float blended_alt_offset_cm = 0.0f;
-    blended_NE_offset_m.zero();
+    // Calculate the weighted sum of the receiver positions relative to the reference position, with each
+    // receiver moved to the time the blended fix is valid
+    const uint32_t blended_time_ms = state[GPS_BLENDED_INSTANCE].last_gps_time_ms - (uint32_t)(_blended_lag_sec * 1000.0f);
+    Vector3f pos_ned[GPS_MAX_RECEIVERS];
+    calc_receiver_positions(state[GPS_BLENDED_INSTANCE].location, blended_time_ms, correct_antennas, pos_ned);
+    Vector3f blended_pos_ned;
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-        if (_blend_weights[i] > 0.0f && i != best_index) {
-            blended_NE_offset_m += location_diff(state[GPS_BLENDED_INSTANCE].location, state[i].location) * _blend_weights[i];
-            blended_alt_offset_cm += (float)(state[i].location.alt - state[GPS_BLENDED_INSTANCE].location.alt) * _blend_weights[i];
+        if (_blend_weights[i] > 0.0f) {
+            blended_pos_ned += pos_ned[i] * _blend_weights[i];
         }
     }
 
     // Add the sum of weighted offsets to the reference location to obtain the blended location
-    state[GPS_BLENDED_INSTANCE].location.offset(blended_NE_offset_m.x, blended_NE_offset_m.y);
-    state[GPS_BLENDED_INSTANCE].location.alt += (int)blended_alt_offset_cm;
+    state[GPS_BLENDED_INSTANCE].location.offset(blended_pos_ned.x, blended_pos_ned.y);
+    state[GPS_BLENDED_INSTANCE].location.alt -= (int32_t)(blended_pos_ned.z * 100.0f);
 
     // Calculate ground speed and course from blended velocity vector
     state[GPS_BLENDED_INSTANCE].ground_speed = norm(state[GPS_BLENDED_INSTANCE].velocity.x, state[GPS_BLENDED_INSTANCE].velocity.y);
@@ -1519,16 +1943,13 @@ void AP_GPS::calc_blended_state(void)
         state[GPS_BLENDED_INSTANCE].time_week_ms = (uint32_t)temp_time_0;
     }
 
-    // calculate a blended value for the timing data and lag
+    // calculate a blended value for the timing data
     double temp_time_1 = 0.0;
     double temp_time_2 = 0.0;
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (_blend_weights[i] > 0.0f) {
             temp_time_1 += (double)timing[i].last_fix_time_ms * (double) _blend_weights[i];
             temp_time_2 += (double)timing[i].last_message_time_ms * (double)_blend_weights[i];
-            float gps_lag_sec = 0;
-            get_lag(i, gps_lag_sec);
-            _blended_lag_sec += gps_lag_sec * _blend_weights[i];
         }
     }
     timing[GPS_BLENDED_INSTANCE].last_fix_time_ms = (uint32_t)temp_time_1;
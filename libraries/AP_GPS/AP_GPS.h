@@ -24,19 +24,29 @@
 #include "GPS_detect_state.h"
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_RTC/AP_RTC.h>
+#include <AP_HAL/utility/RingBuffer.h>
 
 /**
    maximum number of GPS instances available on this platform. If more
-   than 1 then redundant sensors may be available
+   than 1 then redundant sensors may be available. Boards for vehicles
+   with more receivers can raise this to 4
  */
+#ifndef GPS_MAX_RECEIVERS
 #define GPS_MAX_RECEIVERS 2 // maximum number of physical GPS sensors allowed - does not include virtual GPS created by blending receiver data
+#endif
 #define GPS_MAX_INSTANCES  (GPS_MAX_RECEIVERS + 1) // maximum number of GPS instances including the 'virtual' GPS created by blending receiver data
-#define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS  // the virtual blended GPS is always the highest instance (2)
+#define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS  // the virtual blended GPS is always the highest instance
 #define GPS_RTK_INJECT_TO_ALL 127
 #define GPS_MAX_RATE_MS 200 // maximum value of rate_ms (i.e. slowest update rate) is 5hz or 200ms
 #define GPS_UNKNOWN_DOP UINT16_MAX // set unknown DOP's to maximum value, which is also correct for MAVLink
 #define GPS_WORST_LAG_SEC 0.22f // worst lag value any GPS driver is expected to return, expressed in seconds
 #define GPS_MAX_DELTA_MS 245 // 200 ms (5Hz) + 45 ms buffer
+#define GPS_RTCM_SLOTS 4 // number of fragmented RTCM blocks that can be re-assembled at once
+#define GPS_RTCM_FRAGMENT_TIMEOUT_MS 1000 // partly re-assembled RTCM blocks older than this are discarded
+#define GPS_RTCM_INJECTED_HISTORY 8 // number of recently injected RTCM blocks remembered to detect copies
+#define GPS_RTCM_DUPLICATE_TIMEOUT_MS 500 // a block matching one injected within this time is a copy from another link
+#define GPS_RTCM_QUEUE_SIZE 2048 // bytes of RTCM data that can be queued for each receiver
+#define GPS_RTCM_QUEUE_BLOCKS 16 // RTCM blocks that can be queued for each receiver
 
 // the number of GPS leap seconds
 #define GPS_LEAPSECONDS_MILLIS 18000ULL
@@ -519,27 +529,77 @@ private:
               2 bits for fragment number
               5 bits for sequence number
 
-      The rtcm_buffer is allocated on first use. Once a block of data
-      is successfully reassembled it is injected into all active GPS
-      backends. This assumes we don't want more than 4*180=720 bytes
-      in a RTCM data block
+      The rtcm_buffer is allocated on first use. Fragments of up to
+      GPS_RTCM_SLOTS blocks can be re-assembled at once so that blocks
+      sent back to back, or over more than one link, can interleave.
+      Once a block of data is successfully reassembled it is queued
+      for all active GPS backends. This assumes we don't want more than
+      4*180=720 bytes in a RTCM data block
+
+      A block with the same sequence number, length and CRC as one
+      injected within GPS_RTCM_DUPLICATE_TIMEOUT_MS is a copy received
+      on another link and is dropped. The sequence number alone can't
+      be used as it wraps every 32 blocks
      */
     struct rtcm_buffer {
-        uint8_t fragments_received;
-        uint8_t sequence;
-        uint8_t fragment_count;
-        uint16_t total_length;
-        uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
+        struct {
+            uint8_t fragments_received;
+            uint8_t sequence;
+            uint8_t fragment_count;
+            uint16_t total_length;
+            uint32_t first_fragment_ms;
+            uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
+        } slot[GPS_RTCM_SLOTS];
+        struct {
+            uint32_t crc;
+            uint16_t length;
+            uint8_t sequence;
+            uint32_t injected_ms;
+        } injected[GPS_RTCM_INJECTED_HISTORY]; // recently injected blocks
+        uint8_t injected_next;      // next entry of injected to replace
+        uint32_t fragments;         // fragments received
+        uint32_t duplicates;        // fragments and blocks ignored as they had already been received
+        uint32_t incomplete;        // blocks discarded before all their fragments arrived
     } *rtcm_buffer;
 
     // re-assemble GPS_RTCM_DATA message
     void handle_gps_rtcm_data(const mavlink_message_t *msg);
     void handle_gps_inject(const mavlink_message_t *msg);
 
+    // a block of RTCM data in a receiver's queue
+    struct rtcm_block {
+        uint32_t end;               // value of bytes_queued after the block was queued
+        uint32_t queued_ms;         // time the block was queued
+    };
+
+    /*
+      queue of RTCM data for a receiver. Data is queued a whole block at
+      a time and written to the receiver as space becomes available in
+      its UART, so blocks are either delivered intact or dropped
+     */
+    struct rtcm_queue {
+        rtcm_queue() : data(GPS_RTCM_QUEUE_SIZE), blocks(GPS_RTCM_QUEUE_BLOCKS) {}
+        ByteBuffer data;
+        ObjectBuffer<rtcm_block> blocks;
+        uint32_t bytes_queued;
+        uint32_t bytes_written;
+        uint32_t blocks_written;
+        uint32_t blocks_dropped;    // blocks that didn't fit in the queue
+        uint32_t latency_max_ms;    // longest time from queueing a block to writing its last byte
+        float latency_avg_ms;       // filtered time from queueing a block to writing its last byte
+        uint32_t last_log_ms;
+    } *rtcm_queues[GPS_MAX_RECEIVERS];
+
     //Inject a packet of raw binary to a GPS
     void inject_data(uint8_t *data, uint16_t len);
     void inject_data(uint8_t instance, uint8_t *data, uint16_t len);
 
+    // write queued RTCM data to the receivers
+    void update_injection(void);
+
+    // log the RTCM injection statistics for a receiver
+    void log_injection(uint8_t instance, const rtcm_queue &queue) const;
+
 
     // GPS blending and switching
     Vector2f _NE_pos_offset_m[GPS_MAX_RECEIVERS]; // Filtered North,East position offset from GPS instance to blended solution in _output_state.location (m)
@@ -547,6 +607,7 @@ private:
     Vector3f _blended_antenna_offset; // blended antenna offset
     float _blended_lag_sec = 0.001f * GPS_MAX_RATE_MS; // blended receiver lag in seconds
     float _blend_weights[GPS_MAX_RECEIVERS]; // blend weight for each GPS. The blend weights must sum to 1.0 across all instances.
+    uint8_t _blend_outlier_mask; // receivers removed from the blend because they are inconsistent with the others
     uint32_t _last_time_updated[GPS_MAX_RECEIVERS]; // the last value of state.last_gps_time_ms read for that GPS instance - used to detect new data.
     float _omega_lpf; // cutoff frequency in rad/sec of LPF applied to position offsets
     bool _output_is_blended; // true when a blended GPS solution being output
@@ -555,6 +616,12 @@ private:
     // calculate the blend weight.  Returns true if blend could be calculated, false if not
     bool calc_blend_weights(void);
 
+    // remove receivers that are inconsistent with the others from the blend
+    void reject_blend_outliers(void);
+
+    // calculate the NED position in metres of each receiver relative to ref, moved to the time ref_time_ms
+    void calc_receiver_positions(const Location &ref, uint32_t ref_time_ms, bool correct_antennas, Vector3f pos_ned[GPS_MAX_RECEIVERS]) const;
+
     // calculate the blended state
     void calc_blended_state(void);
 
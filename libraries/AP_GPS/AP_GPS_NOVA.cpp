@@ -284,7 +284,7 @@ AP_GPS_NOVA::process_message(void)
 void
 AP_GPS_NOVA::inject_data(const uint8_t *data, uint16_t len)
 {
-    if (port->txspace() > len) {
+    if (port->txspace() >= len) {
         last_injected_data_ms = AP_HAL::millis();
         port->write(data, len);
     } else {
@@ -80,7 +80,7 @@ void
 AP_GPS_SBP::inject_data(const uint8_t *data, uint16_t len)
 {
 
-    if (port->txspace() > len) {
+    if (port->txspace() >= len) {
         last_injected_data_ms = AP_HAL::millis();
         port->write(data, len);
     } else {
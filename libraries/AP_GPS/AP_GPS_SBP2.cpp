@@ -83,7 +83,7 @@ AP_GPS_SBP2::read(void)
 void
 AP_GPS_SBP2::inject_data(const uint8_t *data, uint16_t len)
 {
-    if (port->txspace() > len) {
+    if (port->txspace() >= len) {
         last_injected_data_ms = AP_HAL::millis();
         port->write(data, len);
     } else {
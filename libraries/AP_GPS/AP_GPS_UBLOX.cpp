@@ -340,8 +340,6 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
-    uint8_t data;
-    int16_t numc;
     bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
@@ -370,111 +368,244 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    numc = port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        data = port->read();
-
-	reset:
-        switch(_step) {
+    // process received bytes. Where the HAL supports it we parse
+    // directly from the UART receive buffer rather than making a
+    // read() call per byte
+    const uint32_t numc = port->available();
+    uint32_t count = 0;
+    bool use_span = true;
+    while (count < numc) {
+        uint32_t len;
+        const uint8_t *span = use_span ? port->peek_rx(len) : nullptr;
+        if (span != nullptr) {
+            len = MIN(len, numc - count);
+            if (_parse_span(span, len)) {
+                parsed = true;
+            }
+            if (!port->consume_rx(len)) {
+                // the port was locked after the span was peeked,
+                // carry on a byte at a time as read() honours the lock
+                use_span = false;
+            }
+            count += len;
+        } else {
+            const int16_t c = port->read();
+            if (c < 0) {
+                break;
+            }
+            if (_parse_byte((uint8_t)c)) {
+                parsed = true;
+            }
+            count++;
+        }
+    }
+    return parsed;
+}
 
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
+/*
+  parse a span of received bytes. Frames that lie entirely within the
+  span are checked and dispatched in place, anything that is split
+  across spans goes through the byte at a time state machine with the
+  payload copied in bulk. Returns true if a navigation message was
+  parsed
+ */
+bool
+AP_GPS_UBLOX::_parse_span(const uint8_t *buf, uint32_t len)
+{
+    bool parsed = false;
+    uint32_t i = 0;
+    while (i < len) {
+        if (_step == 0) {
+            // between frames skip straight to the next preamble
+            const uint8_t *preamble = (const uint8_t *)memchr(&buf[i], PREAMBLE1, len - i);
+            if (preamble == nullptr) {
                 break;
             }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-            FALLTHROUGH;
-        case 0:
-            if(PREAMBLE1 == data)
+            i = preamble - buf;
+            uint32_t frame_len;
+            if (_parse_frame(&buf[i], len - i, frame_len, parsed)) {
+                i += frame_len;
+                continue;
+            }
+        } else if (_step == 6) {
+            // payload, copy as much as we have in one go
+            const uint32_t n = MIN(len - i, uint32_t(_payload_length - _payload_counter));
+            for (uint32_t j = 0; j < n; j++) {
+                _ck_b += (_ck_a += buf[i+j]);
+            }
+            memcpy(&_buffer[_payload_counter], &buf[i], n);
+            _payload_counter += n;
+            i += n;
+            if (_payload_counter == _payload_length) {
                 _step++;
-            break;
+            }
+            continue;
+        }
+        if (_parse_byte(buf[i++])) {
+            parsed = true;
+        }
+    }
+    return parsed;
+}
 
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                       // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
+/*
+  check and dispatch a frame starting at the preamble in place. Returns
+  false if the frame is not complete in the buffer or is not valid, in
+  which case it is left to the state machine
+ */
+bool
+AP_GPS_UBLOX::_parse_frame(const uint8_t *frame, uint32_t len, uint32_t &frame_len, bool &parsed)
+{
+    // preamble, class, id and length, then the payload and two checksum bytes
+    const uint8_t header_len = 6;
+    if (len < header_len + 2 || frame[1] != PREAMBLE2) {
+        return false;
+    }
+    const uint16_t payload_length = frame[4] | (frame[5] << 8);
+    frame_len = header_len + payload_length + 2;
+    if (frame_len > len) {
+        return false;
+    }
+
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint32_t j = 2; j < uint32_t(header_len + payload_length); j++) {
+        ck_b += (ck_a += frame[j]);
+    }
+    if (ck_a != frame[frame_len-2] || ck_b != frame[frame_len-1]) {
+        return false;
+    }
+
+    _class = frame[2];
+    _msg_id = frame[3];
+    const uint8_t *payload = &frame[header_len];
+
+#if UBLOX_RXM_RAW_LOGGING
+    if (_class == CLASS_RXM && _msg_id == MSG_RXM_RAWX && gps._raw_data != 0) {
+        // stream raw measurements to the log straight from the receive
+        // buffer, this also allows more than UBLOX_MAX_RXM_RAWX_SATS
+        log_rxm_rawx(payload, payload_length);
+        return true;
+    }
+#endif // UBLOX_RXM_RAW_LOGGING
+
+    if (payload_length > sizeof(_buffer)) {
+        Debug("large payload %u", (unsigned)payload_length);
+        return true;
+    }
+    memcpy(&_buffer, payload, payload_length);
+    _payload_length = payload_length;
+    if (_parse_gps()) {
+        parsed = true;
+    }
+    return true;
+}
+
+/*
+  run one byte through the state machine, returns true if a navigation
+  message was parsed
+ */
+bool
+AP_GPS_UBLOX::_parse_byte(uint8_t data)
+{
+reset:
+    switch(_step) {
+
+    // Message preamble detection
+    //
+    // If we fail to match any of the expected bytes, we reset
+    // the state machine and re-consider the failed byte as
+    // the first byte of the preamble.  This improves our
+    // chances of recovering from a mismatch and makes it less
+    // likely that we will be fooled by the preamble appearing
+    // as data in some other message.
+    //
+    case 1:
+        if (PREAMBLE2 == data) {
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                     // payload length low byte
             break;
-        case 5:
+        }
+        _step = 0;
+        Debug("reset %u", __LINE__);
+        FALLTHROUGH;
+    case 0:
+        if(PREAMBLE1 == data)
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-
-            _payload_length += (uint16_t)(data<<8);
-            if (_payload_length > sizeof(_buffer)) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume any payload bigger then what we know about is noise
-                _payload_length = 0;
-                _step = 0;
-				goto reset;
-            }
-            _payload_counter = 0;                       // prepare to receive payload
-            break;
+        break;
 
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
-            break;
+    // Message header processing
+    //
+    // We sniff the class and message ID to decide whether we
+    // are going to gather the message bytes or just discard
+    // them.
+    //
+    // We always collect the length so that we can avoid being
+    // fooled by preamble bytes in messages.
+    //
+    case 2:
+        _step++;
+        _class = data;
+        _ck_b = _ck_a = data;                       // reset the checksum accumulators
+        break;
+    case 3:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _msg_id = data;
+        break;
+    case 4:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _payload_length = data;                     // payload length low byte
+        break;
+    case 5:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+
+        _payload_length += (uint16_t)(data<<8);
+        if (_payload_length > sizeof(_buffer)) {
+            Debug("large payload %u", (unsigned)_payload_length);
+            // assume any payload bigger then what we know about is noise
+            _payload_length = 0;
+            _step = 0;
+            goto reset;
+        }
+        _payload_counter = 0;                       // prepare to receive payload
+        if (_payload_length == 0) {
+            // no payload, go straight to the checksum
+            _step++;
+        }
+        break;
 
-        // Checksum and message processing
-        //
-        case 7:
+    // Receive message data
+    //
+    case 6:
+        _ck_b += (_ck_a += data);                   // checksum byte
+        if (_payload_counter < sizeof(_buffer)) {
+            _buffer[_payload_counter] = data;
+        }
+        if (++_payload_counter == _payload_length)
             _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
-                _step = 0;
-				goto reset;
-            }
-            break;
-        case 8:
-            _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
-                break;                                                  // bad checksum
-            }
+        break;
 
-            if (_parse_gps()) {
-                parsed = true;
-            }
-            break;
+    // Checksum and message processing
+    //
+    case 7:
+        _step++;
+        if (_ck_a != data) {
+            Debug("bad cka %x should be %x", data, _ck_a);
+            _step = 0;
+            goto reset;
+        }
+        break;
+    case 8:
+        _step = 0;
+        if (_ck_b != data) {
+            Debug("bad ckb %x should be %x", data, _ck_b);
+            break;                                                  // bad checksum
         }
+
+        return _parse_gps();
     }
-    return parsed;
+    return false;
 }
 
 // Private Methods /////////////////////////////////////////////////////////////
@@ -547,11 +678,19 @@ void AP_GPS_UBLOX::log_rxm_raw(const struct ubx_rxm_raw &raw)
     }
 }
 
-void AP_GPS_UBLOX::log_rxm_rawx(const struct ubx_rxm_rawx &raw)
+/*
+  log a RXM-RAWX message from its payload, which may be in the UART
+  receive buffer rather than _buffer and so may hold more measurements
+  than ubx_rxm_rawx has room for
+ */
+void AP_GPS_UBLOX::log_rxm_rawx(const uint8_t *payload, uint16_t payload_length)
 {
-    if (!should_df_log()) {
+    const uint16_t header_length = offsetof(struct ubx_rxm_rawx, svinfo);
+    if (!should_df_log() || payload_length < header_length) {
         return;
     }
+    const struct ubx_rxm_rawx &raw = *(const struct ubx_rxm_rawx *)payload;
+    const uint8_t num_meas = MIN(raw.numMeas, (payload_length - header_length) / sizeof(ubx_rxm_rawx::ubx_rxm_rawx_sv));
 
     uint64_t now = AP_HAL::micros64();
 
@@ -566,22 +705,23 @@ void AP_GPS_UBLOX::log_rxm_rawx(const struct ubx_rxm_rawx &raw)
     };
     AP::logger().WriteBlock(&header, sizeof(header));
 
-    for (uint8_t i=0; i<raw.numMeas; i++) {
+    for (uint8_t i=0; i<num_meas; i++) {
+        const ubx_rxm_rawx::ubx_rxm_rawx_sv &sv = ((const ubx_rxm_rawx::ubx_rxm_rawx_sv *)&payload[header_length])[i];
         struct log_GPS_RAWS pkt = {
             LOG_PACKET_HEADER_INIT(LOG_GPS_RAWS_MSG),
             time_us    : now,
-            prMes      : raw.svinfo[i].prMes,
-            cpMes      : raw.svinfo[i].cpMes,
-            doMes      : raw.svinfo[i].doMes,
-            gnssId     : raw.svinfo[i].gnssId,
-            svId       : raw.svinfo[i].svId,
-            freqId     : raw.svinfo[i].freqId,
-            locktime   : raw.svinfo[i].locktime,
-            cno        : raw.svinfo[i].cno,
-            prStdev    : raw.svinfo[i].prStdev,
-            cpStdev    : raw.svinfo[i].cpStdev,
-            doStdev    : raw.svinfo[i].doStdev,
-            trkStat    : raw.svinfo[i].trkStat
+            prMes      : sv.prMes,
+            cpMes      : sv.cpMes,
+            doMes      : sv.doMes,
+            gnssId     : sv.gnssId,
+            svId       : sv.svId,
+            freqId     : sv.freqId,
+            locktime   : sv.locktime,
+            cno        : sv.cno,
+            prStdev    : sv.prStdev,
+            cpStdev    : sv.cpStdev,
+            doStdev    : sv.doStdev,
+            trkStat    : sv.trkStat
         };
         AP::logger().WriteBlock(&pkt, sizeof(pkt));
     }
@@ -866,7 +1006,7 @@ AP_GPS_UBLOX::_parse_gps(void)
         log_rxm_raw(_buffer.rxm_raw);
         return false;
     } else if (_class == CLASS_RXM && _msg_id == MSG_RXM_RAWX && gps._raw_data != 0) {
-        log_rxm_rawx(_buffer.rxm_rawx);
+        log_rxm_rawx((const uint8_t *)&_buffer, _payload_length);
         return false;
     }
 #endif // UBLOX_RXM_RAW_LOGGING
@@ -556,6 +556,9 @@ private:
 
     // Buffer parse & GPS state update
     bool        _parse_gps();
+    bool        _parse_span(const uint8_t *buf, uint32_t len);
+    bool        _parse_frame(const uint8_t *frame, uint32_t len, uint32_t &frame_len, bool &parsed);
+    bool        _parse_byte(uint8_t data);
 
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix;
@@ -584,7 +587,7 @@ private:
     void log_mon_hw(void);
     void log_mon_hw2(void);
     void log_rxm_raw(const struct ubx_rxm_raw &raw);
-    void log_rxm_rawx(const struct ubx_rxm_rawx &raw);
+    void log_rxm_rawx(const uint8_t *payload, uint16_t payload_length);
 
     // Calculates the correct log message ID based on what GPS instance is being logged
     uint8_t _ubx_msg_log_index(uint8_t ubx_msg) {
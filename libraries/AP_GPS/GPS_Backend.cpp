@@ -128,7 +128,7 @@ AP_GPS_Backend::inject_data(const uint8_t *data, uint16_t len)
 {
     // not all backends have valid ports
     if (port != nullptr) {
-        if (port->txspace() > len) {
+        if (port->txspace() >= len) {
             port->write(data, len);
         } else {
             Debug("GPS %d: Not enough TXSPACE", state.instance + 1);
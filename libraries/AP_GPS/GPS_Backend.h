@@ -44,6 +44,12 @@ public:
 
     virtual void inject_data(const uint8_t *data, uint16_t len);
 
+    // true if the receiver can be sent correction data
+    virtual bool accepts_injection(void) const { return port != nullptr; }
+
+    // bytes of correction data that can be injected without blocking
+    virtual uint32_t inject_space(void) const { return port != nullptr ? port->txspace() : 0; }
+
     //MAVLink methods
     virtual bool supports_mavlink_gps_rtk_message() { return false; }
     virtual void send_mavlink_gps_rtk(mavlink_channel_t chan);
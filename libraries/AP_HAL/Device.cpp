@@ -108,3 +108,17 @@ bool AP_HAL::Device::check_next_register(void)
     _checked.next = (_checked.next+1) % _checked.n_set;
     return true;
 }
+
+/*
+  default batch transfer, one bus transaction per element
+ */
+bool AP_HAL::Device::transfer_batch(BatchTransfer *xfers, uint8_t count)
+{
+    for (uint8_t i=0; i<count; i++) {
+        if (!transfer(xfers[i].send, xfers[i].send_len,
+                      xfers[i].recv, xfers[i].recv_len)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -103,6 +103,46 @@ public:
     virtual bool transfer(const uint8_t *send, uint32_t send_len,
                           uint8_t *recv, uint32_t recv_len) = 0;
 
+    /*
+     * A single transaction within a batch submitted with
+     * #transfer_batch(). Each element is equivalent to one call to
+     * #transfer(), with chip select (or an I2C stop) between elements.
+     */
+    struct BatchTransfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+        // storage for the register address when filled by #setup_batch_read()
+        uint8_t reg;
+    };
+
+    /*
+     * Perform a sequence of transactions as one submission to the bus
+     * driver. Backends that can queue several transactions (eg. a
+     * single SPI_IOC_MESSAGE() on Linux or one DMA allocation on
+     * ChibiOS) override this to save the per-transaction overhead. The
+     * default implementation calls #transfer() for each element.
+     *
+     * Return: true if all transfers succeeded, false on failure.
+     */
+    virtual bool transfer_batch(BatchTransfer *xfers, uint8_t count);
+
+    /*
+     * Fill in a batch element to read recv_len registers starting at
+     * first_reg, applying the read flag in the same way as
+     * #read_registers().
+     */
+    void setup_batch_read(BatchTransfer &xfer, uint8_t first_reg,
+                          uint8_t *recv, uint32_t recv_len)
+    {
+        xfer.reg = first_reg | _read_flag;
+        xfer.send = &xfer.reg;
+        xfer.send_len = 1;
+        xfer.recv = recv;
+        xfer.recv_len = recv_len;
+    }
+
     /**
      * Wrapper function over #transfer() to read recv_len registers, starting
      * by first_reg, into the array pointed by recv. The read flag passed to
@@ -4,6 +4,7 @@
 
 #include "AP_HAL_Namespace.h"
 #include "utility/BetterStream.h"
+#include "utility/RingBuffer.h"
 
 /* Pure virtual UARTDriver class */
 class AP_HAL::UARTDriver : public AP_HAL::BetterStream {
@@ -72,6 +73,40 @@ public:
      */
     virtual bool set_unbuffered_writes(bool on){ return false; };
 
+    /*
+      return a pointer to the next contiguous span of received bytes
+      without copying them out of the receive buffer. len is set to
+      the number of bytes in the span, which may be less than
+      available() if the buffer has wrapped. The bytes stay in the
+      buffer until consume_rx() is called. Returns nullptr if the
+      driver does not support direct access or has no data
+     */
+    virtual const uint8_t *peek_rx(uint32_t &len) { len = 0; return nullptr; }
+
+    /*
+      discard n bytes from the start of the receive buffer, normally
+      after processing a span returned by peek_rx()
+     */
+    virtual bool consume_rx(uint32_t n) { return false; }
+
+    /*
+      reserve len bytes in the transmit buffer so the caller can
+      serialise directly into it. On success vec is filled with one or
+      two regions (two if the ring buffer wraps) totalling len bytes
+      and the number of regions is returned. The port is held for
+      writing until commit_tx() is called, which must happen without
+      any other write to the port in between. Returns 0 if the driver
+      does not support reservations, the port is busy or there is not
+      enough space
+     */
+    virtual uint8_t reserve_tx(ByteBuffer::IoVec vec[2], uint32_t len) { return 0; }
+
+    /*
+      release a reservation made with reserve_tx(), queueing the first
+      len bytes of it for transmission
+     */
+    virtual void commit_tx(uint32_t len) {}
+
     /*
       wait for at least n bytes of incoming data, with timeout in
       milliseconds. Return true if n bytes are available, false if
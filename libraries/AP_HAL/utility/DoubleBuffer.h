@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/*
+  lock-free double buffer for passing an object from one writer thread
+  to one reader thread
+
+  The writer fills the slot not currently published and then publishes
+  it by incrementing the sequence number, so it never waits for the
+  reader.  The reader copies the published slot and checks that the
+  sequence number did not change while it was copying; if it did the
+  writer may have started on the slot being read and the copy is
+  retried.  This suits small objects written at a lower rate than they
+  are read, such as targets from the main loop to a fast thread.
+ */
+template <class T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() : _seq(0) {}
+
+    // publish a new object, only one thread may write
+    void write(const T &object) {
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _slot[(seq + 1) & 1] = object;
+        _seq.store(seq + 1, std::memory_order_release);
+    }
+
+    // copy the latest object, returns false if nothing has been written
+    bool read(T &object) const {
+        uint32_t seq = _seq.load(std::memory_order_acquire);
+        while (true) {
+            if (seq == 0) {
+                return false;
+            }
+            object = _slot[seq & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t seq2 = _seq.load(std::memory_order_relaxed);
+            if (seq2 == seq) {
+                return true;
+            }
+            seq = seq2;
+        }
+    }
+
+    // number of objects written, lets the reader see if anything is new
+    uint32_t sequence(void) const {
+        return _seq.load(std::memory_order_acquire);
+    }
+
+private:
+    T _slot[2];
+    std::atomic<uint32_t> _seq;
+};
@@ -0,0 +1,72 @@
+#include <AP_gtest.h>
+
+#include <thread>
+#include <AP_HAL/utility/DoubleBuffer.h>
+
+struct Sample {
+    uint32_t a;
+    uint32_t b[7];
+};
+
+TEST(DoubleBufferTest, Empty)
+{
+    DoubleBuffer<Sample> buf;
+    Sample s;
+
+    EXPECT_FALSE(buf.read(s));
+    EXPECT_EQ(0U, buf.sequence());
+}
+
+TEST(DoubleBufferTest, LatestWins)
+{
+    DoubleBuffer<Sample> buf;
+    Sample s {};
+
+    for (uint32_t i = 1; i < 5; i++) {
+        s.a = i;
+        buf.write(s);
+        EXPECT_EQ(i, buf.sequence());
+    }
+
+    Sample out;
+    EXPECT_TRUE(buf.read(out));
+    EXPECT_EQ(4U, out.a);
+
+    // reading does not consume
+    EXPECT_TRUE(buf.read(out));
+    EXPECT_EQ(4U, out.a);
+}
+
+TEST(DoubleBufferTest, NoTornReads)
+{
+    DoubleBuffer<Sample> buf;
+    const uint32_t count = 200000;
+
+    std::thread writer([&buf]() {
+        Sample s;
+        for (uint32_t i = 1; i <= count; i++) {
+            s.a = i;
+            for (uint8_t j = 0; j < 7; j++) {
+                s.b[j] = i;
+            }
+            buf.write(s);
+        }
+    });
+
+    uint32_t last = 0;
+    while (last < count) {
+        Sample s;
+        if (!buf.read(s)) {
+            continue;
+        }
+        for (uint8_t j = 0; j < 7; j++) {
+            ASSERT_EQ(s.a, s.b[j]);
+        }
+        ASSERT_GE(s.a, last);
+        last = s.a;
+    }
+
+    writer.join();
+}
+
+AP_GTEST_MAIN()
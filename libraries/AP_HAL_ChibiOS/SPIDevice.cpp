@@ -174,7 +174,16 @@ void SPIDevice::do_transfer(const uint8_t *send, uint8_t *recv, uint32_t len)
         return;
     }
 
+    do_exchange(send, recv, len);
 
+    set_chip_select(old_cs_forced);
+}
+
+/*
+  exchange data with the bus already acquired and chip select asserted
+ */
+void SPIDevice::do_exchange(const uint8_t *send, uint8_t *recv, uint32_t len)
+{
 #if defined(HAL_SPI_USE_POLLED)
     for (uint16_t i=0; i<len; i++) {
         uint8_t ret = spiPolledExchange(spi_devices[device_desc.bus].driver, send?send[i]:0);
@@ -193,8 +202,6 @@ void SPIDevice::do_transfer(const uint8_t *send, uint8_t *recv, uint32_t len)
     }
     bus.bouncebuffer_finish(send, recv, len);
 #endif
-
-    set_chip_select(old_cs_forced);
 }
 
 bool SPIDevice::clock_pulse(uint32_t n)
@@ -269,6 +276,52 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     return true;
 }
 
+/*
+  perform a batch of transfers with a single DMA allocation and
+  peripheral setup, toggling chip select between elements
+ */
+bool SPIDevice::transfer_batch(AP_HAL::Device::BatchTransfer *xfers, uint8_t count)
+{
+    if (!bus.semaphore.check_owner()) {
+        hal.console->printf("SPI: not owner of 0x%x\n", unsigned(get_bus_id()));
+        return false;
+    }
+    if (cs_forced) {
+        // the caller is managing chip select, so the elements can't
+        // be separated
+        return AP_HAL::SPIDevice::transfer_batch(xfers, count);
+    }
+
+    SPIDriver *spi = spi_devices[device_desc.bus].driver;
+    acquire_bus(true, true);
+    for (uint8_t i=0; i<count; i++) {
+        const uint8_t *send = xfers[i].send;
+        uint32_t send_len = xfers[i].send_len;
+        uint8_t *recv = xfers[i].recv;
+        uint32_t recv_len = xfers[i].recv_len;
+
+        spiSelectI(spi);
+        if ((send_len == recv_len && send == recv) || !send || !recv) {
+            do_exchange(send, recv, recv_len?recv_len:send_len);
+        } else {
+            uint8_t buf[send_len+recv_len];
+            if (send_len > 0) {
+                memcpy(buf, send, send_len);
+            }
+            if (recv_len > 0) {
+                memset(&buf[send_len], 0, recv_len);
+            }
+            do_exchange(buf, buf, send_len+recv_len);
+            if (recv_len > 0) {
+                memcpy(recv, &buf[send_len], recv_len);
+            }
+        }
+        spiUnselectI(spi);
+    }
+    acquire_bus(false, true);
+    return true;
+}
+
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv, uint32_t len)
 {
     bus.semaphore.assert_owner();
@@ -85,6 +85,9 @@ public:
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
 
+    /* See AP_HAL::Device::transfer_batch() */
+    bool transfer_batch(AP_HAL::Device::BatchTransfer *xfers, uint8_t count) override;
+
     /* 
      *  send N bytes of clock pulses without taking CS. This is used
      *  when initialising microSD interfaces over SPI
@@ -124,6 +127,7 @@ private:
     uint32_t freq_flag_high;
     char *pname;
     bool cs_forced;
+    void do_exchange(const uint8_t *send, uint8_t *recv, uint32_t len);
     static void *spi_thread(void *arg);
     static uint32_t derive_freq_flag_bus(uint8_t busid, uint32_t _frequency);
     uint32_t derive_freq_flag(uint32_t _frequency);
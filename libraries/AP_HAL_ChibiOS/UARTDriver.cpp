@@ -540,6 +540,45 @@ int16_t UARTDriver::read_locked(uint32_t key)
     return byte;
 }
 
+/*
+  return a contiguous span of received bytes without copying
+ */
+const uint8_t *UARTDriver::peek_rx(uint32_t &len)
+{
+    len = 0;
+    if (lock_read_key != 0 || _uart_owner_thd != chThdGetSelfX()){
+        return nullptr;
+    }
+    if (!_initialised) {
+        return nullptr;
+    }
+    const uint8_t *ptr = _readbuf.readptr(len);
+    if (len == 0) {
+        return nullptr;
+    }
+    return ptr;
+}
+
+/*
+  discard bytes previously returned by peek_rx()
+ */
+bool UARTDriver::consume_rx(uint32_t n)
+{
+    if (lock_read_key != 0 || _uart_owner_thd != chThdGetSelfX()){
+        return false;
+    }
+    if (!_initialised) {
+        return false;
+    }
+    if (!_readbuf.advance(n)) {
+        return false;
+    }
+    if (!_rts_is_active) {
+        update_rts_line();
+    }
+    return true;
+}
+
 /* Empty implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -598,6 +637,37 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
     return ret;
 }
 
+/*
+  reserve space in the write buffer for the caller to fill. The write
+  mutex is held until commit_tx()
+ */
+uint8_t UARTDriver::reserve_tx(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (!_initialised || lock_write_key != 0 || len == 0) {
+        return 0;
+    }
+    if (!_write_mutex.take_nonblocking()) {
+        return 0;
+    }
+    if (_writebuf.space() < len) {
+        _write_mutex.give();
+        return 0;
+    }
+    return _writebuf.reserve(vec, len);
+}
+
+/*
+  queue bytes written into a reservation and release the write mutex
+ */
+void UARTDriver::commit_tx(uint32_t len)
+{
+    _writebuf.commit(len);
+    if (unbuffered_writes) {
+        write_pending_bytes();
+    }
+    _write_mutex.give();
+}
+
 /*
   lock the uart for exclusive use by write_locked() and read_locked() with the right key
  */
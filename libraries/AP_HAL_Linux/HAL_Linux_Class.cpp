@@ -250,6 +250,9 @@ void _usage(void)
     printf("\tcustom log path:\n");
     printf("\t                  --log-directory /var/APM/logs\n");
     printf("\t                  -l /var/APM/logs\n");
+    printf("\tthread cpu affinity and priority configuration:\n");
+    printf("\t                   --thread-config /etc/ardupilot/threads.conf\n");
+    printf("\t                   -T /etc/ardupilot/threads.conf\n");
     printf("\tcustom terrain path:\n");
     printf("\t                   --terrain-directory /var/APM/terrain\n");
     printf("\t                   -t /var/APM/terrain\n");
@@ -265,6 +268,7 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
 #if AP_MODULE_SUPPORTED
     const char *module_path = AP_MODULE_DEFAULT_DIRECTORY;
 #endif
+    bool thread_config_loaded = false;
     
     assert(callbacks);
 
@@ -281,11 +285,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"terrain-directory",   true,  0, 't'},
         {"storage-directory",   true,  0, 's'},
         {"module-directory",    true,  0, 'M'},
+        {"thread-config",       true,  0, 'T'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:s:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:s:he:SM:T:",
                     options);
 
     /*
@@ -323,6 +328,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 's':
             utilInstance.set_custom_storage_directory(gopt.optarg);
             break;
+        case 'T':
+            if (!Scheduler::from(scheduler)->thread_config().load(gopt.optarg)) {
+                exit(1);
+            }
+            thread_config_loaded = true;
+            break;
 #if AP_MODULE_SUPPORTED
         case 'M':
             module_path = gopt.optarg;
@@ -370,6 +381,11 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
     AP_Module::call_hook_setup_complete();
 #endif
 
+    // by now the sensor bus threads have been started by the drivers
+    if (thread_config_loaded) {
+        Scheduler::from(scheduler)->thread_config().report();
+    }
+
     while (!_should_exit) {
         callbacks->loop();
     }
@@ -262,6 +262,48 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
     return true;
 }
 
+/*
+  set the SPI mode for this device if another device on the bus last
+  changed it
+ */
+bool SPIDevice::_update_mode(int fd)
+{
+#if DEBUG
+    if (_desc.mode == _bus.last_mode) {
+        /*
+          the mode in the kernel is not tied to the file descriptor,
+          so there is a chance some other process has changed it since
+          we last used the bus. We want to report when this happens so
+          the user has a chance of figuring out when there is
+          conflicted use of the SPI bus. Unfortunately this costs us
+          an extra syscall per transfer.
+         */
+        uint8_t current_mode;
+        if (ioctl(fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
+            hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
+                                fd, strerror(errno));
+            _bus.last_mode = -1;
+        } else if (current_mode != _bus.last_mode) {
+            hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
+                                fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
+            _bus.last_mode = -1;
+        }
+    }
+#endif
+
+    if (_desc.mode != _bus.last_mode) {
+        int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
+        if (r < 0) {
+            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
+                                fd, strerror(errno));
+            return false;
+        }
+        _bus.last_mode = _desc.mode;
+    }
+
+    return true;
+}
+
 bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
                          uint8_t *recv, uint32_t recv_len)
 {
@@ -297,46 +339,73 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         return false;
     }
 
-#if DEBUG
-    if (_desc.mode == _bus.last_mode) {
-        /*
-          the mode in the kernel is not tied to the file descriptor,
-          so there is a chance some other process has changed it since
-          we last used the bus. We want to report when this happens so
-          the user has a chance of figuring out when there is
-          conflicted use of the SPI bus. Unfortunately this costs us
-          an extra syscall per transfer.
-         */
-        uint8_t current_mode;
-        if (ioctl(fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
-            hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
-                                fd, strerror(errno));
-            _bus.last_mode = -1;
-        } else if (current_mode != _bus.last_mode) {
-            hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
-                                fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
-            _bus.last_mode = -1;
-        }
+    if (!_update_mode(fd)) {
+        return false;
     }
-#endif
 
-    int r;
-    if (_desc.mode != _bus.last_mode) {
-        r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
-        if (r < 0) {
-            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                                fd, strerror(errno));
+    _cs_assert();
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    _cs_release();
+
+    if (r == -1) {
+        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+                            fd, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+/*
+  submit a batch of transfers as a single SPI_IOC_MESSAGE(). The kernel
+  toggles chip select between elements via cs_change, so this is only
+  possible when the kernel owns the CS line
+ */
+bool SPIDevice::transfer_batch(AP_HAL::Device::BatchTransfer *xfers, uint8_t count)
+{
+    const uint8_t max_batch = 8;
+    struct spi_ioc_transfer msgs[2*max_batch] = { };
+    unsigned nmsgs = 0;
+    int fd = _bus.fd[_desc.subdev];
+
+    assert(fd >= 0);
+
+    if (_desc.cs_pin != SPI_CS_KERNEL || count > max_batch) {
+        return AP_HAL::SPIDevice::transfer_batch(xfers, count);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        const AP_HAL::Device::BatchTransfer &x = xfers[i];
+        const unsigned first = nmsgs;
+
+        if (x.send && x.send_len != 0) {
+            msgs[nmsgs].tx_buf = (uint64_t) x.send;
+            msgs[nmsgs].len = x.send_len;
+            nmsgs++;
+        }
+        if (x.recv && x.recv_len != 0) {
+            msgs[nmsgs].rx_buf = (uint64_t) x.recv;
+            msgs[nmsgs].len = x.recv_len;
+            nmsgs++;
+        }
+        if (nmsgs == first) {
             return false;
         }
-        _bus.last_mode = _desc.mode;
+        for (unsigned j = first; j < nmsgs; j++) {
+            msgs[j].speed_hz = _speed;
+            msgs[j].bits_per_word = _desc.bits_per_word;
+        }
+        // release CS at the end of each element except the last
+        msgs[nmsgs-1].cs_change = (i < count - 1) ? 1 : 0;
     }
 
-    _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
-    _cs_release();
+    if (!_update_mode(fd)) {
+        return false;
+    }
 
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
     if (r == -1) {
-        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+        hal.console->printf("SPIDevice: error transferring batch fd=%d (%s)\n",
                             fd, strerror(errno));
         return false;
     }
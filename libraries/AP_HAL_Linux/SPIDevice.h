@@ -46,6 +46,9 @@ public:
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
 
+    /* See AP_HAL::Device::transfer_batch() */
+    bool transfer_batch(AP_HAL::Device::BatchTransfer *xfers, uint8_t count) override;
+
     /* See AP_HAL::Device::get_semaphore() */
     AP_HAL::Semaphore *get_semaphore() override;
 
@@ -63,6 +66,11 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Make sure the kernel has the mode of this device set on the bus
+     */
+    bool _update_mode(int fd);
+
     /*
      * Select device if using userspace CS
      */
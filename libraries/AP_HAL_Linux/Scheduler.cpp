@@ -74,11 +74,22 @@ void Scheduler::init_realtime()
 
     mlockall(MCL_CURRENT|MCL_FUTURE);
 
-    struct sched_param param = { .sched_priority = APM_LINUX_MAIN_PRIORITY };
-    if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+    int policy = SCHED_FIFO;
+    int prio = APM_LINUX_MAIN_PRIORITY;
+    cpu_set_t cpus;
+    bool has_cpus;
+    _thread_config.apply("ap-main", policy, prio, cpus, has_cpus);
+
+    struct sched_param param = { .sched_priority = prio };
+    if (sched_setscheduler(0, policy, &param) == -1) {
         AP_HAL::panic("Scheduler: failed to set scheduling parameters: %s",
                       strerror(errno));
     }
+    if (has_cpus && sched_setaffinity(0, sizeof(cpus), &cpus) == -1) {
+        AP_HAL::panic("Scheduler: failed to set cpu affinity: %s",
+                      strerror(errno));
+    }
+    _thread_config.record("ap-main", policy, prio, has_cpus ? &cpus : nullptr);
 }
 
 void Scheduler::init()
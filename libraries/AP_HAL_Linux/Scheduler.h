@@ -5,6 +5,7 @@
 #include "AP_HAL_Linux.h"
 #include "Semaphores.h"
 #include "Thread.h"
+#include "ThreadConfig.h"
 
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
@@ -51,7 +52,12 @@ public:
       create a new thread
      */
     bool thread_create(AP_HAL::MemberProc, const char *name, uint32_t stack_size, priority_base base, int8_t priority) override;
-    
+
+    /*
+      per-thread cpu affinity and priority configuration
+     */
+    ThreadConfig &thread_config() { return _thread_config; }
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -102,6 +108,8 @@ private:
     pthread_t _main_ctx;
 
     Semaphore _io_semaphore;
+
+    ThreadConfig _thread_config;
 };
 
 }
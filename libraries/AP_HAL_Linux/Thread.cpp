@@ -163,12 +163,23 @@ bool Thread::start(const char *name, int policy, int prio)
         return false;
     }
 
+    cpu_set_t cpus;
+    bool has_cpus;
+    ThreadConfig &config = Scheduler::from(hal.scheduler)->thread_config();
+    config.apply(name, policy, prio, cpus, has_cpus);
+
     struct sched_param param = { .sched_priority = prio };
     pthread_attr_t attr;
     int r;
 
     pthread_attr_init(&attr);
 
+    if (has_cpus &&
+        (r = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus)) != 0) {
+        AP_HAL::panic("Failed to set cpu affinity for thread '%s': %s",
+                      name, strerror(r));
+    }
+
     /*
       we need to run as root to get realtime scheduling. Allow it to
       run as non-root for debugging purposes, plus to allow the Replay
@@ -200,6 +211,8 @@ bool Thread::start(const char *name, int policy, int prio)
         pthread_setname_np(_ctx, name);
     }
 
+    config.record(name, policy, prio, has_cpus ? &cpus : nullptr);
+
     _started = true;
 
     return true;
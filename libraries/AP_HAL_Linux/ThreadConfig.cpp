@@ -0,0 +1,275 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadConfig.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AP_Common/Semaphore.h>
+
+using namespace Linux;
+
+/*
+  load thread configuration file
+ */
+bool ThreadConfig::load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+        fprintf(stderr, "ThreadConfig: unable to open %s: %s\n",
+                path, strerror(errno));
+        return false;
+    }
+
+    char line[128];
+    unsigned lineno = 0;
+    bool ret = true;
+
+    _num_entries = 0;
+
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        lineno++;
+
+        char *comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = 0;
+        }
+
+        char *saveptr = nullptr;
+        const char *name = strtok_r(line, " \t\r\n", &saveptr);
+        if (name == nullptr) {
+            // blank line
+            continue;
+        }
+        const char *cpus = strtok_r(nullptr, " \t\r\n", &saveptr);
+        const char *policy = strtok_r(nullptr, " \t\r\n", &saveptr);
+        const char *prio = strtok_r(nullptr, " \t\r\n", &saveptr);
+
+        if (_num_entries >= LINUX_THREAD_CONFIG_MAX_ENTRIES) {
+            fprintf(stderr, "ThreadConfig: too many entries in %s\n", path);
+            ret = false;
+            break;
+        }
+
+        struct entry &e = _entries[_num_entries];
+        memset(&e, 0, sizeof(e));
+        strncpy(e.name, name, sizeof(e.name)-1);
+        e.policy = -1;
+        e.prio = -1;
+
+        if (cpus != nullptr && strcmp(cpus, "-") != 0) {
+            if (!_parse_cpus(cpus, e.cpus)) {
+                fprintf(stderr, "ThreadConfig: %s:%u: bad cpu list '%s'\n",
+                        path, lineno, cpus);
+                ret = false;
+                continue;
+            }
+            e.has_cpus = true;
+        }
+
+        if (policy != nullptr && strcmp(policy, "-") != 0 &&
+            !_parse_policy(policy, e.policy)) {
+            fprintf(stderr, "ThreadConfig: %s:%u: bad policy '%s'\n",
+                    path, lineno, policy);
+            ret = false;
+            continue;
+        }
+
+        if (prio != nullptr && strcmp(prio, "-") != 0) {
+            char *end;
+            long p = strtol(prio, &end, 10);
+            if (*end != 0 || p < 0 || p > 99) {
+                fprintf(stderr, "ThreadConfig: %s:%u: bad priority '%s'\n",
+                        path, lineno, prio);
+                ret = false;
+                continue;
+            }
+            e.prio = p;
+        }
+
+        // SCHED_OTHER only accepts priority 0 and the realtime policies
+        // the code starts threads with only accept 1 to 99
+        if (e.policy == SCHED_OTHER) {
+            if (e.prio > 0) {
+                fprintf(stderr, "ThreadConfig: %s:%u: policy OTHER requires priority 0\n",
+                        path, lineno);
+                ret = false;
+                continue;
+            }
+            e.prio = 0;
+        } else if (e.prio == 0) {
+            fprintf(stderr, "ThreadConfig: %s:%u: priority 0 requires policy OTHER\n",
+                    path, lineno);
+            ret = false;
+            continue;
+        }
+
+        _num_entries++;
+    }
+
+    fclose(f);
+
+    return ret;
+}
+
+/*
+  parse a cpu list such as "1", "0,2" or "0-3"
+ */
+bool ThreadConfig::_parse_cpus(const char *str, cpu_set_t &cpus)
+{
+    CPU_ZERO(&cpus);
+
+    while (*str) {
+        char *end;
+        long first = strtol(str, &end, 10);
+        if (end == str || first < 0 || first >= CPU_SETSIZE) {
+            return false;
+        }
+        long last = first;
+        if (*end == '-') {
+            str = end + 1;
+            last = strtol(str, &end, 10);
+            if (end == str || last < first || last >= CPU_SETSIZE) {
+                return false;
+            }
+        }
+        for (long i = first; i <= last; i++) {
+            CPU_SET(i, &cpus);
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != 0) {
+            return false;
+        }
+        str = end;
+    }
+
+    return CPU_COUNT(&cpus) > 0;
+}
+
+bool ThreadConfig::_parse_policy(const char *str, int &policy)
+{
+    if (strcmp(str, "FIFO") == 0) {
+        policy = SCHED_FIFO;
+    } else if (strcmp(str, "RR") == 0) {
+        policy = SCHED_RR;
+    } else if (strcmp(str, "OTHER") == 0) {
+        policy = SCHED_OTHER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *ThreadConfig::_policy_name(int policy)
+{
+    switch (policy) {
+    case SCHED_FIFO:
+        return "FIFO";
+    case SCHED_RR:
+        return "RR";
+    case SCHED_OTHER:
+        return "OTHER";
+    }
+    return "?";
+}
+
+/*
+  find the first entry matching a thread name
+ */
+const struct ThreadConfig::entry *ThreadConfig::_find(const char *name) const
+{
+    for (uint8_t i = 0; i < _num_entries; i++) {
+        const struct entry &e = _entries[i];
+        const size_t len = strlen(e.name);
+        if (len > 0 && e.name[len-1] == '*') {
+            if (strncmp(e.name, name, len-1) == 0) {
+                return &e;
+            }
+        } else if (strcmp(e.name, name) == 0) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadConfig::apply(const char *name, int &policy, int &prio,
+                         cpu_set_t &cpus, bool &has_cpus) const
+{
+    has_cpus = false;
+
+    if (name == nullptr) {
+        return;
+    }
+
+    const struct entry *e = _find(name);
+    if (e == nullptr) {
+        return;
+    }
+    if (e->policy != -1) {
+        policy = e->policy;
+    }
+    if (e->prio != -1) {
+        prio = e->prio;
+    }
+    if (e->has_cpus) {
+        cpus = e->cpus;
+        has_cpus = true;
+    }
+}
+
+void ThreadConfig::record(const char *name, int policy, int prio,
+                          const cpu_set_t *cpus)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_num_threads >= LINUX_THREAD_CONFIG_MAX_THREADS) {
+        return;
+    }
+    struct entry &t = _threads[_num_threads++];
+    memset(&t, 0, sizeof(t));
+    strncpy(t.name, name ? name : "?", sizeof(t.name)-1);
+    t.policy = policy;
+    t.prio = prio;
+    if (cpus != nullptr) {
+        t.cpus = *cpus;
+        t.has_cpus = true;
+    }
+}
+
+void ThreadConfig::report() const
+{
+    WITH_SEMAPHORE(_sem);
+
+    printf("Thread layout:\n");
+    for (uint8_t i = 0; i < _num_threads; i++) {
+        const struct entry &t = _threads[i];
+        char cpus[64] = "any";
+        if (t.has_cpus) {
+            size_t ofs = 0;
+            cpus[0] = 0;
+            for (int c = 0; c < CPU_SETSIZE && ofs < sizeof(cpus) - 4; c++) {
+                if (CPU_ISSET(c, &t.cpus)) {
+                    ofs += snprintf(&cpus[ofs], sizeof(cpus) - ofs, "%s%d",
+                                    ofs ? "," : "", c);
+                }
+            }
+        }
+        printf("  %-16s %-5s prio=%-3d cpus=%s\n",
+               t.name, _policy_name(t.policy), t.prio, cpus);
+    }
+}
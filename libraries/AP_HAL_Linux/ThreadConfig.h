@@ -0,0 +1,89 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "Semaphores.h"
+
+#define LINUX_THREAD_CONFIG_MAX_ENTRIES 32
+#define LINUX_THREAD_CONFIG_MAX_THREADS 32
+#define LINUX_THREAD_CONFIG_NAME_LEN    16
+
+namespace Linux {
+
+/*
+ * Per-thread scheduling configuration, loaded from a file given with
+ * --thread-config. Each line has the form:
+ *
+ *    <thread name> <cpu list|-> <FIFO|RR|OTHER|-> <priority|->
+ *
+ * for example:
+ *
+ *    # keep the IMU bus alone on cpu 3
+ *    ap-spi-0   3     FIFO  14
+ *    ap-timer   2     -     -
+ *    ap-*       0-2   -     -
+ *
+ * A trailing '*' in the name matches any thread with that prefix and
+ * the first matching line wins. A '-' keeps the value chosen by the
+ * code starting the thread. OTHER requires priority 0 or '-', which
+ * then also means 0, and FIFO and RR require a priority of 1 to 99.
+ */
+class ThreadConfig {
+public:
+    /* Load configuration from @path. Return false on a parse error */
+    bool load(const char *path);
+
+    /*
+     * Apply configured overrides for thread @name to @policy and
+     * @prio. If a cpu list is configured it is copied to @cpus and
+     * true is returned in @has_cpus.
+     */
+    void apply(const char *name, int &policy, int &prio,
+               cpu_set_t &cpus, bool &has_cpus) const;
+
+    /* Remember a started thread for the layout report */
+    void record(const char *name, int policy, int prio,
+                const cpu_set_t *cpus);
+
+    /* Print the layout of all started threads */
+    void report() const;
+
+private:
+    struct entry {
+        char name[LINUX_THREAD_CONFIG_NAME_LEN];
+        int policy;
+        int prio;
+        bool has_cpus;
+        cpu_set_t cpus;
+    };
+
+    const struct entry *_find(const char *name) const;
+    static bool _parse_cpus(const char *str, cpu_set_t &cpus);
+    static bool _parse_policy(const char *str, int &policy);
+    static const char *_policy_name(int policy);
+
+    struct entry _entries[LINUX_THREAD_CONFIG_MAX_ENTRIES];
+    uint8_t _num_entries;
+
+    struct entry _threads[LINUX_THREAD_CONFIG_MAX_THREADS];
+    uint8_t _num_threads;
+
+    mutable Semaphore _sem;
+};
+
+}
@@ -291,6 +291,33 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+/*
+  return a contiguous span of received bytes without copying
+ */
+const uint8_t *UARTDriver::peek_rx(uint32_t &len)
+{
+    len = 0;
+    if (!_initialised) {
+        return nullptr;
+    }
+    const uint8_t *ptr = _readbuf.readptr(len);
+    if (len == 0) {
+        return nullptr;
+    }
+    return ptr;
+}
+
+/*
+  discard bytes previously returned by peek_rx()
+ */
+bool UARTDriver::consume_rx(uint32_t n)
+{
+    if (!_initialised) {
+        return false;
+    }
+    return _readbuf.advance(n);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -342,6 +369,34 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
     return ret;
 }
 
+/*
+  reserve space in the write buffer for the caller to fill. The write
+  mutex is held until commit_tx()
+ */
+uint8_t UARTDriver::reserve_tx(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (!_initialised || len == 0) {
+        return 0;
+    }
+    if (!_write_mutex.take_nonblocking()) {
+        return 0;
+    }
+    if (_writebuf.space() < len) {
+        _write_mutex.give();
+        return 0;
+    }
+    return _writebuf.reserve(vec, len);
+}
+
+/*
+  queue bytes written into a reservation and release the write mutex
+ */
+void UARTDriver::commit_tx(uint32_t len)
+{
+    _writebuf.commit(len);
+    _write_mutex.give();
+}
+
 /*
   try writing n bytes, handling an unresponsive port
  */
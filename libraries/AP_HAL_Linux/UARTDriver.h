@@ -30,6 +30,10 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    const uint8_t *peek_rx(uint32_t &len) override;
+    bool consume_rx(uint32_t n) override;
+    uint8_t reserve_tx(ByteBuffer::IoVec vec[2], uint32_t len) override;
+    void commit_tx(uint32_t len) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c) override;
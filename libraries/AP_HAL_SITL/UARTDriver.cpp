@@ -173,6 +173,30 @@ int16_t UARTDriver::read(void)
     return c;
 }
 
+/*
+  return a contiguous span of received bytes without copying
+ */
+const uint8_t *UARTDriver::peek_rx(uint32_t &len)
+{
+    len = 0;
+    if (available() <= 0) {
+        return nullptr;
+    }
+    const uint8_t *ptr = _readbuffer.readptr(len);
+    if (len == 0) {
+        return nullptr;
+    }
+    return ptr;
+}
+
+/*
+  discard bytes previously returned by peek_rx()
+ */
+bool UARTDriver::consume_rx(uint32_t n)
+{
+    return _readbuffer.advance(n);
+}
+
 void UARTDriver::flush(void)
 {
 }
@@ -210,6 +234,22 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
     return size;
 }
 
+
+/*
+  reserve space in the write buffer for the caller to fill
+ */
+uint8_t UARTDriver::reserve_tx(ByteBuffer::IoVec vec[2], uint32_t len)
+{
+    if (_unbuffered_writes || len == 0 || txspace() < len) {
+        return 0;
+    }
+    return _writebuffer.reserve(vec, len);
+}
+
+void UARTDriver::commit_tx(uint32_t len)
+{
+    _writebuffer.commit(len);
+}
     
 /*
   start a TCP connection for the serial port. If wait_for_connection
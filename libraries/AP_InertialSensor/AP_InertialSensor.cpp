@@ -460,7 +460,8 @@ AP_InertialSensor *AP_InertialSensor::_singleton = nullptr;
 
 AP_InertialSensor::AP_InertialSensor() :
     _board_orientation(ROTATION_NONE),
-    _log_raw_bit(-1)
+    _log_raw_bit(-1),
+    _fast_gyro_queue(nullptr)
 {
     if (_singleton) {
         AP_HAL::panic("Too many inertial sensors");
@@ -1458,6 +1459,46 @@ check_sample:
     _have_sample = true;
 }
 
+/*
+  start queueing primary gyro samples for a rate controller running
+  in its own thread. The queue only needs to cover the time between
+  the thread waking up and draining it
+ */
+bool AP_InertialSensor::enable_fast_gyro(uint8_t queue_length)
+{
+    if (_fast_gyro_queue != nullptr) {
+        return true;
+    }
+    ObjectBuffer<FastGyroSample> *queue = new ObjectBuffer<FastGyroSample>(queue_length);
+    if (queue == nullptr) {
+        return false;
+    }
+    _fast_gyro_queue = queue;
+    return true;
+}
+
+/*
+  wait for the next primary gyro sample. If the caller has fallen
+  behind older samples are discarded so the rate controller always
+  runs on the latest gyro
+ */
+bool AP_InertialSensor::wait_for_fast_gyro_sample(FastGyroSample &sample, uint32_t timeout_us)
+{
+    if (_fast_gyro_queue == nullptr) {
+        return false;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+    while (_fast_gyro_queue->empty()) {
+        if (AP_HAL::micros() - start_us >= timeout_us) {
+            return false;
+        }
+        hal.scheduler->delay_microseconds(50);
+    }
+    while (_fast_gyro_queue->pop(sample)) {
+    }
+    return true;
+}
+
 
 /*
   get delta angles
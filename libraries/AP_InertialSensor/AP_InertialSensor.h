@@ -21,6 +21,7 @@
 
 #include <AP_AccelCal/AP_AccelCal.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
 #include <AP_Math/AP_Math.h>
 #include <Filter/LowPassFilter2p.h>
 #include <Filter/LowPassFilter.h>
@@ -182,6 +183,22 @@ public:
     // wait for a sample to be available
     void wait_for_sample(void);
 
+    // filtered primary gyro sample for a rate controller running
+    // outside the main loop
+    struct FastGyroSample {
+        Vector3f gyro;
+        uint64_t sample_us;         // time the sample was received from the sensor
+    };
+
+    // start queueing primary gyro samples as they arrive, returns false if the queue can't be allocated
+    bool enable_fast_gyro(uint8_t queue_length);
+
+    // wait up to timeout_us for the latest primary gyro sample, only one thread may call this
+    bool wait_for_fast_gyro_sample(FastGyroSample &sample, uint32_t timeout_us);
+
+    // number of gyro samples dropped because the fast gyro queue was full
+    uint32_t get_fast_gyro_overruns(void) const { return _fast_gyro_overruns; }
+
     // class level parameters
     static const struct AP_Param::GroupInfo var_info[];
 
@@ -494,6 +511,10 @@ private:
     // bitmask bit which indicates if we should log raw accel and gyro data
     uint32_t _log_raw_bit;
 
+    // queue of primary gyro samples for the fast rate controller
+    ObjectBuffer<FastGyroSample> *_fast_gyro_queue;
+    uint32_t _fast_gyro_overruns;
+
     // has wait_for_sample() found a sample?
     bool _have_sample:1;
 
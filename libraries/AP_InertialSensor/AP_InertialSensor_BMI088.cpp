@@ -130,6 +130,36 @@ bool AP_InertialSensor_BMI088::read_accel_registers(uint8_t reg, uint8_t *data,
     return true;
 }
 
+/*
+  read two blocks of accelerometer registers in a single bus batch
+*/
+bool AP_InertialSensor_BMI088::read_accel_registers_batch(uint8_t reg1, uint8_t *data1, uint8_t len1,
+                                                          uint8_t reg2, uint8_t *data2, uint8_t len2)
+{
+    AP_HAL::Device::BatchTransfer xfers[2];
+    if (dev_accel->bus_type() != AP_HAL::Device::BUS_TYPE_SPI) {
+        dev_accel->setup_batch_read(xfers[0], reg1, data1, len1);
+        dev_accel->setup_batch_read(xfers[1], reg2, data2, len2);
+        return dev_accel->transfer_batch(xfers, 2);
+    }
+    // for SPI we need to discard the first returned byte, as in
+    // read_accel_registers()
+    uint8_t b1[len1+2];
+    uint8_t b2[len2+2];
+    b1[0] = reg1 | 0x80;
+    memset(&b1[1], 0, len1+1);
+    b2[0] = reg2 | 0x80;
+    memset(&b2[1], 0, len2+1);
+    xfers[0] = { b1, uint32_t(len1+2), b1, uint32_t(len1+2), 0 };
+    xfers[1] = { b2, uint32_t(len2+2), b2, uint32_t(len2+2), 0 };
+    if (!dev_accel->transfer_batch(xfers, 2)) {
+        return false;
+    }
+    memcpy(data1, &b1[2], len1);
+    memcpy(data2, &b2[2], len2);
+    return true;
+}
+
 /*
   write to accel registers with retries. The SPI sensor may take
   several tries to correctly write a register
@@ -256,7 +286,22 @@ bool AP_InertialSensor_BMI088::init()
 void AP_InertialSensor_BMI088::read_fifo_accel(void)
 {
     uint8_t len[2];
-    if (!read_accel_registers(REGA_FIFO_LEN0, len, 2)) {
+    uint8_t tbuf[2];
+
+    // the temperature is fetched in the same bus batch as the FIFO length
+    const bool read_temperature = (temperature_counter++ == 100);
+    if (read_temperature) {
+        temperature_counter = 0;
+        if (!read_accel_registers_batch(REGA_FIFO_LEN0, len, 2,
+                                        REGA_TEMP_LSB, tbuf, 2)) {
+            _inc_accel_error_count(accel_instance);
+            return;
+        }
+        uint16_t temp_uint11 = (tbuf[0]<<3) | (tbuf[1]>>5);
+        int16_t temp_int11 = temp_uint11>1023?temp_uint11-2048:temp_uint11;
+        float temp_degc = temp_int11 * 0.125 + 23;
+        _publish_temperature(accel_instance, temp_degc);
+    } else if (!read_accel_registers(REGA_FIFO_LEN0, len, 2)) {
         _inc_accel_error_count(accel_instance);
         return;
     }
@@ -324,19 +369,6 @@ void AP_InertialSensor_BMI088::read_fifo_accel(void)
         p += frame_len;
         fifo_length -= frame_len;
     }
-
-    if (temperature_counter++ == 100) {
-        temperature_counter = 0;
-        uint8_t tbuf[2];
-        if (!read_accel_registers(REGA_TEMP_LSB, tbuf, 2)) {
-            _inc_accel_error_count(accel_instance);
-        } else {
-            uint16_t temp_uint11 = (tbuf[0]<<3) | (tbuf[1]>>5);
-            int16_t temp_int11 = temp_uint11>1023?temp_uint11-2048:temp_uint11;
-            float temp_degc = temp_int11 * 0.125 + 23;
-            _publish_temperature(accel_instance, temp_degc);
-        }
-    }
 }
 
 /*
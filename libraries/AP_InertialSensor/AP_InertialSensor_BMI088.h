@@ -63,6 +63,8 @@ private:
       read from accelerometer registers, special SPI handling needed
      */
     bool read_accel_registers(uint8_t reg, uint8_t *data, uint8_t len);
+    bool read_accel_registers_batch(uint8_t reg1, uint8_t *data1, uint8_t len1,
+                                    uint8_t reg2, uint8_t *data2, uint8_t len2);
 
     /*
       write to an accelerometer register with retries
@@ -211,6 +211,14 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
         _imu._new_gyro_data[instance] = true;
     }
 
+    if (_imu._fast_gyro_queue != nullptr && instance == _imu._primary_gyro) {
+        // pass the filtered sample straight to the fast rate controller
+        const AP_InertialSensor::FastGyroSample fast_sample { _imu._gyro_filtered[instance], AP_HAL::micros64() };
+        if (!_imu._fast_gyro_queue->push(fast_sample)) {
+            _imu._fast_gyro_overruns++;
+        }
+    }
+
     log_gyro_raw(instance, sample_us, gyro);
 }
 
@@ -539,6 +539,12 @@ void AP_InertialSensor_Invensense::_read_fifo()
     uint8_t *rx = _fifo_buffer;
     bool need_reset = false;
 
+    /*
+      the FIFO count is not batched with the FIFO data read. The data
+      length is only known once the count has been read, and reading
+      past the samples counted would pop and then discard samples that
+      arrive in between
+     */
     if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
         goto check_registers;
     }
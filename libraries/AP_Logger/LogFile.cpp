@@ -136,9 +136,22 @@ void AP_Logger::Write_GPS(uint8_t i, uint64_t time_us)
     if (time_us == 0) {
         time_us = AP_HAL::micros64();
     }
+    // the first two receivers and the blended solution have the
+    // original message IDs, further receivers were added later
+    uint8_t gps_msg, gpa_msg;
+    if (i == GPS_BLENDED_INSTANCE) {
+        gps_msg = LOG_GPSB_MSG;
+        gpa_msg = LOG_GPAB_MSG;
+    } else if (i < 2) {
+        gps_msg = LOG_GPS_MSG + i;
+        gpa_msg = LOG_GPA_MSG + i;
+    } else {
+        gps_msg = LOG_GPS3_MSG + (i - 2);
+        gpa_msg = LOG_GPA3_MSG + (i - 2);
+    }
     const struct Location &loc = gps.location(i);
     struct log_GPS pkt = {
-        LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GPS_MSG+i)),
+        LOG_PACKET_HEADER_INIT(gps_msg),
         time_us       : time_us,
         status        : (uint8_t)gps.status(i),
         gps_week_ms   : gps.time_week_ms(i),
@@ -161,7 +174,7 @@ void AP_Logger::Write_GPS(uint8_t i, uint64_t time_us)
     gps.vertical_accuracy(i, vacc);
     gps.speed_accuracy(i, sacc);
     struct log_GPA pkt2 = {
-        LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GPA_MSG+i)),
+        LOG_PACKET_HEADER_INIT(gpa_msg),
         time_us       : time_us,
         vdop          : gps.get_vdop(i),
         hacc          : (uint16_t)MIN((hacc*100), UINT16_MAX),
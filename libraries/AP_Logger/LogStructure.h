@@ -1088,6 +1088,32 @@ struct PACKED log_SRTL {
     float D;
 };
 
+struct PACKED log_LUAM {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint32_t alloc_count;
+    uint32_t alloc_bytes;
+    uint32_t mem_used;
+    uint32_t mem_high_water;
+    uint32_t slab_used;
+    uint32_t slab_waste;
+    uint32_t slab_free;
+    uint32_t slab_failed;
+};
+
+struct PACKED log_LUAT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint32_t run_count;
+    uint32_t run_time_us;
+    uint32_t max_run_time_us;
+    uint32_t avg_run_time_us;
+    uint32_t run_steps;
+    uint32_t throttled;
+};
+
 struct PACKED log_DSTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1242,6 +1268,14 @@ Format characters in the format string for binary log messages
       "GPA2", GPA_FMT, GPA_LABELS, GPA_UNITS, GPA_MULTS }, \
     { LOG_GPAB_MSG, sizeof(log_GPA), \
       "GPAB", GPA_FMT, GPA_LABELS, GPA_UNITS, GPA_MULTS }, \
+    { LOG_GPS3_MSG, sizeof(log_GPS), \
+      "GPS3", GPS_FMT, GPS_LABELS, GPS_UNITS, GPS_MULTS }, \
+    { LOG_GPS4_MSG, sizeof(log_GPS), \
+      "GPS4", GPS_FMT, GPS_LABELS, GPS_UNITS, GPS_MULTS }, \
+    { LOG_GPA3_MSG, sizeof(log_GPA), \
+      "GPA3", GPA_FMT, GPA_LABELS, GPA_UNITS, GPA_MULTS }, \
+    { LOG_GPA4_MSG, sizeof(log_GPA), \
+      "GPA4", GPA_FMT, GPA_LABELS, GPA_UNITS, GPA_MULTS }, \
     { LOG_IMU_MSG, sizeof(log_IMU), \
       "IMU",  IMU_FMT,     IMU_LABELS, IMU_UNITS, IMU_MULTS }, \
     { LOG_MESSAGE_MSG, sizeof(log_Message), \
@@ -1500,7 +1534,11 @@ Format characters in the format string for binary log messages
     { LOG_MSG_SBPEVENT, sizeof(log_SbpEvent), \
       "SBRE", "QHIiBB", "TimeUS,GWk,GMS,ns_residual,level,quality", "s?????", "F?????" }, \
     { LOG_ERROR_MSG, sizeof(log_Error), \
-      "ERR",   "QBB",         "TimeUS,Subsys,ECode", "s--", "F--" }
+      "ERR",   "QBB",         "TimeUS,Subsys,ECode", "s--", "F--" }, \
+    { LOG_LUAM_MSG, sizeof(log_LUAM), \
+      "LUAM", "QNIIIIIIII", "TimeUS,Name,Allocs,Bytes,Used,HWM,SlabUsed,SlabWaste,SlabFree,SlabFail", "s--bbbbbb-", "F--000000-" }, \
+    { LOG_LUAT_MSG, sizeof(log_LUAT), \
+      "LUAT", "QNIIIIII", "TimeUS,Name,Runs,Time,MaxTime,AvgTime,Steps,Throttled", "s--sss--", "F--FFF--" }
 
 // #endif
 
@@ -1660,6 +1698,12 @@ enum LogMessages : uint8_t {
     LOG_WHEELENCODER_MSG,
     LOG_MAV_MSG,
     LOG_ERROR_MSG,
+    LOG_GPS3_MSG,
+    LOG_GPS4_MSG,
+    LOG_GPA3_MSG,
+    LOG_GPA4_MSG,
+    LOG_LUAM_MSG,
+    LOG_LUAT_MSG,
 
     _LOG_LAST_MSG_
 };
@@ -0,0 +1,147 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SCurve.h"
+
+// clear the segment, the target stays at the origin
+void SCurve::init()
+{
+    _origin.zero();
+    _destination.zero();
+    _unit.zero();
+    _length = 0.0f;
+    _speed_max = 0.0f;
+    _accel_time = 0.0f;
+    _duration = 0.0f;
+    _time = 0.0f;
+    memset(_phase, 0, sizeof(_phase));
+}
+
+/*
+  calculate the profile from origin to destination
+
+  With jerk J the acceleration limit A is reached after tj = A/J and
+  the speed limit V after a further ta = V/A - tj at constant
+  acceleration, covering V * (ta + 2 * tj) / 2.  If V < A^2/J the
+  acceleration limit can not be reached before the speed limit so A
+  is reduced to sqrt(V*J).  If the segment is too short to reach V and
+  slow down again V is reduced, first keeping A and failing that with
+  no constant acceleration phase at all.
+ */
+void SCurve::calculate_track(const Vector3f &origin, const Vector3f &destination, float speed, float accel, float jerk)
+{
+    init();
+    _origin = origin;
+    _destination = destination;
+
+    const Vector3f delta = destination - origin;
+    _length = delta.length();
+    if (!is_positive(_length) || !is_positive(speed) || !is_positive(accel) || !is_positive(jerk)) {
+        // nothing to move along, the segment is finished at its origin
+        _length = 0.0f;
+        return;
+    }
+    _unit = delta / _length;
+
+    accel = MIN(accel, safe_sqrt(speed * jerk));
+    float t_jerk = accel / jerk;
+    float t_accel = speed / accel - t_jerk;
+
+    // reduce the speed if the distance to accelerate and decelerate is longer than the segment
+    if (speed * (t_accel + 2.0f * t_jerk) > _length) {
+        // speed^2/accel + speed*t_jerk = length
+        t_jerk = accel / jerk;
+        speed = 0.5f * accel * (safe_sqrt(sq(t_jerk) + 4.0f * _length / accel) - t_jerk);
+        if (speed < accel * t_jerk) {
+            // the acceleration limit is not reached, speed*t_jerk = length/2 with speed = jerk*t_jerk^2
+            t_jerk = cbrtf(0.5f * _length / jerk);
+            accel = jerk * t_jerk;
+            speed = accel * t_jerk;
+        }
+        t_accel = MAX(speed / accel - t_jerk, 0.0f);
+    }
+    const float t_cruise = MAX((_length - speed * (t_accel + 2.0f * t_jerk)) / speed, 0.0f);
+
+    _speed_max = speed;
+    _accel_time = t_accel + 2.0f * t_jerk;
+
+    // integrate the phases to find the state at the start of each one
+    const float duration[SCURVE_PHASES] = {t_jerk, t_accel, t_jerk, t_cruise, t_jerk, t_accel, t_jerk};
+    const float phase_jerk[SCURVE_PHASES] = {jerk, 0.0f, -jerk, 0.0f, -jerk, 0.0f, jerk};
+    float t = 0.0f, p = 0.0f, v = 0.0f, a = 0.0f;
+    for (uint8_t i=0; i<SCURVE_PHASES; i++) {
+        Phase &phase = _phase[i];
+        const float d = duration[i];
+        const float j = phase_jerk[i];
+        phase.jerk = j;
+        phase.t0 = t;
+        phase.p0 = p;
+        phase.v0 = v;
+        phase.a0 = a;
+        t += d;
+        p += d * (v + d * (0.5f * a + d * j / 6.0f));
+        v += d * (a + 0.5f * d * j);
+        a += d * j;
+        phase.t_end = t;
+    }
+    _duration = t;
+}
+
+// get the distance, speed and acceleration along the segment at time t
+void SCurve::calc_along_track(float t, float &pos, float &vel, float &accel) const
+{
+    if (t >= _duration) {
+        // hide rounding errors in the integration at the destination
+        pos = _length;
+        vel = 0.0f;
+        accel = 0.0f;
+        return;
+    }
+    if (t <= 0.0f) {
+        pos = 0.0f;
+        vel = 0.0f;
+        accel = 0.0f;
+        return;
+    }
+
+    uint8_t i = 0;
+    while (i < SCURVE_PHASES-1 && t >= _phase[i].t_end) {
+        i++;
+    }
+    const Phase &phase = _phase[i];
+    const float d = t - phase.t0;
+    const float j = phase.jerk;
+    pos = constrain_float(phase.p0 + d * (phase.v0 + d * (0.5f * phase.a0 + d * j / 6.0f)), 0.0f, _length);
+    vel = MAX(phase.v0 + d * (phase.a0 + 0.5f * d * j), 0.0f);
+    accel = phase.a0 + d * j;
+}
+
+// get the target's displacement from the origin, velocity and acceleration at the current time
+void SCurve::get_target(Vector3f &pos, Vector3f &vel, Vector3f &accel) const
+{
+    float p, v, a;
+    calc_along_track(_time, p, v, a);
+    pos = _unit * p;
+    vel = _unit * v;
+    accel = _unit * a;
+}
+
+// get the distance along the segment at the current time
+float SCurve::get_distance() const
+{
+    float p, v, a;
+    calc_along_track(_time, p, v, a);
+    return p;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "AP_Math.h"
+
+#define SCURVE_PHASES   7   // jerk, constant acceleration, jerk, cruise, jerk, constant deceleration, jerk
+
+/*
+  jerk limited trajectory along a straight segment
+
+  The vehicle starts and finishes the segment at rest.  The profile is
+  made of seven phases of constant jerk (increasing acceleration,
+  constant acceleration, decreasing acceleration, cruise and the
+  mirror image to slow down) whose durations and starting states are
+  calculated once by calculate_track.  Finding the target for a given
+  time is then a search of the seven phases and one polynomial
+  evaluation.
+
+  Consecutive segments can be blended through a corner by adding the
+  displacement of the next segment while this segment is slowing down
+  (see AC_WPNav).  Distances and times use whatever units the limits
+  are given in.
+ */
+class SCurve {
+public:
+
+    SCurve() { init(); }
+
+    // clear the segment, the target stays at the origin
+    void init();
+
+    // calculate the profile from origin to destination
+    //     speed, accel and jerk are the limits along the segment and must be positive
+    void calculate_track(const Vector3f &origin, const Vector3f &destination, float speed, float accel, float jerk);
+
+    // move time along the segment
+    void advance_time(float dt) { _time += dt; }
+
+    // get the target's displacement from the origin, velocity and acceleration at the current time
+    void get_target(Vector3f &pos, Vector3f &vel, Vector3f &accel) const;
+
+    // get the distance along the segment at the current time
+    float get_distance() const;
+
+    // true once the target has reached the destination
+    bool finished() const { return _time >= _duration; }
+
+    // true once time has started moving along the segment
+    bool started() const { return is_positive(_time); }
+
+    // get the time remaining until the target reaches the destination
+    float time_remaining() const { return MAX(_duration - _time, 0.0f); }
+
+    // get the time taken to accelerate to the cruise speed, the time to slow down at the end is the same
+    float get_accel_time() const { return _accel_time; }
+
+    // get the highest speed along the segment
+    float get_speed_max() const { return _speed_max; }
+
+    const Vector3f &get_origin() const { return _origin; }
+    const Vector3f &get_destination() const { return _destination; }
+    float get_length() const { return _length; }
+
+private:
+
+    // get the distance, speed and acceleration along the segment at time t
+    void calc_along_track(float t, float &pos, float &vel, float &accel) const;
+
+    Vector3f _origin;                   // start of the segment
+    Vector3f _destination;              // end of the segment
+    Vector3f _unit;                     // unit vector from origin to destination
+    float _length;                      // distance from origin to destination
+    float _speed_max;                   // cruise speed, lower than the limit if the segment is short
+    float _accel_time;                  // time taken to reach the cruise speed
+    float _duration;                    // time taken to reach the destination
+    float _time;                        // current time along the segment
+
+    // phase of constant jerk
+    struct Phase {
+        float t_end;                    // time the phase ends
+        float jerk;                     // jerk during the phase
+        float t0, p0, v0, a0;           // time, distance, speed and acceleration at the start of the phase
+    } _phase[SCURVE_PHASES];
+};
@@ -0,0 +1,55 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+static uint8_t crc_buffer[4096];
+
+static void fill_buffer()
+{
+    for (uint16_t i = 0; i < sizeof(crc_buffer); i++) {
+        crc_buffer[i] = (i * 131) ^ (i >> 3);
+    }
+}
+
+static void BM_CRC32(benchmark::State& state)
+{
+    fill_buffer();
+    const uint32_t len = state.range(0);
+
+    while (state.KeepRunning()) {
+        uint32_t crc = crc_crc32(0, crc_buffer, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRCXModem(benchmark::State& state)
+{
+    fill_buffer();
+    const uint16_t len = state.range(0);
+
+    while (state.KeepRunning()) {
+        uint16_t crc = crc_xmodem(crc_buffer, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+static void BM_CRC8(benchmark::State& state)
+{
+    fill_buffer();
+    const uint8_t len = state.range(0);
+
+    while (state.KeepRunning()) {
+        uint8_t crc = crc_crc8(crc_buffer, len);
+        gbenchmark_escape(&crc);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+BENCHMARK(BM_CRC32)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_CRCXModem)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_CRC8)->Arg(16)->Arg(255);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,71 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/crc.h>
+
+static const uint8_t check_string[] = "123456789";
+
+/*
+  bitwise reference implementations
+ */
+static uint32_t crc32_reference(uint32_t crc, const uint8_t *buf, uint32_t size)
+{
+    while (size--) {
+        crc ^= *buf++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+    return crc;
+}
+
+static uint16_t xmodem_reference(const uint8_t *buf, uint16_t size)
+{
+    uint16_t crc = 0;
+    while (size--) {
+        crc ^= uint16_t(*buf++) << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+TEST(CRCTest, CheckValues)
+{
+    EXPECT_EQ(0xCBF43926U, ~crc_crc32(~0U, check_string, 9));
+    EXPECT_EQ(0x31C3U, crc_xmodem(check_string, 9));
+    EXPECT_EQ(0xF4U, crc_crc8(check_string, 9));
+}
+
+TEST(CRCTest, CRC32MatchesReference)
+{
+    uint8_t buf[300];
+    for (uint16_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i * 167) ^ 0x5A;
+    }
+    // cover all alignments and the tail handling of the 8 byte loop
+    for (uint8_t ofs = 0; ofs < 8; ofs++) {
+        for (uint16_t len = 0; len < sizeof(buf) - ofs; len += 7) {
+            EXPECT_EQ(crc32_reference(0x12345678, &buf[ofs], len),
+                      crc_crc32(0x12345678, &buf[ofs], len));
+        }
+    }
+}
+
+TEST(CRCTest, XModemMatchesReference)
+{
+    uint8_t buf[100];
+    for (uint16_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i * 59) ^ 0xA5;
+    }
+    for (uint16_t len = 0; len < sizeof(buf); len++) {
+        EXPECT_EQ(xmodem_reference(buf, len), crc_xmodem(buf, len));
+    }
+    uint16_t crc = 0;
+    for (uint16_t i = 0; i < sizeof(buf); i++) {
+        crc = crc_xmodem_update(crc, buf[i]);
+    }
+    EXPECT_EQ(xmodem_reference(buf, sizeof(buf)), crc);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,108 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/SCurve.h>
+
+#define DT 0.0025f
+
+/*
+  step along a segment checking the target stays within the limits and
+  finishes at rest at the destination
+ */
+static void check_segment(const Vector3f &origin, const Vector3f &destination, float speed, float accel, float jerk)
+{
+    SCurve scurve;
+    scurve.calculate_track(origin, destination, speed, accel, jerk);
+
+    const float length = (destination - origin).length();
+    float last_speed = 0.0f;
+    float last_accel = 0.0f;
+    float last_dist = 0.0f;
+    uint32_t steps = 0;
+    while (!scurve.finished()) {
+        scurve.advance_time(DT);
+        Vector3f pos, vel, acc;
+        scurve.get_target(pos, vel, acc);
+        const float dist = scurve.get_distance();
+        const float accel_along = acc * (destination - origin) / length;
+
+        EXPECT_NEAR(pos.length(), dist, 1.0e-3f * length);
+        EXPECT_GE(dist + 1.0e-4f * length, last_dist);
+        EXPECT_LE(vel.length(), speed * 1.001f);
+        EXPECT_LE(fabsf(accel_along), accel * 1.001f);
+        // the change in acceleration between steps is limited by jerk
+        EXPECT_LE(fabsf(accel_along - last_accel), jerk * DT * 1.01f);
+        // the speed is consistent with the distance moved
+        EXPECT_NEAR(dist - last_dist, 0.5f * (vel.length() + last_speed) * DT, accel * DT * DT + 1.0e-4f * length);
+
+        last_speed = vel.length();
+        last_accel = accel_along;
+        last_dist = dist;
+        ASSERT_LT(++steps, 1000000U);
+    }
+
+    Vector3f pos, vel, acc;
+    scurve.get_target(pos, vel, acc);
+    EXPECT_FLOAT_EQ(length, scurve.get_distance());
+    EXPECT_TRUE(vel.is_zero());
+    EXPECT_NEAR(0.0f, last_speed, jerk * DT * DT + 1.0e-3f * speed);
+    EXPECT_LE(scurve.get_accel_time() * 2.0f, steps * DT + DT);
+}
+
+TEST(SCurveTest, LongSegment)
+{
+    // reaches the speed limit and cruises
+    check_segment(Vector3f(0, 0, 0), Vector3f(10000, 0, 0), 500.0f, 100.0f, 100.0f);
+    check_segment(Vector3f(100, -200, 50), Vector3f(-3000, 4000, 1000), 1000.0f, 250.0f, 500.0f);
+}
+
+TEST(SCurveTest, SpeedLimitsAccel)
+{
+    // the speed is reached before the acceleration limit
+    check_segment(Vector3f(0, 0, 0), Vector3f(5000, 0, 0), 100.0f, 500.0f, 100.0f);
+}
+
+TEST(SCurveTest, ShortSegment)
+{
+    // the speed limit is not reached but the acceleration limit is
+    check_segment(Vector3f(0, 0, 0), Vector3f(0, 600, 0), 1000.0f, 100.0f, 500.0f);
+    // neither limit is reached
+    check_segment(Vector3f(0, 0, 0), Vector3f(0, 0, 20), 1000.0f, 500.0f, 100.0f);
+
+    SCurve scurve;
+    scurve.calculate_track(Vector3f(0, 0, 0), Vector3f(600, 0, 0), 1000.0f, 100.0f, 500.0f);
+    EXPECT_LT(scurve.get_speed_max(), 1000.0f);
+}
+
+TEST(SCurveTest, ZeroLength)
+{
+    SCurve scurve;
+    scurve.calculate_track(Vector3f(1, 2, 3), Vector3f(1, 2, 3), 500.0f, 100.0f, 100.0f);
+    EXPECT_TRUE(scurve.finished());
+    EXPECT_FLOAT_EQ(0.0f, scurve.get_distance());
+}
+
+TEST(SCurveTest, BlendedSegments)
+{
+    // the next segment starting while this one slows down keeps a
+    // constant speed through a straight "corner"
+    SCurve this_leg, next_leg;
+    this_leg.calculate_track(Vector3f(0, 0, 0), Vector3f(5000, 0, 0), 500.0f, 100.0f, 100.0f);
+    next_leg.calculate_track(Vector3f(5000, 0, 0), Vector3f(10000, 0, 0), 500.0f, 100.0f, 100.0f);
+
+    while (!next_leg.finished()) {
+        this_leg.advance_time(DT);
+        if (next_leg.started() || this_leg.time_remaining() <= next_leg.get_accel_time()) {
+            next_leg.advance_time(DT);
+        }
+        Vector3f pos1, vel1, acc1, pos2, vel2, acc2;
+        this_leg.get_target(pos1, vel1, acc1);
+        next_leg.get_target(pos2, vel2, acc2);
+        const float speed = (vel1 + vel2).length();
+        if (this_leg.get_distance() > 2500.0f && next_leg.get_distance() < 2500.0f) {
+            EXPECT_NEAR(500.0f, speed, 1.0f);
+        }
+        EXPECT_LE(speed, 501.0f);
+    }
+}
+
+AP_GTEST_MAIN()
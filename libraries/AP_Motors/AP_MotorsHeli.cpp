@@ -446,37 +446,29 @@ void AP_MotorsHeli::output_logic()
 }
 
 // parameter_check - check if helicopter specific parameters are sensible
-bool AP_MotorsHeli::parameter_check(bool display_msg) const
+bool AP_MotorsHeli::parameter_check(char *failure_msg, const uint8_t failure_msg_len) const
 {
     // returns false if _rsc_setpoint is not higher than _rsc_critical as this would not allow rotor_runup_complete to ever return true
     if (_rsc_critical >= _rsc_setpoint) {
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_RSC_CRITICAL too large");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_RSC_CRITICAL too large");
         return false;
     }
 
     // returns false if RSC Mode is not set to a valid control mode
     if (_rsc_mode <= (int8_t)ROTOR_CONTROL_MODE_DISABLED || _rsc_mode > (int8_t)ROTOR_CONTROL_MODE_CLOSED_LOOP_POWER_OUTPUT) {
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_RSC_MODE invalid");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_RSC_MODE invalid");
         return false;
     }
 
     // returns false if RSC Runup Time is less than Ramp time as this could cause undesired behaviour of rotor speed estimate
     if (_rsc_runup_time <= _rsc_ramp_time){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_RUNUP_TIME too small");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_RUNUP_TIME too small");
         return false;
     }
 
     // returns false if idle output is higher than critical rotor speed as this could block runup_complete from going false
     if ( _rsc_idle_output >=  _rsc_critical){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_RSC_IDLE too large");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_RSC_IDLE too large");
         return false;
     }
 
@@ -80,7 +80,8 @@ public:
     //
 
     // parameter_check - returns true if helicopter specific parameters are sensible, used for pre-arm check
-    virtual bool parameter_check(bool display_msg) const;
+    //   failure_msg is filled in with the reason if they are not
+    virtual bool parameter_check(char *failure_msg, const uint8_t failure_msg_len) const;
 
     // has_flybar - returns true if we have a mechical flybar
     virtual bool has_flybar() const { return AP_MOTORS_HELI_NOFLYBAR; }
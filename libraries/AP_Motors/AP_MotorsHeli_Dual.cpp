@@ -561,24 +561,20 @@ void AP_MotorsHeli_Dual::servo_test()
 }
 
 // parameter_check - check if helicopter specific parameters are sensible
-bool AP_MotorsHeli_Dual::parameter_check(bool display_msg) const
+bool AP_MotorsHeli_Dual::parameter_check(char *failure_msg, const uint8_t failure_msg_len) const
 {
     // returns false if Phase Angle is outside of range for H3 swashplate 1
     if (_swashplate1.get_swash_type() == SWASHPLATE_TYPE_H3 && (_swashplate1.get_phase_angle() > 30 || _swashplate1.get_phase_angle() < -30)){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_SW1_H3_PHANG out of range");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_SW1_H3_PHANG out of range");
         return false;
     }
 
     // returns false if Phase Angle is outside of range for H3 swashplate 2
     if (_swashplate2.get_swash_type() == SWASHPLATE_TYPE_H3 && (_swashplate2.get_phase_angle() > 30 || _swashplate2.get_phase_angle() < -30)){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_SW2_H3_PHANG out of range");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_SW2_H3_PHANG out of range");
         return false;
     }
 
     // check parent class parameters
-    return AP_MotorsHeli::parameter_check(display_msg);
+    return AP_MotorsHeli::parameter_check(failure_msg, failure_msg_len);
 }
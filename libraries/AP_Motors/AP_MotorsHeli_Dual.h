@@ -89,7 +89,8 @@ public:
     void servo_test() override;
 
     // parameter_check - returns true if helicopter specific parameters are sensible, used for pre-arm check
-    bool parameter_check(bool display_msg) const override;
+    //   failure_msg is filled in with the reason if they are not
+    bool parameter_check(char *failure_msg, const uint8_t failure_msg_len) const override;
 
     // var_info for holding Parameter information
     static const struct AP_Param::GroupInfo var_info[];
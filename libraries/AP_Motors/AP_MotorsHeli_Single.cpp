@@ -520,32 +520,26 @@ void AP_MotorsHeli_Single::servo_test()
 }
 
 // parameter_check - check if helicopter specific parameters are sensible
-bool AP_MotorsHeli_Single::parameter_check(bool display_msg) const
+bool AP_MotorsHeli_Single::parameter_check(char *failure_msg, const uint8_t failure_msg_len) const
 {
     // returns false if Phase Angle is outside of range for H3 swashplate
     if (_swashplate.get_swash_type() == SWASHPLATE_TYPE_H3 && (_swashplate.get_phase_angle() > 30 || _swashplate.get_phase_angle() < -30)){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_H3_PHANG out of range");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_H3_PHANG out of range");
         return false;
     }
 
     // returns false if Acro External Gyro Gain is outside of range
     if ((_ext_gyro_gain_acro < 0) || (_ext_gyro_gain_acro > 1000)){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_GYR_GAIN_ACRO out of range");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_GYR_GAIN_ACRO out of range");
         return false;
     }
 
     // returns false if Standard External Gyro Gain is outside of range
     if ((_ext_gyro_gain_std < 0) || (_ext_gyro_gain_std > 1000)){
-        if (display_msg) {
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "PreArm: H_GYR_GAIN out of range");
-        }
+        hal.util->snprintf(failure_msg, failure_msg_len, "H_GYR_GAIN out of range");
         return false;
     }
 
     // check parent class parameters
-    return AP_MotorsHeli::parameter_check(display_msg);
+    return AP_MotorsHeli::parameter_check(failure_msg, failure_msg_len);
 }
@@ -91,7 +91,8 @@ public:
     void set_acro_tail(bool set) override { _acro_tail = set; }
 
     // parameter_check - returns true if helicopter specific parameters are sensible, used for pre-arm check
-    bool parameter_check(bool display_msg) const override;
+    //   failure_msg is filled in with the reason if they are not
+    bool parameter_check(char *failure_msg, const uint8_t failure_msg_len) const override;
 
     // var_info
     static const struct AP_Param::GroupInfo var_info[];
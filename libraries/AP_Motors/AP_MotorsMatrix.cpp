@@ -189,31 +189,29 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // Octo-Quad (x8) + : MOT_YAW_HEADROOM = 300, ATC_RAT_RLL_IMAX = 0.5,   ATC_RAT_PIT_IMAX = 0.5,   ATC_RAT_YAW_IMAX = 0.25
     // Quads cannot make use of motor loss handling because it doesn't have enough degrees of freedom.
 
+    // make sure the mixer matrix holds the current motors and factors
+    if (_mixer.stale) {
+        update_mixer_matrix();
+    }
+    const uint8_t num_motors = _mixer.num_motors;
+    const int8_t lost = mixer_lost_motor();
+
     // calculate amount of yaw we can fit into the throttle range
     // this is always equal to or less than the requested yaw from the pilot or rate controller
-    float rp_low = 1.0f;    // lowest thrust value
-    float rp_high = -1.0f;  // highest thrust value
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            // calculate the thrust outputs for roll and pitch
-            _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
-            // record lowest roll+pitch command
-            if (_thrust_rpyt_out[i] < rp_low) {
-                rp_low = _thrust_rpyt_out[i];
-            }
-            // record highest roll+pitch command
-            if (_thrust_rpyt_out[i] > rp_high && (!_thrust_boost || i != _motor_lost_index)) {
-                rp_high = _thrust_rpyt_out[i];
-            }
-        }
+    float rpy_out[AP_MOTORS_MAX_NUM_MOTORS];    // roll, pitch and yaw outputs of each motor in the mixer matrix
+    for (i=0; i<num_motors; i++) {
+        // calculate the thrust outputs for roll and pitch
+        rpy_out[i] = roll_thrust * _mixer.roll[i] + pitch_thrust * _mixer.pitch[i];
     }
 
+    // record lowest and highest roll+pitch command
+    float rp_low;
+    float rp_high;
+    mixer_out_range(rpy_out, lost, rp_low, rp_high);
+
     // include the lost motor scaled by _thrust_boost_ratio
-    if (_thrust_boost && motor_enabled[_motor_lost_index]) {
-        // record highest roll+pitch command
-        if (_thrust_rpyt_out[_motor_lost_index] > rp_high) {
-            rp_high = _thrust_boost_ratio*rp_high + (1.0f-_thrust_boost_ratio)*_thrust_rpyt_out[_motor_lost_index];
-        }
+    if (lost >= 0 && rpy_out[lost] > rp_high) {
+        rp_high = _thrust_boost_ratio*rp_high + (1.0f-_thrust_boost_ratio)*rpy_out[lost];
     }
 
     // check for roll and pitch saturation
@@ -237,28 +235,18 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     }
 
     // add yaw control to thrust outputs
-    float rpy_low = 1.0f;   // lowest thrust value
-    float rpy_high = -1.0f; // highest thrust value
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
-
-            // record lowest roll+pitch+yaw command
-            if (_thrust_rpyt_out[i] < rpy_low) {
-                rpy_low = _thrust_rpyt_out[i];
-            }
-            // record highest roll+pitch+yaw command
-            if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
-                rpy_high = _thrust_rpyt_out[i];
-            }
-        }
+    for (i=0; i<num_motors; i++) {
+        rpy_out[i] = rpy_out[i] + yaw_thrust * _mixer.yaw[i];
     }
+
+    // record lowest and highest roll+pitch+yaw command
+    float rpy_low;
+    float rpy_high;
+    mixer_out_range(rpy_out, lost, rpy_low, rpy_high);
+
     // include the lost motor scaled by _thrust_boost_ratio
-    if (_thrust_boost) {
-        // record highest roll+pitch+yaw command
-        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
-            rpy_high = _thrust_boost_ratio*rpy_high + (1.0f-_thrust_boost_ratio)*_thrust_rpyt_out[_motor_lost_index];
-        }
+    if (lost >= 0 && rpy_out[lost] > rpy_high) {
+        rpy_high = _thrust_boost_ratio*rpy_high + (1.0f-_thrust_boost_ratio)*rpy_out[lost];
     }
 
     // calculate any scaling needed to make the combined thrust outputs fit within the output range
@@ -295,14 +283,13 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     }
 
     // add scaled roll, pitch, constrained yaw and throttle for each motor
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = throttle_thrust_best_rpy + thr_adj + (rpy_scale * _thrust_rpyt_out[i]);
-        }
+    const float throttle_thrust_out = throttle_thrust_best_rpy + thr_adj;
+    for (i=0; i<num_motors; i++) {
+        _thrust_rpyt_out[_mixer.motor[i]] = throttle_thrust_out + (rpy_scale * rpy_out[i]);
     }
 
     // check for failed motor
-    check_for_failed_motor(throttle_thrust_best_rpy + thr_adj);
+    check_for_failed_motor(throttle_thrust_out);
 }
 
 // check for failed motor
@@ -317,26 +304,23 @@ void AP_MotorsMatrix::check_for_failed_motor(float throttle_thrust_best_plus_adj
 {
     // record filtered and scaled thrust output for motor loss monitoring purposes
     float alpha = 1.0f / (1.0f + _loop_rate * 0.5f);
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out_filt[i] += alpha * (_thrust_rpyt_out[i] - _thrust_rpyt_out_filt[i]);
-        }
+    for (uint8_t i = 0; i < _mixer.num_motors; i++) {
+        const uint8_t motor = _mixer.motor[i];
+        _thrust_rpyt_out_filt[motor] += alpha * (_thrust_rpyt_out[motor] - _thrust_rpyt_out_filt[motor]);
     }
 
     float rpyt_high = 0.0f;
     float rpyt_sum = 0.0f;
-    uint8_t number_motors = 0.0f;
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            number_motors += 1;
-            rpyt_sum += _thrust_rpyt_out_filt[i];
-            // record highest thrust command
-            if (_thrust_rpyt_out_filt[i] > rpyt_high) {
-                rpyt_high = _thrust_rpyt_out_filt[i];
-                // hold motor lost index constant while thrust balance is true
-                if (_thrust_balanced) {
-                    _motor_lost_index = i;
-                }
+    const uint8_t number_motors = _mixer.num_motors;
+    for (uint8_t i = 0; i < number_motors; i++) {
+        const uint8_t motor = _mixer.motor[i];
+        rpyt_sum += _thrust_rpyt_out_filt[motor];
+        // record highest thrust command
+        if (_thrust_rpyt_out_filt[motor] > rpyt_high) {
+            rpyt_high = _thrust_rpyt_out_filt[motor];
+            // hold motor lost index constant while thrust balance is true
+            if (_thrust_balanced) {
+                _motor_lost_index = motor;
             }
         }
     }
@@ -422,6 +406,9 @@ void AP_MotorsMatrix::add_motor_raw(int8_t motor_num, float roll_fac, float pitc
         // set order that motor appears in test
         _test_order[motor_num] = testing_order;
 
+        // repack the mixer matrix before it is next used
+        _mixer.stale = true;
+
         // call parent class method
         add_motor_num(motor_num);
     }
@@ -454,6 +441,7 @@ void AP_MotorsMatrix::remove_motor(int8_t motor_num)
         _roll_factor[motor_num] = 0;
         _pitch_factor[motor_num] = 0;
         _yaw_factor[motor_num] = 0;
+        _mixer.stale = true;
     }
 }
 
@@ -832,6 +820,50 @@ void AP_MotorsMatrix::normalise_rpy_factors()
             }
         }
     }
+    _mixer.stale = true;
+}
+
+// pack the roll, pitch and yaw factors of the enabled motors into the mixer matrix
+void AP_MotorsMatrix::update_mixer_matrix()
+{
+    uint8_t num_motors = 0;
+    for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _mixer.roll[num_motors] = _roll_factor[i];
+            _mixer.pitch[num_motors] = _pitch_factor[i];
+            _mixer.yaw[num_motors] = _yaw_factor[i];
+            _mixer.motor[num_motors] = i;
+            num_motors++;
+        }
+    }
+    _mixer.num_motors = num_motors;
+    _mixer.stale = false;
+}
+
+// get the position of the lost motor in the mixer matrix, returns -1 if thrust boost is not active
+int8_t AP_MotorsMatrix::mixer_lost_motor() const
+{
+    if (_thrust_boost) {
+        for (uint8_t i=0; i<_mixer.num_motors; i++) {
+            if (_mixer.motor[i] == _motor_lost_index) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+// find the lowest and highest mixer outputs, the lost motor is left out of the highest
+void AP_MotorsMatrix::mixer_out_range(const float *out, int8_t lost, float &low, float &high) const
+{
+    low = 1.0f;
+    high = -1.0f;
+    for (uint8_t i=0; i<_mixer.num_motors; i++) {
+        low = MIN(low, out[i]);
+        if (i != lost) {
+            high = MAX(high, out[i]);
+        }
+    }
 }
 
 
@@ -17,7 +17,9 @@ public:
     /// Constructor
     AP_MotorsMatrix(uint16_t loop_rate, uint16_t speed_hz = AP_MOTORS_SPEED_DEFAULT) :
         AP_MotorsMulticopter(loop_rate, speed_hz)
-    {};
+    {
+        _mixer.stale = true;
+    };
 
     // init
     void                init(motor_frame_class frame_class, motor_frame_type frame_type) override;
@@ -83,6 +85,15 @@ protected:
     // call vehicle supplied thrust compensation if set
     void                thrust_compensation(void) override;
 
+    // pack the roll, pitch and yaw factors of the enabled motors into the mixer matrix
+    void                update_mixer_matrix();
+
+    // get the position of the lost motor in the mixer matrix, returns -1 if thrust boost is not active
+    int8_t              mixer_lost_motor() const;
+
+    // find the lowest and highest mixer outputs, the lost motor is left out of the highest
+    void                mixer_out_range(const float *out, int8_t lost, float &low, float &high) const;
+
     float               _roll_factor[AP_MOTORS_MAX_NUM_MOTORS]; // each motors contribution to roll
     float               _pitch_factor[AP_MOTORS_MAX_NUM_MOTORS]; // each motors contribution to pitch
     float               _yaw_factor[AP_MOTORS_MAX_NUM_MOTORS];  // each motors contribution to yaw (normally 1 or -1)
@@ -91,6 +102,16 @@ protected:
     motor_frame_class   _last_frame_class; // most recently requested frame class (i.e. quad, hexa, octa, etc)
     motor_frame_type    _last_frame_type; // most recently requested frame type (i.e. plus, x, v, etc)
 
+    // mixer matrix holding only the enabled motors so the mixing loops are contiguous and free of motor_enabled checks
+    struct {
+        float           roll[AP_MOTORS_MAX_NUM_MOTORS];     // roll factor of each packed motor
+        float           pitch[AP_MOTORS_MAX_NUM_MOTORS];    // pitch factor of each packed motor
+        float           yaw[AP_MOTORS_MAX_NUM_MOTORS];      // yaw factor of each packed motor
+        uint8_t         motor[AP_MOTORS_MAX_NUM_MOTORS];    // motor number of each packed motor, in increasing order
+        uint8_t         num_motors;                         // number of packed motors
+        bool            stale;                              // true if the factors have changed since the matrix was packed
+    } _mixer;
+
     // motor failure handling
     float               _thrust_rpyt_out_filt[AP_MOTORS_MAX_NUM_MOTORS];    // filtered thrust outputs with 1 second time constant
     uint8_t             _motor_lost_index;  // index number of the lost motor
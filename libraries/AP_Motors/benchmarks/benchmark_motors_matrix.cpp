@@ -0,0 +1,52 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Motors/AP_MotorsMatrix.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class AP_MotorsMatrix_Benchmark : public AP_MotorsMatrix
+{
+public:
+    AP_MotorsMatrix_Benchmark() : AP_MotorsMatrix(400) {}
+
+    // set up a frame with motors evenly spaced around the vehicle without assigning servo channels
+    void setup_frame(uint8_t num_motors)
+    {
+        for (uint8_t i=0; i<num_motors; i++) {
+            const float angle = radians(45.0f + i * 360.0f / num_motors);
+            motor_enabled[i] = true;
+            _roll_factor[i] = cosf(angle + radians(90.0f));
+            _pitch_factor[i] = cosf(angle);
+            _yaw_factor[i] = (i % 2) ? AP_MOTORS_MATRIX_YAW_FACTOR_CW : AP_MOTORS_MATRIX_YAW_FACTOR_CCW;
+        }
+        normalise_rpy_factors();
+        _throttle_filter.reset(0.5f);
+        _throttle_avg_max = 0.5f;
+    }
+
+    void mix(float roll, float pitch, float yaw)
+    {
+        _roll_in = roll;
+        _pitch_in = pitch;
+        _yaw_in = yaw;
+        output_armed_stabilizing();
+    }
+};
+
+static void BM_MotorsMatrixMix(benchmark::State& state)
+{
+    AP_MotorsMatrix_Benchmark motors;
+    motors.setup_frame(state.range(0));
+
+    uint8_t n = 0;
+    while (state.KeepRunning()) {
+        // vary the inputs so both saturated and unsaturated outputs are mixed
+        const float input = (n++ - 128) * (1.0f / 128.0f);
+        motors.mix(input, 0.5f * input, 0.25f * input);
+        gbenchmark_escape(&motors);
+    }
+}
+
+BENCHMARK(BM_MotorsMatrixMix)->Arg(4)->Arg(6)->Arg(8)->Arg(12);
+
+BENCHMARK_MAIN()
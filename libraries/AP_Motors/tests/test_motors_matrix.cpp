@@ -0,0 +1,390 @@
+#include <AP_gtest.h>
+
+#include <AP_Motors/AP_MotorsMatrix.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  matrix motors with the mixer inputs exposed and a copy of the mixer
+  from before the mixer matrix was packed to check the results against
+ */
+class AP_MotorsMatrix_Test : public AP_MotorsMatrix
+{
+public:
+    AP_MotorsMatrix_Test() : AP_MotorsMatrix(400) {}
+
+    // set up a frame with motors evenly spaced around the vehicle on the given outputs without assigning servo channels
+    void setup_frame(const uint8_t *outputs, uint8_t num_motors)
+    {
+        for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            remove_motor(i);
+        }
+        for (uint8_t i=0; i<num_motors; i++) {
+            const float angle = radians(45.0f + i * 360.0f / num_motors);
+            const uint8_t motor = outputs[i];
+            motor_enabled[motor] = true;
+            _roll_factor[motor] = cosf(angle + radians(90.0f));
+            _pitch_factor[motor] = cosf(angle);
+            _yaw_factor[motor] = (i % 2) ? AP_MOTORS_MATRIX_YAW_FACTOR_CW : AP_MOTORS_MATRIX_YAW_FACTOR_CCW;
+        }
+        normalise_rpy_factors();
+    }
+
+    void set_inputs(float roll, float pitch, float yaw, float throttle, float throttle_avg_max, float lift_max)
+    {
+        _roll_in = roll;
+        _pitch_in = pitch;
+        _yaw_in = yaw;
+        _throttle_filter.reset(throttle);
+        _throttle_avg_max = throttle_avg_max;
+        _lift_max = lift_max;
+    }
+
+    void set_thrust_boost(bool boost, float ratio, uint8_t lost_index)
+    {
+        _thrust_boost = boost;
+        _thrust_boost_ratio = ratio;
+        _motor_lost_index = lost_index;
+    }
+
+    void clear_limits()
+    {
+        limit.roll_pitch = false;
+        limit.yaw = false;
+        limit.throttle_lower = false;
+        limit.throttle_upper = false;
+    }
+
+    void mix() { output_armed_stabilizing(); }
+    void mix_reference() { output_armed_stabilizing_reference(); }
+
+    float get_thrust_out(uint8_t i) const { return _thrust_rpyt_out[i]; }
+    bool get_thrust_balanced() const { return _thrust_balanced; }
+
+private:
+    void output_armed_stabilizing_reference();
+    void check_for_failed_motor_reference(float throttle_thrust_best_plus_adj);
+};
+
+void AP_MotorsMatrix_Test::output_armed_stabilizing_reference()
+{
+    uint8_t i;                          // general purpose counter
+    float   roll_thrust;                // roll thrust input value, +/- 1.0
+    float   pitch_thrust;               // pitch thrust input value, +/- 1.0
+    float   yaw_thrust;                 // yaw thrust input value, +/- 1.0
+    float   throttle_thrust;            // throttle thrust input value, 0.0 - 1.0
+    float   throttle_avg_max;           // throttle thrust average maximum value, 0.0 - 1.0
+    float   throttle_thrust_max;        // throttle thrust maximum value, 0.0 - 1.0
+    float   throttle_thrust_best_rpy;   // throttle providing maximum roll, pitch and yaw range without climbing
+    float   rpy_scale = 1.0f;           // this is used to scale the roll, pitch and yaw to fit within the motor limits
+    float   yaw_allowed = 1.0f;         // amount of yaw we can fit in
+    float   thr_adj;                    // the difference between the pilot's desired throttle and throttle_thrust_best_rpy
+
+    // apply voltage and air pressure compensation
+    const float compensation_gain = get_compensation_gain(); // compensation for battery voltage and altitude
+    roll_thrust = _roll_in * compensation_gain;
+    pitch_thrust = _pitch_in * compensation_gain;
+    yaw_thrust = _yaw_in * compensation_gain;
+    throttle_thrust = get_throttle() * compensation_gain;
+    throttle_avg_max = _throttle_avg_max * compensation_gain;
+    throttle_thrust_max = _thrust_boost_ratio + (1.0f - _thrust_boost_ratio) * _throttle_thrust_max;
+
+    // sanity check throttle is above zero and below current limited throttle
+    if (throttle_thrust <= 0.0f) {
+        throttle_thrust = 0.0f;
+        limit.throttle_lower = true;
+    }
+    if (throttle_thrust >= throttle_thrust_max) {
+        throttle_thrust = throttle_thrust_max;
+        limit.throttle_upper = true;
+    }
+
+    // ensure that throttle_avg_max is between the input throttle and the maximum throttle
+    throttle_avg_max = constrain_float(throttle_avg_max, throttle_thrust, throttle_thrust_max);
+
+    // calculate throttle that gives most possible room for yaw which is the lower of:
+    //      1. 0.5f - (rpy_low+rpy_high)/2.0 - this would give the maximum possible margin above the highest motor and below the lowest
+    //      2. the higher of:
+    //            a) the pilot's throttle input
+    //            b) the point _throttle_rpy_mix between the pilot's input throttle and hover-throttle
+    //      Situation #2 ensure we never increase the throttle above hover throttle unless the pilot has commanded this.
+    //      Situation #2b allows us to raise the throttle above what the pilot commanded but not so far that it would actually cause the copter to rise.
+    //      We will choose #1 (the best throttle for yaw control) if that means reducing throttle to the motors (i.e. we favor reducing throttle *because* it provides better yaw control)
+    //      We will choose #2 (a mix of pilot and hover throttle) only when the throttle is quite low.  We favor reducing throttle instead of better yaw control because the pilot has commanded it
+
+    // Under the motor lost condition we remove the highest motor output from our calculations and let that motor go greater than 1.0
+    // To ensure control and maximum righting performance Hex and Octo have some optimal settings that should be used
+    // Y6               : MOT_YAW_HEADROOM = 350, ATC_RAT_RLL_IMAX = 1.0,   ATC_RAT_PIT_IMAX = 1.0,   ATC_RAT_YAW_IMAX = 0.5
+    // Octo-Quad (x8) x : MOT_YAW_HEADROOM = 300, ATC_RAT_RLL_IMAX = 0.375, ATC_RAT_PIT_IMAX = 0.375, ATC_RAT_YAW_IMAX = 0.375
+    // Octo-Quad (x8) + : MOT_YAW_HEADROOM = 300, ATC_RAT_RLL_IMAX = 0.75,  ATC_RAT_PIT_IMAX = 0.75,  ATC_RAT_YAW_IMAX = 0.375
+    // Usable minimums below may result in attitude offsets when motors are lost. Hex aircraft are only marginal and must be handles with care
+    // Hex              : MOT_YAW_HEADROOM = 0,   ATC_RAT_RLL_IMAX = 1.0,   ATC_RAT_PIT_IMAX = 1.0,   ATC_RAT_YAW_IMAX = 0.5
+    // Octo-Quad (x8) x : MOT_YAW_HEADROOM = 300, ATC_RAT_RLL_IMAX = 0.25,  ATC_RAT_PIT_IMAX = 0.25,  ATC_RAT_YAW_IMAX = 0.25
+    // Octo-Quad (x8) + : MOT_YAW_HEADROOM = 300, ATC_RAT_RLL_IMAX = 0.5,   ATC_RAT_PIT_IMAX = 0.5,   ATC_RAT_YAW_IMAX = 0.25
+    // Quads cannot make use of motor loss handling because it doesn't have enough degrees of freedom.
+
+    // calculate amount of yaw we can fit into the throttle range
+    // this is always equal to or less than the requested yaw from the pilot or rate controller
+    float rp_low = 1.0f;    // lowest thrust value
+    float rp_high = -1.0f;  // highest thrust value
+    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            // calculate the thrust outputs for roll and pitch
+            _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
+            // record lowest roll+pitch command
+            if (_thrust_rpyt_out[i] < rp_low) {
+                rp_low = _thrust_rpyt_out[i];
+            }
+            // record highest roll+pitch command
+            if (_thrust_rpyt_out[i] > rp_high && (!_thrust_boost || i != _motor_lost_index)) {
+                rp_high = _thrust_rpyt_out[i];
+            }
+        }
+    }
+
+    // include the lost motor scaled by _thrust_boost_ratio
+    if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+        // record highest roll+pitch command
+        if (_thrust_rpyt_out[_motor_lost_index] > rp_high) {
+            rp_high = _thrust_boost_ratio*rp_high + (1.0f-_thrust_boost_ratio)*_thrust_rpyt_out[_motor_lost_index];
+        }
+    }
+
+    // check for roll and pitch saturation
+    if (rp_high-rp_low > 1.0f || throttle_avg_max < -rp_low) {
+        // Full range is being used by roll and pitch.
+        limit.roll_pitch = true;
+    }
+
+    // calculate the highest allowed average thrust that will provide maximum control range
+    throttle_thrust_best_rpy = MIN(0.5f, throttle_avg_max);
+
+    // calculate the maximum yaw control that can be used
+    // todo: make _yaw_headroom 0 to 1
+    yaw_allowed = (float)_yaw_headroom / 1000.0f;
+    yaw_allowed = _thrust_boost_ratio*0.5f + (1.0f - _thrust_boost_ratio) * yaw_allowed;
+    yaw_allowed = MAX(MIN(throttle_thrust_best_rpy+rp_low, 1.0f - (throttle_thrust_best_rpy + rp_high)), yaw_allowed);
+    if (fabsf(yaw_thrust) > yaw_allowed) {
+        // not all commanded yaw can be used
+        yaw_thrust = constrain_float(yaw_thrust, -yaw_allowed, yaw_allowed);
+        limit.yaw = true;
+    }
+
+    // add yaw control to thrust outputs
+    float rpy_low = 1.0f;   // lowest thrust value
+    float rpy_high = -1.0f; // highest thrust value
+    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
+
+            // record lowest roll+pitch+yaw command
+            if (_thrust_rpyt_out[i] < rpy_low) {
+                rpy_low = _thrust_rpyt_out[i];
+            }
+            // record highest roll+pitch+yaw command
+            if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
+                rpy_high = _thrust_rpyt_out[i];
+            }
+        }
+    }
+    // include the lost motor scaled by _thrust_boost_ratio
+    if (_thrust_boost) {
+        // record highest roll+pitch+yaw command
+        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
+            rpy_high = _thrust_boost_ratio*rpy_high + (1.0f-_thrust_boost_ratio)*_thrust_rpyt_out[_motor_lost_index];
+        }
+    }
+
+    // calculate any scaling needed to make the combined thrust outputs fit within the output range
+    if (rpy_high-rpy_low > 1.0f) {
+        rpy_scale = 1.0f / (rpy_high-rpy_low);
+    }
+    if (is_negative(rpy_low)) {
+        rpy_scale = MIN(rpy_scale, -throttle_avg_max / rpy_low);
+    }
+
+    // calculate how close the motors can come to the desired throttle
+    rpy_high *= rpy_scale;
+    rpy_low *= rpy_scale;
+    throttle_thrust_best_rpy = -rpy_low;
+    thr_adj = throttle_thrust - throttle_thrust_best_rpy;
+    if (rpy_scale < 1.0f) {
+        // Full range is being used by roll, pitch, and yaw.
+        limit.roll_pitch = true;
+        limit.yaw = true;
+        if (thr_adj > 0.0f) {
+            limit.throttle_upper = true;
+        }
+        thr_adj = 0.0f;
+    } else {
+        if (thr_adj < 0.0f) {
+            // Throttle can't be reduced to desired value
+            // todo: add lower limit flag and ensure it is handled correctly in altitude controller
+            thr_adj = 0.0f;
+        } else if (thr_adj > 1.0f - (throttle_thrust_best_rpy + rpy_high)) {
+            // Throttle can't be increased to desired value
+            thr_adj = 1.0f - (throttle_thrust_best_rpy + rpy_high);
+            limit.throttle_upper = true;
+        }
+    }
+
+    // add scaled roll, pitch, constrained yaw and throttle for each motor
+    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _thrust_rpyt_out[i] = throttle_thrust_best_rpy + thr_adj + (rpy_scale * _thrust_rpyt_out[i]);
+        }
+    }
+
+    // check for failed motor
+    check_for_failed_motor_reference(throttle_thrust_best_rpy + thr_adj);
+}
+
+// check for failed motor
+//   should be run immediately after output_armed_stabilizing
+//   first argument is the sum of:
+//      a) throttle_thrust_best_rpy : throttle level (from 0 to 1) providing maximum roll, pitch and yaw range without climbing
+//      b) thr_adj: the difference between the pilot's desired throttle and throttle_thrust_best_rpy
+//   records filtered motor output values in _thrust_rpyt_out_filt array
+//   sets thrust_balanced to true if motors are balanced, false if a motor failure is detected
+//   sets _motor_lost_index to index of failed motor
+void AP_MotorsMatrix_Test::check_for_failed_motor_reference(float throttle_thrust_best_plus_adj)
+{
+    // record filtered and scaled thrust output for motor loss monitoring purposes
+    float alpha = 1.0f / (1.0f + _loop_rate * 0.5f);
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _thrust_rpyt_out_filt[i] += alpha * (_thrust_rpyt_out[i] - _thrust_rpyt_out_filt[i]);
+        }
+    }
+
+    float rpyt_high = 0.0f;
+    float rpyt_sum = 0.0f;
+    uint8_t number_motors = 0.0f;
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            number_motors += 1;
+            rpyt_sum += _thrust_rpyt_out_filt[i];
+            // record highest thrust command
+            if (_thrust_rpyt_out_filt[i] > rpyt_high) {
+                rpyt_high = _thrust_rpyt_out_filt[i];
+                // hold motor lost index constant while thrust balance is true
+                if (_thrust_balanced) {
+                    _motor_lost_index = i;
+                }
+            }
+        }
+    }
+
+    float thrust_balance = 1.0f;
+    if (rpyt_sum > 0.1f) {
+        thrust_balance = rpyt_high * number_motors / rpyt_sum;
+    }
+    // ensure thrust balance does not activate for multirotors with less than 6 motors
+    if (number_motors >= 6 && thrust_balance >= 1.5f && _thrust_balanced) {
+        _thrust_balanced = false;
+    }
+    if (thrust_balance <= 1.25f && !_thrust_balanced) {
+        _thrust_balanced = true;
+    }
+
+    // check to see if thrust boost is using more throttle than _throttle_thrust_max
+    if (_throttle_thrust_max > throttle_thrust_best_plus_adj && rpyt_high < 0.9f && _thrust_balanced) {
+        _thrust_boost = false;
+    }
+}
+
+// uniformly distributed random number between low and high
+static float rand_range(float low, float high)
+{
+    return low + (high - low) * (float)rand() / (float)RAND_MAX;
+}
+
+static void check_frame(const uint8_t *outputs, uint8_t num_motors)
+{
+    AP_MotorsMatrix_Test motors;
+    AP_MotorsMatrix_Test reference;
+    motors.setup_frame(outputs, num_motors);
+    reference.setup_frame(outputs, num_motors);
+
+    srand(num_motors);
+    for (uint16_t n = 0; n < 5000; n++) {
+        const float roll = rand_range(-1.0f, 1.0f);
+        const float pitch = rand_range(-1.0f, 1.0f);
+        const float yaw = rand_range(-1.0f, 1.0f);
+        const float throttle = rand_range(-0.1f, 1.1f);
+        const float throttle_avg_max = rand_range(0.0f, 1.0f);
+        const float lift_max = rand_range(0.8f, 1.0f);
+        const int16_t yaw_headroom = rand() % 500;
+        const bool boost = (n % 4) == 0;
+        const float boost_ratio = boost ? rand_range(0.0f, 1.0f) : 0.0f;
+        const uint8_t lost = outputs[rand() % num_motors];
+
+        for (AP_MotorsMatrix_Test *m : {&motors, &reference}) {
+            m->set_inputs(roll, pitch, yaw, throttle, throttle_avg_max, lift_max);
+            m->set_yaw_headroom(yaw_headroom);
+            m->set_thrust_boost(boost, boost_ratio, lost);
+            m->clear_limits();
+        }
+        motors.mix();
+        reference.mix_reference();
+
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            EXPECT_FLOAT_EQ(reference.get_thrust_out(i), motors.get_thrust_out(i));
+        }
+        EXPECT_EQ(reference.limit.roll_pitch, motors.limit.roll_pitch);
+        EXPECT_EQ(reference.limit.yaw, motors.limit.yaw);
+        EXPECT_EQ(reference.limit.throttle_lower, motors.limit.throttle_lower);
+        EXPECT_EQ(reference.limit.throttle_upper, motors.limit.throttle_upper);
+        EXPECT_EQ(reference.get_thrust_boost(), motors.get_thrust_boost());
+        EXPECT_EQ(reference.get_thrust_balanced(), motors.get_thrust_balanced());
+        EXPECT_EQ(reference.get_lost_motor(), motors.get_lost_motor());
+    }
+}
+
+TEST(MotorsMatrixTest, Quad)
+{
+    const uint8_t outputs[] = {0, 1, 2, 3};
+    check_frame(outputs, ARRAY_SIZE(outputs));
+}
+
+TEST(MotorsMatrixTest, Octa)
+{
+    const uint8_t outputs[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    check_frame(outputs, ARRAY_SIZE(outputs));
+}
+
+TEST(MotorsMatrixTest, Dodeca)
+{
+    const uint8_t outputs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    check_frame(outputs, ARRAY_SIZE(outputs));
+}
+
+TEST(MotorsMatrixTest, SparseOutputs)
+{
+    // motors on outputs with gaps between them are packed together in the mixer matrix
+    const uint8_t outputs[] = {1, 2, 4, 7, 8, 11};
+    check_frame(outputs, ARRAY_SIZE(outputs));
+}
+
+TEST(MotorsMatrixTest, MotorRemoved)
+{
+    // the mixer matrix is repacked when the frame changes
+    AP_MotorsMatrix_Test motors;
+    AP_MotorsMatrix_Test reference;
+    const uint8_t hexa[] = {0, 1, 2, 3, 4, 5};
+    const uint8_t quad[] = {0, 1, 2, 3};
+    motors.setup_frame(hexa, ARRAY_SIZE(hexa));
+    motors.set_inputs(0.2f, -0.1f, 0.05f, 0.5f, 0.5f, 1.0f);
+    motors.mix();
+    motors.setup_frame(quad, ARRAY_SIZE(quad));
+    motors.mix();
+
+    reference.setup_frame(quad, ARRAY_SIZE(quad));
+    reference.set_inputs(0.2f, -0.1f, 0.05f, 0.5f, 0.5f, 1.0f);
+    reference.mix_reference();
+    for (uint8_t i = 0; i < ARRAY_SIZE(quad); i++) {
+        EXPECT_FLOAT_EQ(reference.get_thrust_out(i), motors.get_thrust_out(i));
+    }
+}
+
+AP_GTEST_MAIN()
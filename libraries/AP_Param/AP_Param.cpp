@@ -63,6 +63,9 @@ uint16_t AP_Param::_num_vars;
 // cached parameter count
 uint16_t AP_Param::_parameter_count;
 
+// count of parameter changes
+uint32_t AP_Param::_change_count;
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -1083,6 +1086,8 @@ void AP_Param::save_sync(bool force_save)
 */
 void AP_Param::save(bool force_save)
 {
+    _change_count++;
+
     struct param_save p;
     p.param = this;
     p.force_save = force_save;
@@ -1811,6 +1816,7 @@ void AP_Param::set_float(float value, enum ap_var_type var_type)
         v = constrain_float(v, -128, 127);
         ((AP_Int8 *)this)->set(v);
     }
+    _change_count++;
 }
 
 
@@ -2224,6 +2230,7 @@ bool AP_Param::set_by_name(const char *name, float value)
     if (vp == nullptr) {
         return false;
     }
+    _change_count++;
     switch (vtype) {
     case AP_PARAM_INT8:
         ((AP_Int8 *)vp)->set(value);
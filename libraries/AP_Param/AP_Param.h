@@ -429,6 +429,10 @@ public:
     // count of parameters in tree
     static uint16_t count_parameters(void);
 
+    // count of parameter changes through set_float(), set_by_name()
+    // and save(), for detecting configuration changes
+    static uint32_t change_count(void) { return _change_count; }
+
     static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
 
     // set frame type flags. Used to unhide frame specific parameters
@@ -612,6 +616,7 @@ private:
     static StorageAccess        _storage;
     static uint16_t             _num_vars;
     static uint16_t             _parameter_count;
+    static uint32_t             _change_count;
     static const struct Info *  _var_info;
 
     /*
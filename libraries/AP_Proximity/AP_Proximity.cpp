@@ -22,6 +22,9 @@
 #include "AP_Proximity_MAV.h"
 #include "AP_Proximity_SITL.h"
 #include "AP_Proximity_MorseSITL.h"
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Common/Semaphore.h>
+#include <AP_RangeFinder/RangeFinder_Backend.h>
 
 extern const AP_HAL::HAL &hal;
 
@@ -173,6 +176,35 @@ const AP_Param::GroupInfo AP_Proximity::var_info[] = {
     AP_GROUPINFO("2_YAW_CORR", 18, AP_Proximity, _yaw_correction[1], PROXIMITY_YAW_CORRECTION_DEFAULT),
 #endif
 
+#if HAL_PROXIMITY_MAP_ENABLED
+    // @Param: _MAP_RES
+    // @DisplayName: Proximity occupancy map resolution
+    // @Description: Size of the cubes the 3D occupancy map of obstacles is divided into.  Zero, the default, disables the map.  The map uses about 12k of memory when enabled
+    // @Units: m
+    // @Range: 0 5
+    // @Increment: 0.1
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_MAP_RES", 19, AP_Proximity, _map_res, PROXIMITY_MAP_RES_DEFAULT),
+
+    // @Param: _MAP_AGE
+    // @DisplayName: Proximity occupancy map obstacle timeout
+    // @Description: Obstacles which have not been seen by a proximity sensor or rangefinder for this long are removed from the occupancy map
+    // @Units: s
+    // @Range: 1 120
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_MAP_AGE", 20, AP_Proximity, _map_age, PROXIMITY_MAP_AGE_DEFAULT),
+#endif
+
+    // @Param: _SECTORS
+    // @DisplayName: Proximity scanning sensor sectors
+    // @Description: Number of equal width sectors the area around the vehicle is divided into for scanning sensors (RPLidarA2, SITL and MorseSITL).  More sectors allow avoidance of narrower obstacles.  Readings within ignore areas are discarded.  Zero uses up to 12 sectors fitted around the ignore areas
+    // @Values: 0:Default,8:8 sectors,36:36 sectors,72:72 sectors,120:120 sectors,180:180 sectors,360:360 sectors
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_SECTORS", 21, AP_Proximity, _scan_sectors, 0),
+
     AP_GROUPEND
 };
 
@@ -229,7 +261,118 @@ void AP_Proximity::update(void)
             primary_instance = i;
         }
     }
+
+#if HAL_PROXIMITY_MAP_ENABLED
+    update_map();
+#endif
+}
+
+#if HAL_PROXIMITY_MAP_ENABLED
+// returns true if any sensor can add returns to the occupancy map
+bool AP_Proximity::have_map_sensor() const
+{
+    if (num_instances > 0) {
+        return true;
+    }
+    if (_rangefinder == nullptr) {
+        return false;
+    }
+    for (uint8_t i=0; i<_rangefinder->num_sensors(); i++) {
+        const AP_RangeFinder_Backend *rangefinder = _rangefinder->get_backend(i);
+        if (rangefinder != nullptr && rangefinder->orientation() != ROTATION_PITCH_270) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// add latest proximity sensor and rangefinder returns to the occupancy map
+// at most PROXIMITY_MAP_RETURNS_MAX returns are added each call, the next call continues from where this one stopped
+void AP_Proximity::update_map()
+{
+    const uint32_t now = AP_HAL::millis();
+    if (_map_next_return == 0) {
+        if (now - _map_update_ms < PROXIMITY_MAP_UPDATE_MS) {
+            return;
+        }
+        _map_update_ms = now;
+    }
+
+    // the avoidance path planner reads the map from its own thread
+    WITH_SEMAPHORE(_map.get_semaphore());
+
+    // memory is only allocated if the map is enabled and there is a sensor to fill it
+    if (!_map.enabled()) {
+        if (!is_positive(_map_res) || _map_alloc_failed || !have_map_sensor()) {
+            return;
+        }
+        if (!_map.init(_map_res, _map_age * 1000)) {
+            _map_alloc_failed = true;
+            return;
+        }
+    }
+
+    const AP_AHRS &ahrs = AP::ahrs();
+    Vector3f pos;
+    if (!ahrs.get_relative_position_NED_origin(pos)) {
+        _map_next_return = 0;
+        return;
+    }
+    _map.set_vehicle_position(pos);
+
+    // returns are numbered across all sensors, first_return is the number of the first return of the current sensor
+    uint16_t first_return = 0;
+    uint8_t num_added = 0;
+
+    // proximity sensor distances are horizontal from the vehicle
+    for (uint8_t i=0; i<num_instances; i++) {
+        if (drivers[i] == nullptr || _type[i] == Proximity_Type_None || state[i].status != Proximity_Good) {
+            continue;
+        }
+        const uint16_t num_objects = drivers[i]->get_object_count();
+        for (uint16_t j=MAX(_map_next_return, first_return) - first_return; j<num_objects; j++) {
+            if (num_added >= PROXIMITY_MAP_RETURNS_MAX) {
+                return;
+            }
+            float angle_deg, distance;
+            if (drivers[i]->get_object_angle_and_distance(j, angle_deg, distance)) {
+                const float angle_ef = radians(angle_deg) + ahrs.yaw;
+                _map.add_return(pos, pos + Vector3f(cosf(angle_ef) * distance, sinf(angle_ef) * distance, 0.0f));
+            }
+            num_added++;
+            _map_next_return++;
+        }
+        first_return += num_objects;
+    }
+
+    // rangefinders may point in any direction except down where they only see the ground
+    if (_rangefinder != nullptr) {
+        const Matrix3f &body_to_ned = ahrs.get_rotation_body_to_ned();
+        for (uint8_t i=0; i<_rangefinder->num_sensors(); i++, first_return++) {
+            if (first_return < _map_next_return) {
+                continue;
+            }
+            if (num_added >= PROXIMITY_MAP_RETURNS_MAX) {
+                return;
+            }
+            num_added++;
+            _map_next_return++;
+            const AP_RangeFinder_Backend *rangefinder = _rangefinder->get_backend(i);
+            if (rangefinder == nullptr ||
+                rangefinder->orientation() == ROTATION_PITCH_270 ||
+                rangefinder->status() != RangeFinder::RangeFinder_Good) {
+                continue;
+            }
+            Vector3f direction(1.0f, 0.0f, 0.0f);
+            direction.rotate(rangefinder->orientation());
+            _map.add_return(pos, pos + body_to_ned * direction * (rangefinder->distance_cm() * 0.01f));
+        }
+    }
+
+    // all returns have been added, start a new pass
+    _map_next_return = 0;
 }
+#endif
 
 // return sensor orientation
 uint8_t AP_Proximity::get_orientation(uint8_t instance) const
@@ -390,7 +533,7 @@ bool AP_Proximity::get_closest_object(float& angle_deg, float &distance) const
 }
 
 // get number of objects, used for non-GPS avoidance
-uint8_t AP_Proximity::get_object_count() const
+uint16_t AP_Proximity::get_object_count() const
 {
     if ((drivers[primary_instance] == nullptr) || (_type[primary_instance] == Proximity_Type_None)) {
         return 0;
@@ -401,7 +544,7 @@ uint8_t AP_Proximity::get_object_count() const
 
 // get an object's angle and distance, used for non-GPS avoidance
 // returns false if no angle or distance could be returned for some reason
-bool AP_Proximity::get_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const
+bool AP_Proximity::get_object_angle_and_distance(uint16_t object_number, float& angle_deg, float &distance) const
 {
     if ((drivers[primary_instance] == nullptr) || (_type[primary_instance] == Proximity_Type_None)) {
         return false;
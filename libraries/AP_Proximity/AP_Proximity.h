@@ -20,6 +20,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_RangeFinder/AP_RangeFinder.h>
+#include "AP_Proximity_Map.h"
 
 #define PROXIMITY_MAX_INSTANCES             1   // Maximum number of proximity sensor instances available on this platform
 #define PROXIMITY_YAW_CORRECTION_DEFAULT    22  // default correction for sensor error in yaw
@@ -27,6 +28,14 @@
 #define PROXIMITY_MAX_DIRECTION 8
 #define PROXIMITY_SENSOR_ID_START 10
 
+#ifndef HAL_PROXIMITY_MAP_ENABLED
+#define HAL_PROXIMITY_MAP_ENABLED !HAL_MINIMIZE_FEATURES
+#endif
+#define PROXIMITY_MAP_RES_DEFAULT           0.0f    // default size of occupancy map voxels in meters, zero disables the map
+#define PROXIMITY_MAP_AGE_DEFAULT           10      // default time in seconds before unseen voxels are removed from the map
+#define PROXIMITY_MAP_UPDATE_MS             50      // a new pass over all sensor returns is started at most at 20hz
+#define PROXIMITY_MAP_RETURNS_MAX           8       // maximum number of returns added to the occupancy map per update
+
 class AP_Proximity_Backend;
 
 class AP_Proximity
@@ -105,8 +114,8 @@ public:
     bool get_closest_object(float& angle_deg, float &distance) const;
 
     // get number of objects, angle and distance - used for non-GPS avoidance
-    uint8_t get_object_count() const;
-    bool get_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const;
+    uint16_t get_object_count() const;
+    bool get_object_angle_and_distance(uint16_t object_number, float& angle_deg, float &distance) const;
 
     // get maximum and minimum distances (in meters) of primary sensor
     float distance_max() const;
@@ -131,6 +140,15 @@ public:
 
     Proximity_Type get_type(uint8_t instance) const;
 
+    // get 3D occupancy map of obstacles, returns nullptr if the map is disabled
+    const AP_Proximity_Map *get_map() const {
+#if HAL_PROXIMITY_MAP_ENABLED
+        return _map.enabled() ? &_map : nullptr;
+#else
+        return nullptr;
+#endif
+    }
+
     // parameter list
     static const struct AP_Param::GroupInfo var_info[];
 
@@ -157,7 +175,23 @@ private:
     AP_Int16 _yaw_correction[PROXIMITY_MAX_INSTANCES];
     AP_Int16 _ignore_angle_deg[PROXIMITY_MAX_IGNORE];   // angle (in degrees) of area that should be ignored by sensor (i.e. leg shows up)
     AP_Int8 _ignore_width_deg[PROXIMITY_MAX_IGNORE];    // width of beam (in degrees) that should be ignored
+    AP_Int16 _scan_sectors;                             // number of equal width sectors used by scanning sensors, zero to fit sectors around ignore areas
 
     void detect_instance(uint8_t instance);
     void update_instance(uint8_t instance);  
+
+#if HAL_PROXIMITY_MAP_ENABLED
+    // add latest proximity sensor and rangefinder returns to the occupancy map
+    void update_map();
+
+    // returns true if any sensor can add returns to the occupancy map
+    bool have_map_sensor() const;
+
+    AP_Float _map_res;                  // size of occupancy map voxels in meters, zero disables the map
+    AP_Int16 _map_age;                  // time in seconds before unseen voxels are removed from the map
+    AP_Proximity_Map _map;              // 3D occupancy map of obstacles
+    uint32_t _map_update_ms;            // system time the last pass over all sensor returns was started
+    uint16_t _map_next_return;          // next return to add to the occupancy map, zero when a new pass is due
+    bool _map_alloc_failed;             // true if memory for the occupancy map could not be allocated
+#endif
 };
@@ -24,7 +24,14 @@
 */
 AP_Proximity_Backend::AP_Proximity_Backend(AP_Proximity &_frontend, AP_Proximity::Proximity_State &_state) :
         frontend(_frontend),
-        state(_state)
+        state(_state),
+        _sector_middle_deg(_sector_middle_deg_buf),
+        _sector_width_deg(_sector_width_deg_buf),
+        _angle(_angle_buf),
+        _distance(_distance_buf),
+        _distance_valid(_distance_valid_buf),
+        _sector_edge_vector(_sector_edge_vector_buf),
+        _boundary_point(_boundary_point_buf)
 {
     // initialise sector edge vector used for building the boundary fence
     init_boundary();
@@ -33,7 +40,7 @@ AP_Proximity_Backend::AP_Proximity_Backend(AP_Proximity &_frontend, AP_Proximity
 // get distance in meters in a particular direction in degrees (0 is forward, angles increase in the clockwise direction)
 bool AP_Proximity_Backend::get_horizontal_distance(float angle_deg, float &distance) const
 {
-    uint8_t sector;
+    uint16_t sector;
     if (convert_angle_to_sector(angle_deg, sector)) {
         if (_distance_valid[sector]) {
             distance = _distance[sector];
@@ -48,10 +55,10 @@ bool AP_Proximity_Backend::get_horizontal_distance(float angle_deg, float &dista
 bool AP_Proximity_Backend::get_closest_object(float& angle_deg, float &distance) const
 {
     bool sector_found = false;
-    uint8_t sector = 0;
+    uint16_t sector = 0;
 
     // check all sectors for shorter distance
-    for (uint8_t i=0; i<_num_sectors; i++) {
+    for (uint16_t i=0; i<_num_sectors; i++) {
         if (_distance_valid[i]) {
             if (!sector_found || (_distance[i] < _distance[sector])) {
                 sector = i;
@@ -68,14 +75,14 @@ bool AP_Proximity_Backend::get_closest_object(float& angle_deg, float &distance)
 }
 
 // get number of objects, used for non-GPS avoidance
-uint8_t AP_Proximity_Backend::get_object_count() const
+uint16_t AP_Proximity_Backend::get_object_count() const
 {
     return _num_sectors;
 }
 
 // get an object's angle and distance, used for non-GPS avoidance
 // returns false if no angle or distance could be returned for some reason
-bool AP_Proximity_Backend::get_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const
+bool AP_Proximity_Backend::get_object_angle_and_distance(uint16_t object_number, float& angle_deg, float &distance) const
 {
     if (object_number < _num_sectors && _distance_valid[object_number]) {
         angle_deg = _angle[object_number];
@@ -90,7 +97,7 @@ bool AP_Proximity_Backend::get_horizontal_distances(AP_Proximity::Proximity_Dist
 {
     // exit immediately if we have no good ranges
     bool valid_distances = false;
-    for (uint8_t i=0; i<_num_sectors; i++) {
+    for (uint16_t i=0; i<_num_sectors; i++) {
         if (_distance_valid[i]) {
             valid_distances = true;
         }
@@ -110,7 +117,7 @@ bool AP_Proximity_Backend::get_horizontal_distances(AP_Proximity::Proximity_Dist
     }
 
     // cycle through all sectors filling in distances
-    for (uint8_t i=0; i<_num_sectors; i++) {
+    for (uint16_t i=0; i<_num_sectors; i++) {
         if (_distance_valid[i]) {
             // convert angle to orientation
             int16_t orientation = static_cast<int16_t>(_angle[i] * (PROXIMITY_MAX_DIRECTION / 360.0f));
@@ -146,7 +153,7 @@ const Vector2f* AP_Proximity_Backend::get_boundary_points(uint16_t& num_points)
 
     // check at least one sector has valid data, if not, exit
     bool some_valid = false;
-    for (uint8_t i=0; i<_num_sectors; i++) {
+    for (uint16_t i=0; i<_num_sectors; i++) {
         if (_distance_valid[i]) {
             some_valid = true;
             break;
@@ -166,7 +173,7 @@ const Vector2f* AP_Proximity_Backend::get_boundary_points(uint16_t& num_points)
 //   should be called if the sector_middle_deg or _setor_width_deg arrays are changed
 void AP_Proximity_Backend::init_boundary()
 {
-    for (uint8_t sector=0; sector < _num_sectors; sector++) {
+    for (uint16_t sector=0; sector < _num_sectors; sector++) {
         float angle_rad = radians((float)_sector_middle_deg[sector]+(float)_sector_width_deg[sector]/2.0f);
         _sector_edge_vector[sector].x = cosf(angle_rad) * 100.0f;
         _sector_edge_vector[sector].y = sinf(angle_rad) * 100.0f;
@@ -177,7 +184,7 @@ void AP_Proximity_Backend::init_boundary()
 // update boundary points used for object avoidance based on a single sector's distance changing
 //   the boundary points lie on the line between sectors meaning two boundary points may be updated based on a single sector's distance changing
 //   the boundary point is set to the shortest distance found in the two adjacent sectors, this is a conservative boundary around the vehicle
-void AP_Proximity_Backend::update_boundary_for_sector(uint8_t sector)
+void AP_Proximity_Backend::update_boundary_for_sector(uint16_t sector)
 {
     // sanity check
     if (sector >= _num_sectors) {
@@ -185,7 +192,7 @@ void AP_Proximity_Backend::update_boundary_for_sector(uint8_t sector)
     }
 
     // find adjacent sector (clockwise)
-    uint8_t next_sector = sector + 1;
+    uint16_t next_sector = sector + 1;
     if (next_sector >= _num_sectors) {
         next_sector = 0;
     }
@@ -210,7 +217,7 @@ void AP_Proximity_Backend::update_boundary_for_sector(uint8_t sector)
     }
 
     // repeat for edge between sector and previous sector
-    uint8_t prev_sector = (sector == 0) ? _num_sectors-1 : sector-1;
+    uint16_t prev_sector = (sector == 0) ? _num_sectors-1 : sector-1;
     shortest_distance = PROXIMITY_BOUNDARY_DIST_DEFAULT;
     if (_distance_valid[prev_sector] && _distance_valid[sector]) {
         shortest_distance = MIN(_distance[prev_sector], _distance[sector]);
@@ -222,19 +229,111 @@ void AP_Proximity_Backend::update_boundary_for_sector(uint8_t sector)
     _boundary_point[prev_sector] = _sector_edge_vector[prev_sector] * shortest_distance;
 
     // if the sector counter-clockwise from the previous sector has an invalid distance, set boundary to create a cup like boundary
-    uint8_t prev_sector_ccw = (prev_sector == 0) ? _num_sectors-1 : prev_sector-1;
+    uint16_t prev_sector_ccw = (prev_sector == 0) ? _num_sectors-1 : prev_sector-1;
     if (!_distance_valid[prev_sector_ccw]) {
         _boundary_point[prev_sector_ccw] = _sector_edge_vector[prev_sector_ccw] * shortest_distance;
     }
 }
 
+// divide the area around the vehicle into the number of equal width sectors set by the user, the first centred on the vehicle's forward direction
+//   used by sensors which scan around the vehicle.  Returns false if the user has not asked for more sectors or memory could not be allocated
+bool AP_Proximity_Backend::init_uniform_sectors()
+{
+    const uint16_t num_sectors = frontend._scan_sectors;
+    if (num_sectors < PROXIMITY_MAX_DIRECTION || num_sectors > PROXIMITY_UNIFORM_SECTORS_MAX || (360 % num_sectors) != 0) {
+        return false;
+    }
+
+    // sectors cannot be changed once memory has been allocated
+    if (_sector_middle_deg != _sector_middle_deg_buf) {
+        return _num_sectors == num_sectors;
+    }
+
+    if (num_sectors > PROXIMITY_SECTORS_MAX) {
+        // allocate all arrays in one block with the largest types first so each array is aligned
+        uint8_t *buf = (uint8_t *)calloc(num_sectors, 2 * sizeof(Vector2f) + 2 * sizeof(float) + sizeof(uint16_t) + sizeof(uint8_t) + sizeof(bool));
+        if (buf == nullptr) {
+            return false;
+        }
+        _sector_edge_vector = (Vector2f *)buf;
+        buf += num_sectors * sizeof(Vector2f);
+        _boundary_point = (Vector2f *)buf;
+        buf += num_sectors * sizeof(Vector2f);
+        _angle = (float *)buf;
+        buf += num_sectors * sizeof(float);
+        _distance = (float *)buf;
+        buf += num_sectors * sizeof(float);
+        _sector_middle_deg = (uint16_t *)buf;
+        buf += num_sectors * sizeof(uint16_t);
+        _sector_width_deg = buf;
+        buf += num_sectors * sizeof(uint8_t);
+        _distance_valid = (bool *)buf;
+    }
+
+    const uint8_t sector_width = 360 / num_sectors;
+    for (uint16_t i=0; i<num_sectors; i++) {
+        _sector_middle_deg[i] = i * sector_width;
+        _sector_width_deg[i] = sector_width;
+        _distance_valid[i] = false;
+    }
+    _num_sectors = num_sectors;
+    _uniform_sectors = true;
+    _scan_have_reading = false;
+
+    // re-initialise boundary because sector locations have changed
+    init_boundary();
+
+    return true;
+}
+
+// add a distance measured by a sensor which scans around the vehicle
+//   readings are combined keeping the closest until the scan moves into another sector which is then updated along with its boundary points
+//   readings within ignore areas are discarded if sectors are of equal width
+void AP_Proximity_Backend::add_scan_reading(float angle_deg, float distance_m)
+{
+    // sectors fitted around ignore areas already exclude them
+    if (_uniform_sectors && angle_ignored(angle_deg)) {
+        return;
+    }
+
+    uint16_t sector;
+    if (!convert_angle_to_sector(angle_deg, sector)) {
+        return;
+    }
+
+    // a new sector started, the previous one can be updated now
+    if (_scan_have_reading && (sector != _scan_sector)) {
+        complete_scan_sector();
+    }
+
+    if (!_scan_have_reading || (distance_m < _scan_distance_m)) {
+        _scan_sector = sector;
+        _scan_angle_deg = angle_deg;
+        _scan_distance_m = distance_m;
+        _scan_have_reading = true;
+    }
+}
+
+// update the sector holding readings added by add_scan_reading, should be called when a scan is complete
+void AP_Proximity_Backend::complete_scan_sector()
+{
+    if (!_scan_have_reading) {
+        return;
+    }
+    _angle[_scan_sector] = _scan_angle_deg;
+    _distance[_scan_sector] = _scan_distance_m;
+    _distance_valid[_scan_sector] = true;
+    update_boundary_for_sector(_scan_sector);
+    _scan_have_reading = false;
+}
+
 // set status and update valid count
 void AP_Proximity_Backend::set_status(AP_Proximity::Proximity_Status status)
 {
     state.status = status;
 }
 
-bool AP_Proximity_Backend::convert_angle_to_sector(float angle_degrees, uint8_t &sector) const
+bool AP_Proximity_Backend::convert_angle_to_sector(float angle_degrees, uint16_t &sector) const
 {
     // sanity check angle
     if (angle_degrees > 360.0f || angle_degrees < -180.0f) {
@@ -246,12 +345,19 @@ bool AP_Proximity_Backend::convert_angle_to_sector(float angle_degrees, uint8_t
         angle_degrees += 360.0f;
     }
 
+    // equal width sectors can be calculated directly, the first sector is centred on forward
+    if (_uniform_sectors) {
+        const float sector_width = 360.0f / _num_sectors;
+        sector = (uint16_t)(wrap_360(angle_degrees + sector_width * 0.5f) / sector_width) % _num_sectors;
+        return true;
+    }
+
     bool closest_found = false;
-    uint8_t closest_sector;
+    uint16_t closest_sector;
     float closest_angle;
 
     // search for which sector angle_degrees falls into
-    for (uint8_t i = 0; i < _num_sectors; i++) {
+    for (uint16_t i = 0; i < _num_sectors; i++) {
         float angle_diff = fabsf(wrap_180(_sector_middle_deg[i] - angle_degrees));
 
         // record if closest
@@ -300,6 +406,18 @@ bool AP_Proximity_Backend::get_ignore_area(uint8_t index, uint16_t &angle_deg, u
     return true;
 }
 
+// returns true if angle_deg falls within one of the user's ignore areas
+bool AP_Proximity_Backend::angle_ignored(float angle_deg) const
+{
+    for (uint8_t i=0; i < PROXIMITY_MAX_IGNORE; i++) {
+        const uint8_t width_deg = frontend._ignore_width_deg[i];
+        if ((width_deg != 0) && (fabsf(wrap_180(angle_deg - frontend._ignore_angle_deg[i])) <= width_deg * 0.5f)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // retrieve start or end angle of next ignore area (i.e. closest ignore area higher than the start_angle)
 // start_or_end = 0 to get start, 1 to retrieve end
 bool AP_Proximity_Backend::get_next_ignore_start_or_end(uint8_t start_or_end, int16_t start_angle, int16_t &ignore_start) const
@@ -18,7 +18,8 @@
 #include <AP_HAL/AP_HAL.h>
 #include "AP_Proximity.h"
 
-#define PROXIMITY_SECTORS_MAX   12  // maximum number of sectors
+#define PROXIMITY_SECTORS_MAX   12  // maximum number of sectors held without allocating memory
+#define PROXIMITY_UNIFORM_SECTORS_MAX   360 // maximum number of equal width sectors for scanning sensors
 #define PROXIMITY_BOUNDARY_DIST_MIN 0.6f    // minimum distance for a boundary point.  This ensures the object avoidance code doesn't think we are outside the boundary.
 #define PROXIMITY_BOUNDARY_DIST_DEFAULT 100 // if we have no data for a sector, boundary is placed 100m out
 
@@ -58,8 +59,8 @@ public:
     bool get_closest_object(float& angle_deg, float &distance) const;
 
     // get number of objects, angle and distance - used for non-GPS avoidance
-    uint8_t get_object_count() const;
-    bool get_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const;
+    uint16_t get_object_count() const;
+    bool get_object_angle_and_distance(uint16_t object_number, float& angle_deg, float &distance) const;
 
     // get distances in 8 directions. used for sending distances to ground station
     bool get_horizontal_distances(AP_Proximity::Proximity_Distance_Array &prx_dist_array) const;
@@ -70,7 +71,19 @@ protected:
     void set_status(AP_Proximity::Proximity_Status status);
 
     // find which sector a given angle falls into
-    bool convert_angle_to_sector(float angle_degrees, uint8_t &sector) const;
+    bool convert_angle_to_sector(float angle_degrees, uint16_t &sector) const;
+
+    // divide the area around the vehicle into the number of equal width sectors set by the user, the first centred on the vehicle's forward direction
+    //   used by sensors which scan around the vehicle.  Returns false if the user has not asked for more sectors or memory could not be allocated
+    bool init_uniform_sectors();
+
+    // add a distance measured by a sensor which scans around the vehicle
+    //   readings are combined keeping the closest until the scan moves into another sector which is then updated along with its boundary points
+    //   readings within ignore areas are discarded if sectors are of equal width
+    void add_scan_reading(float angle_deg, float distance_m);
+
+    // update the sector holding readings added by add_scan_reading, should be called when a scan is complete
+    void complete_scan_sector();
 
     // initialise the boundary and sector_edge_vector array used for object avoidance
     //   should be called if the sector_middle_deg or _setor_width_deg arrays are changed
@@ -79,27 +92,48 @@ protected:
     // update boundary points used for object avoidance based on a single sector's distance changing
     //   the boundary points lie on the line between sectors meaning two boundary points may be updated based on a single sector's distance changing
     //   the boundary point is set to the shortest distance found in the two adjacent sectors, this is a conservative boundary around the vehicle
-    void update_boundary_for_sector(uint8_t sector);
+    void update_boundary_for_sector(uint16_t sector);
 
     // get ignore area info
     uint8_t get_ignore_area_count() const;
     bool get_ignore_area(uint8_t index, uint16_t &angle_deg, uint8_t &width_deg) const;
     bool get_next_ignore_start_or_end(uint8_t start_or_end, int16_t start_angle, int16_t &ignore_start) const;
 
+    // returns true if angle_deg falls within one of the user's ignore areas
+    bool angle_ignored(float angle_deg) const;
+
     AP_Proximity &frontend;
     AP_Proximity::Proximity_State &state;   // reference to this instances state
 
     // sectors
-    uint8_t _num_sectors = PROXIMITY_MAX_DIRECTION;
-    uint16_t _sector_middle_deg[PROXIMITY_SECTORS_MAX] = {0, 45, 90, 135, 180, 225, 270, 315, 0, 0, 0, 0};  // middle angle of each sector
-    uint8_t _sector_width_deg[PROXIMITY_SECTORS_MAX] = {45, 45, 45, 45, 45, 45, 45, 45, 0, 0, 0, 0};        // width (in degrees) of each sector
+    uint16_t _num_sectors = PROXIMITY_MAX_DIRECTION;
+    bool _uniform_sectors;                  // true if sectors are of equal width with the first centred on forward, see init_uniform_sectors
+    uint16_t *_sector_middle_deg;           // middle angle of each sector
+    uint8_t *_sector_width_deg;             // width (in degrees) of each sector
 
     // sensor data
-    float _angle[PROXIMITY_SECTORS_MAX];            // angle to closest object within each sector
-    float _distance[PROXIMITY_SECTORS_MAX];         // distance to closest object within each sector
-    bool _distance_valid[PROXIMITY_SECTORS_MAX];    // true if a valid distance received for each sector
+    float *_angle;                          // angle to closest object within each sector
+    float *_distance;                       // distance to closest object within each sector
+    bool *_distance_valid;                  // true if a valid distance received for each sector
 
     // fence boundary
-    Vector2f _sector_edge_vector[PROXIMITY_SECTORS_MAX];    // vector for right-edge of each sector, used to speed up calculation of boundary
-    Vector2f _boundary_point[PROXIMITY_SECTORS_MAX];        // bounding polygon around the vehicle calculated conservatively for object avoidance
+    Vector2f *_sector_edge_vector;          // vector for right-edge of each sector, used to speed up calculation of boundary
+    Vector2f *_boundary_point;              // bounding polygon around the vehicle calculated conservatively for object avoidance
+
+    // closest reading in the sector currently being scanned, see add_scan_reading
+    uint16_t _scan_sector;
+    float _scan_angle_deg;
+    float _scan_distance_m;
+    bool _scan_have_reading;
+
+private:
+
+    // storage for sectors unless more than PROXIMITY_SECTORS_MAX are used
+    uint16_t _sector_middle_deg_buf[PROXIMITY_SECTORS_MAX] = {0, 45, 90, 135, 180, 225, 270, 315, 0, 0, 0, 0};
+    uint8_t _sector_width_deg_buf[PROXIMITY_SECTORS_MAX] = {45, 45, 45, 45, 45, 45, 45, 45, 0, 0, 0, 0};
+    float _angle_buf[PROXIMITY_SECTORS_MAX];
+    float _distance_buf[PROXIMITY_SECTORS_MAX];
+    bool _distance_valid_buf[PROXIMITY_SECTORS_MAX];
+    Vector2f _sector_edge_vector_buf[PROXIMITY_SECTORS_MAX];
+    Vector2f _boundary_point_buf[PROXIMITY_SECTORS_MAX];
 };
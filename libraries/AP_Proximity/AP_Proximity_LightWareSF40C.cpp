@@ -410,7 +410,7 @@ bool AP_Proximity_LightWareSF40C::process_reply()
         {
             float angle_deg = (float)atof(element_buf[0]);
             float distance_m = (float)atof(element_buf[1]);
-            uint8_t sector;
+            uint16_t sector;
             if (convert_angle_to_sector(angle_deg, sector)) {
                 _angle[sector] = angle_deg;
                 _distance[sector] = distance_m;
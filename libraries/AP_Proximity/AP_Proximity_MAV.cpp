@@ -113,7 +113,7 @@ void AP_Proximity_MAV::handle_msg(mavlink_message_t *msg)
         // initialise updated array and proximity sector angles (to closest object) and distances
         bool sector_updated[_num_sectors];
         float sector_width_half[_num_sectors];
-        for (uint8_t i = 0; i < _num_sectors; i++) {
+        for (uint16_t i = 0; i < _num_sectors; i++) {
             sector_updated[i] = false;
             sector_width_half[i] = _sector_width_deg[i] * 0.5f;
             _angle[i] = _sector_middle_deg[i];
@@ -126,7 +126,7 @@ void AP_Proximity_MAV::handle_msg(mavlink_message_t *msg)
             const float mid_angle = wrap_360(j * increment * dir_correction + yaw_correction);
 
             // iterate over proximity sectors
-            for (uint8_t i = 0; i < _num_sectors; i++) {
+            for (uint16_t i = 0; i < _num_sectors; i++) {
                 float angle_diff = fabsf(wrap_180(_sector_middle_deg[i] - mid_angle));
                 // update distance array sector with shortest distance from message
                 if ((angle_diff <= sector_width_half[i]) && (packet_distance_m < _distance[i])) {
@@ -138,7 +138,7 @@ void AP_Proximity_MAV::handle_msg(mavlink_message_t *msg)
         }
 
         // update proximity sectors validity and boundary point
-        for (uint8_t i = 0; i < _num_sectors; i++) {
+        for (uint16_t i = 0; i < _num_sectors; i++) {
             _distance_valid[i] = (_distance[i] >= _distance_min) && (_distance[i] <= _distance_max);
             if (sector_updated[i]) {
                 update_boundary_for_sector(i);
@@ -0,0 +1,237 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include "AP_Proximity_Map.h"
+
+// allocate the map, returns false if memory could not be allocated
+bool AP_Proximity_Map::init(float voxel_size, uint32_t timeout_ms)
+{
+    if (_voxels == nullptr) {
+        _voxels = (Voxel *)calloc(PROXIMITY_MAP_SLOTS, sizeof(Voxel));
+        if (_voxels == nullptr) {
+            return false;
+        }
+    }
+    _voxel_size = MAX(voxel_size, 0.1f);
+    _timeout_ms = timeout_ms;
+    return true;
+}
+
+// convert a position to voxel coordinates, returns false if outside the range of the map
+bool AP_Proximity_Map::pos_to_voxel(const Vector3f &pos, int16_t &x, int16_t &y, int16_t &z) const
+{
+    const float fx = floorf(pos.x / _voxel_size);
+    const float fy = floorf(pos.y / _voxel_size);
+    const float fz = floorf(pos.z / _voxel_size);
+    if (fabsf(fx) >= INT16_MAX || fabsf(fy) >= INT16_MAX || fabsf(fz) >= INT16_MAX) {
+        return false;
+    }
+    x = fx;
+    y = fy;
+    z = fz;
+    return true;
+}
+
+// get the centre of a voxel
+Vector3f AP_Proximity_Map::voxel_centre(const Voxel &voxel) const
+{
+    return Vector3f(voxel.x + 0.5f, voxel.y + 0.5f, voxel.z + 0.5f) * _voxel_size;
+}
+
+// get first slot of the bucket holding voxel x,y,z
+uint16_t AP_Proximity_Map::bucket_start(int16_t x, int16_t y, int16_t z)
+{
+    const uint32_t hash = ((uint32_t)(uint16_t)x * 73856093U) ^
+                          ((uint32_t)(uint16_t)y * 19349663U) ^
+                          ((uint32_t)(uint16_t)z * 83492791U);
+    return (hash & (PROXIMITY_MAP_BUCKETS - 1)) * PROXIMITY_MAP_WAYS;
+}
+
+// find the slot holding voxel x,y,z, returns -1 if not found
+int16_t AP_Proximity_Map::find(int16_t x, int16_t y, int16_t z, uint32_t now_ms) const
+{
+    const uint16_t start = bucket_start(x, y, z);
+    for (uint16_t slot=start; slot<start+PROXIMITY_MAP_WAYS; slot++) {
+        const Voxel &voxel = _voxels[slot];
+        if (voxel.x == x && voxel.y == y && voxel.z == z && voxel_valid(voxel, now_ms)) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/*
+  add a return at position pos seen by a sensor at sensor_pos
+
+  The voxels between the sensor and the return are cleared, stopping
+  one voxel short of the return so its own voxel is not cleared by a
+  ray passing through its corner.
+ */
+void AP_Proximity_Map::add_return(const Vector3f &sensor_pos, const Vector3f &pos)
+{
+    if (_voxels == nullptr) {
+        return;
+    }
+
+    // zero is used to mark empty voxels
+    const uint32_t now_ms = MAX(AP_HAL::millis(), 1U);
+
+    // clear voxels along the ray
+    Vector3f ray = pos - sensor_pos;
+    const float ray_length = ray.length();
+    if (ray_length > _voxel_size) {
+        ray /= ray_length;
+        int16_t last_x = 0, last_y = 0, last_z = 0;
+        bool have_last = false;
+        for (float dist = 0.0f; dist < ray_length - _voxel_size; dist += _voxel_size * 0.5f) {
+            int16_t x, y, z;
+            if (!pos_to_voxel(sensor_pos + ray * dist, x, y, z)) {
+                break;
+            }
+            if (have_last && x == last_x && y == last_y && z == last_z) {
+                continue;
+            }
+            const int16_t slot = find(x, y, z, now_ms);
+            if (slot >= 0) {
+                _voxels[slot].seen_ms = 0;
+            }
+            last_x = x;
+            last_y = y;
+            last_z = z;
+            have_last = true;
+        }
+    }
+
+    // mark voxel holding the return as occupied
+    int16_t x, y, z;
+    if (!pos_to_voxel(pos, x, y, z)) {
+        return;
+    }
+    const int16_t found = find(x, y, z, now_ms);
+    if (found >= 0) {
+        _voxels[found].seen_ms = now_ms;
+        return;
+    }
+
+    // use an empty or expired slot, otherwise replace the voxel furthest from the vehicle
+    const uint16_t start = bucket_start(x, y, z);
+    uint16_t replace = start;
+    float replace_dist_sq = -1.0f;
+    for (uint16_t slot=start; slot<start+PROXIMITY_MAP_WAYS; slot++) {
+        if (!voxel_valid(_voxels[slot], now_ms)) {
+            replace = slot;
+            break;
+        }
+        const float dist_sq = (voxel_centre(_voxels[slot]) - _vehicle_pos).length_squared();
+        if (dist_sq > replace_dist_sq) {
+            replace = slot;
+            replace_dist_sq = dist_sq;
+        }
+    }
+    Voxel &voxel = _voxels[replace];
+    voxel.x = x;
+    voxel.y = y;
+    voxel.z = z;
+    voxel.seen_ms = now_ms;
+}
+
+// returns true if the voxel holding pos is occupied
+bool AP_Proximity_Map::is_occupied(const Vector3f &pos) const
+{
+    int16_t x, y, z;
+    if (_voxels == nullptr || !pos_to_voxel(pos, x, y, z)) {
+        return false;
+    }
+    return find(x, y, z, AP_HAL::millis()) >= 0;
+}
+
+AP_Proximity_Map::OccupiedIterator::OccupiedIterator(const AP_Proximity_Map &map) :
+    _map(map),
+    _now_ms(AP_HAL::millis()),
+    _slot(0),
+    _bounded(false),
+    _lookup(false)
+{
+}
+
+/*
+  iterate over occupied voxels within dist_xy horizontally and dist_z
+  vertically of pos
+
+  When the search box holds fewer voxels than there are buckets each
+  voxel in the box is looked up, otherwise every slot is checked and
+  those outside the box are skipped.
+ */
+AP_Proximity_Map::OccupiedIterator::OccupiedIterator(const AP_Proximity_Map &map, const Vector3f &pos, float dist_xy, float dist_z) :
+    _map(map),
+    _now_ms(AP_HAL::millis()),
+    _slot(0),
+    _bounded(true)
+{
+    const float voxel_size = map._voxel_size;
+    _min_x = constrain_float(floorf((pos.x - dist_xy) / voxel_size), -INT16_MAX, INT16_MAX);
+    _max_x = constrain_float(floorf((pos.x + dist_xy) / voxel_size), -INT16_MAX, INT16_MAX);
+    _min_y = constrain_float(floorf((pos.y - dist_xy) / voxel_size), -INT16_MAX, INT16_MAX);
+    _max_y = constrain_float(floorf((pos.y + dist_xy) / voxel_size), -INT16_MAX, INT16_MAX);
+    _min_z = constrain_float(floorf((pos.z - dist_z) / voxel_size), -INT16_MAX, INT16_MAX);
+    _max_z = constrain_float(floorf((pos.z + dist_z) / voxel_size), -INT16_MAX, INT16_MAX);
+    const uint64_t box_voxels = (uint64_t)(_max_x - _min_x + 1) * (_max_y - _min_y + 1) * (_max_z - _min_z + 1);
+    _lookup = box_voxels <= PROXIMITY_MAP_BUCKETS;
+    _x = _min_x;
+    _y = _min_y;
+    _z = _min_z;
+}
+
+// returns true if voxel x,y,z is within the search box
+bool AP_Proximity_Map::OccupiedIterator::in_box(int16_t x, int16_t y, int16_t z) const
+{
+    return x >= _min_x && x <= _max_x &&
+           y >= _min_y && y <= _max_y &&
+           z >= _min_z && z <= _max_z;
+}
+
+// get the centre of the next occupied voxel, returns false when there are no more voxels
+bool AP_Proximity_Map::OccupiedIterator::next(Vector3f &centre)
+{
+    if (_map._voxels == nullptr) {
+        return false;
+    }
+    if (_lookup) {
+        while (_z <= _max_z) {
+            const int16_t slot = _map.find(_x, _y, _z, _now_ms);
+            if (++_x > _max_x) {
+                _x = _min_x;
+                if (++_y > _max_y) {
+                    _y = _min_y;
+                    _z++;
+                }
+            }
+            if (slot >= 0) {
+                centre = _map.voxel_centre(_map._voxels[slot]);
+                return true;
+            }
+        }
+        return false;
+    }
+    while (_slot < PROXIMITY_MAP_SLOTS) {
+        const Voxel &voxel = _map._voxels[_slot++];
+        if (_map.voxel_valid(voxel, _now_ms) && (!_bounded || in_box(voxel.x, voxel.y, voxel.z))) {
+            centre = _map.voxel_centre(voxel);
+            return true;
+        }
+    }
+    return false;
+}
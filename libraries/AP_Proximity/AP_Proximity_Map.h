@@ -0,0 +1,139 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#define PROXIMITY_MAP_BUCKETS       256     // number of hash buckets, must be a power of two
+#define PROXIMITY_MAP_WAYS          4       // number of voxels held in each bucket
+#define PROXIMITY_MAP_SLOTS         (PROXIMITY_MAP_BUCKETS * PROXIMITY_MAP_WAYS)
+
+/*
+  3D occupancy map of the obstacles around the vehicle
+
+  Occupied voxels are held in a fixed size hash table keyed on the
+  voxel's coordinates in the earth frame.  Each bucket holds
+  PROXIMITY_MAP_WAYS voxels so finding a voxel takes at most that
+  many comparisons.  A new voxel takes the place of an empty or
+  expired voxel in its bucket or, failing that, the voxel furthest
+  from the vehicle, so memory use is fixed and the map stays centred
+  on the vehicle.
+
+  Voxels expire when they have not been seen for the timeout.  When a
+  sensor return is added the voxels between the sensor and the return
+  are cleared because the sensor could see through them.
+
+  All positions are NED offsets in meters from the EKF origin.
+
+  The map is updated from the main thread.  Other threads must hold
+  the map's semaphore while reading it.
+ */
+class AP_Proximity_Map
+{
+public:
+
+    AP_Proximity_Map() {}
+
+    /* Do not allow copies */
+    AP_Proximity_Map(const AP_Proximity_Map &other) = delete;
+    AP_Proximity_Map &operator=(const AP_Proximity_Map&) = delete;
+
+    // allocate the map, returns false if memory could not be allocated
+    bool init(float voxel_size, uint32_t timeout_ms);
+
+    // returns true once the map has been allocated
+    bool enabled() const { return _voxels != nullptr; }
+
+    // get size of each voxel in meters
+    float get_voxel_size() const { return _voxel_size; }
+
+    // set vehicle position, used to choose which voxel to replace when a bucket is full
+    void set_vehicle_position(const Vector3f &pos) { _vehicle_pos = pos; }
+
+    // add a return at position pos seen by a sensor at sensor_pos
+    void add_return(const Vector3f &sensor_pos, const Vector3f &pos);
+
+    // returns true if the voxel holding pos is occupied
+    bool is_occupied(const Vector3f &pos) const;
+
+    // iterator over occupied voxels
+    class OccupiedIterator {
+    public:
+        OccupiedIterator(const AP_Proximity_Map &map);
+
+        // iterate over occupied voxels within dist_xy horizontally and dist_z vertically of pos
+        // some voxels just outside these distances may also be returned
+        OccupiedIterator(const AP_Proximity_Map &map, const Vector3f &pos, float dist_xy, float dist_z);
+
+        // get the centre of the next occupied voxel, returns false when there are no more voxels
+        bool next(Vector3f &centre);
+
+    private:
+        // returns true if voxel x,y,z is within the search box
+        bool in_box(int16_t x, int16_t y, int16_t z) const;
+
+        const AP_Proximity_Map &_map;
+        uint32_t _now_ms;
+        uint16_t _slot;
+        bool _bounded;          // true if only voxels within the search box are returned
+        bool _lookup;           // true if each voxel in the search box is looked up rather than checking every slot
+        int32_t _min_x, _min_y, _min_z;     // search box in voxel coordinates
+        int32_t _max_x, _max_y, _max_z;
+        int32_t _x, _y, _z;     // next voxel to look up
+    };
+
+    // get an iterator over all occupied voxels
+    OccupiedIterator occupied() const { return OccupiedIterator(*this); }
+
+    // get an iterator over occupied voxels within dist_xy horizontally and dist_z vertically of pos
+    OccupiedIterator occupied_near(const Vector3f &pos, float dist_xy, float dist_z) const {
+        return OccupiedIterator(*this, pos, dist_xy, dist_z);
+    }
+
+    // get semaphore protecting the map
+    HAL_Semaphore &get_semaphore() const { return _sem; }
+
+private:
+
+    struct Voxel {
+        int16_t x, y, z;        // voxel coordinates
+        uint32_t seen_ms;       // system time voxel was last seen, zero if empty
+    };
+
+    // convert a position to voxel coordinates, returns false if outside the range of the map
+    bool pos_to_voxel(const Vector3f &pos, int16_t &x, int16_t &y, int16_t &z) const;
+
+    // get the centre of a voxel
+    Vector3f voxel_centre(const Voxel &voxel) const;
+
+    // get first slot of the bucket holding voxel x,y,z
+    static uint16_t bucket_start(int16_t x, int16_t y, int16_t z);
+
+    // find the slot holding voxel x,y,z, returns -1 if not found
+    int16_t find(int16_t x, int16_t y, int16_t z, uint32_t now_ms) const;
+
+    // returns true if voxel has been seen within the timeout
+    bool voxel_valid(const Voxel &voxel, uint32_t now_ms) const {
+        return voxel.seen_ms != 0 && (now_ms - voxel.seen_ms) < _timeout_ms;
+    }
+
+    Voxel *_voxels = nullptr;
+    float _voxel_size = 1.0f;           // size of each voxel in meters
+    uint32_t _timeout_ms;               // voxels not seen for this long expire
+    Vector3f _vehicle_pos;              // latest vehicle position
+    mutable HAL_Semaphore _sem;         // semaphore for readers on other threads
+};
@@ -32,6 +32,8 @@ AP_Proximity_MorseSITL::AP_Proximity_MorseSITL(AP_Proximity &_frontend,
     AP_Proximity_Backend(_frontend, _state),
     sitl(AP::sitl())
 {
+    // use equal width sectors if the user has asked for them
+    init_uniform_sectors();
 }
 
 // update the state of the sensor
@@ -47,13 +49,9 @@ void AP_Proximity_MorseSITL::update(void)
 
     set_status(AP_Proximity::Proximity_Good);
 
-    memset(_distance_valid, 0, sizeof(_distance_valid));
-    memset(_angle, 0, sizeof(_angle));
-    memset(_distance, 0, sizeof(_distance));
-
-    // only use 8 sectors to match RPLidar
-    const uint8_t nsectors = MIN(8, PROXIMITY_SECTORS_MAX);
-    const uint16_t degrees_per_sector = 360 / nsectors;
+    memset(_distance_valid, 0, sizeof(bool) * _num_sectors);
+    memset(_angle, 0, sizeof(float) * _num_sectors);
+    memset(_distance, 0, sizeof(float) * _num_sectors);
 
     for (uint16_t i=0; i<points.length; i++) {
         Vector3f &point = points.data[i];
@@ -63,19 +61,25 @@ void AP_Proximity_MorseSITL::update(void)
             continue;
         }
         float angle_deg = wrap_360(degrees(atan2f(-point.y, point.x)));
-        uint16_t angle_rounded = uint16_t(angle_deg+0.5);
-        uint8_t sector = wrap_360(angle_rounded + 22.5f) / degrees_per_sector;
+        uint16_t sector;
+        if (!convert_angle_to_sector(angle_deg, sector)) {
+            continue;
+        }
         if (!_distance_valid[sector] || range < _distance[sector]) {
             _distance_valid[sector] = true;
             _distance[sector] = range;
             _angle[sector] = angle_deg;
-            update_boundary_for_sector(sector);
         }
     }
 
+    // update the boundary once per sector rather than for every point in the scan
+    for (uint16_t i=0; i<_num_sectors; i++) {
+        update_boundary_for_sector(i);
+    }
+
 #if 0
     printf("npoints=%u\n", points.length);
-    for (uint16_t i=0; i<nsectors; i++) {
+    for (uint16_t i=0; i<_num_sectors; i++) {
         printf("sector[%u] ang=%.1f dist=%.1f\n", i, _angle[i], _distance[i]);
     }
 #endif
@@ -161,6 +161,12 @@ void AP_Proximity_RPLidarA2::reset_rplidar()
 // initialise sector angles using user defined ignore areas, left same as SF40C
 void AP_Proximity_RPLidarA2::init_sectors()
 {
+    // use equal width sectors if the user has asked for them
+    if (init_uniform_sectors()) {
+        _sector_initialised = true;
+        return;
+    }
+
     // use defaults if no ignore areas defined
     const uint8_t ignore_area_count = get_ignore_area_count();
     if (ignore_area_count == 0) {
@@ -401,27 +407,12 @@ void AP_Proximity_RPLidarA2::parse_response_data()
                 Debug(2, "                                       D%02.2f A%03.1f Q%02d", distance_m, angle_deg, quality);
 #endif
                 _last_distance_received_ms = AP_HAL::millis();
-                uint8_t sector;
-                if (convert_angle_to_sector(angle_deg, sector)) {
-                    if (distance_m > distance_min()) {
-                        if (_last_sector == sector) {
-                            if (_distance_m_last > distance_m) {
-                                _distance_m_last = distance_m;
-                                _angle_deg_last  = angle_deg;
-                            }
-                        } else {
-                            // a new sector started, the previous one can be updated now
-                            _angle[_last_sector] = _angle_deg_last;
-                            _distance[_last_sector] = _distance_m_last;
-                            _distance_valid[_last_sector] = true;
-                            // update boundary used for avoidance
-                            update_boundary_for_sector(_last_sector);
-                            // initialize the new sector
-                            _last_sector     = sector;
-                            _distance_m_last = distance_m;
-                            _angle_deg_last  = angle_deg;
-                        }
-                    } else {
+                if (distance_m > distance_min()) {
+                    // closest reading in each sector is used to update the sector and boundary once the scan moves on
+                    add_scan_reading(angle_deg, distance_m);
+                } else {
+                    uint16_t sector;
+                    if (convert_angle_to_sector(angle_deg, sector)) {
                         _distance_valid[sector] = false;
                     }
                 }
@@ -42,6 +42,9 @@ AP_Proximity_SITL::AP_Proximity_SITL(AP_Proximity &_frontend,
     if (fence_alt_max == nullptr || ptype != AP_PARAM_FLOAT) {
         AP_HAL::panic("Proximity_SITL: Failed to find FENCE_ALT_MAX");
     }
+
+    // use equal width sectors if the user has asked for them
+    init_uniform_sectors();
 }
 
 // update the state of the sensor
@@ -52,18 +55,21 @@ void AP_Proximity_SITL::update(void)
     current_loc.lng = sitl->state.longitude * 1.0e7;
     current_loc.alt = sitl->state.altitude * 1.0e2;
     if (fence && fence_loader.boundary_valid(fence_count->get(), fence)) {
-        // update distance in one sector
-        if (get_distance_to_fence(_sector_middle_deg[last_sector], _distance[last_sector])) {
-            set_status(AP_Proximity::Proximity_Good);
-            _distance_valid[last_sector] = true;
-            _angle[last_sector] = _sector_middle_deg[last_sector];
-            update_boundary_for_sector(last_sector);
-        } else {
-            _distance_valid[last_sector] = false;
-        }
-        last_sector++;
-        if (last_sector >= _num_sectors) {
-            last_sector = 0;
+        // update distance in enough sectors to scan all the way around at the same rate however many sectors there are
+        const uint16_t num_updates = MAX(_num_sectors / PROXIMITY_MAX_DIRECTION, 1);
+        for (uint16_t i=0; i<num_updates; i++) {
+            if (get_distance_to_fence(_sector_middle_deg[last_sector], _distance[last_sector])) {
+                set_status(AP_Proximity::Proximity_Good);
+                _distance_valid[last_sector] = true;
+                _angle[last_sector] = _sector_middle_deg[last_sector];
+                update_boundary_for_sector(last_sector);
+            } else {
+                _distance_valid[last_sector] = false;
+            }
+            last_sector++;
+            if (last_sector >= _num_sectors) {
+                last_sector = 0;
+            }
         }
     } else {
         set_status(AP_Proximity::Proximity_NoData);        
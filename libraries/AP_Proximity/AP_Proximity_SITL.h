@@ -33,7 +33,7 @@ private:
     Location current_loc;
 
     // latest sector updated
-    uint8_t last_sector;
+    uint16_t last_sector;
 
     void load_fence(void);
 
@@ -117,7 +117,7 @@ bool AP_Proximity_TeraRangerTower::read_sensor_data()
 // process reply
 void AP_Proximity_TeraRangerTower::update_sector_data(int16_t angle_deg, uint16_t distance_cm)
 {
-    uint8_t sector;
+    uint16_t sector;
     if (convert_angle_to_sector(angle_deg, sector)) {
         _angle[sector] = angle_deg;
         _distance[sector] = ((float) distance_cm) / 1000;
@@ -63,6 +63,24 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @RebootRequired: True
     AP_GROUPINFO("HEAP_SIZE", 3, AP_Scripting, _script_heap_size, 32*1024),
 
+    // @Param: RUN_TIME
+    // @DisplayName: Scripting Run Time Limit
+    // @Description: The longest time a script can run for each time it is called before it is stopped. 0 disables the time limit, leaving only the instruction count limit
+    // @Units: ms
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("RUN_TIME", 4, AP_Scripting, _script_run_time, 0),
+
+    // @Param: CPU_PCT
+    // @DisplayName: Scripting CPU Share
+    // @Description: The percentage of time each script can spend running. A script that runs for longer than this share allows is not run again until enough time has passed, even if it asked to be run sooner. 100 disables throttling
+    // @Units: %
+    // @Range: 1 100
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("CPU_PCT", 5, AP_Scripting, _script_cpu_pct, 100),
+
     AP_GROUPEND
 };
 
@@ -92,7 +110,7 @@ bool AP_Scripting::init(void) {
 }
 
 void AP_Scripting::thread(void) {
-    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size);
+    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _script_run_time, _script_cpu_pct);
     if (lua == nullptr) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Unable to allocate scripting memory");
         return;
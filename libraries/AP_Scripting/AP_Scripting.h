@@ -42,6 +42,8 @@ private:
     AP_Int8 _enable;
     AP_Int32 _script_vm_exec_count;
     AP_Int32 _script_heap_size;
+    AP_Int16 _script_run_time;
+    AP_Int8 _script_cpu_pct;
 
     static AP_Scripting *_singleton;
 
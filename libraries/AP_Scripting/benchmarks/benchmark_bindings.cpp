@@ -0,0 +1,77 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/Location.h>
+#include <AP_Scripting/lua_bindings.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  create a Lua state with the bindings loaded and a benchmark function
+  compiled from chunk, which is left on top of the stack
+ */
+static lua_State *setup_state(const char *chunk)
+{
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    load_lua_bindings(L);
+    if (luaL_dostring(L, chunk)) {
+        lua_close(L);
+        return nullptr;
+    }
+    return L;
+}
+
+/*
+  time one call of the function returned by chunk, including the
+  garbage collection it causes
+ */
+static void run_chunk(benchmark::State& state, const char *chunk)
+{
+    lua_State *L = setup_state(chunk);
+    if (L == nullptr) {
+        state.SkipWithError("failed to load chunk");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        lua_pushvalue(L, -1);
+        lua_call(L, 0, 0);
+    }
+
+    lua_close(L);
+}
+
+static void BM_LocationNew(benchmark::State& state)
+{
+    run_chunk(state, "return function() local l = loc.new() end");
+}
+
+static void BM_LocationField(benchmark::State& state)
+{
+    run_chunk(state, "local l = loc.new() return function() l:lat(l:lat() + 1) end");
+}
+
+static void BM_LocationOffset(benchmark::State& state)
+{
+    run_chunk(state, "local l = loc.new() return function() l:offset(1, 1) end");
+}
+
+static void BM_LocationDistanceNE(benchmark::State& state)
+{
+    run_chunk(state, "local a = loc.new() local b = loc.new() b:offset(10, 10) "
+                     "return function() local n, e = a:get_distance_NE(b) end");
+}
+
+static void BM_LocationCopyFrom(benchmark::State& state)
+{
+    run_chunk(state, "local a = loc.new() local b = loc.new() "
+                     "return function() a:copy_from(b) end");
+}
+
+BENCHMARK(BM_LocationNew);
+BENCHMARK(BM_LocationField);
+BENCHMARK(BM_LocationOffset);
+BENCHMARK(BM_LocationDistanceNE);
+BENCHMARK(BM_LocationCopyFrom);
+
+BENCHMARK_MAIN()
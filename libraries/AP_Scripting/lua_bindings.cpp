@@ -62,18 +62,33 @@ static const luaL_Reg servo_functions[] =
     {NULL, NULL}
 };
 
+// registry references to the metatables, so bindings don't look them up by name on every call
+static int location_metatable_ref = LUA_NOREF;
+static int ahrs_metatable_ref = LUA_NOREF;
+
 // location stuff
-static int new_location(lua_State *L) {
+static Location *new_location_userdata(lua_State *L) {
     Location *loc = (Location *)lua_newuserdata(L, sizeof(Location));
-    luaL_getmetatable(L, "location");
+    lua_rawgeti(L, LUA_REGISTRYINDEX, location_metatable_ref);
     lua_setmetatable(L, -2);
     memset((void *)loc, 0, sizeof(Location));
+    return loc;
+}
+
+static int new_location(lua_State *L) {
+    new_location_userdata(L);
     return 1;
 }
 
 static Location *check_location(lua_State *L, int arg) {
-    void *data = luaL_checkudata(L, arg, "location");
-    luaL_argcheck(L, data != NULL, arg, "`location` expected");
+    void *data = lua_touserdata(L, arg);
+    bool is_location = false;
+    if (data != NULL && lua_getmetatable(L, arg)) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, location_metatable_ref);
+        is_location = lua_rawequal(L, -1, -2);
+        lua_pop(L, 2);
+    }
+    luaL_argcheck(L, is_location, arg, "`location` expected");
     return (Location *)data;
 }
 
@@ -293,6 +308,33 @@ static int location_equal(lua_State *L) {
     return 1;
 }
 
+static int location_copy_from(lua_State *L) {
+    const int args = lua_gettop(L);
+    if (args != 2) {
+        return luaL_argerror(L, args, "too many arguments");
+    }
+
+    *check_location(L, -2) = *check_location(L, -1);
+
+    lua_pop(L, 1);
+
+    return 1;
+}
+
+static int location_get_distance_NE(lua_State *L) {
+    const int args = lua_gettop(L);
+    if (args != 2) {
+        return luaL_argerror(L, args, "too many arguments");
+    }
+
+    // return the components rather than a new vector userdata
+    const Vector2f dist = location_diff(*check_location(L, -2), *check_location(L, -1));
+    lua_pushnumber(L, dist.x);
+    lua_pushnumber(L, dist.y);
+
+    return 2;
+}
+
 static const luaL_Reg locLib[] = {
   {"new", new_location},
   {NULL, NULL}
@@ -312,26 +354,34 @@ static const luaL_Reg locationMeta[] = {
   {"passed_point", location_passed_point},
   {"path_proportion", location_path_proportion},
   {"offset", location_offset},
+  {"copy_from", location_copy_from},
+  {"get_distance_NE", location_get_distance_NE},
   {"__tostring", location_tostring},
   {"__eq", location_equal},
   {NULL, NULL}
 };
 
-static int ahrs_position(lua_State *L) {
-    check_arguments(L, 1, "ahrs:position");
+// get a location to return from a binding, an existing location can
+// be passed in as the last argument to be updated in place instead of
+// allocating a new one
+static Location *result_location(lua_State *L, int args, const char *fn_name) {
+    const int given = lua_gettop(L);
+    if (given == args + 1) {
+        return check_location(L, -1);
+    }
+    check_arguments(L, args, fn_name);
+    return new_location_userdata(L);
+}
 
-    new_location(L);
-    Location *loc = check_location(L, -1);
+static int ahrs_position(lua_State *L) {
+    Location *loc = result_location(L, 1, "ahrs:position");
     AP::ahrs().get_position(*loc);
 
     return 1;
 }
 
 static int ahrs_get_home(lua_State *L) {
-    check_arguments(L, 1, "ahrs:home");
-
-    new_location(L);
-    Location *loc = check_location(L, -1);
+    Location *loc = result_location(L, 1, "ahrs:home");
     *loc = AP::ahrs().get_home();
 
     return 1;
@@ -343,6 +393,16 @@ static const luaL_Reg ahrsMeta[] = {
   {NULL, NULL}
 };
 
+// create a metatable that is its own __index, returning a registry reference to it
+static int new_metatable(lua_State *L, const char *name, const luaL_Reg *funcs) {
+    luaL_newmetatable(L, name);
+    luaL_setfuncs(L, funcs, 0);
+    lua_pushstring(L, "__index");
+    lua_pushvalue(L, -2);
+    lua_settable(L, -3);
+    return luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
 // all bindings
 
 void load_lua_bindings(lua_State *L) {
@@ -353,27 +413,16 @@ void load_lua_bindings(lua_State *L) {
     lua_setglobal(L, "servo");
 
     // location metatable
-    luaL_newmetatable(L, "location");
-    luaL_setfuncs(L, locationMeta, 0);
-    lua_pushstring(L, "__index");
-    lua_pushvalue(L, -2);
-    lua_settable(L, -3);
-    lua_pop(L, 1);
+    location_metatable_ref = new_metatable(L, "location", locationMeta);
     luaL_newlib(L, locLib);
     lua_setglobal(L, "loc");
 
     // ahrs metatable
-    luaL_newmetatable(L, "ahrs");
-    luaL_setfuncs(L, ahrsMeta, 0);
-    lua_pushstring(L, "__index");
-    lua_pushvalue(L, -2);
-    lua_settable(L, -3);
-    lua_pop(L, 1);
+    ahrs_metatable_ref = new_metatable(L, "ahrs", ahrsMeta);
 
     // ahrs userdata
     lua_newuserdata(L, 0); // lose the pointer, we don't really care about it
-    luaL_getmetatable(L, "ahrs");
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ahrs_metatable_ref);
     lua_setmetatable(L, -2);
     lua_setglobal(L, "ahrs");
 }
-
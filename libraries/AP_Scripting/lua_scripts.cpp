@@ -17,6 +17,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_ROMFS/AP_ROMFS.h>
+#include <AP_Logger/AP_Logger.h>
 
 #if HAL_OS_POSIX_IO
 #include <dirent.h>
@@ -34,22 +35,51 @@
   #endif //HAL_OS_FATFS_IO
 #endif // SCRIPTING_DIRECTORY
 
+// percentage of the heap reserved for slabs of small objects
+#ifndef SCRIPTING_SLAB_PERCENT
+  #define SCRIPTING_SLAB_PERCENT 25
+#endif // SCRIPTING_SLAB_PERCENT
+
+// number of virtual machine instructions between checks of a script's instruction count and run time
+#ifndef SCRIPTING_HOOK_STEPS
+  #define SCRIPTING_HOOK_STEPS 100
+#endif // SCRIPTING_HOOK_STEPS
+
+// minimum time between logging the statistics of each script
+#ifndef SCRIPTING_LOG_INTERVAL_MS
+  #define SCRIPTING_LOG_INTERVAL_MS 1000
+#endif // SCRIPTING_LOG_INTERVAL_MS
+
 extern const AP_HAL::HAL& hal;
 
 bool lua_scripts::overtime;
 jmp_buf lua_scripts::panic_jmp;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size)
-    : _vm_steps(vm_steps) {
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int16 &run_time_ms, const AP_Int8 &cpu_pct)
+    : _vm_steps(vm_steps),
+      _run_time_ms(run_time_ms),
+      _cpu_pct(cpu_pct) {
     _heap = hal.util->allocate_heap_memory(heap_size);
+    if (_heap != nullptr) {
+        _slab_region_size = heap_size * SCRIPTING_SLAB_PERCENT / 100;
+        _slab_region = hal.util->heap_realloc(_heap, nullptr, _slab_region_size);
+    }
 }
 
 void lua_scripts::hook(lua_State *L, lua_Debug *ar) {
-    lua_scripts::overtime = true;
+    if (!overtime) {
+        _run_steps += _hook_steps;
+        if (_run_steps < _step_limit &&
+            (_run_limit_us == 0 || AP_HAL::micros() - _run_start_us < _run_limit_us)) {
+            return;
+        }
 
-    // we need to aggressively bail out as we are over time
-    // so we will aggressively trap errors until we clear out
-    lua_sethook(L, hook, LUA_MASKCOUNT, 1);
+        lua_scripts::overtime = true;
+
+        // we need to aggressively bail out as we are over time
+        // so we will aggressively trap errors until we clear out
+        lua_sethook(L, hook, LUA_MASKCOUNT, 1);
+    }
 
     luaL_error(L, "Exceeded CPU time");
 }
@@ -89,6 +119,15 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     }
 
     new_script->name = filename;
+    new_script->alloc_count = 0;
+    new_script->alloc_bytes = 0;
+    new_script->run_count = 0;
+    new_script->run_time_us = 0;
+    new_script->max_run_time_us = 0;
+    new_script->total_run_time_us = 0;
+    new_script->run_steps = 0;
+    new_script->throttled = 0;
+    new_script->last_log_ms = 0;
     new_script->next = nullptr;
 
 
@@ -167,8 +206,11 @@ void lua_scripts::run_next_script(lua_State *L) {
     scripts = script->next;
 
     // reset the hook to clear the counter
-    const int32_t vm_steps = MAX(_vm_steps, 1000);
-    lua_sethook(L, hook, LUA_MASKCOUNT, vm_steps);
+    _step_limit = MAX(_vm_steps, 1000);
+    _hook_steps = MIN(_step_limit, (uint32_t)SCRIPTING_HOOK_STEPS);
+    _run_steps = 0;
+    _run_limit_us = MAX(_run_time_ms, 0) * 1000U;
+    lua_sethook(L, hook, LUA_MASKCOUNT, _hook_steps);
 
     // store top of stack so we can calculate the number of return values
     int stack_top = lua_gettop(L);
@@ -176,10 +218,26 @@ void lua_scripts::run_next_script(lua_State *L) {
     // pop the function to the top of the stack
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->lua_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    _current_script = script;
+    _run_start_us = AP_HAL::micros();
+    const int result = lua_pcall(L, 0, LUA_MULTRET, 0);
+    const uint32_t run_time_us = AP_HAL::micros() - _run_start_us;
+    _current_script = nullptr;
+    const uint64_t earliest_run_ms = account_run(script, run_time_us);
+
+    // scripts may run every few milliseconds so limit the rate their statistics are logged
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - script->last_log_ms >= SCRIPTING_LOG_INTERVAL_MS) {
+        script->last_log_ms = now_ms;
+        log_memory(script);
+        log_timing(script);
+    }
+
+    if (result) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
-            gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded time limit (%d)", script->name,  vm_steps);
+            gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded time limit (%u steps, %u us)", script->name,
+                            (unsigned)_run_steps, (unsigned)run_time_us);
             remove_script(L, script);
         } else {
             gcs().send_text(MAV_SEVERITY_INFO, "Lua: %s", lua_tostring(L, -1));
@@ -213,6 +271,11 @@ void lua_scripts::run_next_script(lua_State *L) {
 
                    // types match the expectations, go ahead and reschedule
                    script->next_run_ms = AP_HAL::millis64() + (uint64_t)luaL_checknumber(L, -1);
+                   if (script->next_run_ms < earliest_run_ms) {
+                       // the script has used more than its share of the CPU, give the other scripts a chance to run
+                       script->next_run_ms = earliest_run_ms;
+                       script->throttled++;
+                   }
                    lua_pop(L, 1);
                    int old_ref = script->lua_ref;
                    script->lua_ref = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -295,10 +358,170 @@ void lua_scripts::reschedule_script(script_info *script) {
 }
 
 void *lua_scripts::_heap;
+lua_slab lua_scripts::_slab;
+void *lua_scripts::_slab_region;
+uint32_t lua_scripts::_slab_region_size;
+uint32_t lua_scripts::_mem_used;
+uint32_t lua_scripts::_mem_high_water;
+lua_scripts::script_info *lua_scripts::_current_script;
+uint32_t lua_scripts::_hook_steps;
+uint32_t lua_scripts::_run_steps;
+uint32_t lua_scripts::_step_limit;
+uint32_t lua_scripts::_run_start_us;
+uint32_t lua_scripts::_run_limit_us;
+
+void lua_scripts::free_block(void *ptr, size_t size) {
+    if (_slab.owns(ptr)) {
+        _slab.free(ptr, size);
+    } else {
+        hal.util->heap_realloc(_heap, ptr, 0);
+    }
+}
 
+/*
+  allocator for Lua. Small objects come from the slabs, anything larger
+  or that doesn't fit in the slabs comes from the heap. Lua tells us the
+  old size of a block, which for a new block is the type of object
+ */
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
-    (void)ud; (void)osize;  /* not used */
-    return hal.util->heap_realloc(_heap, ptr, nsize);
+    (void)ud;  /* not used */
+    if (ptr == nullptr) {
+        osize = 0;
+    }
+
+    if (nsize == 0) {
+        if (ptr != nullptr) {
+            free_block(ptr, osize);
+            _mem_used -= osize;
+        }
+        return nullptr;
+    }
+
+    void *new_ptr = nullptr;
+    if (ptr != nullptr && _slab.owns(ptr) && _slab.fits_block(ptr, nsize)) {
+        // the block is still the right size class
+        _slab.resized(osize, nsize);
+        new_ptr = ptr;
+    } else if (ptr != nullptr && !_slab.owns(ptr) && !lua_slab::fits(nsize)) {
+        // large blocks stay in the heap
+        new_ptr = hal.util->heap_realloc(_heap, ptr, nsize);
+    } else {
+        // new block, or moving between the slabs and the heap
+        if (lua_slab::fits(nsize)) {
+            new_ptr = _slab.allocate(nsize);
+        }
+        if (new_ptr == nullptr) {
+            new_ptr = hal.util->heap_realloc(_heap, nullptr, nsize);
+        }
+        if (new_ptr == nullptr) {
+            if (ptr != nullptr && nsize <= osize) {
+                // Lua requires that shrinking a block never fails, keep the old block
+                if (_slab.owns(ptr)) {
+                    _slab.resized(osize, nsize);
+                    new_ptr = ptr;
+                } else {
+                    new_ptr = hal.util->heap_realloc(_heap, ptr, nsize);
+                }
+            }
+        } else if (ptr != nullptr) {
+            memcpy(new_ptr, ptr, MIN(osize, nsize));
+            free_block(ptr, osize);
+        }
+    }
+
+    if (new_ptr == nullptr) {
+        return nullptr;
+    }
+
+    _mem_used += nsize - osize;
+    _mem_high_water = MAX(_mem_high_water, _mem_used);
+    if (_current_script != nullptr && nsize > osize) {
+        _current_script->alloc_count++;
+        _current_script->alloc_bytes += nsize - osize;
+    }
+    return new_ptr;
+}
+
+/*
+  log memory use after a script has run
+ */
+void lua_scripts::log_memory(const script_info *script) const {
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr || !logger->logging_enabled()) {
+        return;
+    }
+
+    const lua_slab::stats &slab = _slab.get_stats();
+    struct log_LUAM pkt {
+        LOG_PACKET_HEADER_INIT(LOG_LUAM_MSG),
+        time_us        : AP_HAL::micros64(),
+        name           : {},
+        alloc_count    : script->alloc_count,
+        alloc_bytes    : script->alloc_bytes,
+        mem_used       : _mem_used,
+        mem_high_water : _mem_high_water,
+        slab_used      : slab.used_bytes,
+        slab_waste     : slab.used_bytes - slab.requested_bytes,
+        slab_free      : slab.free_bytes + slab.unused_bytes,
+        slab_failed    : slab.failed
+    };
+    copy_log_name(script, pkt.name);
+
+    // this runs on the scripting thread so must use a message with a fixed format rather than Write
+    logger->WriteBlock(&pkt, sizeof(pkt));
+}
+
+/*
+  copy the file name of a script without the directory into a log name field
+ */
+void lua_scripts::copy_log_name(const script_info *script, char (&log_name)[16]) {
+    const char *name = strrchr(script->name, '/');
+    name = (name == nullptr) ? script->name : name + 1;
+    strncpy(log_name, name, sizeof(log_name));
+}
+
+/*
+  update the timing statistics for a script that has just run. A script
+  that ran for t must then wait for t * (100 - SCR_CPU_PCT) / SCR_CPU_PCT
+  so that no script can take more than its share of the scripting
+  thread, returns the earliest time the script may run again
+ */
+uint64_t lua_scripts::account_run(script_info *script, uint32_t run_time_us) {
+    script->run_count++;
+    script->run_time_us = run_time_us;
+    script->max_run_time_us = MAX(script->max_run_time_us, run_time_us);
+    script->total_run_time_us += run_time_us;
+    script->run_steps = _run_steps;
+
+    const uint32_t cpu_pct = constrain_int16(_cpu_pct, 1, 100);
+    const uint64_t idle_us = uint64_t(run_time_us) * (100 - cpu_pct) / cpu_pct;
+    return AP_HAL::millis64() + idle_us / 1000;
+}
+
+/*
+  log the time taken by a script after it has run
+ */
+void lua_scripts::log_timing(const script_info *script) const {
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr || !logger->logging_enabled()) {
+        return;
+    }
+
+    struct log_LUAT pkt {
+        LOG_PACKET_HEADER_INIT(LOG_LUAT_MSG),
+        time_us         : AP_HAL::micros64(),
+        name            : {},
+        run_count       : script->run_count,
+        run_time_us     : script->run_time_us,
+        max_run_time_us : script->max_run_time_us,
+        avg_run_time_us : (uint32_t)(script->total_run_time_us / script->run_count),
+        run_steps       : script->run_steps,
+        throttled       : script->throttled
+    };
+    copy_log_name(script, pkt.name);
+
+    // this runs on the scripting thread so must use a message with a fixed format rather than Write
+    logger->WriteBlock(&pkt, sizeof(pkt));
 }
 
 void lua_scripts::run(void) {
@@ -320,6 +543,10 @@ void lua_scripts::run(void) {
         overtime = false;
     }
 
+    // all objects were freed when the old state was closed, so the slabs can be reset
+    _slab.init(_slab_region, _slab_region_size);
+    _mem_used = 0;
+
     lua_state = lua_newstate(alloc, NULL);
     lua_State *L = lua_state;
     if (L == nullptr) {
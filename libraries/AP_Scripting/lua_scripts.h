@@ -19,11 +19,12 @@
 #include <setjmp.h>
 
 #include "lua_bindings.h"
+#include "lua_slab.h"
 
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int16 &run_time_ms, const AP_Int8 &cpu_pct);
 
     /* Do not allow copies */
     lua_scripts(const lua_scripts &other) = delete;
@@ -39,6 +40,15 @@ private:
        int lua_ref;          // reference to the loaded script object
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        char *name;           // filename for the script // FIXME: This information should be available from Lua
+       uint32_t alloc_count; // number of allocations made while the script was running
+       uint32_t alloc_bytes; // bytes allocated while the script was running
+       uint32_t run_count;   // number of times the script has been run
+       uint32_t run_time_us; // time taken by the last run
+       uint32_t max_run_time_us; // longest run
+       uint64_t total_run_time_us; // time taken by all runs
+       uint32_t run_steps;   // virtual machine instructions executed by the last run, to the nearest hook interval
+       uint32_t throttled;   // number of times the script was delayed to keep it within its CPU share
+       uint32_t last_log_ms; // system time statistics were last logged
        script_info *next;
     } script_info;
 
@@ -55,10 +65,18 @@ private:
 
     script_info *scripts; // linked list of scripts to be run, sorted by next run time (soonest first)
 
-    // hook will be run when CPU time for a script is exceeded
+    // hook is run every _hook_steps instructions to count them and
+    // stop the script if it has exceeded its instruction count or run time
     // it must be static to be passed to the C API
     static void hook(lua_State *L, lua_Debug *ar);
 
+    // state of the script being run for the hook
+    static uint32_t _hook_steps;    // instructions between calls to the hook
+    static uint32_t _run_steps;     // instructions executed so far
+    static uint32_t _step_limit;    // instructions allowed
+    static uint32_t _run_start_us;  // time the script was started
+    static uint32_t _run_limit_us;  // time allowed, 0 for no limit
+
     // lua panic handler, will jump back to the start of run
     static int atpanic(lua_State *L);
     static jmp_buf panic_jmp;
@@ -66,8 +84,36 @@ private:
     lua_State *lua_state;
 
     const AP_Int32 & _vm_steps;
+    const AP_Int16 & _run_time_ms;
+    const AP_Int8 & _cpu_pct;
+
+    // update the timing statistics after a run and return the earliest time the script may run again
+    uint64_t account_run(script_info *script, uint32_t run_time_us);
+
+    // log timing statistics after a script has run
+    void log_timing(const script_info *script) const;
 
     static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
 
+    // free a block from either the slabs or the heap
+    static void free_block(void *ptr, size_t size);
+
+    // log memory statistics after a script has run
+    void log_memory(const script_info *script) const;
+
+    // copy the file name of a script without the directory into a log name field
+    static void copy_log_name(const script_info *script, char (&log_name)[16]);
+
     static void *_heap;
+
+    // small objects are allocated from slabs in front of the heap
+    static lua_slab _slab;
+    static void *_slab_region;
+    static uint32_t _slab_region_size;
+
+    static uint32_t _mem_used;          // bytes requested by Lua
+    static uint32_t _mem_high_water;    // highest value of _mem_used
+
+    // script being run, allocations are counted against it
+    static script_info *_current_script;
 };
@@ -0,0 +1,108 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lua_slab.h"
+
+#include <string.h>
+
+// block sizes are multiples of 8 so every block is suitably aligned for Lua
+const uint16_t lua_slab::class_sizes[LUA_SLAB_NUM_CLASSES] = { 16, 32, 48, 64, 96, 128 };
+
+static_assert(LUA_SLAB_PAGE_SIZE % 8 == 0, "slab pages must keep blocks aligned");
+
+void lua_slab::init(void *region, size_t size)
+{
+    memset(_free_list, 0, sizeof(_free_list));
+    memset(&_stats, 0, sizeof(_stats));
+    _pages = nullptr;
+    _page_class = nullptr;
+    _num_pages = 0;
+    _pages_used = 0;
+    if (region == nullptr) {
+        return;
+    }
+
+    // the page class table is kept at the start of the region, followed by the pages
+    uint8_t *start = (uint8_t *)region;
+    const uint16_t num_pages = size / (LUA_SLAB_PAGE_SIZE + 1);
+    const size_t table_size = (num_pages + 7) & ~7U;
+    if (num_pages == 0 || table_size + num_pages * LUA_SLAB_PAGE_SIZE > size) {
+        return;
+    }
+    _page_class = start;
+    _pages = start + table_size;
+    _num_pages = num_pages;
+    _stats.unused_bytes = num_pages * LUA_SLAB_PAGE_SIZE;
+}
+
+uint8_t lua_slab::size_class(size_t size)
+{
+    uint8_t c = 0;
+    while (c < LUA_SLAB_NUM_CLASSES-1 && class_sizes[c] < size) {
+        c++;
+    }
+    return c;
+}
+
+bool lua_slab::fits_block(const void *ptr, size_t size) const
+{
+    const uint16_t page = ((const uint8_t *)ptr - _pages) / LUA_SLAB_PAGE_SIZE;
+    return fits(size) && size_class(size) == _page_class[page];
+}
+
+void *lua_slab::allocate(size_t size)
+{
+    if (!fits(size)) {
+        return nullptr;
+    }
+    const uint8_t c = size_class(size);
+    const uint16_t block = class_sizes[c];
+
+    if (_free_list[c] == nullptr) {
+        if (_pages_used >= _num_pages) {
+            _stats.failed++;
+            return nullptr;
+        }
+        // divide a new page into blocks for this class
+        uint8_t *page = _pages + _pages_used * LUA_SLAB_PAGE_SIZE;
+        _page_class[_pages_used++] = c;
+        for (uint16_t ofs = 0; ofs + block <= LUA_SLAB_PAGE_SIZE; ofs += block) {
+            free_block *b = (free_block *)(page + ofs);
+            b->next = _free_list[c];
+            _free_list[c] = b;
+            _stats.free_bytes += block;
+        }
+        _stats.unused_bytes -= LUA_SLAB_PAGE_SIZE;
+    }
+
+    free_block *b = _free_list[c];
+    _free_list[c] = b->next;
+    _stats.free_bytes -= block;
+    _stats.used_bytes += block;
+    _stats.requested_bytes += size;
+    return b;
+}
+
+void lua_slab::free(void *ptr, size_t size)
+{
+    const uint16_t page = ((uint8_t *)ptr - _pages) / LUA_SLAB_PAGE_SIZE;
+    const uint8_t c = _page_class[page];
+    free_block *b = (free_block *)ptr;
+    b->next = _free_list[c];
+    _free_list[c] = b;
+    _stats.free_bytes += class_sizes[c];
+    _stats.used_bytes -= class_sizes[c];
+    _stats.requested_bytes -= size;
+}
@@ -0,0 +1,95 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LUA_SLAB_PAGE_SIZE      512     // bytes carved from the region at a time for one size class
+#define LUA_SLAB_NUM_CLASSES    6
+
+/*
+  size class slab allocator for small Lua objects
+
+  Lua allocates and frees large numbers of small objects (strings,
+  tables, userdata), which fragments a general purpose heap. This
+  allocator serves them from a fixed region instead. The region is
+  divided into pages on demand, each page holding blocks of a single
+  size class, and freed blocks are kept on a free list for their class
+  so they can be reused by an object of similar size. Pages are never
+  returned, so the region only holds small objects.
+
+  Ownership and size class of a block are found from its address, so
+  the caller doesn't need to know which allocator a block came from.
+ */
+class lua_slab {
+public:
+    struct stats {
+        uint32_t used_bytes;        // bytes in blocks that are allocated, by block size
+        uint32_t requested_bytes;   // bytes requested for allocated blocks
+        uint32_t free_bytes;        // bytes in blocks on the free lists
+        uint32_t unused_bytes;      // bytes not yet divided into pages
+        uint32_t failed;            // allocations that did not fit in the region
+    };
+
+    // take a region of memory to divide into slabs
+    void init(void *region, size_t size);
+
+    // true if size can be allocated from a slab
+    static bool fits(size_t size) {
+        return size > 0 && size <= class_sizes[LUA_SLAB_NUM_CLASSES-1];
+    }
+
+    // true if the block was allocated from the slab region
+    bool owns(const void *ptr) const {
+        return ptr >= _pages && ptr < _pages + _num_pages * LUA_SLAB_PAGE_SIZE;
+    }
+
+    // true if a block allocated from the slab region is the size class for size bytes
+    bool fits_block(const void *ptr, size_t size) const;
+
+    // allocate a block of at least size bytes, returns nullptr if
+    // size is too large or there is no room left in the region
+    void *allocate(size_t size);
+
+    // return a block to the free list for its size class, size is the size that was requested
+    void free(void *ptr, size_t size);
+
+    // account for a block being reused for a different requested size
+    void resized(size_t old_size, size_t new_size) {
+        _stats.requested_bytes += new_size - old_size;
+    }
+
+    const struct stats &get_stats(void) const { return _stats; }
+
+private:
+    static const uint16_t class_sizes[LUA_SLAB_NUM_CLASSES];
+
+    // smallest size class that holds size bytes
+    static uint8_t size_class(size_t size);
+
+    struct free_block {
+        free_block *next;
+    };
+
+    free_block *_free_list[LUA_SLAB_NUM_CLASSES];
+
+    uint8_t *_pages;            // start of the pages
+    uint8_t *_page_class;       // size class of each page in use
+    uint16_t _num_pages;
+    uint16_t _pages_used;
+
+    struct stats _stats;
+};
@@ -30,8 +30,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
-    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.  SmartRTL is deactivated if there is not enough free memory for this many points.
+    // @Range: 0 5000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -55,7 +55,10 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    points when their line segments get close. This algorithm will never
 *    compare two consecutive line segments. Obviously the segments (p1,p2) and
 *    (p2,p3) will get very close (they touch), but there would be nothing to
-*    trim between them.
+*    trim between them.  Segments are held in a spatial index (a hashed
+*    horizontal grid keyed by each segment's midpoint) which is built up as
+*    new points are checked, so each new segment is only compared with the
+*    earlier segments that are nearby instead of with the whole path.
 *
 *    2. Simplification uses the Ramer-Douglas-Peucker algorithm. See Wikipedia
 *    for a more complete description.
@@ -99,26 +102,44 @@ void AP_SmartRTL::init()
         return;
     }
 
+    // check there is enough memory first, boards with little memory could otherwise be left without enough for other libraries
+    _prune.loops_max = _points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT;
+    _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
+    const uint32_t mem_required = _points_max * (sizeof(Vector3f) + sizeof(uint16_t)) +
+                                  _prune.loops_max * sizeof(prune_loop_t) +
+                                  SMARTRTL_GRID_BUCKETS * sizeof(uint16_t) +
+                                  _simplify.stack_max * sizeof(simplify_start_finish_t);
+    if (hal.util->available_memory() < mem_required + SMARTRTL_MEMORY_RESERVE) {
+        log_action(SRTL_DEACTIVATED_INIT_FAILED);
+        gcs().send_text(MAV_SEVERITY_WARNING, "SmartRTL deactivated: not enough memory for %u points", (unsigned)_points_max);
+        return;
+    }
+
     // allocate arrays
     _path = (Vector3f*)calloc(_points_max, sizeof(Vector3f));
 
-    _prune.loops_max = _points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT;
     _prune.loops = (prune_loop_t*)calloc(_prune.loops_max, sizeof(prune_loop_t));
 
-    _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
+    _prune.grid_heads = (uint16_t*)calloc(SMARTRTL_GRID_BUCKETS, sizeof(uint16_t));
+    _prune.grid_next = (uint16_t*)calloc(_points_max, sizeof(uint16_t));
+
     _simplify.stack = (simplify_start_finish_t*)calloc(_simplify.stack_max, sizeof(simplify_start_finish_t));
 
     // check if memory allocation failed
-    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr) {
+    if (_path == nullptr || _prune.loops == nullptr || _prune.grid_heads == nullptr ||
+        _prune.grid_next == nullptr || _simplify.stack == nullptr) {
         log_action(SRTL_DEACTIVATED_INIT_FAILED);
         gcs().send_text(MAV_SEVERITY_WARNING, "SmartRTL deactivated: init failed");
         free(_path);
         free(_prune.loops);
+        free(_prune.grid_heads);
+        free(_prune.grid_next);
         free(_simplify.stack);
         return;
     }
 
     _path_points_max = _points_max;
+    grid_reset();
 
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
     if (!_example_mode){
@@ -516,8 +537,9 @@ void AP_SmartRTL::detect_simplifications()
 
 /**
 *   This method runs for the allotted time, and detects loops in a path. Any detected loops are added to _prune.loops,
-*   this function does not alter the path in memory. It works by comparing the line segment between any two sequential points
-*   to the line segment between any other two sequential points. If they get close enough, anything between them could be pruned.
+*   this function does not alter the path in memory. It works by comparing the line segment between each new pair of sequential
+*   points to the earlier line segments held in the spatial index. If they get close enough, anything between them could be pruned.
+*   Only new segments are added to the spatial index so the work done grows with the number of new points rather than the whole path.
 *
 *   reset_pruning should have been called at least once before this function is called to setup the indexes (_prune.i, etc)
 */
@@ -535,32 +557,33 @@ void AP_SmartRTL::detect_loops()
     // run for defined amount of time
     while (AP_HAL::micros() - start_time_us < SMARTRTL_PRUNING_LOOP_TIME_US) {
 
-        // advance inner loop
-        _prune.j++;
-        if (_prune.j > _prune.i - 2) {
-            // set inner loop back to first point
-            _prune.j = 1;
-            // reduce outer loop
-            _prune.i--;
-            // complete when outer loop has run out of new points to check
-            if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
-                _prune.complete = true;
-                _prune.path_points_completed = _prune.path_points_count;
-                return;
-            }
+        // add any new segments to the spatial index
+        if (_prune.grid_count < _prune.path_points_count) {
+            grid_add_next_segment();
+            continue;
+        }
+
+        // complete when outer loop has run out of new points to check
+        if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+            _prune.complete = true;
+            _prune.path_points_completed = _prune.path_points_count;
+            return;
         }
 
-        // find the closest distance between two line segments and the mid-point
-        dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[_prune.j-1], _path[_prune.j]);
-        if (dp.distance < SMARTRTL_PRUNING_DELTA) {
+        // find the earliest segment which comes close to this one
+        dist_point dp;
+        const uint16_t j = grid_find_loop(_prune.i, dp);
+        if (j > 0) {
             // if there is a loop here, add to loop array
-            if (!add_loop(_prune.j, _prune.i-1, dp.midpoint)) {
+            if (!add_loop(j, _prune.i-1, dp.midpoint)) {
                 // if the buffer is full, stop trying to prune
                 _prune.complete = true;
+                return;
             }
-            // set inner loop forward to trigger outer loop move to next segment
-            _prune.j = _prune.i;
         }
+
+        // move to next segment
+        _prune.i--;
     }
 }
 
@@ -605,16 +628,18 @@ void AP_SmartRTL::restart_pruning(uint16_t path_points_count)
 {
     _prune.complete = false;
     _prune.i = (path_points_count > 0) ? path_points_count - 1 : 0;
-    _prune.j = 0;
     _prune.path_points_count = path_points_count;
+    // discard segments from the spatial index which may have changed since they were added
+    grid_truncate(_prune.path_points_completed);
 }
 
 // reset pruning algorithm so that it will re-check all points in the path
 void AP_SmartRTL::reset_pruning()
 {
-    restart_pruning(0);
     _prune.loops_count = 0; // clear the loops that we've recorded
     _prune.path_points_completed = 0;
+    grid_reset();
+    restart_pruning(0);
 }
 
 // remove all simplify-able points from the path
@@ -629,6 +654,10 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     for (uint16_t src = 1; src < _path_points_count; src++) {
         if (!_simplify.bitmask.get(src)) {
             log_action(SRTL_POINT_SIMPLIFY, _path[src]);
+            if (removed == 0) {
+                // segments from here on will move so remove them from the spatial index
+                grid_truncate(src);
+            }
             removed++;
         } else {
             _path[dest] = _path[src];
@@ -677,6 +706,9 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         // midpoint goes into start_index (this is the end point of the first segment)
         _path[loop.start_index] = loop.midpoint;
 
+        // segments from start_index on will change so remove them from the spatial index
+        grid_truncate(loop.start_index);
+
         // shift points after the end of the loop down by the number of points in the loop
         uint16_t loop_num_points_to_remove = loop.end_index - loop.start_index;
         for (uint16_t dest = loop.start_index + 1; dest < _path_points_count - loop_num_points_to_remove; dest++) {
@@ -817,6 +849,123 @@ AP_SmartRTL::dist_point AP_SmartRTL::segment_segment_dist(const Vector3f &p1, co
     return {dP.length(), midpoint};
 }
 
+// reset the spatial index so that it holds no segments
+void AP_SmartRTL::grid_reset()
+{
+    if (_prune.grid_heads == nullptr) {
+        return;
+    }
+    for (uint16_t b = 0; b < SMARTRTL_GRID_BUCKETS; b++) {
+        _prune.grid_heads[b] = SMARTRTL_GRID_NONE;
+    }
+    _prune.grid_long = SMARTRTL_GRID_NONE;
+    // the first segment ends at point 1
+    _prune.grid_count = 1;
+    // capture cell size in case the accuracy parameter is changed while the index is in use
+    _prune.grid_cell_size = SMARTRTL_GRID_CELL_SIZE;
+}
+
+// remove all segments ending at or after index from the spatial index
+// segments are always added to the front of their list so each list is in descending index order
+void AP_SmartRTL::grid_truncate(uint16_t index)
+{
+    if (_prune.grid_heads == nullptr || index >= _prune.grid_count) {
+        return;
+    }
+    for (uint16_t b = 0; b < SMARTRTL_GRID_BUCKETS; b++) {
+        while (_prune.grid_heads[b] != SMARTRTL_GRID_NONE && _prune.grid_heads[b] >= index) {
+            _prune.grid_heads[b] = _prune.grid_next[_prune.grid_heads[b]];
+        }
+    }
+    while (_prune.grid_long != SMARTRTL_GRID_NONE && _prune.grid_long >= index) {
+        _prune.grid_long = _prune.grid_next[_prune.grid_long];
+    }
+    _prune.grid_count = MAX(index, (uint16_t)1);
+}
+
+// add the segment ending at _prune.grid_count to the spatial index
+void AP_SmartRTL::grid_add_next_segment()
+{
+    const uint16_t index = _prune.grid_count++;
+    const Vector3f& p1 = _path[index-1];
+    const Vector3f& p2 = _path[index];
+    const float cell_size = _prune.grid_cell_size;
+
+    // long segments cannot be found by searching the cells around a midpoint so are held separately
+    if ((p2-p1).length() > cell_size) {
+        _prune.grid_next[index] = _prune.grid_long;
+        _prune.grid_long = index;
+        return;
+    }
+
+    const uint16_t bucket = grid_bucket((int32_t)floorf((p1.x + p2.x) * 0.5f / cell_size), (int32_t)floorf((p1.y + p2.y) * 0.5f / cell_size));
+    _prune.grid_next[index] = _prune.grid_heads[bucket];
+    _prune.grid_heads[bucket] = index;
+}
+
+// return the index of the hash bucket holding the given horizontal grid cell
+uint16_t AP_SmartRTL::grid_bucket(int32_t cell_x, int32_t cell_y)
+{
+    return (((uint32_t)cell_x * 73856093U) ^ ((uint32_t)cell_y * 19349663U)) & (SMARTRTL_GRID_BUCKETS - 1);
+}
+
+// check one candidate segment for grid_find_loop, updating best_index and best_dp if it is closer than SMARTRTL_PRUNING_DELTA
+void AP_SmartRTL::grid_check_segment(uint16_t index, uint16_t candidate, uint16_t &best_index, dist_point &best_dp) const
+{
+    // ignore neighbouring segments and, as we only want the longest loop, anything after the best so far
+    if ((candidate + 2 > index) || (best_index != 0 && candidate >= best_index)) {
+        return;
+    }
+    const dist_point dp = segment_segment_dist(_path[index], _path[index-1], _path[candidate-1], _path[candidate]);
+    if (dp.distance < SMARTRTL_PRUNING_DELTA) {
+        best_index = candidate;
+        best_dp = dp;
+    }
+}
+
+// find the earliest segment in the spatial index which comes close to the segment ending at index
+// segments within one of the segment ending at index are ignored because they always touch it
+// returns the end index of that segment, or zero if no segment is close.  dp is filled in on success
+uint16_t AP_SmartRTL::grid_find_loop(uint16_t index, dist_point &dp) const
+{
+    const Vector3f& p1 = _path[index-1];
+    const Vector3f& p2 = _path[index];
+    const float cell_size = _prune.grid_cell_size;
+    uint16_t best_index = 0;
+
+    // long segments are always checked
+    for (uint16_t k = _prune.grid_long; k != SMARTRTL_GRID_NONE; k = _prune.grid_next[k]) {
+        grid_check_segment(index, k, best_index, dp);
+    }
+
+    // segments in the grid are no longer than a cell, so a segment close to this one must have
+    // its midpoint within this distance of this segment's midpoint
+    const Vector3f midpoint = (p1 + p2) * 0.5f;
+    const float radius = (p2-p1).length() * 0.5f + cell_size * 0.5f + SMARTRTL_PRUNING_DELTA;
+    const int32_t x_min = (int32_t)floorf((midpoint.x - radius) / cell_size);
+    const int32_t x_max = (int32_t)floorf((midpoint.x + radius) / cell_size);
+    const int32_t y_min = (int32_t)floorf((midpoint.y - radius) / cell_size);
+    const int32_t y_max = (int32_t)floorf((midpoint.y + radius) / cell_size);
+
+    // if this segment is very long it is quicker to check it against every segment
+    if ((x_max - x_min >= SMARTRTL_GRID_QUERY_CELLS_MAX) || (y_max - y_min >= SMARTRTL_GRID_QUERY_CELLS_MAX)) {
+        for (uint16_t k = 1; k + 2 <= index; k++) {
+            grid_check_segment(index, k, best_index, dp);
+        }
+        return best_index;
+    }
+
+    for (int32_t x = x_min; x <= x_max; x++) {
+        for (int32_t y = y_min; y <= y_max; y++) {
+            for (uint16_t k = _prune.grid_heads[grid_bucket(x, y)]; k != SMARTRTL_GRID_NONE; k = _prune.grid_next[k]) {
+                grid_check_segment(index, k, best_index, dp);
+            }
+        }
+    }
+
+    return best_index;
+}
+
 // de-activate SmartRTL, send warning to GCS and log to dataflash
 void AP_SmartRTL::deactivate(SRTL_Actions action, const char *reason)
 {
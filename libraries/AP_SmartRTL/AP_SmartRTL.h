@@ -6,8 +6,9 @@
 
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
-#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
-#define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 24bytes * this number.
+#define SMARTRTL_POINTS_MAX              5000   // the absolute maximum number of points this library can support.
+#define SMARTRTL_MEMORY_RESERVE          4096   // bytes of free memory that must remain after the path is allocated
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
@@ -20,6 +21,10 @@
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
+#define SMARTRTL_GRID_BUCKETS            256    // number of hash buckets in the spatial index used by the loop finding algorithm.  must be a power of 2
+#define SMARTRTL_GRID_CELL_SIZE (_accuracy * 10.0f) // size (in meters) of the spatial index's horizontal grid cells.  Segments longer than this are kept in a separate list
+#define SMARTRTL_GRID_QUERY_CELLS_MAX    6      // if a segment spans more than this many cells in either direction, loop finding checks it against all segments
+#define SMARTRTL_GRID_NONE               0xFFFF // marks the end of a spatial index list
 
 class AP_SmartRTL {
 
@@ -155,6 +160,27 @@ private:
     // get the closest distance between 2 line segments and the point midway between the closest points
     static dist_point segment_segment_dist(const Vector3f& p1, const Vector3f& p2, const Vector3f& p3, const Vector3f& p4);
 
+    // spatial index of path segments used by detect_loops.  The segment ending at point index
+    // (i.e. from _path[index-1] to _path[index]) is stored in the grid cell holding its midpoint
+    // reset the index so that it holds no segments
+    void grid_reset();
+
+    // remove all segments ending at or after index from the spatial index
+    void grid_truncate(uint16_t index);
+
+    // add the segment ending at _prune.grid_count to the spatial index
+    void grid_add_next_segment();
+
+    // return the index of the hash bucket holding the given horizontal grid cell
+    static uint16_t grid_bucket(int32_t cell_x, int32_t cell_y);
+
+    // find the earliest segment in the spatial index (ending at or before index-2) which comes close to the segment ending at index
+    // returns the end index of that segment, or zero if no segment is close.  dp is filled in on success
+    uint16_t grid_find_loop(uint16_t index, dist_point &dp) const;
+
+    // check one candidate segment for grid_find_loop, updating best_index and best_dp if it is closer than SMARTRTL_PRUNING_DELTA
+    void grid_check_segment(uint16_t index, uint16_t candidate, uint16_t &best_index, dist_point &best_dp) const;
+
     // de-activate SmartRTL, send warning to GCS and log to dataflash
     void deactivate(SRTL_Actions action, const char *reason);
 
@@ -210,11 +236,15 @@ private:
         bool complete;
         uint16_t path_points_count;  // copy of _path_points_count taken when the prune algorithm started
         uint16_t path_points_completed; // number of points in that path that have already been checked for loops and should be ignored
-        uint16_t i;     // loop search's outer loop index
-        uint16_t j;     // loop search's inner loop index
+        uint16_t i;     // loop search's outer loop index (end index of the segment being checked)
         prune_loop_t* loops;// the result of the pruning algorithm
         uint16_t loops_max; // maximum number of elements in the _prunable_loops array
         uint16_t loops_count;   // number of elements in the _prunable_loops array
+        uint16_t* grid_heads;   // first segment in each spatial index hash bucket (SMARTRTL_GRID_BUCKETS elements)
+        uint16_t* grid_next;    // next segment in the same bucket for each segment, one element per path point
+        uint16_t grid_long;     // first segment too long to be stored in the grid
+        uint16_t grid_count;    // segments ending at points 1 to grid_count-1 are held in the spatial index
+        float grid_cell_size;   // cell size captured when the spatial index was reset
     } _prune;
 
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
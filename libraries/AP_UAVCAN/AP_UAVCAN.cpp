@@ -32,6 +32,7 @@
 #include <uavcan/equipment/actuator/Status.hpp>
 
 #include <uavcan/equipment/esc/RawCommand.hpp>
+#include <uavcan/equipment/esc/Status.hpp>
 #include <uavcan/equipment/indication/LightsCommand.hpp>
 #include <uavcan/equipment/indication/SingleLightCommand.hpp>
 #include <uavcan/equipment/indication/RGB565.hpp>
@@ -41,6 +42,7 @@
 #include <AP_BattMonitor/AP_BattMonitor_UAVCAN.h>
 #include <AP_Compass/AP_Compass_UAVCAN.h>
 #include <AP_Airspeed/AP_Airspeed_UAVCAN.h>
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
 
 #define LED_DELAY_US 50000
 
@@ -96,6 +98,10 @@ static uavcan::Publisher<uavcan::equipment::actuator::ArrayCommand>* act_out_arr
 static uavcan::Publisher<uavcan::equipment::esc::RawCommand>* esc_raw[MAX_NUMBER_OF_CAN_DRIVERS];
 static uavcan::Publisher<uavcan::equipment::indication::LightsCommand>* rgb_led[MAX_NUMBER_OF_CAN_DRIVERS];
 
+// subscribers
+UC_REGISTRY_BINDER(ESCStatusCb, uavcan::equipment::esc::Status);
+static uavcan::Subscriber<uavcan::equipment::esc::Status, ESCStatusCb> *esc_status_listener[MAX_NUMBER_OF_CAN_DRIVERS];
+
 AP_UAVCAN::AP_UAVCAN() :
     _node_allocator()
 {
@@ -217,6 +223,12 @@ void AP_UAVCAN::init(uint8_t driver_index, bool enable_filters)
     rgb_led[driver_index]->setTxTimeout(uavcan::MonotonicDuration::fromMSec(20));
     rgb_led[driver_index]->setPriority(uavcan::TransferPriority::OneHigherThanLowest);
 
+    esc_status_listener[driver_index] = new uavcan::Subscriber<uavcan::equipment::esc::Status, ESCStatusCb>(*_node);
+    if (esc_status_listener[driver_index]->start(ESCStatusCb(this, &handle_ESC_status)) < 0) {
+        AP_HAL::panic("UAVCAN ESC Status subscriber start problem\n\r");
+        return;
+    }
+
     _led_conf.devices_count = 0;
     if (enable_filters) {
         configureCanAcceptanceFilters(*_node);
@@ -469,4 +481,28 @@ bool AP_UAVCAN::led_write(uint8_t led_index, uint8_t red, uint8_t green, uint8_t
     return true;
 }
 
+/*
+  handle ESC status message, publishing it to the ESC telemetry store
+ */
+void AP_UAVCAN::handle_ESC_status(AP_UAVCAN* ap_uavcan, uint8_t node_id, const ESCStatusCb &cb)
+{
+    AP_ESC_Telem *esc_telem = AP::esc_telem();
+    if (esc_telem == nullptr) {
+        return;
+    }
+
+    AP_ESC_Telem::TelemetryData data {};
+    data.rpm = cb.msg->rpm;
+    data.voltage = cb.msg->voltage;
+    data.current = cb.msg->current;
+    data.temperature = int16_t(cb.msg->temperature - C_TO_KELVIN);
+    data.error_count = cb.msg->error_count;
+
+    esc_telem->update_telemetry(cb.msg->esc_index, data,
+                                AP_ESC_Telem::TELEM_RPM |
+                                AP_ESC_Telem::TELEM_VOLTAGE |
+                                AP_ESC_Telem::TELEM_CURRENT |
+                                AP_ESC_Telem::TELEM_TEMPERATURE);
+}
+
 #endif // HAL_WITH_UAVCAN
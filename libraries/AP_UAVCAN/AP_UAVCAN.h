@@ -58,6 +58,9 @@
 				RegistryBinder(uc, (Registry)ffunc) {} \
 	}
 
+// fwd-declare callback classes
+class ESCStatusCb;
+
 class AP_UAVCAN : public AP_HAL::CANProtocol {
 public:
     AP_UAVCAN();
@@ -146,6 +149,9 @@ private:
     ///// LED /////
     void led_out_send();
 
+    ///// ESC telemetry /////
+    static void handle_ESC_status(AP_UAVCAN* ap_uavcan, uint8_t node_id, const ESCStatusCb &cb);
+
     uavcan::PoolAllocator<UAVCAN_NODE_POOL_SIZE, UAVCAN_NODE_POOL_BLOCK_SIZE, AP_UAVCAN::RaiiSynchronizer> _node_allocator;
 
     // UAVCAN parameters
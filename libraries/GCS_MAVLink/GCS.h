@@ -456,6 +456,11 @@ private:
 
     void log_mavlink_stats();
 
+    uint32_t parse_received_bytes(const uint8_t *buf, uint32_t len,
+                                  uint32_t now_ms, bool try_alternative,
+                                  uint32_t tstart_us, uint32_t max_time_us,
+                                  uint16_t &count, bool &out_of_time);
+
     MAV_RESULT _set_mode_common(const MAV_MODE base_mode, const uint32_t custom_mode);
 
     virtual void        handleMessage(mavlink_message_t * msg) = 0;
@@ -675,7 +680,9 @@ private:
     bool signing_enabled(void) const;
     static void save_signing_timestamp(bool force_save_now);
 
-    // alternative protocol handler support
+    // alternative protocol handler support, the handler is tried
+    // when no MAVLink has been received for the protocol timeout
+    static const uint32_t alternative_protocol_timeout_ms = 4000;
     struct {
         GCS_MAVLINK::protocol_handler_fn_t handler;
         uint32_t last_mavlink_ms;
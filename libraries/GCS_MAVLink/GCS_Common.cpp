@@ -23,7 +23,7 @@
 #include <AP_RangeFinder/RangeFinder_Backend.h>
 #include <AP_Airspeed/AP_Airspeed.h>
 #include <AP_Gripper/AP_Gripper.h>
-#include <AP_BLHeli/AP_BLHeli.h>
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
 #include <AP_Common/Semaphore.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_VisualOdom/AP_VisualOdom.h>
@@ -1459,28 +1459,49 @@ void GCS_MAVLINK::packetReceived(const mavlink_status_t &status,
     handleMessage(&msg);
 }
 
-void
-GCS_MAVLINK::update_receive(uint32_t max_time_us)
+/*
+  parse a buffer of received bytes. Returns the number of bytes
+  consumed, which is less than len if we ran out of time
+
+  Bytes between frames are skipped in bulk but bytes within a frame
+  still go through mavlink_parse_char() as the generated parser keeps
+  the channel's sequence, drop counts, protocol version and signing
+  state. The saving over the byte at a time path comes from reading
+  the UART in spans rather than from frame level parsing.
+ */
+uint32_t GCS_MAVLINK::parse_received_bytes(const uint8_t *buf, uint32_t len,
+                                           uint32_t now_ms, bool try_alternative,
+                                           uint32_t tstart_us, uint32_t max_time_us,
+                                           uint16_t &count, bool &out_of_time)
 {
-    // receive new packets
     mavlink_message_t msg;
     mavlink_status_t status;
-    uint32_t tstart_us = AP_HAL::micros();
-    uint32_t now_ms = AP_HAL::millis();
-
-    hal.util->perf_begin(_perf_update);
+    const mavlink_status_t *chan_status = mavlink_get_channel_status(chan);
+    uint32_t i = 0;
 
     status.packet_rx_drop_count = 0;
 
-    // process received bytes
-    uint16_t nbytes = comm_get_available(chan);
-    for (uint16_t i=0; i<nbytes; i++)
-    {
-        const uint8_t c = (uint8_t)_port->read();
-        const uint32_t protocol_timeout = 4000;
-        
-        if (alternative.handler &&
-            now_ms - alternative.last_mavlink_ms > protocol_timeout) {
+    while (i < len) {
+        if (!try_alternative &&
+            (chan_status->parse_state == MAVLINK_PARSE_STATE_UNINIT ||
+             chan_status->parse_state == MAVLINK_PARSE_STATE_IDLE)) {
+            // between frames the parser drops anything that isn't a
+            // start marker, so skip straight to the next one
+            while (i < len &&
+                   buf[i] != MAVLINK_STX &&
+                   buf[i] != MAVLINK_STX_MAVLINK1) {
+                i++;
+                count++;
+            }
+            if (i == len) {
+                break;
+            }
+        }
+
+        const uint8_t c = buf[i++];
+        count++;
+
+        if (try_alternative) {
             /*
               we have an alternative protocol handler installed and we
               haven't parsed a MAVLink packet for 4 seconds. Try
@@ -1495,7 +1516,7 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
               we may also try parsing as MAVLink if we haven't had a
               successful parse on the alternative protocol for 4s
              */
-            if (now_ms - alternative.last_alternate_ms <= protocol_timeout) {
+            if (now_ms - alternative.last_alternate_ms <= alternative_protocol_timeout_ms) {
                 continue;
             }
         }
@@ -1512,14 +1533,57 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
             alternative.last_mavlink_ms = now_ms;
         }
 
-        if (parsed_packet || i % 100 == 0) {
+        if (parsed_packet || count % 100 == 0) {
             // make sure we don't spend too much time parsing mavlink messages
             if (AP_HAL::micros() - tstart_us > max_time_us) {
+                out_of_time = true;
                 break;
             }
         }
     }
 
+    return i;
+}
+
+void
+GCS_MAVLINK::update_receive(uint32_t max_time_us)
+{
+    // receive new packets
+    uint32_t tstart_us = AP_HAL::micros();
+    uint32_t now_ms = AP_HAL::millis();
+
+    hal.util->perf_begin(_perf_update);
+
+    // process received bytes. Where the HAL supports it we parse
+    // directly from the UART receive buffer rather than making a
+    // read() call per byte. An alternative protocol handler may lock
+    // the port part way through a span, so bytes are read one at a
+    // time while it is being tried
+    uint16_t nbytes = comm_get_available(chan);
+    uint16_t count = 0;
+    bool out_of_time = false;
+    while (count < nbytes && !out_of_time) {
+        const bool try_alternative = alternative.handler &&
+            now_ms - alternative.last_mavlink_ms > alternative_protocol_timeout_ms;
+        uint32_t len;
+        const uint8_t *span = try_alternative ? nullptr : _port->peek_rx(len);
+        if (span != nullptr) {
+            len = MIN(len, uint32_t(nbytes - count));
+            if (!_port->consume_rx(parse_received_bytes(span, len, now_ms, false,
+                                                        tstart_us, max_time_us,
+                                                        count, out_of_time))) {
+                // the port has been locked by another user, leave
+                // the remaining bytes for them
+                break;
+            }
+        } else {
+            const uint8_t c = (uint8_t)_port->read();
+            parse_received_bytes(&c, 1, now_ms, try_alternative,
+                                 tstart_us, max_time_us,
+                                 count, out_of_time);
+        }
+    }
+
     const uint32_t tnow = AP_HAL::millis();
 
     // send a timesync message every 10 seconds; this is for data
@@ -4293,13 +4357,11 @@ bool GCS_MAVLINK::try_send_message(const enum ap_message id)
         break;
 
     case MSG_ESC_TELEMETRY: {
-#ifdef HAVE_AP_BLHELI_SUPPORT
         CHECK_PAYLOAD_SIZE(ESC_TELEMETRY_1_TO_4);
-        AP_BLHeli *blheli = AP_BLHeli::get_singleton();
-        if (blheli) {
-            blheli->send_esc_telemetry_mavlink(uint8_t(chan));
+        AP_ESC_Telem *esc_telem = AP::esc_telem();
+        if (esc_telem) {
+            esc_telem->send_esc_telemetry_mavlink(uint8_t(chan));
         }
-#endif
 #if HAL_WITH_UAVCAN
         uint8_t num_drivers = AP::can().get_num_drivers();
 
@@ -43,6 +43,15 @@ bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
 // per-channel lock
 static HAL_Semaphore chan_locks[MAVLINK_COMM_NUM_BUFFERS];
 
+// per-channel reservation in the UART transmit buffer, held between
+// comm_send_lock() and comm_send_unlock()
+static struct {
+    ByteBuffer::IoVec vec[2];
+    uint8_t n_vec;
+    uint16_t size;
+    uint16_t ofs;
+} chan_tx_reservation[MAVLINK_COMM_NUM_BUFFERS];
+
 mavlink_system_t mavlink_system = {7,1};
 
 // mask of serial ports disabled to allow for SERIAL_CONTROL
@@ -145,15 +154,50 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
         // an alternative protocol is active
         return;
     }
-    mavlink_comm_port[chan]->write(buf, len);
+    auto &r = chan_tx_reservation[chan];
+    if (r.n_vec == 0) {
+        mavlink_comm_port[chan]->write(buf, len);
+        return;
+    }
+    // copy straight into the space reserved in the UART transmit
+    // buffer, which may be split in two where the ring wraps
+    if (len > r.size - r.ofs) {
+        len = r.size - r.ofs;
+    }
+    uint16_t skip = r.ofs;
+    r.ofs += len;
+    for (uint8_t i=0; i<r.n_vec && len > 0; i++) {
+        if (skip >= r.vec[i].len) {
+            skip -= r.vec[i].len;
+            continue;
+        }
+        const uint16_t n = MIN(len, r.vec[i].len - skip);
+        memcpy(&r.vec[i].data[skip], buf, n);
+        buf += n;
+        len -= n;
+        skip = 0;
+    }
 }
 
 /*
-  lock a channel for send
+  lock a channel for send. The whole packet of size bytes is reserved
+  in the UART transmit buffer if the HAL supports it, so the pieces
+  passed to comm_send_buffer() are copied in without further locking
  */
-void comm_send_lock(mavlink_channel_t chan)
+void comm_send_lock(mavlink_channel_t chan, uint16_t size)
 {
+    if (!valid_channel(chan)) {
+        return;
+    }
     chan_locks[(uint8_t)chan].take_blocking();
+    auto &r = chan_tx_reservation[chan];
+    r.n_vec = 0;
+    if (gcs_alternative_active[chan] || (1U<<chan) & mavlink_locked_mask) {
+        return;
+    }
+    r.n_vec = mavlink_comm_port[chan]->reserve_tx(r.vec, size);
+    r.size = size;
+    r.ofs = 0;
 }
 
 /*
@@ -161,5 +205,13 @@ void comm_send_lock(mavlink_channel_t chan)
  */
 void comm_send_unlock(mavlink_channel_t chan)
 {
+    if (!valid_channel(chan)) {
+        return;
+    }
+    auto &r = chan_tx_reservation[chan];
+    if (r.n_vec != 0) {
+        mavlink_comm_port[chan]->commit_tx(r.ofs);
+        r.n_vec = 0;
+    }
     chan_locks[(uint8_t)chan].give();
 }
@@ -394,6 +394,8 @@ void Aircraft::fill_fdm(struct sitl_fdm &fdm)
     fdm.battery_current = battery_current;
     fdm.rpm1 = rpm1;
     fdm.rpm2 = rpm2;
+    fdm.num_escs = num_escs;
+    memcpy(fdm.escs, escs, num_escs * sizeof(struct sitl_esc));
     fdm.rcin_chan_count = rcin_chan_count;
     fdm.range = range;
     memcpy(fdm.rcin, rcin, rcin_chan_count * sizeof(float));
@@ -145,6 +145,8 @@ protected:
     float battery_current = 0.0f;
     float rpm1 = 0;
     float rpm2 = 0;
+    uint8_t num_escs = 0;
+    struct sitl_esc escs[SITL_NUM_ESCS] {};
     uint8_t rcin_chan_count = 0;
     float rcin[8];
     float range = -1.0f;                 // rangefinder detection in m
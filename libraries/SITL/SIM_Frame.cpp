@@ -290,3 +290,20 @@ void Frame::current_and_voltage(const struct sitl_input &input, float &voltage,
     // use average for voltage, total for current
     voltage /= num_motors;
 }
+
+/*
+  update simulated ESC telemetry, indexed by the servo output of each motor
+ */
+uint8_t Frame::update_escs(const struct sitl_input &input, float dt, struct sitl_esc *escs, uint8_t max_escs)
+{
+    uint8_t num_escs = 0;
+    for (uint8_t i=0; i<num_motors; i++) {
+        const uint8_t esc_index = motors[i].servo;
+        if (esc_index >= max_escs) {
+            continue;
+        }
+        motors[i].update_esc(input, dt, motor_offset, escs[esc_index]);
+        num_escs = MAX(num_escs, esc_index+1);
+    }
+    return num_escs;
+}
@@ -58,5 +58,8 @@ public:
 
     // calculate current and voltage
     void current_and_voltage(const struct sitl_input &input, float &voltage, float &current);
+
+    // update simulated ESC telemetry for each motor, returns number of ESCs
+    uint8_t update_escs(const struct sitl_input &input, float dt, struct sitl_esc *escs, uint8_t max_escs);
 };
 }
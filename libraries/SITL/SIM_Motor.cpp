@@ -125,3 +125,34 @@ void Motor::current_and_voltage(const struct sitl_input &input, float &voltage,
         voltage = AP::sitl()->batt_voltage - motor_speed * 0.7;
     }
 }
+
+/*
+  update the simulated ESC telemetry. The RPM follows the command with
+  a first order lag and the ESC heats towards a temperature that rises
+  with current
+ */
+void Motor::update_esc(const struct sitl_input &input, float dt, uint8_t motor_offset, struct sitl_esc &esc)
+{
+    // assume a 920kV motor with a 50ms spin up time constant
+    const float kv = 920;
+    const float rpm_tc = 0.05;
+    // ESC heats by 4C per amp above ambient with a 30s time constant
+    const float ambient_temperature = 25;
+    const float temperature_per_amp = 4;
+    const float temperature_tc = 30;
+
+    float voltage = 0, current = 0;
+    current_and_voltage(input, voltage, current, motor_offset);
+
+    const float motor_speed = constrain_float((input.servos[motor_offset+servo]-1100)/900.0, 0, 1);
+    const float target_rpm = motor_speed * kv * voltage;
+    esc_rpm += (target_rpm - esc_rpm) * constrain_float(dt / rpm_tc, 0, 1);
+
+    const float target_temperature = ambient_temperature + current * temperature_per_amp;
+    esc_temperature += (target_temperature - esc_temperature) * constrain_float(dt / temperature_tc, 0, 1);
+
+    esc.rpm = esc_rpm;
+    esc.voltage = voltage;
+    esc.current = current;
+    esc.temperature = esc_temperature;
+}
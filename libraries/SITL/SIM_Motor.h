@@ -44,6 +44,10 @@ public:
     uint64_t last_change_usec;
     float last_roll_value, last_pitch_value;
 
+    // state of the simulated ESC driving this motor
+    float esc_rpm;
+    float esc_temperature = 25;
+
     Motor(uint8_t _servo, float _angle, float _yaw_factor, uint8_t _display_order) :
         servo(_servo), // what servo output drives this motor
         angle(_angle), // angle in degrees from front
@@ -79,6 +83,9 @@ public:
 
     // calculate current and voltage
     void current_and_voltage(const struct sitl_input &input, float &voltage, float &current, uint8_t motor_offset);
+
+    // update the simulated ESC telemetry for this motor
+    void update_esc(const struct sitl_input &input, float dt, uint8_t motor_offset, struct sitl_esc &esc);
 };
 
 }
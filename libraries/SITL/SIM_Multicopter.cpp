@@ -67,6 +67,9 @@ void MultiCopter::update(const struct sitl_input &input)
     // estimate voltage and current
     frame->current_and_voltage(input, battery_voltage, battery_current);
 
+    // simulate telemetry from each ESC
+    num_escs = frame->update_escs(input, frame_time_us * 1.0e-6f, escs, SITL_NUM_ESCS);
+
     update_dynamics(rot_accel);
     update_external_payload(input);
 
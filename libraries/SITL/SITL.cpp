@@ -152,6 +152,13 @@ const AP_Param::GroupInfo SITL::var_info2[] = {
     AP_GROUPINFO("SHOVE_Y",     31, SITL,  shove.y, 0),
     AP_GROUPINFO("SHOVE_Z",     32, SITL,  shove.z, 0),
     AP_GROUPINFO("SHOVE_TIME",  33, SITL,  shove.t, 0),
+
+    // @Param: ESC_TELEM
+    // @DisplayName: Simulated ESC telemetry
+    // @Description: Enable telemetry from the simulated ESCs of multicopter frames
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("ESC_TELEM",   34, SITL,  esc_telem, 0),
     AP_GROUPEND
 };
     
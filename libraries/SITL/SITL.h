@@ -23,6 +23,16 @@ struct float_array {
     uint16_t length;
     float *data;
 };
+
+// maximum number of simulated ESCs reporting telemetry
+#define SITL_NUM_ESCS 12
+
+struct sitl_esc {
+    float rpm;          // mechanical RPM
+    float voltage;      // Volts
+    float current;      // Amps
+    float temperature;  // degrees C
+};
     
 
 struct sitl_fdm {
@@ -47,6 +57,8 @@ struct sitl_fdm {
     double range;           // rangefinder value
     Vector3f bodyMagField;  // Truth XYZ magnetic field vector in body-frame. Includes motor interference. Units are milli-Gauss.
     Vector3f angAccel; // Angular acceleration in degrees/s/s about the XYZ body axes
+    uint8_t num_escs;       // number of ESCs reporting telemetry
+    struct sitl_esc escs[SITL_NUM_ESCS];
 
     struct {
         // data from simulated laser scanner, if available
@@ -162,6 +174,7 @@ public:
     AP_Vector3f gps2_glitch; // glitch offsets in lat, lon and altitude for 2nd GPS
     AP_Int8  gps_hertz;   // GPS update rate in Hz
     AP_Float batt_voltage; // battery voltage base
+    AP_Int8 esc_telem;     // enable simulated ESC telemetry
     AP_Float accel_fail;  // accelerometer failure value
     AP_Int8  rc_fail;     // fail RC input
     AP_Int8  rc_chancount; // channel count
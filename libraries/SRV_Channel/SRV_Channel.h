@@ -21,6 +21,7 @@
 #include <AP_RobotisServo/AP_RobotisServo.h>
 #include <AP_SBusOut/AP_SBusOut.h>
 #include <AP_BLHeli/AP_BLHeli.h>
+#include <AP_ESC_Telem/AP_ESC_Telem.h>
 
 #define NUM_SERVO_CHANNELS 16
 
@@ -447,6 +448,9 @@ public:
 
     static void push();
 
+    // log ESC telemetry, must be called from the main thread as push() may run on another thread
+    void update_esc_telem(void) { esc_telem.update(); }
+
     // disable output to a set of channels given by a mask. This is used by the AP_BLHeli code
     static void set_disabled_channel_mask(uint16_t mask) { disabled_mask = mask; }
 
@@ -495,6 +499,9 @@ private:
     // support for Robotis servo protocol
     AP_RobotisServo robotis;
     static AP_RobotisServo *robotis_ptr;
+
+    // store for ESC telemetry
+    AP_ESC_Telem esc_telem;
     
 #if HAL_SUPPORT_RCOUT_SERIAL
     // support for BLHeli protocol
@@ -243,11 +243,6 @@ void SRV_Channels::push()
 
     // give robotis library a chance to update
     robotis_ptr->update();
-    
-#if HAL_SUPPORT_RCOUT_SERIAL
-    // give blheli telemetry a chance to update
-    blheli_ptr->update_telemetry();
-#endif
 
 #if HAL_WITH_UAVCAN
     // push outputs to CAN